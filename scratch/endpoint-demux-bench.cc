@@ -0,0 +1,184 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// Transport end point demultiplexing benchmark.
+//
+// A sink node binds --sockets UDP sockets (10000 by default) to as many
+// ports, on IPv4 and on IPv6, as a farm of UdpServer applications does.
+// A source node, on the other end of a point-to-point link, sends
+// --packets UDP packets of --size bytes to the ports in turn, first over
+// IPv4, then over IPv6. The program reports, for each family, the time
+// taken to bind the sockets, the packets received by the sockets and the
+// receive rate in packets per second of processor time.
+//
+// ./waf --run "endpoint-demux-bench --sockets=10000 --packets=500000"
+//
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+
+#include <ctime>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("EndpointDemuxBench");
+
+static uint32_t g_received = 0;
+
+static void
+CountPackets (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      g_received++;
+    }
+}
+
+static void
+SendPacket (Ptr<Socket> socket, uint32_t size, Address to)
+{
+  socket->SendTo (Create<Packet> (size), 0, to);
+}
+
+/**
+ * Bind the sockets of the sink, send the packets and report the rate.
+ * \param name the name of the run
+ * \param sink the sink node
+ * \param source the source node
+ * \param sinkAddress the address of the sink, with port 0
+ * \param anyAddress the wildcard address of the family, with port 0
+ * \param sockets the number of sockets
+ * \param packets the number of packets
+ * \param size the size of the packets
+ * \param start the time of the first packet
+ */
+static void
+Run (std::string name, Ptr<Node> sink, Ptr<Node> source, Address sinkAddress, Address anyAddress,
+     uint32_t sockets, uint32_t packets, uint32_t size, Time start)
+{
+  const uint16_t firstPort = 10000;
+  std::vector<Ptr<Socket> > sinkSockets;
+  std::clock_t clock = std::clock ();
+  for (uint32_t i = 0; i < sockets; i++)
+    {
+      Ptr<Socket> socket = Socket::CreateSocket (sink, UdpSocketFactory::GetTypeId ());
+      Address local = anyAddress;
+      if (InetSocketAddress::IsMatchingType (local))
+        {
+          InetSocketAddress inet = InetSocketAddress::ConvertFrom (local);
+          inet.SetPort (firstPort + i);
+          local = inet;
+        }
+      else
+        {
+          Inet6SocketAddress inet6 = Inet6SocketAddress::ConvertFrom (local);
+          inet6.SetPort (firstPort + i);
+          local = inet6;
+        }
+      socket->Bind (local);
+      socket->SetRecvCallback (MakeCallback (&CountPackets));
+      sinkSockets.push_back (socket);
+    }
+  double setup = (double) (std::clock () - clock) / CLOCKS_PER_SEC;
+
+  Ptr<Socket> sourceSocket = Socket::CreateSocket (source, UdpSocketFactory::GetTypeId ());
+  if (InetSocketAddress::IsMatchingType (sinkAddress))
+    {
+      sourceSocket->Bind ();
+    }
+  else
+    {
+      sourceSocket->Bind6 ();
+    }
+  for (uint32_t i = 0; i < packets; i++)
+    {
+      Address to = sinkAddress;
+      if (InetSocketAddress::IsMatchingType (to))
+        {
+          InetSocketAddress inet = InetSocketAddress::ConvertFrom (to);
+          inet.SetPort (firstPort + i % sockets);
+          to = inet;
+        }
+      else
+        {
+          Inet6SocketAddress inet6 = Inet6SocketAddress::ConvertFrom (to);
+          inet6.SetPort (firstPort + i % sockets);
+          to = inet6;
+        }
+      // the link is fast enough for the packets not to be queued
+      Simulator::Schedule (start + MicroSeconds (i), &SendPacket, sourceSocket, size, to);
+    }
+
+  g_received = 0;
+  clock = std::clock ();
+  Simulator::Run ();
+  double seconds = (double) (std::clock () - clock) / CLOCKS_PER_SEC;
+  std::cout << name << "\t" << setup << "\t" << g_received << "/" << packets
+            << "\t" << g_received / seconds << std::endl;
+
+  for (uint32_t i = 0; i < sockets; i++)
+    {
+      sinkSockets[i]->Close ();
+    }
+  sourceSocket->Close ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t sockets = 10000;
+  uint32_t packets = 200000;
+  uint32_t size = 100;
+
+  CommandLine cmd;
+  cmd.AddValue ("sockets", "Number of bound sockets of the sink", sockets);
+  cmd.AddValue ("packets", "Number of packets received in each run", packets);
+  cmd.AddValue ("size", "Size of the payload of the packets (bytes)", size);
+  cmd.Parse (argc, argv);
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  Ptr<Node> source = nodes.Get (0);
+  Ptr<Node> sink = nodes.Get (1);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  PointToPointHelper p2ph;
+  p2ph.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("100Gb/s")));
+  p2ph.SetChannelAttribute ("Delay", TimeValue (Seconds (0)));
+  NetDeviceContainer devices = p2ph.Install (source, sink);
+  Ipv4AddressHelper ipv4Addresses ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer ipv4Ifaces = ipv4Addresses.Assign (devices);
+  Ipv6AddressHelper ipv6Addresses;
+  ipv6Addresses.SetBase (Ipv6Address ("2001:1::"), Ipv6Prefix (64));
+  Ipv6InterfaceContainer ipv6Ifaces = ipv6Addresses.Assign (devices);
+
+  std::cout << sockets << " sockets, " << packets << " packets, " << size << " bytes" << std::endl;
+  std::cout << "family\tbind(s)\treceived\tpackets/s" << std::endl;
+  Run ("IPv4", sink, source, InetSocketAddress (ipv4Ifaces.GetAddress (1), 0),
+       InetSocketAddress (Ipv4Address::GetAny (), 0), sockets, packets, size, Seconds (1));
+  // after the duplicate address detection of IPv6
+  Run ("IPv6", sink, source, Inet6SocketAddress (ipv6Ifaces.GetAddress (1, 1), 0),
+       Inet6SocketAddress (Ipv6Address::GetAny (), 0), sockets, packets, size, Simulator::Now () + Seconds (5));
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,196 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// EPC TFT classifier benchmark.
+//
+// Creates one EpcTftClassifier per UE for --ues UEs (1000 by default),
+// each with a default bearer and --bearers - 1 dedicated bearers (10
+// bearers in total by default). The TFT of a dedicated bearer has a
+// downlink filter on a range of local ports, and an uplink filter on a
+// remote port and, for every other bearer, a remote address prefix, as
+// the TFTs of the LTE examples. Then --packets UDP packets over IPv4, or
+// IPv6 with --ipv6, are classified in each direction, as the PGW and the
+// UE NAS do; most of them match a dedicated bearer, the others fall back
+// to the default bearer. The program reports the classifications per
+// second of processor time in each direction, and a checksum of the
+// results to compare implementations.
+//
+// ./waf --run "epc-tft-classifier-bench --ues=1000 --bearers=10 --ipv6=1"
+//
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/lte-module.h"
+
+#include <ctime>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("EpcTftClassifierBench");
+
+static const uint16_t DL_PORT_BASE = 10000; ///< first local port of the downlink filters
+static const uint16_t UL_PORT_BASE = 20000; ///< remote port of the uplink filter of the first dedicated bearer
+
+static Ptr<EpcTft>
+CreateDedicatedTft (uint32_t bearer, bool ipv6)
+{
+  Ptr<EpcTft> tft = Create<EpcTft> ();
+  EpcTft::PacketFilter dlpf (!ipv6);
+  dlpf.direction = EpcTft::DOWNLINK;
+  dlpf.localPortStart = DL_PORT_BASE + 10 * bearer;
+  dlpf.localPortEnd = DL_PORT_BASE + 10 * bearer + 9;
+  tft->Add (dlpf);
+  EpcTft::PacketFilter ulpf (!ipv6);
+  ulpf.direction = EpcTft::UPLINK;
+  ulpf.remotePortStart = UL_PORT_BASE + bearer;
+  ulpf.remotePortEnd = UL_PORT_BASE + bearer;
+  if (bearer % 2)
+    {
+      if (ipv6)
+        {
+          ulpf.remoteAddress6 = Ipv6Address ("2001:db8::");
+          ulpf.remotePrefix = Ipv6Prefix (32);
+        }
+      else
+        {
+          ulpf.remoteAddress = Ipv4Address ("1.0.0.0");
+          ulpf.remoteMask = Ipv4Mask ("255.0.0.0");
+        }
+    }
+  tft->Add (ulpf);
+  return tft;
+}
+
+static Ptr<Packet>
+CreatePacket (bool ipv6, uint32_t ue, uint16_t sourcePort, uint16_t destinationPort, bool uplink)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  UdpHeader udp;
+  udp.SetSourcePort (sourcePort);
+  udp.SetDestinationPort (destinationPort);
+  p->AddHeader (udp);
+  if (ipv6)
+    {
+      Ipv6Header ip;
+      // b0::<ue + 2>
+      uint8_t ueBytes[16] = { 0x00, 0xb0 };
+      ueBytes[12] = (ue + 2) >> 24;
+      ueBytes[13] = (ue + 2) >> 16;
+      ueBytes[14] = (ue + 2) >> 8;
+      ueBytes[15] = (ue + 2);
+      Ipv6Address ueAddr (ueBytes);
+      Ipv6Address remoteAddr ("2001:db8::1");
+      ip.SetSourceAddress (uplink ? ueAddr : remoteAddr);
+      ip.SetDestinationAddress (uplink ? remoteAddr : ueAddr);
+      ip.SetNextHeader (UdpL4Protocol::PROT_NUMBER);
+      ip.SetPayloadLength (p->GetSize ());
+      p->AddHeader (ip);
+    }
+  else
+    {
+      Ipv4Header ip;
+      Ipv4Address ueAddr (0x07000002 + ue);
+      Ipv4Address remoteAddr ("1.0.0.2");
+      ip.SetSource (uplink ? ueAddr : remoteAddr);
+      ip.SetDestination (uplink ? remoteAddr : ueAddr);
+      ip.SetProtocol (UdpL4Protocol::PROT_NUMBER);
+      ip.SetPayloadSize (p->GetSize ());
+      p->AddHeader (ip);
+    }
+  return p;
+}
+
+static void
+Run (const std::vector<Ptr<EpcTftClassifier> > &classifiers, const std::vector<Ptr<Packet> > &packets,
+     const std::vector<uint32_t> &ues, EpcTft::Direction direction, uint32_t n,
+     double &rate, uint64_t &checksum)
+{
+  std::clock_t start = std::clock ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      uint32_t k = i % packets.size ();
+      checksum += classifiers[ues[k]]->Classify (packets[k], direction);
+    }
+  rate = n / ((double) (std::clock () - start) / CLOCKS_PER_SEC);
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nUes = 1000;
+  uint32_t bearers = 10;
+  uint32_t n = 2000000;
+  bool ipv6 = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("ues", "Number of UEs", nUes);
+  cmd.AddValue ("bearers", "Number of bearers per UE, including the default one", bearers);
+  cmd.AddValue ("packets", "Number of packets classified in each direction", n);
+  cmd.AddValue ("ipv6", "Classify IPv6 packets instead of IPv4 ones", ipv6);
+  cmd.Parse (argc, argv);
+
+  std::vector<Ptr<EpcTftClassifier> > classifiers;
+  for (uint32_t u = 0; u < nUes; u++)
+    {
+      Ptr<EpcTftClassifier> c = Create<EpcTftClassifier> ();
+      // the default bearer is added first, and gets the lowest identifier
+      c->Add (EpcTft::Default (!ipv6), 1);
+      for (uint32_t b = 2; b <= bearers; b++)
+        {
+          c->Add (CreateDedicatedTft (b, ipv6), b);
+        }
+      classifiers.push_back (c);
+    }
+
+  // a pool of packets of random UEs and bearers, one in 8 of which
+  // matches no dedicated bearer
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  uniform->SetStream (1);
+  const uint32_t poolSize = 8192;
+  std::vector<Ptr<Packet> > dlPackets;
+  std::vector<Ptr<Packet> > ulPackets;
+  std::vector<uint32_t> ues;
+  for (uint32_t k = 0; k < poolSize; k++)
+    {
+      uint32_t ue = uniform->GetInteger (0, nUes - 1);
+      uint32_t bearer = uniform->GetInteger (2, bearers);
+      bool dedicated = (bearers > 1) && (uniform->GetInteger (0, 7) > 0);
+      uint16_t remotePort = uniform->GetInteger (40000, 50000);
+      uint16_t dlPort = dedicated ? DL_PORT_BASE + 10 * bearer + uniform->GetInteger (0, 9) : 9;
+      uint16_t ulPort = dedicated ? UL_PORT_BASE + bearer : 9;
+      dlPackets.push_back (CreatePacket (ipv6, ue, remotePort, dlPort, false));
+      ulPackets.push_back (CreatePacket (ipv6, ue, remotePort, ulPort, true));
+      ues.push_back (ue);
+    }
+
+  double dlRate;
+  double ulRate;
+  uint64_t checksum = 0;
+  Run (classifiers, dlPackets, ues, EpcTft::DOWNLINK, n, dlRate, checksum);
+  Run (classifiers, ulPackets, ues, EpcTft::UPLINK, n, ulRate, checksum);
+
+  std::cout << "IP version:                    " << (ipv6 ? 6 : 4) << std::endl
+            << "UEs:                           " << nUes << std::endl
+            << "bearers per UE:                " << bearers << std::endl
+            << "DL classifications per second: " << dlRate << std::endl
+            << "UL classifications per second: " << ulRate << std::endl
+            << "checksum:                      " << checksum << std::endl;
+  return 0;
+}
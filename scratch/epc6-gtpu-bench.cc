@@ -0,0 +1,241 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// IPv6 SGW/PGW user plane benchmark.
+//
+// An Epc6SgwPgwApplication is set up as PointToPointEpc6Helper does,
+// with a S1-U point-to-point link to an eNB node, and --ues UEs with a
+// default bearer each, whose sessions are created directly through the
+// S11 SAP. First, --packets downlink IPv6 packets of --size bytes
+// addressed to the UEs in turn are handed to the SGW/PGW as its TUN
+// device would, and tunnelled over GTP-U/UDP/IPv6 to a socket of the eNB
+// node. Then, the eNB node sends as many GTP-U packets to the SGW/PGW,
+// which decapsulates them and delivers them through its TUN device to a
+// socket of the PGW node. The program reports the packets received at
+// both ends and the rate of each direction, in packets per second of
+// processor time.
+//
+// ./waf --run "epc6-gtpu-bench --ues=50 --packets=500000"
+//
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/virtual-net-device-module.h"
+#include "ns3/lte-module.h"
+
+#include <ctime>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("Epc6GtpuBench");
+
+/**
+ * MME side of the S11 SAP, which ignores the answers of the SGW/PGW.
+ */
+class BenchS11SapMme : public EpcS11SapMme
+{
+public:
+  virtual void CreateSessionResponse (CreateSessionResponseMessage msg)
+  {
+  }
+  virtual void ModifyBearerResponse (ModifyBearerResponseMessage msg)
+  {
+  }
+  virtual void DeleteBearerRequest (DeleteBearerRequestMessage msg)
+  {
+  }
+};
+
+static uint32_t g_received = 0;
+
+static void
+CountPackets (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      g_received++;
+    }
+}
+
+static void
+SendDownlink (Ptr<Epc6SgwPgwApplication> sgwPgwApp, Ipv6Address remoteAddr,
+              const std::vector<Ipv6Address> &ueAddrs, uint32_t size, uint32_t n, Time start, Time interval)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (size);
+      UdpHeader udp;
+      udp.SetSourcePort (4000);
+      udp.SetDestinationPort (5000);
+      p->AddHeader (udp);
+      Ipv6Header ip;
+      ip.SetSourceAddress (remoteAddr);
+      ip.SetDestinationAddress (ueAddrs[i % ueAddrs.size ()]);
+      ip.SetNextHeader (UdpL4Protocol::PROT_NUMBER);
+      ip.SetPayloadLength (p->GetSize ());
+      ip.SetHopLimit (64);
+      p->AddHeader (ip);
+      // the TUN device calls the SGW/PGW back as soon as it is handed a
+      // packet, so that each packet is tunnelled at its own time
+      Simulator::Schedule (start + interval * i, &Epc6SgwPgwApplication::RecvFromTunDevice, sgwPgwApp,
+                           p, Address (), Address (), Ipv6L3Protocol::PROT_NUMBER);
+    }
+}
+
+static void
+SendGtpu (Ptr<Socket> socket, Ptr<Packet> p, Inet6SocketAddress to)
+{
+  socket->SendTo (p, 0, to);
+}
+
+static void
+SendUplink (Ptr<Socket> socket, Ipv6Address sgwAddr, Ipv6Address pgwAddr,
+            const std::vector<Ipv6Address> &ueAddrs, uint32_t size, uint32_t n, Time start, Time interval)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (size);
+      UdpHeader udp;
+      udp.SetSourcePort (5000);
+      udp.SetDestinationPort (4000);
+      p->AddHeader (udp);
+      Ipv6Header ip;
+      ip.SetSourceAddress (ueAddrs[i % ueAddrs.size ()]);
+      ip.SetDestinationAddress (pgwAddr);
+      ip.SetNextHeader (UdpL4Protocol::PROT_NUMBER);
+      ip.SetPayloadLength (p->GetSize ());
+      ip.SetHopLimit (64);
+      p->AddHeader (ip);
+      GtpuHeader gtpu;
+      // the SGW/PGW allocates the TEIDs from 1, one per UE here
+      gtpu.SetTeid (1 + i % ueAddrs.size ());
+      gtpu.SetLength (p->GetSize () + gtpu.GetSerializedSize () - 8);
+      p->AddHeader (gtpu);
+      Simulator::Schedule (start + interval * i, &SendGtpu, socket, p, Inet6SocketAddress (sgwAddr, 2152));
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t ues = 10;
+  uint32_t packets = 200000;
+  uint32_t size = 1000;
+
+  CommandLine cmd;
+  cmd.AddValue ("ues", "Number of UEs", ues);
+  cmd.AddValue ("packets", "Number of packets sent in each direction", packets);
+  cmd.AddValue ("size", "Size of the payload of the UDP packets (bytes)", size);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault ("ns3::Ipv6::IpForward", BooleanValue (true));
+  const uint16_t gtpuUdpPort = 2152;
+  const uint16_t cellId = 1;
+  // the S1-U link is fast enough for the packets not to be queued
+  Time interval = MicroSeconds (1);
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  Ptr<Node> sgwPgw = nodes.Get (0);
+  Ptr<Node> enb = nodes.Get (1);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  sgwPgw->GetObject<Ipv6> ()->SetAttribute ("SendIcmpv6Redirect", BooleanValue (false));
+
+  PointToPointHelper p2ph;
+  p2ph.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("100Gb/s")));
+  p2ph.SetDeviceAttribute ("Mtu", UintegerValue (2000));
+  p2ph.SetChannelAttribute ("Delay", TimeValue (Seconds (0)));
+  NetDeviceContainer s1uDevices = p2ph.Install (enb, sgwPgw);
+  Ipv6AddressHelper s1uAddressHelper;
+  s1uAddressHelper.SetBase ("a0::", 64);
+  Ipv6InterfaceContainer s1uIfaces = s1uAddressHelper.Assign (s1uDevices);
+  Ipv6Address enbAddr = s1uIfaces.GetAddress (0, 1);
+  Ipv6Address sgwAddr = s1uIfaces.GetAddress (1, 1);
+
+  Ptr<Socket> sgwS1uSocket = Socket::CreateSocket (sgwPgw, UdpSocketFactory::GetTypeId ());
+  sgwS1uSocket->Bind (Inet6SocketAddress (Ipv6Address::GetAny (), gtpuUdpPort));
+  Ptr<VirtualNetDevice> tunDevice = CreateObject<VirtualNetDevice> ();
+  tunDevice->SetAttribute ("Mtu", UintegerValue (30000));
+  tunDevice->SetAddress (Mac48Address::Allocate ());
+  sgwPgw->AddDevice (tunDevice);
+  Ipv6AddressHelper ueAddressHelper;
+  ueAddressHelper.SetBase ("b0::", 64);
+  Ipv6InterfaceContainer tunIfaces = ueAddressHelper.Assign (NetDeviceContainer (tunDevice));
+  Ipv6Address pgwAddr = tunIfaces.GetAddress (0, 1);
+
+  Ptr<Epc6SgwPgwApplication> sgwPgwApp = CreateObject<Epc6SgwPgwApplication> (tunDevice, sgwS1uSocket);
+  sgwPgw->AddApplication (sgwPgwApp);
+  tunDevice->SetSendCallback (MakeCallback (&Epc6SgwPgwApplication::RecvFromTunDevice, sgwPgwApp));
+  BenchS11SapMme mme;
+  sgwPgwApp->SetS11SapMme (&mme);
+  sgwPgwApp->AddEnb (cellId, enbAddr, sgwAddr);
+
+  std::vector<Ipv6Address> ueAddrs;
+  for (uint32_t u = 0; u < ues; u++)
+    {
+      uint64_t imsi = u + 1;
+      Ipv6Address ueAddr = ueAddressHelper.NewAddress ();
+      sgwPgwApp->AddUe (imsi);
+      sgwPgwApp->SetUeAddress (imsi, ueAddr);
+      EpcS11SapSgw::CreateSessionRequestMessage req;
+      req.imsi = imsi;
+      req.uli.gci = cellId;
+      EpcS11SapSgw::BearerContextToBeCreated bearer;
+      bearer.epsBearerId = 1;
+      bearer.bearerLevelQos = EpsBearer (EpsBearer::NGBR_VIDEO_TCP_DEFAULT);
+      bearer.tft = EpcTft::Default (false);
+      req.bearerContextsToBeCreated.push_back (bearer);
+      sgwPgwApp->GetS11SapSgw ()->CreateSessionRequest (req);
+      ueAddrs.push_back (ueAddr);
+    }
+
+  // downlink: remote host -> SGW/PGW -> eNB
+  Ptr<Socket> enbS1uSocket = Socket::CreateSocket (enb, UdpSocketFactory::GetTypeId ());
+  enbS1uSocket->Bind (Inet6SocketAddress (enbAddr, gtpuUdpPort));
+  enbS1uSocket->SetRecvCallback (MakeCallback (&CountPackets));
+  SendDownlink (sgwPgwApp, Ipv6Address ("c0::1"), ueAddrs, size, packets, Seconds (0), interval);
+  std::clock_t start = std::clock ();
+  Simulator::Run ();
+  double dlSeconds = (double) (std::clock () - start) / CLOCKS_PER_SEC;
+  uint32_t dlReceived = g_received;
+
+  // uplink: eNB -> SGW/PGW -> PGW node
+  g_received = 0;
+  Ptr<Socket> pgwSocket = Socket::CreateSocket (sgwPgw, UdpSocketFactory::GetTypeId ());
+  pgwSocket->Bind (Inet6SocketAddress (Ipv6Address::GetAny (), 4000));
+  pgwSocket->SetRecvCallback (MakeCallback (&CountPackets));
+  SendUplink (enbS1uSocket, sgwAddr, pgwAddr, ueAddrs, size, packets, Seconds (1), interval);
+  start = std::clock ();
+  Simulator::Run ();
+  double ulSeconds = (double) (std::clock () - start) / CLOCKS_PER_SEC;
+  uint32_t ulReceived = g_received;
+
+  std::cout << "UEs:                  " << ues << std::endl
+            << "packet size (bytes):  " << size << std::endl
+            << "DL packets received:  " << dlReceived << "/" << packets << std::endl
+            << "DL rate (packets/s):  " << dlReceived / dlSeconds << std::endl
+            << "UL packets received:  " << ulReceived << "/" << packets << std::endl
+            << "UL rate (packets/s):  " << ulReceived / ulSeconds << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,218 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// Unicast forwarding lookup benchmark.
+//
+// Fills the routing tables of a node with --prefixes random prefixes
+// (100000 by default) and a default route, then looks up the routes of
+// --lookups destinations, half of which are in one of the prefixes, as
+// the node does for each packet it forwards or sends:
+//  - Ipv4StaticRouting, with /16 and /24 network routes,
+//  - Ipv4GlobalRouting, with as many /24 network routes and host routes
+//    as global routing installs for the interfaces of a large topology,
+//  - Ipv6StaticRouting, with /48 and /64 network routes.
+// The program reports the time taken to install the routes and the
+// lookups per second of processor time of each routing protocol.
+//
+// ./waf --run "ip-fib-bench --prefixes=100000 --lookups=1000000"
+//
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+
+#include <ctime>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("IpFibBench");
+
+/**
+ * \param rng the random draws
+ * \return a random unicast IPv4 address
+ */
+static Ipv4Address
+GetRandomIpv4Address (Ptr<UniformRandomVariable> rng)
+{
+  return Ipv4Address ((rng->GetInteger (1, 223) << 24) | rng->GetInteger (0, 0xffffff));
+}
+
+/**
+ * \param rng the random draws
+ * \return a random global unicast IPv6 address
+ */
+static Ipv6Address
+GetRandomIpv6Address (Ptr<UniformRandomVariable> rng)
+{
+  uint8_t address[16];
+  address[0] = 0x20;
+  for (uint32_t i = 1; i < 16; i++)
+    {
+      address[i] = rng->GetInteger (0, 255);
+    }
+  return Ipv6Address (address);
+}
+
+/**
+ * Report the rate of a run.
+ * \param name the name of the run
+ * \param setup the time taken to install the routes (s)
+ * \param lookups the number of lookups
+ * \param found the number of lookups which found a route
+ * \param start the start of the lookups
+ */
+static void
+Report (std::string name, double setup, uint32_t lookups, uint32_t found, std::clock_t start)
+{
+  double seconds = (double) (std::clock () - start) / CLOCKS_PER_SEC;
+  std::cout << name << "\t" << setup << "\t" << lookups / seconds << "\t" << found << std::endl;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t prefixes = 100000;
+  uint32_t lookups = 1000000;
+
+  CommandLine cmd;
+  cmd.AddValue ("prefixes", "Number of prefixes of each routing table", prefixes);
+  cmd.AddValue ("lookups", "Number of route lookups per routing protocol", lookups);
+  cmd.Parse (argc, argv);
+
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  device->SetAddress (Mac48Address::Allocate ());
+  device->SetChannel (CreateObject<SimpleChannel> ());
+  node->AddDevice (device);
+  Ipv4AddressHelper ipv4Addresses ("10.255.0.0", "255.255.0.0");
+  ipv4Addresses.Assign (NetDeviceContainer (device));
+  Ipv6AddressHelper ipv6Addresses;
+  ipv6Addresses.SetBase (Ipv6Address ("2001:ffff::"), Ipv6Prefix (64));
+  ipv6Addresses.Assign (NetDeviceContainer (device));
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  Ptr<Ipv6> ipv6 = node->GetObject<Ipv6> ();
+  uint32_t ipv4Interface = ipv4->GetInterfaceForDevice (device);
+  uint32_t ipv6Interface = ipv6->GetInterfaceForDevice (device);
+  // the default routes have their own gateway
+  Ipv4Address ipv4Gateway ("10.255.0.2");
+  Ipv4Address ipv4DefaultGateway ("10.255.0.3");
+  Ipv6Address ipv6Gateway ("2001:ffff::2");
+  Ipv6Address ipv6DefaultGateway ("2001:ffff::3");
+
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+  std::vector<Ipv4Address> ipv4Prefixes;
+  std::vector<Ipv6Address> ipv6Prefixes;
+  for (uint32_t i = 0; i < prefixes; i++)
+    {
+      ipv4Prefixes.push_back (GetRandomIpv4Address (rng));
+      ipv6Prefixes.push_back (GetRandomIpv6Address (rng));
+    }
+  // half of the destinations are in one of the prefixes
+  std::vector<Ipv4Header> ipv4Headers;
+  std::vector<Ipv6Header> ipv6Headers;
+  for (uint32_t i = 0; i < 4096; i++)
+    {
+      uint32_t p = rng->GetInteger (0, prefixes - 1);
+      bool inPrefix = (i % 2 == 0);
+      Ipv4Header ipv4Header;
+      ipv4Header.SetDestination (inPrefix ? Ipv4Address (ipv4Prefixes[p].Get () | (i & 0xff)) : GetRandomIpv4Address (rng));
+      ipv4Headers.push_back (ipv4Header);
+      Ipv6Header ipv6Header;
+      ipv6Header.SetDestinationAddress (inPrefix ? ipv6Prefixes[p] : GetRandomIpv6Address (rng));
+      ipv6Headers.push_back (ipv6Header);
+    }
+
+  std::cout << prefixes << " prefixes, " << lookups << " lookups" << std::endl;
+  std::cout << "routing\tsetup(s)\tlookups/s\tfound" << std::endl;
+
+  // IPv4 static routing
+  Ipv4StaticRoutingHelper ipv4RoutingHelper;
+  Ptr<Ipv4StaticRouting> ipv4Static = ipv4RoutingHelper.GetStaticRouting (ipv4);
+  std::clock_t start = std::clock ();
+  for (uint32_t i = 0; i < prefixes; i++)
+    {
+      Ipv4Mask mask ((i % 4 == 0) ? "255.255.0.0" : "255.255.255.0");
+      ipv4Static->AddNetworkRouteTo (ipv4Prefixes[i].CombineMask (mask), mask, ipv4Gateway, ipv4Interface);
+    }
+  ipv4Static->SetDefaultRoute (ipv4DefaultGateway, ipv4Interface);
+  double setup = (double) (std::clock () - start) / CLOCKS_PER_SEC;
+  uint32_t found = 0;
+  Socket::SocketErrno sockerr;
+  start = std::clock ();
+  for (uint32_t i = 0; i < lookups; i++)
+    {
+      if (ipv4Static->RouteOutput (0, ipv4Headers[i % ipv4Headers.size ()], 0, sockerr)->GetGateway () == ipv4Gateway)
+        {
+          found++;
+        }
+    }
+  Report ("Ipv4StaticRouting", setup, lookups, found, start);
+
+  // IPv4 global routing, not installed on the node so that its routes
+  // are looked up directly
+  Ptr<Ipv4GlobalRouting> ipv4Global = CreateObject<Ipv4GlobalRouting> ();
+  ipv4Global->SetIpv4 (ipv4);
+  start = std::clock ();
+  for (uint32_t i = 0; i < prefixes; i++)
+    {
+      Ipv4Mask mask ("255.255.255.0");
+      ipv4Global->AddNetworkRouteTo (ipv4Prefixes[i].CombineMask (mask), mask, ipv4Gateway, ipv4Interface);
+      ipv4Global->AddHostRouteTo (Ipv4Address (ipv4Prefixes[i].CombineMask (mask).Get () | 1), ipv4Gateway, ipv4Interface);
+    }
+  setup = (double) (std::clock () - start) / CLOCKS_PER_SEC;
+  found = 0;
+  start = std::clock ();
+  for (uint32_t i = 0; i < lookups; i++)
+    {
+      if (ipv4Global->RouteOutput (0, ipv4Headers[i % ipv4Headers.size ()], 0, sockerr))
+        {
+          found++;
+        }
+    }
+  Report ("Ipv4GlobalRouting", setup, lookups, found, start);
+
+  // IPv6 static routing
+  Ipv6StaticRoutingHelper ipv6RoutingHelper;
+  Ptr<Ipv6StaticRouting> ipv6Static = ipv6RoutingHelper.GetStaticRouting (ipv6);
+  start = std::clock ();
+  for (uint32_t i = 0; i < prefixes; i++)
+    {
+      Ipv6Prefix prefix ((i % 4 == 0) ? 48 : 64);
+      ipv6Static->AddNetworkRouteTo (ipv6Prefixes[i].CombinePrefix (prefix), prefix, ipv6Gateway, ipv6Interface);
+    }
+  ipv6Static->SetDefaultRoute (ipv6DefaultGateway, ipv6Interface);
+  setup = (double) (std::clock () - start) / CLOCKS_PER_SEC;
+  found = 0;
+  start = std::clock ();
+  for (uint32_t i = 0; i < lookups; i++)
+    {
+      if (ipv6Static->RouteOutput (0, ipv6Headers[i % ipv6Headers.size ()], 0, sockerr)->GetGateway () == ipv6Gateway)
+        {
+          found++;
+        }
+    }
+  Report ("Ipv6StaticRouting", setup, lookups, found, start);
+
+  ipv4Global->Dispose ();
+  Simulator::Destroy ();
+  return 0;
+}
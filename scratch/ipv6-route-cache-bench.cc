@@ -0,0 +1,227 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// IPv6 forwarding benchmark.
+//
+// A router node is set up as a MAG or LMA is, with static source routing
+// and static routing in a list routing, and --routes /64 routes through
+// a point-to-point link to a sink. --packets IPv6 packets of --flows
+// flows (pairs of source and destination) are handed to the router as
+// its ingress point-to-point device would, first with the route cache of
+// Ipv6L3Protocol turned off, then on. The program reports, for each run,
+// the packets received by the sink, the forwarding rate in packets per
+// second of processor time, and the route cache hits and misses.
+//
+// ./waf --run "ipv6-route-cache-bench --routes=1000 --flows=100 --packets=500000"
+//
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/pmipv6-module.h"
+
+#include <ctime>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("Ipv6RouteCacheBench");
+
+static uint32_t g_received = 0;
+static uint32_t g_hits = 0;
+static uint32_t g_misses = 0;
+
+static void
+CountPacket (Ptr<const Packet> p)
+{
+  g_received++;
+}
+
+static void
+CountLookup (const Ipv6Header &header, uint32_t interface, bool hit)
+{
+  if (hit)
+    {
+      g_hits++;
+    }
+  else
+    {
+      g_misses++;
+    }
+}
+
+/**
+ * \param rng the random draws
+ * \param prefix the first 4 bytes of the address
+ * \return a random address in prefix/32
+ */
+static Ipv6Address
+GetRandomAddress (Ptr<UniformRandomVariable> rng, uint32_t prefix)
+{
+  uint8_t address[16];
+  address[0] = prefix >> 24;
+  address[1] = prefix >> 16;
+  address[2] = prefix >> 8;
+  address[3] = prefix;
+  for (uint32_t i = 4; i < 16; i++)
+    {
+      address[i] = rng->GetInteger (0, 255);
+    }
+  return Ipv6Address (address);
+}
+
+static void
+Receive (Ptr<Ipv6L3Protocol> ipv6, Ptr<NetDevice> device, Ptr<const Packet> p)
+{
+  ipv6->Receive (device, p, Ipv6L3Protocol::PROT_NUMBER, Address (), device->GetAddress (), NetDevice::PACKET_HOST);
+}
+
+static void
+Send (Ptr<Ipv6L3Protocol> ipv6, Ptr<NetDevice> device, const std::vector<Ptr<Packet> > &packets,
+      uint32_t n, Time start, Time interval)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      // as the point-to-point device would
+      Simulator::Schedule (start + interval * i, &Receive, ipv6, device, packets[i % packets.size ()]);
+    }
+}
+
+/**
+ * Forward the packets and report the rate.
+ * \param name the name of the run
+ * \param ipv6 the IPv6 stack of the router
+ * \param device the ingress device
+ * \param packets the packets of the flows
+ * \param n the number of packets
+ * \param start the time of the first packet
+ */
+static void
+Run (std::string name, Ptr<Ipv6L3Protocol> ipv6, Ptr<NetDevice> device,
+     const std::vector<Ptr<Packet> > &packets, uint32_t n, Time start)
+{
+  g_received = 0;
+  g_hits = 0;
+  g_misses = 0;
+  // the egress link is fast enough for the packets not to be queued
+  Send (ipv6, device, packets, n, start, MicroSeconds (1));
+  std::clock_t clock = std::clock ();
+  Simulator::Run ();
+  double seconds = (double) (std::clock () - clock) / CLOCKS_PER_SEC;
+  std::cout << name << "\t" << g_received << "/" << n << "\t" << g_received / seconds
+            << "\t" << g_hits << "\t" << g_misses << std::endl;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t routes = 1000;
+  uint32_t flows = 100;
+  uint32_t packets = 200000;
+  uint32_t size = 1000;
+
+  CommandLine cmd;
+  cmd.AddValue ("routes", "Number of routes of the router", routes);
+  cmd.AddValue ("flows", "Number of flows (source and destination pairs)", flows);
+  cmd.AddValue ("packets", "Number of packets forwarded in each run", packets);
+  cmd.AddValue ("size", "Size of the payload of the packets (bytes)", size);
+  cmd.Parse (argc, argv);
+
+  NodeContainer nodes;
+  nodes.Create (3);
+  Ptr<Node> source = nodes.Get (0);
+  Ptr<Node> router = nodes.Get (1);
+  Ptr<Node> sink = nodes.Get (2);
+
+  // the routing protocols of a MAG; the end nodes do not have any IPv6
+  // stack, so that they drop the packets they receive
+  Ipv6StaticSourceRoutingHelper sourceRoutingHelper;
+  Ipv6StaticRoutingHelper staticRoutingHelper;
+  Ipv6ListRoutingHelper listRoutingHelper;
+  listRoutingHelper.Add (sourceRoutingHelper, 10);
+  listRoutingHelper.Add (staticRoutingHelper, 0);
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.SetRoutingHelper (listRoutingHelper);
+  internet.Install (router);
+  Ptr<Ipv6L3Protocol> ipv6 = router->GetObject<Ipv6L3Protocol> ();
+  ipv6->SetAttribute ("IpForward", BooleanValue (true));
+  ipv6->SetAttribute ("SendIcmpv6Redirect", BooleanValue (false));
+
+  PointToPointHelper p2ph;
+  p2ph.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("100Gb/s")));
+  p2ph.SetChannelAttribute ("Delay", TimeValue (Seconds (0)));
+  NetDeviceContainer ingressDevices = p2ph.Install (source, router);
+  NetDeviceContainer egressDevices = p2ph.Install (router, sink);
+  Ptr<NetDevice> ingress = ingressDevices.Get (1);
+  Ptr<NetDevice> egress = egressDevices.Get (0);
+  egressDevices.Get (1)->TraceConnectWithoutContext ("MacRx", MakeCallback (&CountPacket));
+
+  uint32_t ingressInterface = ipv6->AddInterface (ingress);
+  ipv6->AddAddress (ingressInterface, Ipv6InterfaceAddress (Ipv6Address ("2001:a::1"), Ipv6Prefix (64)));
+  ipv6->SetUp (ingressInterface);
+  uint32_t egressInterface = ipv6->AddInterface (egress);
+  ipv6->AddAddress (egressInterface, Ipv6InterfaceAddress (Ipv6Address ("2001:b::1"), Ipv6Prefix (64)));
+  ipv6->SetUp (egressInterface);
+  ipv6->SetForwarding (ingressInterface, true);
+  ipv6->SetForwarding (egressInterface, true);
+
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+  Ptr<Ipv6StaticRouting> staticRouting = staticRoutingHelper.GetStaticRouting (ipv6);
+  std::vector<Ipv6Address> prefixes;
+  for (uint32_t i = 0; i < routes; i++)
+    {
+      Ipv6Address prefix = GetRandomAddress (rng, 0x20010db9).CombinePrefix (Ipv6Prefix (64));
+      staticRouting->AddNetworkRouteTo (prefix, Ipv6Prefix (64), Ipv6Address ("2001:b::2"), egressInterface);
+      prefixes.push_back (prefix);
+    }
+
+  std::vector<Ptr<Packet> > flowPackets;
+  for (uint32_t f = 0; f < flows; f++)
+    {
+      uint8_t destination[16];
+      prefixes[rng->GetInteger (0, routes - 1)].GetBytes (destination);
+      destination[15] = 1 + f % 255;
+      Ptr<Packet> p = Create<Packet> (size);
+      UdpHeader udp;
+      udp.SetSourcePort (4000);
+      udp.SetDestinationPort (5000);
+      p->AddHeader (udp);
+      Ipv6Header ip;
+      ip.SetSourceAddress (GetRandomAddress (rng, 0x2001000a));
+      ip.SetDestinationAddress (Ipv6Address (destination));
+      ip.SetNextHeader (UdpL4Protocol::PROT_NUMBER);
+      ip.SetPayloadLength (p->GetSize ());
+      ip.SetHopLimit (64);
+      p->AddHeader (ip);
+      flowPackets.push_back (p);
+    }
+
+  ipv6->TraceConnectWithoutContext ("RouteCache", MakeCallback (&CountLookup));
+  std::cout << routes << " routes, " << flows << " flows, " << size << " bytes" << std::endl;
+  std::cout << "cache\treceived\tpackets/s\thits\tmisses" << std::endl;
+  ipv6->SetAttribute ("RouteCache", BooleanValue (false));
+  Run ("off", ipv6, ingress, flowPackets, packets, Seconds (1));
+  ipv6->SetAttribute ("RouteCache", BooleanValue (true));
+  Run ("on", ipv6, ingress, flowPackets, packets, Simulator::Now () + Seconds (1));
+
+  Simulator::Destroy ();
+  return 0;
+}
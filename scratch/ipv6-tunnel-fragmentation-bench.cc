@@ -0,0 +1,169 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// IPv6-in-IPv6 tunnel fragmentation benchmark.
+//
+// A MAG node and an LMA node are the end points of an IPv6-in-IPv6
+// tunnel, over a point-to-point link of --mtu bytes (1280 by default).
+// --packets IPv6 packets of --size bytes of payload are sent through the
+// TunnelNetDevice of the MAG: each is fragmented by the MAG, reassembled
+// by the LMA, decapsulated and forwarded to a sink on another
+// point-to-point link. The program reports the fragments received by the
+// LMA, the packets received by the sink, the rate in packets per second
+// of processor time and the packets dropped by the reassembly.
+//
+// ./waf --run "ipv6-tunnel-fragmentation-bench --size=8000 --mtu=1280 --packets=100000"
+//
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/pmipv6-module.h"
+
+#include <ctime>
+#include <iostream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("Ipv6TunnelFragmentationBench");
+
+static uint32_t g_fragments = 0;
+static uint32_t g_received = 0;
+static uint32_t g_dropped = 0;
+
+static void
+CountFragment (Ptr<const Packet> p)
+{
+  g_fragments++;
+}
+
+static void
+CountPacket (Ptr<const Packet> p)
+{
+  g_received++;
+}
+
+static void
+CountDrop (const Ipv6Header &header, Ptr<const Packet> p, Ipv6L3Protocol::DropReason reason,
+           Ptr<Ipv6> ipv6, uint32_t interface)
+{
+  if (reason == Ipv6L3Protocol::DROP_MALFORMED_HEADER
+      || reason == Ipv6L3Protocol::DROP_FRAGMENT_TIMEOUT
+      || reason == Ipv6L3Protocol::DROP_FRAGMENT_MEMORY)
+    {
+      g_dropped++;
+    }
+}
+
+static void
+Send (Ptr<NetDevice> tunnel, Ptr<const Packet> p)
+{
+  // the tunnel device tags the packet
+  tunnel->Send (p->Copy (), Address (), Ipv6L3Protocol::PROT_NUMBER);
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t packets = 100000;
+  uint32_t size = 8000;
+  uint16_t mtu = 1280;
+
+  CommandLine cmd;
+  cmd.AddValue ("packets", "Number of packets sent through the tunnel", packets);
+  cmd.AddValue ("size", "Size of the payload of the packets (bytes)", size);
+  cmd.AddValue ("mtu", "MTU of the link between the tunnel end points (bytes)", mtu);
+  cmd.Parse (argc, argv);
+
+  NodeContainer nodes;
+  nodes.Create (3);
+  Ptr<Node> mag = nodes.Get (0);
+  Ptr<Node> lma = nodes.Get (1);
+  Ptr<Node> sink = nodes.Get (2);
+
+  // the sink does not have any IPv6 stack, so that it drops the packets
+  // it receives
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (NodeContainer (mag, lma));
+
+  PointToPointHelper p2ph;
+  p2ph.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("100Gb/s")));
+  p2ph.SetDeviceAttribute ("Mtu", UintegerValue (mtu));
+  p2ph.SetChannelAttribute ("Delay", TimeValue (Seconds (0)));
+  NetDeviceContainer tunnelDevices = p2ph.Install (mag, lma);
+  p2ph.SetDeviceAttribute ("Mtu", UintegerValue (65535));
+  NetDeviceContainer sinkDevices = p2ph.Install (lma, sink);
+  tunnelDevices.Get (1)->TraceConnectWithoutContext ("MacRx", MakeCallback (&CountFragment));
+  sinkDevices.Get (1)->TraceConnectWithoutContext ("MacRx", MakeCallback (&CountPacket));
+
+  Ipv6Address magAddress ("2001:a::1");
+  Ipv6Address lmaAddress ("2001:a::2");
+  Ptr<Ipv6L3Protocol> magIpv6 = mag->GetObject<Ipv6L3Protocol> ();
+  uint32_t interface = magIpv6->AddInterface (tunnelDevices.Get (0));
+  magIpv6->AddAddress (interface, Ipv6InterfaceAddress (magAddress, Ipv6Prefix (64)));
+  magIpv6->SetUp (interface);
+  Ptr<Ipv6L3Protocol> lmaIpv6 = lma->GetObject<Ipv6L3Protocol> ();
+  interface = lmaIpv6->AddInterface (tunnelDevices.Get (1));
+  lmaIpv6->AddAddress (interface, Ipv6InterfaceAddress (lmaAddress, Ipv6Prefix (64)));
+  lmaIpv6->SetUp (interface);
+  interface = lmaIpv6->AddInterface (sinkDevices.Get (0));
+  lmaIpv6->AddAddress (interface, Ipv6InterfaceAddress (Ipv6Address ("2001:c::1"), Ipv6Prefix (64)));
+  lmaIpv6->SetUp (interface);
+  lmaIpv6->TraceConnectWithoutContext ("Drop", MakeCallback (&CountDrop));
+
+  Ptr<Ipv6TunnelL4Protocol> magTunnel = CreateObject<Ipv6TunnelL4Protocol> ();
+  mag->AggregateObject (magTunnel);
+  magTunnel->AddTunnel (lmaAddress);
+  Ptr<NetDevice> tunnel = magTunnel->GetTunnelDevice (lmaAddress);
+  Ptr<Ipv6TunnelL4Protocol> lmaTunnel = CreateObject<Ipv6TunnelL4Protocol> ();
+  lma->AggregateObject (lmaTunnel);
+  lmaTunnel->AddTunnel (magAddress);
+
+  // a packet of a mobile node to a correspondent node behind the LMA
+  Ptr<Packet> p = Create<Packet> (size);
+  UdpHeader udp;
+  udp.SetSourcePort (4000);
+  udp.SetDestinationPort (5000);
+  p->AddHeader (udp);
+  Ipv6Header ip;
+  ip.SetSourceAddress (Ipv6Address ("2001:b::2"));
+  ip.SetDestinationAddress (Ipv6Address ("2001:c::2"));
+  ip.SetNextHeader (UdpL4Protocol::PROT_NUMBER);
+  ip.SetPayloadLength (p->GetSize ());
+  ip.SetHopLimit (64);
+  p->AddHeader (ip);
+
+  // after the duplicate address detection; the links are fast enough
+  // for the packets not to be queued
+  for (uint32_t i = 0; i < packets; i++)
+    {
+      Simulator::Schedule (Seconds (2) + MicroSeconds (i), &Send, tunnel, p);
+    }
+
+  std::cout << packets << " packets, " << size << " bytes, MTU " << mtu << std::endl;
+  std::cout << "fragments\treceived\tpackets/s\tdropped" << std::endl;
+  std::clock_t clock = std::clock ();
+  Simulator::Run ();
+  double seconds = (double) (std::clock () - clock) / CLOCKS_PER_SEC;
+  std::cout << g_fragments << "\t" << g_received << "/" << packets << "\t" << g_received / seconds
+            << "\t" << g_dropped << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
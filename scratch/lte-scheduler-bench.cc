@@ -0,0 +1,118 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// LTE FF MAC scheduler benchmark.
+//
+// Drives the PF, PSS, CQA and TTA schedulers (or only the one given with
+// --scheduler) with FfMacSchedulerHarness, without PHY or channel, for a
+// cell of --bandwidth RBs and 50, 100, 200 and 500 full buffer UEs
+// reporting --cqiType CQIs. For each scheduler and number of UEs, the
+// program reports the distribution of the processor time of the DL and
+// UL triggers per TTI, the number of allocations and the cell throughput
+// per TTI, and with --check whether two runs took the same decisions.
+//
+// ./waf --run "lte-scheduler-bench --scheduler=ns3::PssFfMacScheduler --cqiType=P10"
+//
+
+#include "ns3/core-module.h"
+#include "ns3/lte-module.h"
+
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("LteSchedulerBench");
+
+int
+main (int argc, char *argv[])
+{
+  std::string scheduler = "";
+  uint16_t bandwidth = 100;
+  uint32_t ttis = 2000;
+  std::string cqiType = "A30";
+  double nackProbability = 0.1;
+  bool check = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("scheduler", "TypeId of the FF MAC scheduler (PF, PSS, CQA and TTA if empty)", scheduler);
+  cmd.AddValue ("bandwidth", "Number of RBs of the cell", bandwidth);
+  cmd.AddValue ("ttis", "Number of TTIs to schedule per run", ttis);
+  cmd.AddValue ("cqiType", "Type of the DL CQI reports (P10 or A30)", cqiType);
+  cmd.AddValue ("nackProbability", "Probability of a HARQ NACK", nackProbability);
+  cmd.AddValue ("check", "Run each scheduler twice and compare the decisions", check);
+  cmd.Parse (argc, argv);
+
+  std::vector<std::string> schedulers;
+  if (scheduler.empty ())
+    {
+      schedulers.push_back ("ns3::PfFfMacScheduler");
+      schedulers.push_back ("ns3::PssFfMacScheduler");
+      schedulers.push_back ("ns3::CqaFfMacScheduler");
+      schedulers.push_back ("ns3::TtaFfMacScheduler");
+    }
+  else
+    {
+      schedulers.push_back (scheduler);
+    }
+  const uint16_t nUes[] = { 50, 100, 200, 500 };
+
+  Ptr<FfMacSchedulerHarness> harness = CreateObject<FfMacSchedulerHarness> ();
+  harness->SetAttribute ("Bandwidth", UintegerValue (bandwidth));
+  harness->SetAttribute ("CqiType", StringValue (cqiType));
+  harness->SetAttribute ("NackProbability", DoubleValue (nackProbability));
+  harness->AssignStreams (1);
+
+  std::cout << bandwidth << " RBs, " << cqiType << " CQIs, " << ttis << " TTIs" << std::endl;
+  std::cout << "scheduler\tUEs\tmean(us)\tp50(us)\tp99(us)\tmax(us)\tDL DCIs/TTI\tUL DCIs/TTI\tDL Mbps\tUL Mbps";
+  if (check)
+    {
+      std::cout << "\tdeterministic";
+    }
+  std::cout << std::endl;
+  for (uint32_t s = 0; s < schedulers.size (); s++)
+    {
+      harness->SetSchedulerType (schedulers[s]);
+      for (uint32_t i = 0; i < sizeof (nUes) / sizeof (nUes[0]); i++)
+        {
+          harness->SetAttribute ("NumberOfUes", UintegerValue (nUes[i]));
+          FfMacSchedulerHarness::Result result = harness->Run (ttis);
+          std::cout << schedulers[s] << "\t" << nUes[i]
+                    << "\t" << result.GetMeanLatency ()
+                    << "\t" << result.GetLatencyPercentile (50)
+                    << "\t" << result.GetLatencyPercentile (99)
+                    << "\t" << result.GetLatencyPercentile (100)
+                    << "\t" << (double) result.m_dlDcis / ttis
+                    << "\t" << (double) result.m_ulDcis / ttis
+                    // bytes per TTI of 1 ms
+                    << "\t" << result.m_dlBytes * 8.0 / ttis / 1e3
+                    << "\t" << result.m_ulBytes * 8.0 / ttis / 1e3;
+          if (result.m_conflicts > 0)
+            {
+              std::cout << "\t" << result.m_conflicts << " overlapping allocations";
+            }
+          if (check)
+            {
+              std::cout << "\t" << ((harness->CheckDeterminism (ttis) == ttis) ? "yes" : "no");
+            }
+          std::cout << std::endl;
+        }
+    }
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,245 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// Neighbor cache timer benchmark.
+//
+// The neighbor cache of the access link of a MAG holds --neighbors
+// REACHABLE entries (5000 by default). Every --interval, the reachability
+// of each neighbor is confirmed, which restarts the reachable timer of its
+// entry, and --churn of the neighbors leave the link and are replaced by
+// new ones. The program runs --time seconds of this, first with one
+// ns3::Timer per entry, as the entries of NdiscCache used to have, then
+// with the NdiscCache entries and their timer wheel. It reports, for each
+// run, the events inserted in the scheduler and the processor time.
+//
+// ./waf --run "ndisc-timer-wheel-bench --neighbors=5000 --time=300"
+//
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+
+#include <algorithm>
+#include <ctime>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("NdiscTimerWheelBench");
+
+/**
+ * A map scheduler which counts the events inserted.
+ */
+class CountingScheduler : public MapScheduler
+{
+public:
+  static TypeId GetTypeId (void);
+  virtual void Insert (const Event &ev);
+
+  static uint64_t m_inserted; //!< the number of events inserted
+};
+
+uint64_t CountingScheduler::m_inserted = 0;
+
+NS_OBJECT_ENSURE_REGISTERED (CountingScheduler);
+
+TypeId
+CountingScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CountingScheduler")
+    .SetParent<MapScheduler> ()
+    .AddConstructor<CountingScheduler> ()
+  ;
+  return tid;
+}
+
+void
+CountingScheduler::Insert (const Event &ev)
+{
+  m_inserted++;
+  MapScheduler::Insert (ev);
+}
+
+/**
+ * A neighbor cache entry with its own reachable timer, as before the timer
+ * wheel.
+ */
+class TimerEntry
+{
+public:
+  TimerEntry ()
+    : m_timer (Timer::CANCEL_ON_DESTROY),
+      m_stale (false)
+  {
+  }
+  void Confirm ()
+  {
+    m_stale = false;
+    if (m_timer.IsRunning ())
+      {
+        m_timer.Cancel ();
+      }
+    m_timer.SetFunction (&TimerEntry::MarkStale, this);
+    m_timer.SetDelay (MilliSeconds (Icmpv6L4Protocol::REACHABLE_TIME));
+    m_timer.Schedule ();
+  }
+  void MarkStale ()
+  {
+    m_stale = true;
+  }
+
+  Timer m_timer; //!< the reachable timer
+  bool m_stale;  //!< whether the entry is stale
+};
+
+/**
+ * \param i the index of a neighbor
+ * \return the link-local address of the neighbor
+ */
+static Ipv6Address
+GetNeighborAddress (uint32_t i)
+{
+  uint8_t address[16] = { 0xfe, 0x80 };
+  address[12] = i >> 24;
+  address[13] = i >> 16;
+  address[14] = i >> 8;
+  address[15] = i;
+  return Ipv6Address (address);
+}
+
+/**
+ * Confirm the reachability of a batch of neighbors with their own timers,
+ * replacing some of them.
+ */
+static void
+ConfirmTimers (std::vector<TimerEntry *> *entries, uint32_t first, uint32_t n, uint32_t churn)
+{
+  for (uint32_t i = first; i < first + n; i++)
+    {
+      if (i % 1000 < churn)
+        {
+          delete (*entries)[i];
+          (*entries)[i] = new TimerEntry ();
+        }
+      (*entries)[i]->Confirm ();
+    }
+}
+
+static std::vector<Ipv6Address> g_addresses;
+static uint32_t g_nextAddress = 0;
+
+/**
+ * Confirm the reachability of a batch of neighbors of a neighbor cache,
+ * replacing some of them.
+ */
+static void
+ConfirmNdisc (Ptr<NdiscCache> cache, uint32_t first, uint32_t n, uint32_t churn)
+{
+  for (uint32_t i = first; i < first + n; i++)
+    {
+      NdiscCache::Entry *entry = cache->Lookup (g_addresses[i]);
+      if (i % 1000 < churn)
+        {
+          cache->Remove (entry);
+          g_addresses[i] = GetNeighborAddress (g_nextAddress++);
+          entry = cache->Add (g_addresses[i]);
+        }
+      entry->MarkReachable ();
+      entry->StartReachableTimer ();
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t neighbors = 5000;
+  double interval = 1;
+  double churn = 0.01;
+  double time = 300;
+
+  CommandLine cmd;
+  cmd.AddValue ("neighbors", "Number of neighbors on the link", neighbors);
+  cmd.AddValue ("interval", "Interval between the reachability confirmations of a neighbor (s)", interval);
+  cmd.AddValue ("churn", "Fraction of the neighbors replaced every interval", churn);
+  cmd.AddValue ("time", "Duration of each run (s)", time);
+  cmd.Parse (argc, argv);
+
+  // the confirmations are spread over the interval, in batches of 10 ms
+  const uint32_t batches = std::max (1.0, interval / 0.01);
+  const uint32_t batch = (neighbors + batches - 1) / batches;
+  const uint32_t churnPerMille = churn * 1000;
+  ObjectFactory scheduler;
+  scheduler.SetTypeId ("ns3::CountingScheduler");
+
+  std::cout << neighbors << " neighbors, confirmed every " << interval << " s, "
+            << churn * 100 << "% churn, " << time << " s" << std::endl;
+  std::cout << "timers\tevents\tseconds" << std::endl;
+
+  // one timer per entry
+  Simulator::SetScheduler (scheduler);
+  CountingScheduler::m_inserted = 0;
+  std::vector<TimerEntry *> entries;
+  for (uint32_t i = 0; i < neighbors; i++)
+    {
+      entries.push_back (new TimerEntry ());
+    }
+  for (uint32_t t = 0; t * interval < time; t++)
+    {
+      for (uint32_t b = 0; b * batch < neighbors; b++)
+        {
+          Simulator::Schedule (Seconds (t * interval + b * interval / batches), &ConfirmTimers, &entries,
+                               b * batch, std::min (batch, neighbors - b * batch), churnPerMille);
+        }
+    }
+  std::clock_t clock = std::clock ();
+  Simulator::Stop (Seconds (time));
+  Simulator::Run ();
+  double seconds = (double) (std::clock () - clock) / CLOCKS_PER_SEC;
+  std::cout << "entry\t" << CountingScheduler::m_inserted << "\t" << seconds << std::endl;
+  for (uint32_t i = 0; i < neighbors; i++)
+    {
+      delete entries[i];
+    }
+  Simulator::Destroy ();
+
+  // the timer wheel of the neighbor cache
+  Simulator::SetScheduler (scheduler);
+  CountingScheduler::m_inserted = 0;
+  Ptr<NdiscCache> cache = CreateObject<NdiscCache> ();
+  for (uint32_t i = 0; i < neighbors; i++)
+    {
+      g_addresses.push_back (GetNeighborAddress (g_nextAddress++));
+      cache->Add (g_addresses[i]);
+    }
+  for (uint32_t t = 0; t * interval < time; t++)
+    {
+      for (uint32_t b = 0; b * batch < neighbors; b++)
+        {
+          Simulator::Schedule (Seconds (t * interval + b * interval / batches), &ConfirmNdisc, cache,
+                               b * batch, std::min (batch, neighbors - b * batch), churnPerMille);
+        }
+    }
+  clock = std::clock ();
+  Simulator::Stop (Seconds (time));
+  Simulator::Run ();
+  seconds = (double) (std::clock () - clock) / CLOCKS_PER_SEC;
+  std::cout << "wheel\t" << CountingScheduler::m_inserted << "\t" << seconds << std::endl;
+  cache->Dispose ();
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// Multi-model spectrum coexistence benchmark.
+//
+// A Wi-Fi transmitter (5 MHz resolution model), an LTE-like 20 MHz
+// carrier (100 RBs of 180 kHz centered on 2437 MHz) and a microwave
+// oven share a MultiModelSpectrumChannel, each transmitting with a
+// waveform generator. nAnalyzers spectrum analyzers per spectrum model
+// listen to the channel, so that every transmission is converted to
+// the two other spectrum models.
+//
+// The program first reports, for each pair of spectrum models, the
+// number of non-zero conversion coefficients against the size of the
+// dense matrix and the time per SpectrumConverter::Convert call, then
+// the wall-clock time of the whole simulation.
+//
+// ./waf --run "spectrum-coexistence-bench --nAnalyzers=50"
+//
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/spectrum-module.h"
+
+#include <iostream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("SpectrumCoexistenceBench");
+
+static uint64_t g_txCount = 0;
+
+static void
+TxStart (Ptr<const Packet> p)
+{
+  g_txCount++;
+}
+
+static void
+BenchConvert (std::string name, Ptr<const SpectrumValue> psd, Ptr<const SpectrumModel> to, uint32_t conversions)
+{
+  SpectrumConverter converter (psd->GetSpectrumModel (), to);
+  double sink = 0;
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < conversions; i++)
+    {
+      sink += Sum (*converter.Convert (psd));
+    }
+  double us = clock.End () * 1000.0 / conversions;
+  NS_LOG_DEBUG ("checksum " << sink);
+  std::cout << name << ": dense size " << psd->GetSpectrumModel ()->GetNumBands () * to->GetNumBands ()
+            << ", " << us << " us/conversion" << std::endl;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nAnalyzers = 20;
+  double simTime = 1.0;
+  uint32_t conversions = 100000;
+
+  CommandLine cmd;
+  cmd.AddValue ("nAnalyzers", "Number of spectrum analyzers per spectrum model", nAnalyzers);
+  cmd.AddValue ("simTime", "Simulated time (s)", simTime);
+  cmd.AddValue ("conversions", "Number of conversions timed per pair of spectrum models", conversions);
+  cmd.Parse (argc, argv);
+
+  WifiSpectrumValue5MhzFactory wifiFactory;
+  Ptr<SpectrumValue> wifiPsd = wifiFactory.CreateTxPowerSpectralDensity (0.1, 6);
+  Ptr<SpectrumValue> mwoPsd = MicrowaveOvenSpectrumValueHelper::CreatePowerSpectralDensityMwo1 ();
+  std::vector<double> lteFreqs;
+  for (int i = -50; i < 50; i++)
+    {
+      lteFreqs.push_back (2437e6 + (i + 0.5) * 180e3);
+    }
+  Ptr<SpectrumModel> lteModel = Create<SpectrumModel> (lteFreqs);
+  Ptr<SpectrumValue> ltePsd = Create<SpectrumValue> (lteModel);
+  (*ltePsd) = 1e-11;
+
+  Ptr<SpectrumValue> psds[3] = { wifiPsd, ltePsd, mwoPsd };
+  std::string names[3] = { "wifi", "lte", "mwo" };
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      for (uint32_t j = 0; j < 3; j++)
+        {
+          if (i != j)
+            {
+              BenchConvert (names[i] + " -> " + names[j], psds[i], psds[j]->GetSpectrumModel (), conversions);
+            }
+        }
+    }
+
+  Ptr<MultiModelSpectrumChannel> channel = CreateObject<MultiModelSpectrumChannel> ();
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      NodeContainer generatorNode;
+      generatorNode.Create (1);
+      mobility.Install (generatorNode);
+      WaveformGeneratorHelper generatorHelper;
+      generatorHelper.SetChannel (channel);
+      generatorHelper.SetTxPowerSpectralDensity (psds[i]);
+      generatorHelper.SetPhyAttribute ("Period", TimeValue (MicroSeconds (1000 + 100 * i)));
+      generatorHelper.SetPhyAttribute ("DutyCycle", DoubleValue (0.5));
+      NetDeviceContainer generators = generatorHelper.Install (generatorNode);
+      Ptr<WaveformGenerator> generator = generators.Get (0)->GetObject<NonCommunicatingNetDevice> ()
+        ->GetPhy ()->GetObject<WaveformGenerator> ();
+      generator->TraceConnectWithoutContext ("TxStart", MakeCallback (&TxStart));
+      Simulator::Schedule (Seconds (0), &WaveformGenerator::Start, generator);
+
+      NodeContainer analyzerNodes;
+      analyzerNodes.Create (nAnalyzers);
+      mobility.Install (analyzerNodes);
+      SpectrumAnalyzerHelper analyzerHelper;
+      analyzerHelper.SetChannel (channel);
+      analyzerHelper.SetRxSpectrumModel (ConstCast<SpectrumModel> (psds[i]->GetSpectrumModel ()));
+      analyzerHelper.Install (analyzerNodes);
+    }
+
+  Simulator::Stop (Seconds (simTime));
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  double elapsed = clock.End () / 1000.0;
+  Simulator::Destroy ();
+
+  std::cout << "transmissions:       " << g_txCount << std::endl
+            << "receivers per tx:    " << 3 * nAnalyzers << std::endl
+            << "wall-clock time:     " << elapsed << " s" << std::endl
+            << "transmissions/sec:   " << (elapsed > 0 ? g_txCount / elapsed : 0) << std::endl;
+  return 0;
+}
@@ -0,0 +1,321 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// TCP congestion control benchmark under PMIPv6 handovers.
+//
+// The topology is the one of pmipv6-wifi: a CN behind the LMA, two MAGs
+// each bridged to a WLAN AP, and a station moving at --speed m/s from the
+// AP of MAG1 to the AP of MAG2. The CN sends a bulk transfer to the
+// station over TCP NewReno, CUBIC and HighSpeed, without then with
+// pacing, and over BBR, which always paces. The program reports, for each
+// run, the goodput, the longest gap between two receptions at the station
+// (the outage of the handover), the events inserted in the scheduler and
+// the events per second of processor time.
+//
+// ./waf --run "tcp-cc-handover-bench --speed=10 --time=12"
+//
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/pmipv6-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/csma-module.h"
+#include "ns3/bridge-module.h"
+
+#include <ctime>
+#include <iostream>
+#include <string>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpCcHandoverBench");
+
+/**
+ * A map scheduler which counts the events inserted.
+ */
+class CountingScheduler : public MapScheduler
+{
+public:
+  static TypeId GetTypeId (void);
+  virtual void Insert (const Event &ev);
+
+  static uint64_t m_inserted; //!< the number of events inserted
+};
+
+uint64_t CountingScheduler::m_inserted = 0;
+
+NS_OBJECT_ENSURE_REGISTERED (CountingScheduler);
+
+TypeId
+CountingScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CountingScheduler")
+    .SetParent<MapScheduler> ()
+    .AddConstructor<CountingScheduler> ()
+  ;
+  return tid;
+}
+
+void
+CountingScheduler::Insert (const Event &ev)
+{
+  m_inserted++;
+  MapScheduler::Insert (ev);
+}
+
+static Ipv6InterfaceContainer
+AssignIpv6Address (Ptr<NetDevice> device, Ipv6Address addr, Ipv6Prefix prefix)
+{
+  Ptr<Ipv6> ipv6 = device->GetNode ()->GetObject<Ipv6> ();
+  int32_t ifIndex = ipv6->GetInterfaceForDevice (device);
+  if (ifIndex == -1)
+    {
+      ifIndex = ipv6->AddInterface (device);
+    }
+  ipv6->SetMetric (ifIndex, 1);
+  ipv6->SetUp (ifIndex);
+  ipv6->AddAddress (ifIndex, Ipv6InterfaceAddress (addr, prefix));
+  Ipv6InterfaceContainer retval;
+  retval.Add (ipv6, ifIndex);
+  return retval;
+}
+
+static Ipv6InterfaceContainer
+AssignWithoutAddress (Ptr<NetDevice> device)
+{
+  Ptr<Ipv6> ipv6 = device->GetNode ()->GetObject<Ipv6> ();
+  int32_t ifIndex = ipv6->GetInterfaceForDevice (device);
+  if (ifIndex == -1)
+    {
+      ifIndex = ipv6->AddInterface (device);
+    }
+  ipv6->SetMetric (ifIndex, 1);
+  ipv6->SetUp (ifIndex);
+  Ipv6InterfaceContainer retval;
+  retval.Add (ipv6, ifIndex);
+  return retval;
+}
+
+static Time g_lastRx;
+static Time g_longestGap;
+
+static void
+CountRx (Ptr<const Packet> packet, const Address &address)
+{
+  Time now = Simulator::Now ();
+  if (!g_lastRx.IsZero ())
+    {
+      g_longestGap = Max (g_longestGap, now - g_lastRx);
+    }
+  g_lastRx = now;
+}
+
+/**
+ * Run the bulk transfer across the handover and report the goodput and
+ * the cost.
+ * \param socketType the TypeId name of the TCP socket
+ * \param pacing whether the socket paces its data
+ * \param speed the speed of the station (m/s)
+ * \param time the duration of the simulation
+ */
+static void
+Run (std::string socketType, bool pacing, double speed, Time time)
+{
+  ObjectFactory scheduler;
+  scheduler.SetTypeId ("ns3::CountingScheduler");
+  Simulator::SetScheduler (scheduler);
+  CountingScheduler::m_inserted = 0;
+  g_lastRx = Seconds (0);
+  g_longestGap = Seconds (0);
+
+  Config::SetDefault ("ns3::TcpL4Protocol::SocketType", TypeIdValue (TypeId::LookupByName (socketType)));
+  Config::SetDefault ("ns3::TcpSocketBase::Pacing", BooleanValue (pacing));
+  // Room for the PMIPv6 tunnel header within the MTU of 1400 bytes
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1200));
+  Config::SetDefault ("ns3::TcpSocket::SndBufSize", UintegerValue (1 << 20));
+  Config::SetDefault ("ns3::TcpSocket::RcvBufSize", UintegerValue (1 << 20));
+  SeedManager::SetSeed (123456);
+
+  NodeContainer backbone;
+  NodeContainer aps;
+  NodeContainer cn;
+  NodeContainer sta;
+  backbone.Create (3);
+  aps.Create (2);
+  cn.Create (1);
+  sta.Create (1);
+  InternetStackHelper internet;
+  internet.Install (backbone);
+  internet.Install (aps);
+  internet.Install (cn);
+  internet.Install (sta);
+
+  Ptr<Node> lma = backbone.Get (0);
+  NodeContainer outerNet (lma, cn.Get (0));
+  NodeContainer mag1Net (backbone.Get (1), aps.Get (0));
+  NodeContainer mag2Net (backbone.Get (2), aps.Get (1));
+
+  // All the links are 50Mbps and 0.1ms delay
+  CsmaHelper csma;
+  csma.SetChannelAttribute ("DataRate", DataRateValue (DataRate (50000000)));
+  csma.SetChannelAttribute ("Delay", TimeValue (MicroSeconds (100)));
+  csma.SetDeviceAttribute ("Mtu", UintegerValue (1400));
+
+  Ipv6InterfaceContainer iifc;
+  NetDeviceContainer outerDevs = csma.Install (outerNet);
+  Ipv6InterfaceContainer outerIfs;
+  iifc = AssignIpv6Address (outerDevs.Get (0), Ipv6Address ("3ffe:2::1"), 64);
+  outerIfs.Add (iifc);
+  iifc = AssignIpv6Address (outerDevs.Get (1), Ipv6Address ("3ffe:2::2"), 64);
+  outerIfs.Add (iifc);
+  outerIfs.SetForwarding (0, true);
+  outerIfs.SetDefaultRouteInAllNodes (0);
+
+  NetDeviceContainer backboneDevs = csma.Install (backbone);
+  Ipv6InterfaceContainer backboneIfs;
+  iifc = AssignIpv6Address (backboneDevs.Get (0), Ipv6Address ("3ffe:1::1"), 64);
+  backboneIfs.Add (iifc);
+  iifc = AssignIpv6Address (backboneDevs.Get (1), Ipv6Address ("3ffe:1::2"), 64);
+  backboneIfs.Add (iifc);
+  iifc = AssignIpv6Address (backboneDevs.Get (2), Ipv6Address ("3ffe:1::3"), 64);
+  backboneIfs.Add (iifc);
+  backboneIfs.SetForwarding (0, true);
+  backboneIfs.SetDefaultRouteInAllNodes (0);
+
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0.0, -20.0, 0.0));   // LMA
+  positionAlloc->Add (Vector (-50.0, 20.0, 0.0));  // MAG1
+  positionAlloc->Add (Vector (50.0, 20.0, 0.0));   // MAG2
+  positionAlloc->Add (Vector (-50.0, 40.0, 0.0));  // MAG1 AP
+  positionAlloc->Add (Vector (50.0, 40.0, 0.0));   // MAG2 AP
+  positionAlloc->Add (Vector (75.0, -20.0, 0.0));  // CN
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (backbone);
+  mobility.Install (aps);
+  mobility.Install (cn);
+
+  // The MAGs share the MAC address of the default gateway of the station
+  Mac48Address magMacAddr ("00:00:AA:BB:CC:DD");
+  Ssid ssid = Ssid ("MAG");
+  YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default ();
+  YansWifiChannelHelper wifiChannel = YansWifiChannelHelper::Default ();
+  wifiPhy.SetChannel (wifiChannel.Create ());
+  WifiHelper wifi = WifiHelper::Default ();
+  NqosWifiMacHelper wifiMac = NqosWifiMacHelper::Default ();
+  wifiMac.SetType ("ns3::ApWifiMac",
+                   "Ssid", SsidValue (ssid),
+                   "BeaconGeneration", BooleanValue (true),
+                   "BeaconInterval", TimeValue (MicroSeconds (102400)));
+  BridgeHelper bridge;
+
+  NetDeviceContainer mag1Devs = csma.Install (mag1Net);
+  mag1Devs.Get (0)->SetAddress (magMacAddr);
+  Ipv6InterfaceContainer mag1Ifs = AssignIpv6Address (mag1Devs.Get (0), Ipv6Address ("3ffe:1:1::1"), 64);
+  NetDeviceContainer mag1ApDev = wifi.Install (wifiPhy, wifiMac, aps.Get (0));
+  bridge.Install (aps.Get (0), NetDeviceContainer (mag1ApDev, mag1Devs.Get (1)));
+  iifc = AssignWithoutAddress (mag1Devs.Get (1));
+  mag1Ifs.Add (iifc);
+  mag1Ifs.SetForwarding (0, true);
+  mag1Ifs.SetDefaultRouteInAllNodes (0);
+
+  NetDeviceContainer mag2Devs = csma.Install (mag2Net);
+  mag2Devs.Get (0)->SetAddress (magMacAddr);
+  Ipv6InterfaceContainer mag2Ifs = AssignIpv6Address (mag2Devs.Get (0), Ipv6Address ("3ffe:1:2::1"), 64);
+  NetDeviceContainer mag2ApDev = wifi.Install (wifiPhy, wifiMac, aps.Get (1));
+  bridge.Install (aps.Get (1), NetDeviceContainer (mag2ApDev, mag2Devs.Get (1)));
+  iifc = AssignWithoutAddress (mag2Devs.Get (1));
+  mag2Ifs.Add (iifc);
+  mag2Ifs.SetForwarding (0, true);
+  mag2Ifs.SetDefaultRouteInAllNodes (0);
+
+  // The station leaves the AP of MAG1 for the one of MAG2
+  positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (-50.0, 60.0, 0.0));
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.SetMobilityModel ("ns3::ConstantVelocityMobilityModel");
+  mobility.Install (sta);
+  sta.Get (0)->GetObject<ConstantVelocityMobilityModel> ()->SetVelocity (Vector (speed, 0, 0));
+  wifiMac.SetType ("ns3::StaWifiMac",
+                   "Ssid", SsidValue (ssid),
+                   "ActiveProbing", BooleanValue (false));
+  NetDeviceContainer staDevs = wifi.Install (wifiPhy, wifiMac, sta);
+  AssignWithoutAddress (staDevs.Get (0));
+
+  Ptr<Pmipv6ProfileHelper> profile = Create<Pmipv6ProfileHelper> ();
+  Mac48Address staMacAddr = Mac48Address::ConvertFrom (staDevs.Get (0)->GetAddress ());
+  profile->AddProfile (Identifier ("pmip1@example.com"), Identifier (staMacAddr),
+                       backboneIfs.GetAddress (0, 1), std::list<Ipv6Address> ());
+  Pmipv6LmaHelper lmahelper;
+  lmahelper.SetPrefixPoolBase (Ipv6Address ("3ffe:1:4::"), 48);
+  lmahelper.SetProfileHelper (profile);
+  lmahelper.Install (lma);
+  Pmipv6MagHelper maghelper;
+  maghelper.SetProfileHelper (profile);
+  maghelper.Install (backbone.Get (1), mag1Ifs.GetAddress (0, 0), aps.Get (0));
+  maghelper.Install (backbone.Get (2), mag2Ifs.GetAddress (0, 0), aps.Get (1));
+
+  // The station configures its address from the first home network prefix of the pool
+  Ipv6Address staAddr = Ipv6Address::MakeAutoconfiguredAddress (staMacAddr, Ipv6Address ("3ffe:1:4:1::"));
+  uint16_t port = 9;
+  PacketSinkHelper sink ("ns3::TcpSocketFactory", Inet6SocketAddress (Ipv6Address::GetAny (), port));
+  ApplicationContainer sinkApp = sink.Install (sta.Get (0));
+  sinkApp.Start (Seconds (1.0));
+  sinkApp.Get (0)->TraceConnectWithoutContext ("Rx", MakeCallback (&CountRx));
+  BulkSendHelper source ("ns3::TcpSocketFactory", Inet6SocketAddress (staAddr, port));
+  source.SetAttribute ("MaxBytes", UintegerValue (0));
+  ApplicationContainer sourceApp = source.Install (cn.Get (0));
+  sourceApp.Start (Seconds (2.0));
+  sourceApp.Stop (time);
+
+  std::clock_t clock = std::clock ();
+  Simulator::Stop (time);
+  Simulator::Run ();
+  double seconds = (double) (std::clock () - clock) / CLOCKS_PER_SEC;
+  uint64_t rx = DynamicCast<PacketSink> (sinkApp.Get (0))->GetTotalRx ();
+  std::cout << socketType.substr (5) << "\t" << pacing << "\t" << rx * 8 / (time.GetSeconds () - 2) / 1e6
+            << "\t" << g_longestGap.GetMilliSeconds () << "\t" << CountingScheduler::m_inserted
+            << "\t" << CountingScheduler::m_inserted / seconds << std::endl;
+  Simulator::Destroy ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  double speed = 10;
+  double time = 12;
+
+  CommandLine cmd;
+  cmd.AddValue ("speed", "Speed of the station (m/s)", speed);
+  cmd.AddValue ("time", "Duration of each simulation (s)", time);
+  cmd.Parse (argc, argv);
+
+  std::cout << speed << " m/s, " << time << " s" << std::endl;
+  std::cout << "tcp\tpacing\tgoodput(Mbps)\tlongest gap(ms)\tevents\tevents/cpu s" << std::endl;
+  std::string socketTypes[] = { "ns3::TcpNewReno", "ns3::TcpCubic", "ns3::TcpHighSpeed" };
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Run (socketTypes[i], false, speed, Seconds (time));
+      Run (socketTypes[i], true, speed, Seconds (time));
+    }
+  Run ("ns3::TcpBbr", true, speed, Seconds (time));
+  return 0;
+}
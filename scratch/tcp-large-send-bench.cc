@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// TCP large send benchmark.
+//
+// A bulk transfer runs for --time seconds over a point-to-point link of
+// 10 Gbps, then of 40 Gbps, with a delay of --delay ms, as on the core
+// links of an LMA. Each transfer runs first segment by segment, then with
+// large sends of --large bytes which the NetDevice splits into segments.
+// The program reports, for each run, the goodput, the frames sent by the
+// sender, the events inserted in the scheduler and the simulated seconds
+// per second of processor time.
+//
+// ./waf --run "tcp-large-send-bench --delay=1 --large=64000 --time=1"
+//
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+
+#include <ctime>
+#include <iostream>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpLargeSendBench");
+
+/**
+ * A map scheduler which counts the events inserted.
+ */
+class CountingScheduler : public MapScheduler
+{
+public:
+  static TypeId GetTypeId (void);
+  virtual void Insert (const Event &ev);
+
+  static uint64_t m_inserted; //!< the number of events inserted
+};
+
+uint64_t CountingScheduler::m_inserted = 0;
+
+NS_OBJECT_ENSURE_REGISTERED (CountingScheduler);
+
+TypeId
+CountingScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CountingScheduler")
+    .SetParent<MapScheduler> ()
+    .AddConstructor<CountingScheduler> ()
+  ;
+  return tid;
+}
+
+void
+CountingScheduler::Insert (const Event &ev)
+{
+  m_inserted++;
+  MapScheduler::Insert (ev);
+}
+
+static uint32_t g_frames = 0;
+
+static void
+CountFrame (Ptr<const Packet> p)
+{
+  g_frames++;
+}
+
+/**
+ * Run the bulk transfer and report the goodput and the cost.
+ * \param rate the rate of the link (Gbps)
+ * \param delay the delay of the link (ms)
+ * \param large the largest send handed down at once, 0 to disable
+ * \param time the duration of the transfer
+ */
+static void
+Run (uint32_t rate, uint32_t delay, uint32_t large, Time time)
+{
+  ObjectFactory scheduler;
+  scheduler.SetTypeId ("ns3::CountingScheduler");
+  Simulator::SetScheduler (scheduler);
+  CountingScheduler::m_inserted = 0;
+  g_frames = 0;
+
+  Config::SetDefault ("ns3::TcpL4Protocol::SocketType", TypeIdValue (TcpNewReno::GetTypeId ()));
+  Config::SetDefault ("ns3::TcpSocketBase::LargeSend", UintegerValue (large));
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1448));
+  Config::SetDefault ("ns3::TcpSocket::SndBufSize", UintegerValue (1 << 25));
+  Config::SetDefault ("ns3::TcpSocket::RcvBufSize", UintegerValue (1 << 25));
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  std::ostringstream dataRate;
+  dataRate << rate << "Gbps";
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue (dataRate.str ()));
+  p2p.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (delay)));
+  NetDeviceContainer devices = p2p.Install (nodes);
+  devices.Get (0)->TraceConnectWithoutContext ("PhyTxBegin", MakeCallback (&CountFrame));
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  uint16_t port = 9;
+  BulkSendHelper source ("ns3::TcpSocketFactory", InetSocketAddress (interfaces.GetAddress (1), port));
+  source.SetAttribute ("MaxBytes", UintegerValue (0));
+  source.SetAttribute ("SendSize", UintegerValue (65536));
+  ApplicationContainer sourceApp = source.Install (nodes.Get (0));
+  sourceApp.Start (Seconds (0.1));
+  sourceApp.Stop (Seconds (0.1) + time);
+  PacketSinkHelper sink ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+  ApplicationContainer sinkApp = sink.Install (nodes.Get (1));
+  sinkApp.Start (Seconds (0));
+
+  std::clock_t clock = std::clock ();
+  Simulator::Stop (Seconds (0.1) + time);
+  Simulator::Run ();
+  double seconds = (double) (std::clock () - clock) / CLOCKS_PER_SEC;
+  uint64_t rx = DynamicCast<PacketSink> (sinkApp.Get (0))->GetTotalRx ();
+  std::cout << rate << "\t" << large << "\t" << rx * 8 / time.GetSeconds () / 1e9 << "\t" << g_frames
+            << "\t" << CountingScheduler::m_inserted << "\t" << (time.GetSeconds () + 0.1) / seconds << std::endl;
+  Simulator::Destroy ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t delay = 1;
+  uint32_t large = 64000;
+  double time = 1;
+
+  CommandLine cmd;
+  cmd.AddValue ("delay", "Delay of the link (ms)", delay);
+  cmd.AddValue ("large", "Largest send handed down at once (bytes)", large);
+  cmd.AddValue ("time", "Duration of each transfer (s)", time);
+  cmd.Parse (argc, argv);
+
+  std::cout << delay << " ms, " << time << " s" << std::endl;
+  std::cout << "Gbps\tlarge\tgoodput(Gbps)\tframes\tevents\tsim s/cpu s" << std::endl;
+  uint32_t rates[] = { 10, 40 };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Run (rates[i], delay, 0, Seconds (time));
+      Run (rates[i], delay, large, Seconds (time));
+    }
+  return 0;
+}
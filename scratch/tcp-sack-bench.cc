@@ -0,0 +1,172 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// TCP selective acknowledgment benchmark.
+//
+// A bulk transfer runs for --time seconds over a point-to-point link of
+// --rate Mbps and --delay ms, whose receiver drops the packets at random
+// with the rate --loss. The transfer runs first with TCP NewReno alone,
+// then with the SACK option. The program reports, for each run, the
+// goodput, the packets sent by the sender for each packet of data
+// received, the events inserted in the scheduler and the processor time.
+//
+// ./waf --run "tcp-sack-bench --rate=100 --delay=20 --loss=0.01 --time=60"
+//
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+
+#include <ctime>
+#include <iostream>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpSackBench");
+
+/**
+ * A map scheduler which counts the events inserted.
+ */
+class CountingScheduler : public MapScheduler
+{
+public:
+  static TypeId GetTypeId (void);
+  virtual void Insert (const Event &ev);
+
+  static uint64_t m_inserted; //!< the number of events inserted
+};
+
+uint64_t CountingScheduler::m_inserted = 0;
+
+NS_OBJECT_ENSURE_REGISTERED (CountingScheduler);
+
+TypeId
+CountingScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CountingScheduler")
+    .SetParent<MapScheduler> ()
+    .AddConstructor<CountingScheduler> ()
+  ;
+  return tid;
+}
+
+void
+CountingScheduler::Insert (const Event &ev)
+{
+  m_inserted++;
+  MapScheduler::Insert (ev);
+}
+
+static uint32_t g_sent = 0;
+
+static void
+CountTx (Ptr<const Packet> p)
+{
+  g_sent++;
+}
+
+/**
+ * Run the bulk transfer and report the goodput and the overhead.
+ * \param name the name of the run
+ * \param sack whether the SACK option is enabled
+ * \param rate the rate of the link (Mbps)
+ * \param delay the delay of the link (ms)
+ * \param loss the rate of the packets dropped
+ * \param time the duration of the transfer
+ */
+static void
+Run (std::string name, bool sack, uint32_t rate, uint32_t delay, double loss, Time time)
+{
+  ObjectFactory scheduler;
+  scheduler.SetTypeId ("ns3::CountingScheduler");
+  Simulator::SetScheduler (scheduler);
+  CountingScheduler::m_inserted = 0;
+  g_sent = 0;
+
+  Config::SetDefault ("ns3::TcpL4Protocol::SocketType", TypeIdValue (TcpNewReno::GetTypeId ()));
+  Config::SetDefault ("ns3::TcpSocketBase::Sack", BooleanValue (sack));
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1448));
+  Config::SetDefault ("ns3::TcpSocket::SndBufSize", UintegerValue (1 << 22));
+  Config::SetDefault ("ns3::TcpSocket::RcvBufSize", UintegerValue (1 << 22));
+  // The same drops in both runs
+  RngSeedManager::SetRun (1);
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  std::ostringstream dataRate;
+  dataRate << rate << "Mbps";
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue (dataRate.str ()));
+  p2p.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (delay)));
+  NetDeviceContainer devices = p2p.Install (nodes);
+  Ptr<RateErrorModel> errors = CreateObject<RateErrorModel> ();
+  errors->SetAttribute ("ErrorRate", DoubleValue (loss));
+  errors->SetAttribute ("ErrorUnit", EnumValue (RateErrorModel::ERROR_UNIT_PACKET));
+  devices.Get (1)->SetAttribute ("ReceiveErrorModel", PointerValue (errors));
+  devices.Get (0)->TraceConnectWithoutContext ("MacTx", MakeCallback (&CountTx));
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  uint16_t port = 9;
+  BulkSendHelper source ("ns3::TcpSocketFactory", InetSocketAddress (interfaces.GetAddress (1), port));
+  source.SetAttribute ("MaxBytes", UintegerValue (0));
+  ApplicationContainer sourceApp = source.Install (nodes.Get (0));
+  sourceApp.Start (Seconds (1));
+  sourceApp.Stop (Seconds (1) + time);
+  PacketSinkHelper sink ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+  ApplicationContainer sinkApp = sink.Install (nodes.Get (1));
+  sinkApp.Start (Seconds (0));
+
+  std::clock_t clock = std::clock ();
+  Simulator::Stop (Seconds (1) + time);
+  Simulator::Run ();
+  double seconds = (double) (std::clock () - clock) / CLOCKS_PER_SEC;
+  uint64_t rx = DynamicCast<PacketSink> (sinkApp.Get (0))->GetTotalRx ();
+  double packets = (double) rx / 1448;
+  std::cout << name << "\t" << rx * 8 / time.GetSeconds () / 1e6 << "\t" << (packets > 0 ? g_sent / packets : 0)
+            << "\t" << CountingScheduler::m_inserted << "\t" << seconds << std::endl;
+  Simulator::Destroy ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t rate = 100;
+  uint32_t delay = 20;
+  double loss = 0.01;
+  double time = 60;
+
+  CommandLine cmd;
+  cmd.AddValue ("rate", "Rate of the link (Mbps)", rate);
+  cmd.AddValue ("delay", "Delay of the link (ms)", delay);
+  cmd.AddValue ("loss", "Rate of the packets dropped by the receiver", loss);
+  cmd.AddValue ("time", "Duration of each transfer (s)", time);
+  cmd.Parse (argc, argv);
+
+  std::cout << rate << " Mbps, " << delay << " ms, loss " << loss << ", " << time << " s" << std::endl;
+  std::cout << "tcp\tgoodput(Mbps)\ttx/rx\tevents\tcpu(s)" << std::endl;
+  Run ("newreno", false, rate, delay, loss, Seconds (time));
+  Run ("sack", true, rate, delay, loss, Seconds (time));
+  return 0;
+}
@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// Unicast router advertisement benchmark.
+//
+// A MAG node sends the unicast RAs of --mns mobile nodes (500 by
+// default), each with its own home network prefix, as Pmipv6Mag sets
+// them up, with RegularUnicastRadvd on its access device. The program
+// runs --time seconds of RAs, first with each RA sent when it is due
+// (BatchInterval of 0), then in batches of --batch milliseconds. It
+// reports, for each run, the RAs sent, the rate in RAs per second of
+// processor time, the events inserted in the scheduler and the mean and
+// maximum delay of the RAs from the time they were due.
+//
+// ./waf --run "unicast-radvd-batch-bench --mns=500 --time=600 --batch=100"
+//
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/pmipv6-module.h"
+
+#include <ctime>
+#include <iostream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("UnicastRadvdBatchBench");
+
+/**
+ * A map scheduler which counts the events inserted.
+ */
+class CountingScheduler : public MapScheduler
+{
+public:
+  static TypeId GetTypeId (void);
+  virtual void Insert (const Event &ev);
+
+  static uint64_t m_inserted; //!< the number of events inserted
+};
+
+uint64_t CountingScheduler::m_inserted = 0;
+
+NS_OBJECT_ENSURE_REGISTERED (CountingScheduler);
+
+TypeId
+CountingScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CountingScheduler")
+    .SetParent<MapScheduler> ()
+    .AddConstructor<CountingScheduler> ()
+  ;
+  return tid;
+}
+
+void
+CountingScheduler::Insert (const Event &ev)
+{
+  m_inserted++;
+  MapScheduler::Insert (ev);
+}
+
+static uint32_t g_ras = 0;
+static Time g_lag;
+static Time g_maxLag;
+
+static void
+CountRa (Ptr<const Packet> p, Time lag)
+{
+  g_ras++;
+  g_lag += lag;
+  g_maxLag = Max (g_maxLag, lag);
+}
+
+/**
+ * Send the RAs of the mobile nodes and report the rate and delays.
+ * \param name the name of the run
+ * \param mns the number of mobile nodes
+ * \param time the duration of the run
+ * \param batch the batch interval of the RAs
+ */
+static void
+Run (std::string name, uint32_t mns, Time time, Time batch)
+{
+  ObjectFactory scheduler;
+  scheduler.SetTypeId ("ns3::CountingScheduler");
+  Simulator::SetScheduler (scheduler);
+  CountingScheduler::m_inserted = 0;
+  g_ras = 0;
+  g_lag = Seconds (0);
+  g_maxLag = Seconds (0);
+
+  Ptr<Node> mag = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (mag);
+  PacketSocketHelper packetSocket;
+  packetSocket.Install (mag);
+  // the RAs are sent to nobody
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  device->SetAddress (Mac48Address::Allocate ());
+  device->SetChannel (CreateObject<SimpleChannel> ());
+  mag->AddDevice (device);
+  Ptr<Ipv6> ipv6 = mag->GetObject<Ipv6> ();
+  uint32_t interface = ipv6->AddInterface (device);
+  ipv6->AddAddress (interface, Ipv6InterfaceAddress (Ipv6Address ("fe80::1"), Ipv6Prefix (64)));
+  ipv6->SetUp (interface);
+
+  Ptr<RegularUnicastRadvd> radvd = CreateObject<RegularUnicastRadvd> ();
+  radvd->SetAttribute ("BatchInterval", TimeValue (batch));
+  radvd->AssignStreams (1);
+  radvd->TraceConnectWithoutContext ("TxRa", MakeCallback (&CountRa));
+  radvd->SetStartTime (Seconds (1));
+  radvd->SetStopTime (Seconds (1) + time);
+  mag->AddApplication (radvd);
+
+  for (uint32_t i = 0; i < mns; i++)
+    {
+      Ptr<UnicastRadvdInterface> uri = Create<UnicastRadvdInterface> (interface, 5000, 1000);
+      uri->SetPhysicalAddress (Mac48Address::Allocate ());
+      uint8_t prefix[16] = { 0x20, 0x01, 0x0d, 0xb8, 0, 0, static_cast<uint8_t> (i >> 8), static_cast<uint8_t> (i) };
+      uri->AddPrefix (Create<RadvdPrefix> (Ipv6Address (prefix), 64, 3, 5));
+      radvd->AddConfiguration (uri);
+    }
+
+  std::clock_t clock = std::clock ();
+  Simulator::Stop (Seconds (2) + time);
+  Simulator::Run ();
+  double seconds = (double) (std::clock () - clock) / CLOCKS_PER_SEC;
+  std::cout << name << "\t" << g_ras << "\t" << g_ras / seconds << "\t" << CountingScheduler::m_inserted
+            << "\t" << (g_ras ? g_lag.GetSeconds () * 1000 / g_ras : 0) << "\t" << g_maxLag.GetSeconds () * 1000 << std::endl;
+  Simulator::Destroy ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t mns = 500;
+  double time = 600;
+  uint32_t batch = 100;
+
+  CommandLine cmd;
+  cmd.AddValue ("mns", "Number of mobile nodes of the MAG", mns);
+  cmd.AddValue ("time", "Duration of each run (s)", time);
+  cmd.AddValue ("batch", "Batch interval of the RAs (ms)", batch);
+  cmd.Parse (argc, argv);
+
+  std::cout << mns << " mobile nodes, " << time << " s" << std::endl;
+  std::cout << "batch\tRAs\tRAs/s\tevents\tlag(ms)\tmax lag(ms)" << std::endl;
+  Run ("none", mns, Seconds (time), Seconds (0));
+  Run ("batch", mns, Seconds (time), MilliSeconds (batch));
+  return 0;
+}
@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+// Dense Wi-Fi interference benchmark.
+//
+// nNodes ad hoc stations (200 by default) are dropped in a small disc so
+// that every station is in range of every other one, and each of them
+// broadcasts frames at random instants. Every frame is thus received (or
+// dropped) by all the other PHYs, and every reception goes through the
+// InterferenceHelper with many overlapping signals. The program reports
+// the number of PHY receptions processed per second of wall-clock time.
+//
+// ./waf --run "wifi-dense-interference-bench --nNodes=400 --simTime=5"
+//
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+
+#include <iostream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("WifiDenseInterferenceBench");
+
+static uint64_t g_rxEnd = 0;
+static uint64_t g_rxDrop = 0;
+
+static void
+PhyRxEnd (Ptr<const Packet> packet)
+{
+  g_rxEnd++;
+}
+
+static void
+PhyRxDrop (Ptr<const Packet> packet)
+{
+  g_rxDrop++;
+}
+
+static void
+SendOne (Ptr<NetDevice> dev, uint32_t size, Ptr<ExponentialRandomVariable> interval)
+{
+  dev->Send (Create<Packet> (size), dev->GetBroadcast (), 0x0800);
+  Simulator::Schedule (Seconds (interval->GetValue ()), &SendOne, dev, size, interval);
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nNodes = 200;
+  double radius = 20.0;
+  double simTime = 2.0;
+  double meanInterval = 0.01;
+  uint32_t packetSize = 500;
+
+  CommandLine cmd;
+  cmd.AddValue ("nNodes", "Number of transmitters in range of each other", nNodes);
+  cmd.AddValue ("radius", "Radius (m) of the disc the nodes are dropped in", radius);
+  cmd.AddValue ("simTime", "Simulated time (s)", simTime);
+  cmd.AddValue ("meanInterval", "Mean interval (s) between two broadcasts of a node", meanInterval);
+  cmd.AddValue ("packetSize", "Size (bytes) of the broadcast frames", packetSize);
+  cmd.Parse (argc, argv);
+
+  NodeContainer nodes;
+  nodes.Create (nNodes);
+
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211a);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("OfdmRate6Mbps"),
+                                "ControlMode", StringValue ("OfdmRate6Mbps"));
+  YansWifiChannelHelper wifiChannel = YansWifiChannelHelper::Default ();
+  YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default ();
+  wifiPhy.SetChannel (wifiChannel.Create ());
+  NqosWifiMacHelper wifiMac = NqosWifiMacHelper::Default ();
+  wifiMac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (wifiPhy, wifiMac, nodes);
+
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::UniformDiscPositionAllocator",
+                                 "rho", DoubleValue (radius));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyRxEnd",
+                                 MakeCallback (&PhyRxEnd));
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyRxDrop",
+                                 MakeCallback (&PhyRxDrop));
+
+  Ptr<ExponentialRandomVariable> interval = CreateObject<ExponentialRandomVariable> ();
+  interval->SetAttribute ("Mean", DoubleValue (meanInterval));
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      Simulator::Schedule (Seconds (interval->GetValue ()), &SendOne,
+                           devices.Get (i), packetSize, interval);
+    }
+
+  Simulator::Stop (Seconds (simTime));
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  int64_t elapsedMs = clock.End ();
+  Simulator::Destroy ();
+
+  uint64_t receptions = g_rxEnd + g_rxDrop;
+  double elapsed = elapsedMs / 1000.0;
+  std::cout << "nodes:             " << nNodes << std::endl
+            << "receptions:        " << receptions
+            << " (" << g_rxEnd << " decoded, " << g_rxDrop << " dropped)" << std::endl
+            << "wall-clock time:   " << elapsed << " s" << std::endl
+            << "receptions/sec:    " << (elapsed > 0 ? receptions / elapsed : 0) << std::endl;
+  return 0;
+}
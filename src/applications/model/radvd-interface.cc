@@ -27,7 +27,8 @@ namespace ns3
 NS_LOG_COMPONENT_DEFINE ("RadvdInterface");
 
 RadvdInterface::RadvdInterface (uint32_t interface)
-  : m_interface (interface)
+  : m_interface (interface),
+    m_changeCount (0)
 {
   NS_LOG_FUNCTION (this << interface);
   /* initialize default value as specified in radvd.conf manpage */
@@ -54,7 +55,8 @@ RadvdInterface::RadvdInterface (uint32_t interface)
 }
 
 RadvdInterface::RadvdInterface (uint32_t interface, uint32_t maxRtrAdvInterval, uint32_t minRtrAdvInterval)
-  : m_interface (interface)
+  : m_interface (interface),
+    m_changeCount (0)
 {
   NS_LOG_FUNCTION (this << interface << maxRtrAdvInterval << minRtrAdvInterval);
   NS_ASSERT (maxRtrAdvInterval > minRtrAdvInterval);
@@ -95,6 +97,7 @@ void RadvdInterface::AddPrefix (Ptr<RadvdPrefix> routerPrefix)
 {
   NS_LOG_FUNCTION (this << routerPrefix);
   m_prefixes.push_back (routerPrefix);
+  m_changeCount++;
 }
 
 
@@ -120,6 +123,7 @@ void RadvdInterface::SetSendAdvert (bool sendAdvert)
 {
   NS_LOG_FUNCTION (this << sendAdvert);
   m_sendAdvert = sendAdvert;
+  m_changeCount++;
 }
 
 uint32_t RadvdInterface::GetMaxRtrAdvInterval () const
@@ -132,6 +136,7 @@ void RadvdInterface::SetMaxRtrAdvInterval (uint32_t maxRtrAdvInterval)
 {
   NS_LOG_FUNCTION (this << maxRtrAdvInterval);
   m_maxRtrAdvInterval = maxRtrAdvInterval;
+  m_changeCount++;
 }
 
 uint32_t RadvdInterface::GetMinRtrAdvInterval () const
@@ -144,6 +149,7 @@ void RadvdInterface::SetMinRtrAdvInterval (uint32_t minRtrAdvInterval)
 {
   NS_LOG_FUNCTION (this << minRtrAdvInterval);
   m_minRtrAdvInterval = minRtrAdvInterval;
+  m_changeCount++;
 }
 
 uint32_t RadvdInterface::GetMinDelayBetweenRAs () const
@@ -156,6 +162,7 @@ void RadvdInterface::SetMinDelayBetweenRAs (uint32_t minDelayBetweenRAs)
 {
   NS_LOG_FUNCTION (this << minDelayBetweenRAs);
   m_minDelayBetweenRAs = minDelayBetweenRAs;
+  m_changeCount++;
 }
 
 bool RadvdInterface::IsManagedFlag () const
@@ -168,6 +175,7 @@ void RadvdInterface::SetManagedFlag (bool managedFlag)
 {
   NS_LOG_FUNCTION (this << managedFlag);
   m_managedFlag = managedFlag;
+  m_changeCount++;
 }
 
 bool RadvdInterface::IsOtherConfigFlag () const
@@ -180,6 +188,7 @@ void RadvdInterface::SetOtherConfigFlag (bool otherConfigFlag)
 {
   NS_LOG_FUNCTION (this << otherConfigFlag);
   m_otherConfigFlag = otherConfigFlag;
+  m_changeCount++;
 }
 
 uint32_t RadvdInterface::GetLinkMtu () const
@@ -192,6 +201,7 @@ void RadvdInterface::SetLinkMtu (uint32_t linkMtu)
 {
   NS_LOG_FUNCTION (this << linkMtu);
   m_linkMtu = linkMtu;
+  m_changeCount++;
 }
 
 uint32_t RadvdInterface::GetReachableTime () const
@@ -204,6 +214,7 @@ void RadvdInterface::SetReachableTime (uint32_t reachableTime)
 {
   NS_LOG_FUNCTION (this << reachableTime);
   m_reachableTime = reachableTime;
+  m_changeCount++;
 }
 
 uint32_t RadvdInterface::GetDefaultLifeTime () const
@@ -216,6 +227,7 @@ void RadvdInterface::SetDefaultLifeTime (uint32_t defaultLifeTime)
 {
   NS_LOG_FUNCTION (this << defaultLifeTime);
   m_defaultLifeTime = defaultLifeTime;
+  m_changeCount++;
 }
 
 uint32_t RadvdInterface::GetRetransTimer () const
@@ -228,6 +240,7 @@ void RadvdInterface::SetRetransTimer (uint32_t retransTimer)
 {
   NS_LOG_FUNCTION (this << retransTimer);
   m_retransTimer = retransTimer;
+  m_changeCount++;
 }
 
 uint8_t RadvdInterface::GetCurHopLimit () const
@@ -240,6 +253,7 @@ void RadvdInterface::SetCurHopLimit (uint8_t curHopLimit)
 {
   NS_LOG_FUNCTION (this << curHopLimit);
   m_curHopLimit = curHopLimit;
+  m_changeCount++;
 }
 
 uint8_t RadvdInterface::GetDefaultPreference () const
@@ -252,6 +266,7 @@ void RadvdInterface::SetDefaultPreference (uint8_t defaultPreference)
 {
   NS_LOG_FUNCTION (this << defaultPreference);
   m_defaultPreference = defaultPreference;
+  m_changeCount++;
 }
 
 bool RadvdInterface::IsSourceLLAddress () const
@@ -264,6 +279,7 @@ void RadvdInterface::SetSourceLLAddress (bool sourceLLAddress)
 {
   NS_LOG_FUNCTION (this << sourceLLAddress);
   m_sourceLLAddress = sourceLLAddress;
+  m_changeCount++;
 }
 
 bool RadvdInterface::IsHomeAgentFlag () const
@@ -276,6 +292,7 @@ void RadvdInterface::SetHomeAgentFlag (bool homeAgentFlag)
 {
   NS_LOG_FUNCTION (this << homeAgentFlag);
   m_homeAgentFlag = homeAgentFlag;
+  m_changeCount++;
 }
 
 bool RadvdInterface::IsHomeAgentInfo () const
@@ -288,6 +305,7 @@ void RadvdInterface::SetHomeAgentInfo (bool homeAgentInfo)
 {
   NS_LOG_FUNCTION (this << homeAgentInfo);
   m_homeAgentInfo = homeAgentInfo;
+  m_changeCount++;
 }
 
 uint32_t RadvdInterface::GetHomeAgentLifeTime () const
@@ -300,6 +318,7 @@ void RadvdInterface::SetHomeAgentLifeTime (uint32_t homeAgentLifeTime)
 {
   NS_LOG_FUNCTION (this << homeAgentLifeTime);
   m_homeAgentLifeTime = homeAgentLifeTime;
+  m_changeCount++;
 }
 
 uint32_t RadvdInterface::GetHomeAgentPreference () const
@@ -312,6 +331,7 @@ void RadvdInterface::SetHomeAgentPreference (uint32_t homeAgentPreference)
 {
   NS_LOG_FUNCTION (this << homeAgentPreference);
   m_homeAgentPreference = homeAgentPreference;
+  m_changeCount++;
 }
 
 bool RadvdInterface::IsMobRtrSupportFlag () const
@@ -324,6 +344,7 @@ void RadvdInterface::SetMobRtrSupportFlag (bool mobRtrSupportFlag)
 {
   NS_LOG_FUNCTION (this << mobRtrSupportFlag);
   m_mobRtrSupportFlag = mobRtrSupportFlag;
+  m_changeCount++;
 }
 
 bool RadvdInterface::IsIntervalOpt () const
@@ -336,6 +357,7 @@ void RadvdInterface::SetIntervalOpt (bool intervalOpt)
 {
   NS_LOG_FUNCTION (this << intervalOpt);
   m_intervalOpt = intervalOpt;
+  m_changeCount++;
 }
 
 Time RadvdInterface::GetLastRaTxTime ()
@@ -357,5 +379,16 @@ bool RadvdInterface::IsInitialRtrAdv ()
   return m_initialRtrAdvertisementsLeft;
 }
 
+uint32_t RadvdInterface::GetChangeCount () const
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t count = m_changeCount;
+  for (RadvdPrefixListCI it = m_prefixes.begin (); it != m_prefixes.end (); ++it)
+    {
+      count += (*it)->GetChangeCount ();
+    }
+  return count;
+}
+
 } /* namespace ns3 */
 
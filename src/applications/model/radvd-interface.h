@@ -327,6 +327,16 @@ public:
    */
   bool IsInitialRtrAdv ();
 
+  /**
+   * \brief Get the number of changes of the advertised parameters.
+   *
+   * The setters of the interface (except SetLastRaTxTime), AddPrefix and
+   * the setters of its prefixes increment this counter, so that the RAs
+   * built from the interface can be reused as long as it does not change.
+   * \returns the number of changes
+   */
+  uint32_t GetChangeCount () const;
+
 private:
 
   /**
@@ -448,6 +458,11 @@ private:
    */
   uint8_t m_initialRtrAdvertisementsLeft;
 
+  /**
+   * \brief Number of changes of the interface parameters and prefix list.
+   */
+  uint32_t m_changeCount;
+
 };
 
 } /* namespace ns3 */
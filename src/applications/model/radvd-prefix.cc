@@ -33,7 +33,8 @@ RadvdPrefix::RadvdPrefix (Ipv6Address network, uint8_t prefixLength, uint32_t pr
     m_validLifeTime (validLifeTime),
     m_onLinkFlag (onLinkFlag),
     m_autonomousFlag (autonomousFlag),
-    m_routerAddrFlag (routerAddrFlag)
+    m_routerAddrFlag (routerAddrFlag),
+    m_changeCount (0)
 {
   NS_LOG_FUNCTION (this << network << prefixLength << preferredLifeTime << validLifeTime << onLinkFlag << autonomousFlag << routerAddrFlag);
 }
@@ -53,6 +54,7 @@ void RadvdPrefix::SetNetwork (Ipv6Address network)
 {
   NS_LOG_FUNCTION (this << network);
   m_network = network;
+  m_changeCount++;
 }
 
 uint8_t RadvdPrefix::GetPrefixLength () const
@@ -65,6 +67,7 @@ void RadvdPrefix::SetPrefixLength (uint8_t prefixLength)
 {
   NS_LOG_FUNCTION (this << prefixLength);
   m_prefixLength = prefixLength;
+  m_changeCount++;
 }
 
 uint32_t RadvdPrefix::GetValidLifeTime () const
@@ -77,6 +80,7 @@ void RadvdPrefix::SetValidLifeTime (uint32_t validLifeTime)
 {
   NS_LOG_FUNCTION (this << validLifeTime);
   m_validLifeTime = validLifeTime;
+  m_changeCount++;
 }
 
 uint32_t RadvdPrefix::GetPreferredLifeTime () const
@@ -89,6 +93,7 @@ void RadvdPrefix::SetPreferredLifeTime (uint32_t preferredLifeTime)
 {
   NS_LOG_FUNCTION (this << preferredLifeTime);
   m_preferredLifeTime = preferredLifeTime;
+  m_changeCount++;
 }
 
 bool RadvdPrefix::IsOnLinkFlag () const
@@ -101,6 +106,7 @@ void RadvdPrefix::SetOnLinkFlag (bool onLinkFlag)
 {
   NS_LOG_FUNCTION (this << onLinkFlag);
   m_onLinkFlag = onLinkFlag;
+  m_changeCount++;
 }
 
 bool RadvdPrefix::IsAutonomousFlag () const
@@ -113,6 +119,7 @@ void RadvdPrefix::SetAutonomousFlag (bool autonomousFlag)
 {
   NS_LOG_FUNCTION (this << autonomousFlag);
   m_autonomousFlag = autonomousFlag;
+  m_changeCount++;
 }
 
 bool RadvdPrefix::IsRouterAddrFlag () const
@@ -125,6 +132,13 @@ void RadvdPrefix::SetRouterAddrFlag (bool routerAddrFlag)
 {
   NS_LOG_FUNCTION (this << routerAddrFlag);
   m_routerAddrFlag = routerAddrFlag;
+  m_changeCount++;
+}
+
+uint32_t RadvdPrefix::GetChangeCount () const
+{
+  NS_LOG_FUNCTION (this);
+  return m_changeCount;
 }
 
 } /* namespace ns3 */
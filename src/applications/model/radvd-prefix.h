@@ -138,6 +138,15 @@ public:
    */
   void SetRouterAddrFlag (bool routerAddrFlag);
 
+  /**
+   * \brief Get the number of changes of the prefix.
+   *
+   * Each setter increments this counter, so that the RAs built
+   * from the prefix can be reused as long as it does not change.
+   * \return the number of changes
+   */
+  uint32_t GetChangeCount () const;
+
 private:
   /**
    * \brief Network prefix.
@@ -174,6 +183,11 @@ private:
    * of network prefix as is required by Mobile IPv6.
    */
   bool m_routerAddrFlag;
+
+  /**
+   * \brief Number of changes of the prefix.
+   */
+  uint32_t m_changeCount;
 };
 
 } /* namespace ns3 */
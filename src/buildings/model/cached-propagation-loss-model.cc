@@ -0,0 +1,195 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/mobility-model.h"
+#include <ns3/mobility-building-info.h>
+#include <algorithm>
+#include <limits>
+#include "cached-propagation-loss-model.h"
+
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("CachedPropagationLossModel");
+
+NS_OBJECT_ENSURE_REGISTERED (CachedPropagationLossModel);
+
+
+bool
+CachedPropagationLossModel::BuildingState::operator == (const BuildingState &other) const
+{
+  return building == other.building
+         && floor == other.floor
+         && roomX == other.roomX
+         && roomY == other.roomY;
+}
+
+TypeId
+CachedPropagationLossModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CachedPropagationLossModel")
+    .SetParent<PropagationLossModel> ()
+    .AddConstructor<CachedPropagationLossModel> ()
+    .AddAttribute ("InvalidationDistance",
+                   "The distance (m) an endpoint may move before the loss of its pairs is computed again.",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&CachedPropagationLossModel::SetInvalidationDistance),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("MaxSize",
+                   "The maximum number of pairs whose loss is cached, 0 for no limit. "
+                   "The least recently used pair is evicted first.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&CachedPropagationLossModel::SetMaxSize),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+CachedPropagationLossModel::CachedPropagationLossModel ()
+  : m_invalidationDistance (0.0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+CachedPropagationLossModel::~CachedPropagationLossModel ()
+{
+}
+
+void
+CachedPropagationLossModel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_cache.Clear ();
+  m_model = 0;
+  PropagationLossModel::DoDispose ();
+}
+
+void
+CachedPropagationLossModel::SetPropagationLossModel (Ptr<PropagationLossModel> model)
+{
+  NS_LOG_FUNCTION (this << model);
+  m_model = model;
+  m_cache.Clear ();
+}
+
+Ptr<PropagationLossModel>
+CachedPropagationLossModel::GetPropagationLossModel (void) const
+{
+  return m_model;
+}
+
+uint32_t
+CachedPropagationLossModel::GetNCachedPaths (void) const
+{
+  return m_cache.GetSize ();
+}
+
+void
+CachedPropagationLossModel::ClearCache (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_cache.Clear ();
+}
+
+void
+CachedPropagationLossModel::SetMaxSize (uint32_t maxSize)
+{
+  m_cache.SetMaxSize (maxSize);
+}
+
+void
+CachedPropagationLossModel::SetInvalidationDistance (double distance)
+{
+  m_invalidationDistance = distance;
+  // a zero distance would disable the invalidation in PropagationCache
+  m_cache.SetInvalidationDistance (std::max (distance, std::numeric_limits<double>::min ()));
+}
+
+CachedPropagationLossModel::BuildingState
+CachedPropagationLossModel::GetBuildingState (Ptr<const MobilityModel> mobility)
+{
+  BuildingState state;
+  state.floor = 0;
+  state.roomX = 0;
+  state.roomY = 0;
+  Ptr<MobilityBuildingInfo> info = mobility->GetObject<MobilityBuildingInfo> ();
+  if (info != 0 && info->IsIndoor ())
+    {
+      state.building = info->GetBuilding ();
+      state.floor = info->GetFloorNumber ();
+      state.roomX = info->GetRoomNumberX ();
+      state.roomY = info->GetRoomNumberY ();
+    }
+  return state;
+}
+
+double
+CachedPropagationLossModel::DoCalcRxPower (double txPowerDbm,
+                                           Ptr<MobilityModel> a,
+                                           Ptr<MobilityModel> b) const
+{
+  NS_ASSERT_MSG (m_model != 0, "no PropagationLossModel to cache");
+  Ptr<const MobilityModel> first = std::min<Ptr<const MobilityModel> > (a, b);
+  Ptr<const MobilityModel> second = std::max<Ptr<const MobilityModel> > (a, b);
+  BuildingState firstBuilding = GetBuildingState (first);
+  BuildingState secondBuilding = GetBuildingState (second);
+
+  Ptr<PathLoss> pathLoss = m_cache.GetPathData (first, second, 0);
+  if (pathLoss != 0
+      && pathLoss->m_firstBuilding == firstBuilding
+      && pathLoss->m_secondBuilding == secondBuilding)
+    {
+      return txPowerDbm + pathLoss->m_gainDb;
+    }
+  if (pathLoss == 0)
+    {
+      pathLoss = Create<PathLoss> ();
+      m_cache.AddPathData (pathLoss, first, second, 0);
+    }
+  pathLoss->m_gainDb = m_model->CalcRxPower (0, a, b);
+  pathLoss->m_firstBuilding = firstBuilding;
+  pathLoss->m_secondBuilding = secondBuilding;
+  NS_LOG_LOGIC (this << " computed gain " << pathLoss->m_gainDb << " dB between " << a << " and " << b);
+  return txPowerDbm + pathLoss->m_gainDb;
+}
+
+int64_t
+CachedPropagationLossModel::DoAssignStreams (int64_t stream)
+{
+  if (m_model == 0)
+    {
+      return 0;
+    }
+  return m_model->AssignStreams (stream);
+}
+
+double
+CachedPropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxThresholdDbm) const
+{
+  if (m_model == 0)
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  // the loss of a pair may have been cached while both endpoints were
+  // up to m_invalidationDistance closer
+  return m_model->GetMaxRange (txPowerDbm, rxThresholdDbm) + 2 * m_invalidationDistance;
+}
+
+
+} // namespace ns3
@@ -0,0 +1,143 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CACHED_PROPAGATION_LOSS_MODEL_H_
+#define CACHED_PROPAGATION_LOSS_MODEL_H_
+
+#include <ns3/propagation-loss-model.h>
+#include <ns3/propagation-cache.h>
+#include <ns3/simple-ref-count.h>
+#include <ns3/building.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup propagation
+ *
+ *  This model caches the loss computed by another PropagationLossModel
+ *  for each pair of mobility models. The loss of a pair is computed
+ *  again only once either endpoint has moved by more than the
+ *  InvalidationDistance since the loss was cached, or when the building,
+ *  floor or room of either endpoint changed, as reported by its
+ *  MobilityBuildingInfo (if any).
+ *
+ *  Between two evaluations, the loss of a pair is thus approximated by
+ *  the one of a position at most InvalidationDistance away from the
+ *  current one. The model is meant to wrap deterministic pathloss models
+ *  (possibly with a shadowing which is drawn once per pair, as in
+ *  BuildingsPropagationLossModel): the fast fading of a wrapped model
+ *  would be frozen. As with PropagationCache, the links are assumed to be
+ *  reciprocal, and the loss of a->b is reused for b->a.
+ */
+class CachedPropagationLossModel : public PropagationLossModel
+{
+
+public:
+  static TypeId GetTypeId (void);
+  CachedPropagationLossModel ();
+  virtual ~CachedPropagationLossModel ();
+
+  /**
+   * \param model the model whose loss is cached; the cache is cleared
+   */
+  void SetPropagationLossModel (Ptr<PropagationLossModel> model);
+  /**
+   * \return the model whose loss is cached
+   */
+  Ptr<PropagationLossModel> GetPropagationLossModel (void) const;
+
+  /**
+   * \return the number of pairs whose loss is cached
+   */
+  uint32_t GetNCachedPaths (void) const;
+  /**
+   * Forget the loss of all the pairs, e.g. after an attribute of the
+   * wrapped model was changed.
+   */
+  void ClearCache (void);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Copy constructor
+   *
+   * Defined and unimplemented to avoid misuse
+   */
+  CachedPropagationLossModel (const CachedPropagationLossModel &);
+  /**
+   * \brief Copy constructor
+   *
+   * Defined and unimplemented to avoid misuse
+   * \returns
+   */
+  CachedPropagationLossModel & operator = (const CachedPropagationLossModel &);
+
+  virtual double DoCalcRxPower (double txPowerDbm,
+                                Ptr<MobilityModel> a,
+                                Ptr<MobilityModel> b) const;
+  virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRange (double txPowerDbm, double rxThresholdDbm) const;
+
+  /**
+   * Set the maximum number of pairs whose loss is cached.
+   * \param maxSize the maximum number of pairs, or 0 for no limit
+   */
+  void SetMaxSize (uint32_t maxSize);
+  /**
+   * Set the distance an endpoint may move before the loss of its pairs
+   * is computed again.
+   * \param distance the distance (m)
+   */
+  void SetInvalidationDistance (double distance);
+
+  /**
+   * The building, floor and room in which an endpoint is located.
+   */
+  struct BuildingState
+  {
+    Ptr<Building> building; //!< the building, or 0 when outdoor
+    uint8_t floor;          //!< the floor number
+    uint8_t roomX;          //!< the room number along the x axis
+    uint8_t roomY;          //!< the room number along the y axis
+    bool operator == (const BuildingState &other) const;
+  };
+  /**
+   * The cached loss of a pair of mobility models.
+   */
+  class PathLoss : public SimpleRefCount<PathLoss>
+  {
+public:
+    double m_gainDb;                //!< the gain (dB) returned by the wrapped model for 0 dBm
+    BuildingState m_firstBuilding;  //!< where the endpoint with the lowest address was
+    BuildingState m_secondBuilding; //!< where the endpoint with the highest address was
+  };
+
+  /**
+   * \param mobility the mobility model of an endpoint
+   * \return the building, floor and room in which the endpoint is located
+   */
+  static BuildingState GetBuildingState (Ptr<const MobilityModel> mobility);
+
+  Ptr<PropagationLossModel> m_model;               //!< the model whose loss is cached
+  double m_invalidationDistance;                    //!< distance (m) beyond which a move invalidates a pair
+  mutable PropagationCache<PathLoss> m_cache;       //!< the cached loss per pair
+};
+
+} // namespace ns3
+
+#endif /* CACHED_PROPAGATION_LOSS_MODEL_H_ */
@@ -0,0 +1,122 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+
+#include "ns3/log.h"
+#include "ns3/test.h"
+#include "ns3/double.h"
+#include <ns3/cached-propagation-loss-model.h>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/mobility-building-info.h>
+#include <ns3/constant-position-mobility-model.h>
+#include <ns3/building.h>
+#include <ns3/simulator.h>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("CachedPropagationLossModelTest");
+
+/**
+ * Check that CachedPropagationLossModel returns the loss of the wrapped
+ * model, and that it computes it again only when an endpoint moved by
+ * more than the invalidation distance or changed building.
+ */
+class CachedPropagationLossModelTestCase : public TestCase
+{
+public:
+  CachedPropagationLossModelTestCase ();
+  virtual ~CachedPropagationLossModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CachedPropagationLossModelTestCase::CachedPropagationLossModelTestCase ()
+  : TestCase ("CachedPropagationLossModel invalidation")
+{
+}
+
+CachedPropagationLossModelTestCase::~CachedPropagationLossModelTestCase ()
+{
+}
+
+void
+CachedPropagationLossModelTestCase::DoRun (void)
+{
+  Ptr<LogDistancePropagationLossModel> logDistance = CreateObject<LogDistancePropagationLossModel> ();
+  Ptr<CachedPropagationLossModel> cached = CreateObject<CachedPropagationLossModel> ();
+  cached->SetAttribute ("InvalidationDistance", DoubleValue (5.0));
+  cached->SetPropagationLossModel (logDistance);
+
+  Ptr<Building> building = CreateObject<Building> ();
+  building->SetBoundaries (Box (0.0, 10.0, 0.0, 10.0, 0.0, 20.0));
+  building->SetNFloors (3);
+
+  Ptr<MobilityModel> enb = CreateObject<ConstantPositionMobilityModel> ();
+  enb->SetPosition (Vector (0.0, 0.0, 30.0));
+  enb->AggregateObject (CreateObject<MobilityBuildingInfo> ());
+  Ptr<MobilityModel> ue = CreateObject<ConstantPositionMobilityModel> ();
+  ue->SetPosition (Vector (100.0, 0.0, 1.5));
+  Ptr<MobilityBuildingInfo> ueInfo = CreateObject<MobilityBuildingInfo> ();
+  ue->AggregateObject (ueInfo);
+
+  double expected = logDistance->CalcRxPower (10.0, enb, ue);
+  NS_TEST_ASSERT_MSG_EQ (cached->CalcRxPower (10.0, enb, ue), expected, "wrong rx power");
+  NS_TEST_ASSERT_MSG_EQ (cached->CalcRxPower (10.0, ue, enb), expected, "the links are reciprocal");
+  NS_TEST_ASSERT_MSG_EQ (cached->GetNCachedPaths (), 1, "one pair expected");
+
+  // a move within the invalidation distance keeps the cached loss
+  ue->SetPosition (Vector (104.0, 0.0, 1.5));
+  NS_TEST_ASSERT_MSG_EQ (cached->CalcRxPower (10.0, enb, ue), expected, "the loss should be cached");
+
+  // a move beyond the invalidation distance updates it
+  ue->SetPosition (Vector (110.0, 0.0, 1.5));
+  expected = logDistance->CalcRxPower (10.0, enb, ue);
+  NS_TEST_ASSERT_MSG_EQ (cached->CalcRxPower (10.0, enb, ue), expected, "the loss should be computed again");
+
+  // entering a building updates it, even without moving
+  logDistance->SetAttribute ("Exponent", DoubleValue (3.5));
+  expected = logDistance->CalcRxPower (10.0, enb, ue);
+  NS_TEST_ASSERT_MSG_NE (cached->CalcRxPower (10.0, enb, ue), expected, "the loss should still be cached");
+  ueInfo->SetIndoor (building, 1, 1, 1);
+  NS_TEST_ASSERT_MSG_EQ (cached->CalcRxPower (10.0, enb, ue), expected, "the building change should invalidate the loss");
+  ueInfo->SetIndoor (building, 2, 1, 1);
+  logDistance->SetAttribute ("Exponent", DoubleValue (3.0));
+  expected = logDistance->CalcRxPower (10.0, enb, ue);
+  NS_TEST_ASSERT_MSG_EQ (cached->CalcRxPower (10.0, enb, ue), expected, "the floor change should invalidate the loss");
+
+  // the range accounts for the moves of both endpoints
+  NS_TEST_ASSERT_MSG_EQ_TOL (cached->GetMaxRange (10.0, -80.0), logDistance->GetMaxRange (10.0, -80.0) + 10.0, 1e-6,
+                             "wrong max range");
+
+  Simulator::Destroy ();
+}
+
+
+class CachedPropagationLossModelTestSuite : public TestSuite
+{
+public:
+  CachedPropagationLossModelTestSuite ();
+};
+
+CachedPropagationLossModelTestSuite::CachedPropagationLossModelTestSuite ()
+  : TestSuite ("cached-propagation-loss-model", UNIT)
+{
+  AddTestCase (new CachedPropagationLossModelTestCase, TestCase::QUICK);
+}
+
+static CachedPropagationLossModelTestSuite cachedPropagationLossModelTestSuite;
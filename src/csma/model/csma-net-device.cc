@@ -29,6 +29,7 @@
 #include "ns3/boolean.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/segmentation-offload.h"
 #include "ns3/trace-source-accessor.h"
 #include "csma-net-device.h"
 #include "csma-channel.h"
@@ -216,6 +217,7 @@ CsmaNetDevice::DoDispose ()
   NS_LOG_FUNCTION_NOARGS ();
   m_channel = 0;
   m_node = 0;
+  m_segments.clear ();
   NetDevice::DoDispose ();
 }
 
@@ -372,7 +374,12 @@ CsmaNetDevice::AddHeader (Ptr<Packet> p,   Mac48Address source,  Mac48Address de
             p->AddAtEnd (padd);
           }
 
-        NS_ASSERT_MSG (p->GetSize () <= GetMtu (),
+        //
+        // A large send is split into frames of the right length before
+        // it is transmitted (see DequeueFrame).
+        //
+        LargeSendTag largeSend;
+        NS_ASSERT_MSG (p->GetSize () <= GetMtu () || p->PeekPacketTag (largeSend),
                        "CsmaNetDevice::AddHeader(): 802.3 Length/Type field with LLC/SNAP: "
                        "length interpretation must not exceed device frame size minus overhead");
       }
@@ -557,14 +564,17 @@ CsmaNetDevice::TransmitAbort (void)
   // get that out.  If the queue is empty we just wait until someone puts one
   // in.
   //
-  if (m_queue->IsEmpty ())
+  if (m_segments.empty () && m_queue->IsEmpty ())
     {
       return;
     }
   else
     {
-      m_currentPkt = m_queue->Dequeue ();
-      NS_ASSERT_MSG (m_currentPkt != 0, "CsmaNetDevice::TransmitAbort(): IsEmpty false but no Packet on queue?");
+      m_currentPkt = DequeueFrame ();
+      if (m_currentPkt == 0)
+        { // A large send which cannot be split, dropped
+          return;
+        }
       m_snifferTrace (m_currentPkt);
       m_promiscSnifferTrace (m_currentPkt);
       TransmitStart ();
@@ -625,20 +635,77 @@ CsmaNetDevice::TransmitReadyEvent (void)
   //
   // Get the next packet from the queue for transmitting
   //
-  if (m_queue->IsEmpty ())
+  if (m_segments.empty () && m_queue->IsEmpty ())
     {
       return;
     }
   else
     {
-      m_currentPkt = m_queue->Dequeue ();
-      NS_ASSERT_MSG (m_currentPkt != 0, "CsmaNetDevice::TransmitReadyEvent(): IsEmpty false but no Packet on queue?");
+      m_currentPkt = DequeueFrame ();
+      if (m_currentPkt == 0)
+        { // A large send which cannot be split, dropped
+          return;
+        }
       m_snifferTrace (m_currentPkt);
       m_promiscSnifferTrace (m_currentPkt);
       TransmitStart ();
     }
 }
 
+Ptr<Packet>
+CsmaNetDevice::DequeueFrame (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  if (!m_segments.empty ())
+    {
+      Ptr<Packet> p = m_segments.front ();
+      m_segments.pop_front ();
+      return p;
+    }
+
+  Ptr<Packet> p;
+  LargeSendTag largeSend;
+  while ((p = m_queue->Dequeue ()) != 0 && p->PeekPacketTag (largeSend))
+    {
+      //
+      // A large send: strip its Ethernet encapsulation, split it into segments
+      // and encapsulate each segment as the large send was.
+      //
+      Ptr<Packet> payload = p->Copy ();
+      EthernetTrailer trailer;
+      payload->RemoveTrailer (trailer);
+      EthernetHeader header (false);
+      payload->RemoveHeader (header);
+      uint16_t protocol = header.GetLengthType ();
+      uint16_t mtu = GetMtu ();
+      if (m_encapMode == LLC)
+        {
+          LlcSnapHeader llc;
+          payload->RemoveHeader (llc);
+          protocol = llc.GetType ();
+          mtu -= llc.GetSerializedSize ();
+        }
+      Ptr<SegmentationOffload> offload = m_node->GetObject<SegmentationOffload> ();
+      if (offload != 0 && offload->Segment (payload, protocol, mtu, m_segments))
+        {
+          for (std::list<Ptr<Packet> >::iterator it = m_segments.begin (); it != m_segments.end (); ++it)
+            {
+              AddHeader (*it, header.GetSource (), header.GetDestination (), protocol);
+            }
+          p = m_segments.front ();
+          m_segments.pop_front ();
+          return p;
+        }
+      //
+      // It would go out above the MTU: drop it, and try the next packet.
+      //
+      NS_LOG_WARN ("Large send which cannot be split into segments, dropped");
+      m_macTxDropTrace (p);
+    }
+  return p;
+}
+
 bool
 CsmaNetDevice::Attach (Ptr<CsmaChannel> ch)
 {
@@ -982,8 +1049,11 @@ CsmaNetDevice::SendFrom (Ptr<Packet> packet, const Address& src, const Address&
     {
       if (m_queue->IsEmpty () == false)
         {
-          m_currentPkt = m_queue->Dequeue ();
-          NS_ASSERT_MSG (m_currentPkt != 0, "CsmaNetDevice::SendFrom(): IsEmpty false but no Packet on queue?");
+          m_currentPkt = DequeueFrame ();
+          if (m_currentPkt == 0)
+            { // A large send which cannot be split, dropped
+              return false;
+            }
           m_promiscSnifferTrace (m_currentPkt);
           m_snifferTrace (m_currentPkt);
           TransmitStart ();
@@ -1043,6 +1113,13 @@ CsmaNetDevice::SupportsSendFrom () const
   return true;
 }
 
+bool
+CsmaNetDevice::SupportsSegmentationOffload (void) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return true;
+}
+
 int64_t
 CsmaNetDevice::AssignStreams (int64_t stream)
 {
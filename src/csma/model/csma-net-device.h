@@ -22,6 +22,7 @@
 #define CSMA_NET_DEVICE_H
 
 #include <cstring>
+#include <list>
 #include "ns3/node.h"
 #include "ns3/backoff.h"
 #include "ns3/address.h"
@@ -321,6 +322,14 @@ public:
   virtual void SetPromiscReceiveCallback (PromiscReceiveCallback cb);
   virtual bool SupportsSendFrom (void) const;
 
+  /**
+   * Is this a net device which splits the large sends itself.
+   *
+   * \returns true, each segment of a large send is transmitted as its own
+   * frame.
+   */
+  virtual bool SupportsSegmentationOffload (void) const;
+
  /**
   * Assign a fixed random variable stream number to the random variables
   * used by this model.  Return the number of streams (possibly zero) that
@@ -426,6 +435,20 @@ private:
    */
   void TransmitReadyEvent (void);
 
+  /**
+   * Get the next frame to transmit.
+   *
+   * The frame is the next segment of the large send being transmitted if
+   * any, else the packet at the head of the queue.  A large send taken
+   * from the queue is split into segments by the SegmentationOffload of
+   * the node, each of which gets its own Ethernet header and trailer and
+   * goes through the channel access on its own. A large send which
+   * cannot be split is dropped, with the MacTxDrop trace.
+   *
+   * \returns the frame, or 0 if the queue is empty
+   */
+  Ptr<Packet> DequeueFrame (void);
+
   /**
    * Aborts the transmission of the current packet
    *
@@ -509,6 +532,12 @@ private:
    */
   Ptr<Packet> m_currentPkt;
 
+  /**
+   * Segments of the large send being transmitted, which are transmitted
+   * before the next packet of the queue.
+   */
+  std::list<Ptr<Packet> > m_segments;
+
   /**
    * The CsmaChannel to which this CsmaNetDevice has been
    * attached.
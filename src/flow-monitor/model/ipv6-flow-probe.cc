@@ -363,6 +363,10 @@ Ipv6FlowProbe::DropLogger (const Ipv6Header &ipHeader, Ptr<const Packet> ipPaylo
           myReason = DROP_FRAGMENT_TIMEOUT;
           NS_LOG_DEBUG ("DROP_FRAGMENT_TIMEOUT");
           break;
+        case Ipv6L3Protocol::DROP_FRAGMENT_MEMORY:
+          myReason = DROP_FRAGMENT_MEMORY;
+          NS_LOG_DEBUG ("DROP_FRAGMENT_MEMORY");
+          break;
         default:
           myReason = DROP_INVALID_REASON;
           NS_FATAL_ERROR ("Unexpected drop reason code " << reason);
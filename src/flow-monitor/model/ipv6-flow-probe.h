@@ -75,6 +75,7 @@ public:
     DROP_MALFORMED_HEADER, /**< Malformed header */
 
     DROP_FRAGMENT_TIMEOUT, /**< Fragment timeout exceeded */
+    DROP_FRAGMENT_MEMORY, /**< Fragment reassembly memory exhausted */
 
     DROP_INVALID_REASON, /**< Fallback reason (no known reason) */
   };
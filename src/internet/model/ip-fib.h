@@ -0,0 +1,387 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IP_FIB_H
+#define IP_FIB_H
+
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv6-address.h"
+#include "ns3/sgi-hashmap.h"
+
+namespace ns3 {
+
+class Ipv4RoutingTableEntry;
+class Ipv6RoutingTableEntry;
+
+/**
+ * \ingroup internet
+ *
+ * \brief Forwarding information base shared by the unicast routing
+ * protocols, which indexes their routes by destination prefix.
+ *
+ * The routes are hashed by masked destination, in one hash table per
+ * network mask, and the tables are sorted by decreasing prefix length.
+ * A lookup thus costs one hash probe per distinct mask of the table,
+ * whatever its number of routes, and the longest prefix match stops at
+ * the first length which has a match.
+ *
+ * The table only stores pointers to the routing table entries, which
+ * remain owned by the routing protocol, along with the output interface
+ * and the metric of each route. Several routes may have the same
+ * destination; the table keeps track of the order in which they were
+ * added, since the routing protocols use it to break ties.
+ *
+ * The masks do not have to be contiguous: two masks with the same prefix
+ * length (as returned by GetPrefixLength) are different tables, but are
+ * considered as long as each other.
+ *
+ * \tparam Address the address type (Ipv4Address or Ipv6Address)
+ * \tparam Mask the mask type (Ipv4Mask or Ipv6Prefix)
+ * \tparam Hash the hash function of Address
+ * \tparam Entry the routing table entry type
+ */
+template <typename Address, typename Mask, typename Hash, typename Entry>
+class IpFib
+{
+public:
+  /// wildcard interface of the lookups
+  static const uint32_t ANY_INTERFACE = 0xffffffff;
+
+  IpFib ();
+  ~IpFib ();
+
+  /**
+   * \brief Add a route.
+   * \param network the destination network
+   * \param mask the destination network mask
+   * \param interface the output interface of the route
+   * \param metric the metric of the route
+   * \param entry the routing table entry, which must outlive the route
+   */
+  void Add (Address network, Mask mask, uint32_t interface, uint32_t metric, Entry *entry);
+
+  /**
+   * \brief Remove a route.
+   * \param network the destination network the route was added with
+   * \param mask the destination network mask the route was added with
+   * \param entry the routing table entry of the route
+   * \return true if the route was found and removed
+   */
+  bool Remove (Address network, Mask mask, Entry *entry);
+
+  /**
+   * \brief Remove all the routes.
+   */
+  void Clear (void);
+
+  /**
+   * \return the number of routes
+   */
+  uint32_t GetNRoutes (void) const;
+
+  /**
+   * \brief Longest prefix match.
+   *
+   * Among the routes on the given interface whose destination matches
+   * dest, select the ones with the longest prefix, then the ones with
+   * the lowest metric, then the one added last.
+   *
+   * \param dest the destination address
+   * \param interface the output interface, or ANY_INTERFACE
+   * \return the selected entry, or 0 if no route matches
+   */
+  Entry *LookupLongest (Address dest, uint32_t interface = ANY_INTERFACE) const;
+
+  /**
+   * \brief Find all the matching routes, whatever their prefix length.
+   * \param dest the destination address
+   * \param interface the output interface, or ANY_INTERFACE
+   * \param entries the entries of the routes on the given interface
+   * whose destination matches dest, in the order they were added, are
+   * appended to this vector
+   */
+  void LookupAll (Address dest, uint32_t interface, std::vector<Entry *> &entries) const;
+
+private:
+  /// a route of the table
+  struct Route
+  {
+    Entry *entry;       //!< the routing table entry
+    uint32_t interface; //!< the output interface
+    uint32_t metric;    //!< the metric
+    uint64_t order;     //!< the rank of the route in the order of insertion
+  };
+
+  /// the routes to a destination, in the order they were added
+  typedef std::vector<Route> Routes;
+  /// the routes of a mask, by masked destination
+  typedef sgi::hash_map<Address, Routes, Hash> Prefixes;
+
+  /// the routes which have the same mask
+  struct Table
+  {
+    Mask mask;          //!< the mask
+    uint32_t length;    //!< the prefix length of the mask
+    Prefixes prefixes;  //!< the routes, by masked destination
+  };
+
+  /// copying a table would copy its pointers to the routing table entries
+  IpFib (const IpFib &);
+  /// copying a table would copy its pointers to the routing table entries
+  IpFib &operator= (const IpFib &);
+
+  /**
+   * \param route a route
+   * \param other another route
+   * \return true if route was added before other
+   */
+  static bool IsAddedBefore (const Route &route, const Route &other);
+
+  /**
+   * \param address an IPv4 address
+   * \param mask an IPv4 mask
+   * \return the masked address
+   */
+  static Ipv4Address Combine (Ipv4Address address, Ipv4Mask mask);
+  /**
+   * \param address an IPv6 address
+   * \param mask an IPv6 prefix
+   * \return the masked address
+   */
+  static Ipv6Address Combine (Ipv6Address address, Ipv6Prefix mask);
+
+  std::vector<Table *> m_tables; //!< the tables, by decreasing prefix length
+  uint32_t m_nRoutes;            //!< the number of routes
+  uint64_t m_nextOrder;          //!< the rank of the next route added
+};
+
+/// The forwarding information base of the IPv4 routing protocols
+typedef IpFib<Ipv4Address, Ipv4Mask, Ipv4AddressHash, Ipv4RoutingTableEntry> Ipv4Fib;
+/// The forwarding information base of the IPv6 routing protocols
+typedef IpFib<Ipv6Address, Ipv6Prefix, Ipv6AddressHash, Ipv6RoutingTableEntry> Ipv6Fib;
+
+} // namespace ns3
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename Address, typename Mask, typename Hash, typename Entry>
+const uint32_t IpFib<Address, Mask, Hash, Entry>::ANY_INTERFACE;
+
+template <typename Address, typename Mask, typename Hash, typename Entry>
+IpFib<Address, Mask, Hash, Entry>::IpFib ()
+  : m_nRoutes (0),
+    m_nextOrder (0)
+{
+}
+
+template <typename Address, typename Mask, typename Hash, typename Entry>
+IpFib<Address, Mask, Hash, Entry>::~IpFib ()
+{
+  Clear ();
+}
+
+template <typename Address, typename Mask, typename Hash, typename Entry>
+void
+IpFib<Address, Mask, Hash, Entry>::Add (Address network, Mask mask, uint32_t interface, uint32_t metric, Entry *entry)
+{
+  typename std::vector<Table *>::iterator it = m_tables.begin ();
+  while (it != m_tables.end () && !((*it)->mask == mask))
+    {
+      it++;
+    }
+  if (it == m_tables.end ())
+    {
+      Table *table = new Table ();
+      table->mask = mask;
+      table->length = mask.GetPrefixLength ();
+      // after the tables of the same length, so that the lookups do not
+      // depend on the order of the masks
+      it = m_tables.begin ();
+      while (it != m_tables.end () && (*it)->length >= table->length)
+        {
+          it++;
+        }
+      it = m_tables.insert (it, table);
+    }
+  Route route;
+  route.entry = entry;
+  route.interface = interface;
+  route.metric = metric;
+  route.order = m_nextOrder++;
+  (*it)->prefixes[Combine (network, mask)].push_back (route);
+  m_nRoutes++;
+}
+
+template <typename Address, typename Mask, typename Hash, typename Entry>
+bool
+IpFib<Address, Mask, Hash, Entry>::Remove (Address network, Mask mask, Entry *entry)
+{
+  for (typename std::vector<Table *>::iterator it = m_tables.begin (); it != m_tables.end (); it++)
+    {
+      Table *table = *it;
+      if (!(table->mask == mask))
+        {
+          continue;
+        }
+      typename Prefixes::iterator prefix = table->prefixes.find (Combine (network, mask));
+      if (prefix == table->prefixes.end ())
+        {
+          return false;
+        }
+      Routes &routes = prefix->second;
+      for (typename Routes::iterator route = routes.begin (); route != routes.end (); route++)
+        {
+          if (route->entry == entry)
+            {
+              routes.erase (route);
+              m_nRoutes--;
+              if (routes.empty ())
+                {
+                  table->prefixes.erase (prefix);
+                  if (table->prefixes.empty ())
+                    {
+                      delete table;
+                      m_tables.erase (it);
+                    }
+                }
+              return true;
+            }
+        }
+      return false;
+    }
+  return false;
+}
+
+template <typename Address, typename Mask, typename Hash, typename Entry>
+void
+IpFib<Address, Mask, Hash, Entry>::Clear (void)
+{
+  for (typename std::vector<Table *>::iterator it = m_tables.begin (); it != m_tables.end (); it++)
+    {
+      delete *it;
+    }
+  m_tables.clear ();
+  m_nRoutes = 0;
+}
+
+template <typename Address, typename Mask, typename Hash, typename Entry>
+uint32_t
+IpFib<Address, Mask, Hash, Entry>::GetNRoutes (void) const
+{
+  return m_nRoutes;
+}
+
+template <typename Address, typename Mask, typename Hash, typename Entry>
+Entry *
+IpFib<Address, Mask, Hash, Entry>::LookupLongest (Address dest, uint32_t interface) const
+{
+  const Route *best = 0;
+  uint32_t bestLength = 0;
+  for (typename std::vector<Table *>::const_iterator it = m_tables.begin (); it != m_tables.end (); it++)
+    {
+      const Table *table = *it;
+      if (best != 0 && table->length < bestLength)
+        {
+          // a longer prefix matched
+          break;
+        }
+      typename Prefixes::const_iterator prefix = table->prefixes.find (Combine (dest, table->mask));
+      if (prefix == table->prefixes.end ())
+        {
+          continue;
+        }
+      const Routes &routes = prefix->second;
+      for (typename Routes::const_iterator route = routes.begin (); route != routes.end (); route++)
+        {
+          if (interface != ANY_INTERFACE && route->interface != interface)
+            {
+              continue;
+            }
+          if (best == 0 || route->metric < best->metric
+              || (route->metric == best->metric && route->order > best->order))
+            {
+              best = &(*route);
+              bestLength = table->length;
+            }
+        }
+    }
+  return (best != 0) ? best->entry : 0;
+}
+
+template <typename Address, typename Mask, typename Hash, typename Entry>
+void
+IpFib<Address, Mask, Hash, Entry>::LookupAll (Address dest, uint32_t interface, std::vector<Entry *> &entries) const
+{
+  std::vector<Route> matches;
+  for (typename std::vector<Table *>::const_iterator it = m_tables.begin (); it != m_tables.end (); it++)
+    {
+      const Table *table = *it;
+      typename Prefixes::const_iterator prefix = table->prefixes.find (Combine (dest, table->mask));
+      if (prefix == table->prefixes.end ())
+        {
+          continue;
+        }
+      const Routes &routes = prefix->second;
+      for (typename Routes::const_iterator route = routes.begin (); route != routes.end (); route++)
+        {
+          if (interface == ANY_INTERFACE || route->interface == interface)
+            {
+              matches.push_back (*route);
+            }
+        }
+    }
+  if (matches.size () > 1)
+    {
+      std::sort (matches.begin (), matches.end (), &IsAddedBefore);
+    }
+  for (typename std::vector<Route>::const_iterator route = matches.begin (); route != matches.end (); route++)
+    {
+      entries.push_back (route->entry);
+    }
+}
+
+template <typename Address, typename Mask, typename Hash, typename Entry>
+bool
+IpFib<Address, Mask, Hash, Entry>::IsAddedBefore (const Route &route, const Route &other)
+{
+  return route.order < other.order;
+}
+
+template <typename Address, typename Mask, typename Hash, typename Entry>
+Ipv4Address
+IpFib<Address, Mask, Hash, Entry>::Combine (Ipv4Address address, Ipv4Mask mask)
+{
+  return address.CombineMask (mask);
+}
+
+template <typename Address, typename Mask, typename Hash, typename Entry>
+Ipv6Address
+IpFib<Address, Mask, Hash, Entry>::Combine (Ipv6Address address, Ipv6Prefix mask)
+{
+  return address.CombinePrefix (mask);
+}
+
+} // namespace ns3
+
+#endif /* IP_FIB_H */
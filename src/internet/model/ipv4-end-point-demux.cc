@@ -27,7 +27,7 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Ipv4EndPointDemux");
 
 Ipv4EndPointDemux::Ipv4EndPointDemux ()
-  : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152)
+  : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152), m_nextOrder (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -38,33 +38,33 @@ Ipv4EndPointDemux::~Ipv4EndPointDemux ()
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
     {
       Ipv4EndPoint *endPoint = *i;
+      endPoint->m_demux = 0;
       delete endPoint;
     }
   m_endPoints.clear ();
+  m_ports.clear ();
+  m_keys.clear ();
 }
 
 bool
 Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
 {
   NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
-    {
-      if ((*i)->GetLocalPort  () == port) 
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_ports.find (port) != m_ports.end ();
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal (Ipv4Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  EndPointsByPort::iterator it = m_ports.find (port);
+  if (it == m_ports.end ())
+    {
+      return false;
+    }
+  for (EndPointsI i = it->second.begin (); i != it->second.end (); i++) 
     {
-      if ((*i)->GetLocalPort () == port &&
-          (*i)->GetLocalAddress () == addr) 
+      if ((*i)->GetLocalAddress () == addr) 
         {
           return true;
         }
@@ -83,7 +83,7 @@ Ipv4EndPointDemux::Allocate (void)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (Ipv4Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -99,7 +99,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -122,7 +122,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address, uint16_t port)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -132,21 +132,15 @@ Ipv4EndPointDemux::Allocate (Ipv4Address localAddress, uint16_t localPort,
                              Ipv4Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  if (m_keys.find (MakeKey (localAddress, localPort, peerAddress, peerPort)) != m_keys.end ())
     {
-      if ((*i)->GetLocalPort () == localPort &&
-          (*i)->GetLocalAddress () == localAddress &&
-          (*i)->GetPeerPort () == peerPort &&
-          (*i)->GetPeerAddress () == peerAddress) 
-        {
-          NS_LOG_WARN ("No way we can allocate this end-point.");
-          /* no way we can allocate this end-point. */
-          return 0;
-        }
+      NS_LOG_WARN ("No way we can allocate this end-point.");
+      /* no way we can allocate this end-point. */
+      return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
 
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
 
@@ -157,15 +151,20 @@ void
 Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this << endPoint);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  if (endPoint->m_demux != this)
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      return;
     }
+  Unhash (endPoint);
+  EndPointsByPort::iterator port = m_ports.find (endPoint->GetLocalPort ());
+  port->second.erase (endPoint->m_demuxPort);
+  if (port->second.empty ())
+    {
+      m_ports.erase (port);
+    }
+  m_endPoints.erase (endPoint->m_demuxAll);
+  endPoint->m_demux = 0;
+  delete endPoint;
 }
 
 /*
@@ -204,21 +203,60 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
   EndPoints retval4; // Exact match on all 4
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  EndPointsByPort::iterator port = m_ports.find (dport);
+  if (port == m_ports.end ())
+    {
+      NS_LOG_LOGIC ("No endpoint has the packet dport " << dport);
+      return retval1;
+    }
+
+  bool subnetDirected = false;
+  Ipv4Address incomingInterfaceAddr = daddr;  // may be a broadcast
+  for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
+    {
+      Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
+      if (addr.GetLocal ().CombineMask (addr.GetMask ()) == daddr.CombineMask (addr.GetMask ()) &&
+          daddr.IsSubnetDirectedBroadcast (addr.GetMask ()))
+        {
+          subnetDirected = true;
+          incomingInterfaceAddr = addr.GetLocal ();
+        }
+    }
+  bool isBroadcast = (daddr.IsBroadcast () || subnetDirected == true);
+  NS_LOG_DEBUG ("dest addr " << daddr << " broadcast? " << isBroadcast);
+
+  if (!isBroadcast)
+    {
+      // Each return list holds the end points of a single four-tuple
+      if (SelectBound (MakeKey (daddr, dport, saddr, sport),
+                       incomingInterface, retval4))
+        {
+          return retval4;
+        }
+      if (SelectBound (MakeKey (Ipv4Address::GetAny (), dport, saddr, sport),
+                       incomingInterface, retval3))
+        {
+          return retval3;
+        }
+      if (SelectBound (MakeKey (daddr, dport, Ipv4Address::GetAny (), 0),
+                       incomingInterface, retval2))
+        {
+          return retval2;
+        }
+      SelectBound (MakeKey (Ipv4Address::GetAny (), dport, Ipv4Address::GetAny (), 0),
+                   incomingInterface, retval1);
+      return retval1;  // might be empty if no matches
+    }
+
+  // A broadcast matches the end points bound to the address of the
+  // incoming interface as well, so look at all the end points of the port
+  for (EndPointsI i = port->second.begin (); i != port->second.end (); i++) 
     {
       Ipv4EndPoint* endP = *i;
       NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
                                                  << " daddr=" << endP->GetLocalAddress ()
                                                  << " sport=" << endP->GetPeerPort ()
                                                  << " saddr=" << endP->GetPeerAddress ());
-      if (endP->GetLocalPort () != dport) 
-        {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                             << " because endpoint dport "
-                                             << endP->GetLocalPort ()
-                                             << " does not match packet dport " << dport);
-          continue;
-        }
       if (endP->GetBoundNetDevice ())
         {
           if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
@@ -230,30 +268,12 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
               continue;
             }
         }
-      bool subnetDirected = false;
-      Ipv4Address incomingInterfaceAddr = daddr;  // may be a broadcast
-      for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
-        {
-          Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
-          if (addr.GetLocal ().CombineMask (addr.GetMask ()) == daddr.CombineMask (addr.GetMask ()) &&
-              daddr.IsSubnetDirectedBroadcast (addr.GetMask ()))
-            {
-              subnetDirected = true;
-              incomingInterfaceAddr = addr.GetLocal ();
-            }
-        }
-      bool isBroadcast = (daddr.IsBroadcast () || subnetDirected == true);
-      NS_LOG_DEBUG ("dest addr " << daddr << " broadcast? " << isBroadcast);
       bool localAddressMatchesWildCard = 
         endP->GetLocalAddress () == Ipv4Address::GetAny ();
       bool localAddressMatchesExact = endP->GetLocalAddress () == daddr;
 
-      if (isBroadcast)
-        {
-          NS_LOG_DEBUG ("Found bcast, localaddr " << endP->GetLocalAddress ());
-        }
-
-      if (isBroadcast && (endP->GetLocalAddress () != Ipv4Address::GetAny ()))
+      NS_LOG_DEBUG ("Found bcast, localaddr " << endP->GetLocalAddress ());
+      if (endP->GetLocalAddress () != Ipv4Address::GetAny ())
         {
           localAddressMatchesExact = (endP->GetLocalAddress () ==
                                       incomingInterfaceAddr);
@@ -280,7 +300,7 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
         { // Only local port matches exactly
           retval1.push_back (endP);
         }
-      if ((localAddressMatchesExact || (isBroadcast && localAddressMatchesWildCard))&&
+      if ((localAddressMatchesExact || localAddressMatchesWildCard) &&
           remotePeerMatchesWildCard &&
           remoteAddressMatchesWildCard)
         { // Only local port and local address matches exactly
@@ -315,23 +335,24 @@ Ipv4EndPointDemux::SimpleLookup (Ipv4Address daddr,
 {
   NS_LOG_FUNCTION (this << daddr << dport << saddr << sport);
 
+  EndPointsByKey::iterator exact = m_keys.find (MakeKey (daddr, dport, saddr, sport));
+  if (exact != m_keys.end ())
+    {
+      /* this is an exact match. */
+      return exact->second.front ();
+    }
+  EndPointsByPort::iterator port = m_ports.find (dport);
+  if (port == m_ports.end ())
+    {
+      return 0;
+    }
+
   // this code is a copy/paste version of an old BSD ip stack lookup
   // function.
   uint32_t genericity = 3;
   Ipv4EndPoint *generic = 0;
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  for (EndPointsI i = port->second.begin (); i != port->second.end (); i++) 
     {
-      if ((*i)->GetLocalPort () != dport) 
-        {
-          continue;
-        }
-      if ((*i)->GetLocalAddress () == daddr &&
-          (*i)->GetPeerPort () == sport &&
-          (*i)->GetPeerAddress () == saddr) 
-        {
-          /* this is an exact match. */
-          return *i;
-        }
       uint32_t tmp = 0;
       if ((*i)->GetLocalAddress () == Ipv4Address::GetAny ()) 
         {
@@ -372,5 +393,104 @@ Ipv4EndPointDemux::AllocateEphemeralPort (void)
   return port;
 }
 
-} // namespace ns3
+bool
+Ipv4EndPointDemux::EndPointKey::operator== (const EndPointKey &other) const
+{
+  return localPort == other.localPort && peerPort == other.peerPort
+         && localAddress == other.localAddress && peerAddress == other.peerAddress;
+}
+
+size_t
+Ipv4EndPointDemux::EndPointKeyHash::operator() (const EndPointKey &key) const
+{
+  Ipv4AddressHash hash;
+  return hash (key.localAddress) ^ (hash (key.peerAddress) * 31)
+         ^ (static_cast<size_t> (key.localPort) << 16) ^ key.peerPort;
+}
+
+Ipv4EndPointDemux::EndPointKey
+Ipv4EndPointDemux::MakeKey (Ipv4Address localAddress, uint16_t localPort,
+                            Ipv4Address peerAddress, uint16_t peerPort)
+{
+  EndPointKey key;
+  key.localAddress = localAddress;
+  key.localPort = localPort;
+  key.peerAddress = peerAddress;
+  key.peerPort = peerPort;
+  return key;
+}
 
+void
+Ipv4EndPointDemux::Insert (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  endPoint->m_demux = this;
+  endPoint->m_demuxOrder = m_nextOrder++;
+  endPoint->m_demuxAll = m_endPoints.insert (m_endPoints.end (), endPoint);
+  EndPoints &port = m_ports[endPoint->GetLocalPort ()];
+  endPoint->m_demuxPort = port.insert (port.end (), endPoint);
+  Hash (endPoint);
+}
+
+void
+Ipv4EndPointDemux::Hash (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  EndPoints &endPoints = m_keys[MakeKey (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                                         endPoint->GetPeerAddress (), endPoint->GetPeerPort ())];
+  // the end point is most often the last one allocated
+  EndPointsI i = endPoints.end ();
+  while (i != endPoints.begin ())
+    {
+      EndPointsI previous = i;
+      previous--;
+      if ((*previous)->m_demuxOrder < endPoint->m_demuxOrder)
+        {
+          break;
+        }
+      i = previous;
+    }
+  endPoint->m_demuxKey = endPoints.insert (i, endPoint);
+}
+
+void
+Ipv4EndPointDemux::Unhash (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  EndPointsByKey::iterator it = m_keys.find (MakeKey (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                                                      endPoint->GetPeerAddress (), endPoint->GetPeerPort ()));
+  NS_ASSERT (it != m_keys.end ());
+  it->second.erase (endPoint->m_demuxKey);
+  if (it->second.empty ())
+    {
+      m_keys.erase (it);
+    }
+}
+
+bool
+Ipv4EndPointDemux::SelectBound (const EndPointKey &key, Ptr<Ipv4Interface> incomingInterface,
+                                EndPoints &selected) const
+{
+  EndPointsByKey::const_iterator it = m_keys.find (key);
+  if (it == m_keys.end ())
+    {
+      return false;
+    }
+  for (EndPoints::const_iterator i = it->second.begin (); i != it->second.end (); i++)
+    {
+      Ipv4EndPoint *endP = *i;
+      if (endP->GetBoundNetDevice ()
+          && endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
+        {
+          NS_LOG_LOGIC ("Skipping endpoint " << endP
+                                             << " because endpoint is bound to specific device and"
+                                             << endP->GetBoundNetDevice ()
+                                             << " does not match packet device " << incomingInterface->GetDevice ());
+          continue;
+        }
+      selected.push_back (endP);
+    }
+  return !selected.empty ();
+}
+
+} // namespace ns3
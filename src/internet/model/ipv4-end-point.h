@@ -22,6 +22,7 @@
 #define IPV4_END_POINT_H
 
 #include <stdint.h>
+#include <list>
 #include "ns3/ipv4-address.h"
 #include "ns3/callback.h"
 #include "ns3/net-device.h"
@@ -32,6 +33,7 @@ namespace ns3 {
 
 class Header;
 class Packet;
+class Ipv4EndPointDemux;
 
 /**
  * \brief A representation of an internet endpoint/connection
@@ -229,6 +231,36 @@ private:
    * \brief The destroy callback.
    */
   Callback<void> m_destroyCallback;
+
+  friend class Ipv4EndPointDemux;
+
+  /**
+   * \brief The demux which indexes the end point, if any.
+   *
+   * The demux hashes the end point by its four-tuple, so it is told
+   * whenever the local address or the peer change.
+   */
+  Ipv4EndPointDemux *m_demux;
+
+  /**
+   * \brief The rank of the end point in the allocation order of the demux.
+   */
+  uint64_t m_demuxOrder;
+
+  /**
+   * \brief The position of the end point in the list of all the end points of the demux.
+   */
+  std::list<Ipv4EndPoint *>::iterator m_demuxAll;
+
+  /**
+   * \brief The position of the end point in the list of the end points of its local port.
+   */
+  std::list<Ipv4EndPoint *>::iterator m_demuxPort;
+
+  /**
+   * \brief The position of the end point in the list of the end points of its four-tuple.
+   */
+  std::list<Ipv4EndPoint *>::iterator m_demuxKey;
 };
 
 } // namespace ns3
@@ -28,6 +28,7 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/ip-fib.h"
 
 namespace ns3 {
 
@@ -264,6 +265,10 @@ private:
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+  Ipv4Fib m_hostFib;                   //!< Routes to hosts, indexed by destination
+  Ipv4Fib m_networkFib;                //!< Routes to networks, indexed by destination
+  Ipv4Fib m_externalFib;               //!< External routes, indexed by destination
+
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
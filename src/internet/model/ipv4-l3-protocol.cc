@@ -24,6 +24,7 @@
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-route.h"
 #include "ns3/node.h"
+#include "ns3/segmentation-offload.h"
 #include "ns3/socket.h"
 #include "ns3/net-device.h"
 #include "ns3/uinteger.h"
@@ -863,12 +864,49 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
   Ptr<Ipv4Interface> outInterface = GetInterface (interface);
   NS_LOG_LOGIC ("Send via NetDevice ifIndex " << outDev->GetIfIndex () << " ipv4InterfaceIndex " << interface);
 
+  // A large send is not fragmented: the device splits it into segments
+  // if it supports it, else it is split here
+  LargeSendTag largeSend;
+  bool isLargeSend = packet->PeekPacketTag (largeSend);
+  std::list<Ptr<Packet> > listSegments;
+  if (isLargeSend)
+    {
+      Ptr<SegmentationOffload> offload = m_node->GetObject<SegmentationOffload> ();
+      NS_ASSERT_MSG (offload != 0, "Large send without a SegmentationOffload on the node");
+      uint32_t nSegments = offload->GetSegmentCount (packet, PROT_NUMBER, outDev->GetMtu ());
+      if (nSegments == 0)
+        { // Sent as a single datagram, fragmented below if too large
+          NS_LOG_WARN ("Large send which cannot be split into segments");
+          packet->RemovePacketTag (largeSend);
+          isLargeSend = false;
+        }
+      else
+        {
+          // The segments take the identifications following the one of
+          // the large send
+          uint64_t srcDst = ipHeader.GetDestination ().Get () | (static_cast<uint64_t> (ipHeader.GetSource ().Get ()) << 32);
+          m_identification[std::make_pair (srcDst, ipHeader.GetProtocol ())] += nSegments - 1;
+          if (!outDev->SupportsSegmentationOffload ())
+            {
+              offload->Segment (packet, PROT_NUMBER, outDev->GetMtu (), listSegments);
+            }
+        }
+    }
+
   if (!route->GetGateway ().IsEqual (Ipv4Address ("0.0.0.0")))
     {
       if (outInterface->IsUp ())
         {
           NS_LOG_LOGIC ("Send to gateway " << route->GetGateway ());
-          if ( packet->GetSize () > outInterface->GetDevice ()->GetMtu () )
+          if (!listSegments.empty ())
+            {
+              for (std::list<Ptr<Packet> >::iterator it = listSegments.begin (); it != listSegments.end (); it++)
+                {
+                  m_txTrace (*it, m_node->GetObject<Ipv4> (), interface);
+                  outInterface->Send (*it, route->GetGateway ());
+                }
+            }
+          else if (!isLargeSend && packet->GetSize () > outInterface->GetDevice ()->GetMtu ())
             {
               std::list<Ptr<Packet> > listFragments;
               DoFragmentation (packet, outInterface->GetDevice ()->GetMtu (), listFragments);
@@ -897,7 +935,15 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
       if (outInterface->IsUp ())
         {
           NS_LOG_LOGIC ("Send to destination " << ipHeader.GetDestination ());
-          if ( packet->GetSize () > outInterface->GetDevice ()->GetMtu () )
+          if (!listSegments.empty ())
+            {
+              for (std::list<Ptr<Packet> >::iterator it = listSegments.begin (); it != listSegments.end (); it++)
+                {
+                  m_txTrace (*it, m_node->GetObject<Ipv4> (), interface);
+                  outInterface->Send (*it, ipHeader.GetDestination ());
+                }
+            }
+          else if (!isLargeSend && packet->GetSize () > outInterface->GetDevice ()->GetMtu ())
             {
               std::list<Ptr<Packet> > listFragments;
               DoFragmentation (packet, outInterface->GetDevice ()->GetMtu (), listFragments);
@@ -31,6 +31,7 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ip-fib.h"
 
 namespace ns3 {
 
@@ -430,6 +431,11 @@ private:
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief the network routes, indexed by destination for the lookups.
+   */
+  Ipv4Fib m_fib;
+
   /**
    * \brief the forwarding table for multicast.
    */
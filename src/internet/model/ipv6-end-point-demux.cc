@@ -29,7 +29,8 @@ NS_LOG_COMPONENT_DEFINE ("Ipv6EndPointDemux");
 Ipv6EndPointDemux::Ipv6EndPointDemux ()
   : m_ephemeral (49152),
     m_portFirst (49152),
-    m_portLast (65535)
+    m_portLast (65535),
+    m_nextOrder (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -40,31 +41,31 @@ Ipv6EndPointDemux::~Ipv6EndPointDemux ()
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
     {
       Ipv6EndPoint *endPoint = *i;
+      endPoint->m_demux = 0;
       delete endPoint;
     }
   m_endPoints.clear ();
+  m_ports.clear ();
+  m_keys.clear ();
 }
 
 bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
 {
   NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
-    {
-      if ((*i)->GetLocalPort  () == port)
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_ports.find (port) != m_ports.end ();
 }
 
 bool Ipv6EndPointDemux::LookupLocal (Ipv6Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  EndPointsByPort::iterator it = m_ports.find (port);
+  if (it == m_ports.end ())
     {
-      if ((*i)->GetLocalPort () == port
-          && (*i)->GetLocalAddress () == addr)
+      return false;
+    }
+  for (EndPointsI i = it->second.begin (); i != it->second.end (); i++)
+    {
+      if ((*i)->GetLocalAddress () == addr)
         {
           return true;
         }
@@ -82,7 +83,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (Ipv6Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -97,7 +98,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -118,7 +119,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address, uint16_t port)
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -127,21 +128,15 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address localAddress, uint16_t lo
                                            Ipv6Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  if (m_keys.find (MakeKey (localAddress, localPort, peerAddress, peerPort)) != m_keys.end ())
     {
-      if ((*i)->GetLocalPort () == localPort
-          && (*i)->GetLocalAddress () == localAddress
-          && (*i)->GetPeerPort () == peerPort
-          && (*i)->GetPeerAddress () == peerAddress)
-        {
-          NS_LOG_WARN ("No way we can allocate this end-point.");
-          /* no way we can allocate this end-point. */
-          return 0;
-        }
+      NS_LOG_WARN ("No way we can allocate this end-point.");
+      /* no way we can allocate this end-point. */
+      return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
 
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
 
@@ -151,15 +146,20 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address localAddress, uint16_t lo
 void Ipv6EndPointDemux::DeAllocate (Ipv6EndPoint *endPoint)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  if (endPoint->m_demux != this)
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      return;
     }
+  Unhash (endPoint);
+  EndPointsByPort::iterator port = m_ports.find (endPoint->GetLocalPort ());
+  port->second.erase (endPoint->m_demuxPort);
+  if (port->second.empty ())
+    {
+      m_ports.erase (port);
+    }
+  m_endPoints.erase (endPoint->m_demuxAll);
+  endPoint->m_demux = 0;
+  delete endPoint;
 }
 
 /*
@@ -179,130 +179,47 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
   EndPoints retval4; /* Exact match on all 4 */
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
-    {
-      Ipv6EndPoint* endP = *i;
-      NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
-                                                 << " daddr=" << endP->GetLocalAddress ()
-                                                 << " sport=" << endP->GetPeerPort ()
-                                                 << " saddr=" << endP->GetPeerAddress ());
-      if (endP->GetLocalPort () != dport)
-        {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                             << " because endpoint dport "
-                                             << endP->GetLocalPort ()
-                                             << " does not match packet dport " << dport);
-          continue;
-        }
-
-      if (endP->GetBoundNetDevice ())
-        {
-          if (!incomingInterface)
-            {
-              continue;
-            }
-          if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
-            {
-              NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                                 << " because endpoint is bound to specific device and"
-                                                 << endP->GetBoundNetDevice ()
-                                                 << " does not match packet device " << incomingInterface->GetDevice ());
-              continue;
-            }
-        }
-
-      /*    Ipv6Address incomingInterfaceAddr = incomingInterface->GetAddress (); */
-      NS_LOG_DEBUG ("dest addr " << daddr);
 
-      bool localAddressMatchesWildCard = endP->GetLocalAddress () == Ipv6Address::GetAny ();
-      bool localAddressMatchesExact = endP->GetLocalAddress () == daddr;
-      bool localAddressMatchesAllRouters = endP->GetLocalAddress () == Ipv6Address::GetAllRoutersMulticast ();
-
-      /* if no match here, keep looking */
-      if (!(localAddressMatchesExact || localAddressMatchesWildCard))
-        {
-          continue;
-        }
-      bool remotePeerMatchesExact = endP->GetPeerPort () == sport;
-      bool remotePeerMatchesWildCard = endP->GetPeerPort () == 0;
-      bool remoteAddressMatchesExact = endP->GetPeerAddress () == saddr;
-      bool remoteAddressMatchesWildCard = endP->GetPeerAddress () == Ipv6Address::GetAny ();
-
-      /* If remote does not match either with exact or wildcard,i
-         skip this one */
-      if (!(remotePeerMatchesExact || remotePeerMatchesWildCard))
-        {
-          continue;
-        }
-      if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
-        {
-          continue;
-        }
-
-      /* Now figure out which return list to add this one to */
-      if (localAddressMatchesWildCard
-          && remotePeerMatchesWildCard
-          && remoteAddressMatchesWildCard)
-        { /* Only local port matches exactly */
-          retval1.push_back (endP);
-        }
-      if ((localAddressMatchesExact || (localAddressMatchesAllRouters))
-          && remotePeerMatchesWildCard
-          && remoteAddressMatchesWildCard)
-        { /* Only local port and local address matches exactly */
-          retval2.push_back (endP);
-        }
-      if (localAddressMatchesWildCard
-          && remotePeerMatchesExact
-          && remoteAddressMatchesExact)
-        { /* All but local address */
-          retval3.push_back (endP);
-        }
-      if (localAddressMatchesExact
-          && remotePeerMatchesExact
-          && remoteAddressMatchesExact)
-        { /* All 4 match */
-          retval4.push_back (endP);
-        }
-    }
-
-  /* Here we find the most exact match */
-  if (!retval4.empty ())
+  /* Each return list holds the end points of a single four-tuple. An end
+     point bound to the all-routers address only matches when it is the
+     destination, so it is found with the exact local address. */
+  if (SelectBound (MakeKey (daddr, dport, saddr, sport), incomingInterface, retval4))
     {
       return retval4;
     }
-  if (!retval3.empty ())
+  if (SelectBound (MakeKey (Ipv6Address::GetAny (), dport, saddr, sport), incomingInterface, retval3))
     {
       return retval3;
     }
-  if (!retval2.empty ())
+  if (SelectBound (MakeKey (daddr, dport, Ipv6Address::GetAny (), 0), incomingInterface, retval2))
     {
       return retval2;
     }
+  SelectBound (MakeKey (Ipv6Address::GetAny (), dport, Ipv6Address::GetAny (), 0), incomingInterface, retval1);
   return retval1;  /* might be empty if no matches */
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::SimpleLookup (Ipv6Address dst, uint16_t dport, Ipv6Address src, uint16_t sport)
 {
+  EndPointsByKey::iterator exact = m_keys.find (MakeKey (dst, dport, src, sport));
+  if (exact != m_keys.end ())
+    {
+      /* this is an exact match. */
+      return exact->second.front ();
+    }
+  EndPointsByPort::iterator port = m_ports.find (dport);
+  if (port == m_ports.end ())
+    {
+      return 0;
+    }
+
   uint32_t genericity = 3;
   Ipv6EndPoint *generic = 0;
 
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  for (EndPointsI i = port->second.begin (); i != port->second.end (); i++)
     {
       uint32_t tmp = 0;
 
-      if ((*i)->GetLocalPort () != dport)
-        {
-          continue;
-        }
-
-      if ((*i)->GetLocalAddress () == dst && (*i)->GetPeerPort () == sport
-          && (*i)->GetPeerAddress () == src)
-        {
-          /* this is an exact match. */
-          return *i;
-        }
-
       if ((*i)->GetLocalAddress () == Ipv6Address::GetAny ())
         {
           tmp++;
@@ -349,5 +266,103 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::GetEndPoints () const
   return m_endPoints;
 }
 
-} /* namespace ns3 */
+bool Ipv6EndPointDemux::EndPointKey::operator== (const EndPointKey &other) const
+{
+  return localPort == other.localPort && peerPort == other.peerPort
+         && localAddress == other.localAddress && peerAddress == other.peerAddress;
+}
 
+size_t Ipv6EndPointDemux::EndPointKeyHash::operator() (const EndPointKey &key) const
+{
+  Ipv6AddressHash hash;
+  return hash (key.localAddress) ^ (hash (key.peerAddress) * 31)
+         ^ (static_cast<size_t> (key.localPort) << 16) ^ key.peerPort;
+}
+
+Ipv6EndPointDemux::EndPointKey Ipv6EndPointDemux::MakeKey (Ipv6Address localAddress, uint16_t localPort,
+                                                           Ipv6Address peerAddress, uint16_t peerPort)
+{
+  EndPointKey key;
+  key.localAddress = localAddress;
+  key.localPort = localPort;
+  key.peerAddress = peerAddress;
+  key.peerPort = peerPort;
+  return key;
+}
+
+void Ipv6EndPointDemux::Insert (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  endPoint->m_demux = this;
+  endPoint->m_demuxOrder = m_nextOrder++;
+  endPoint->m_demuxAll = m_endPoints.insert (m_endPoints.end (), endPoint);
+  EndPoints &port = m_ports[endPoint->GetLocalPort ()];
+  endPoint->m_demuxPort = port.insert (port.end (), endPoint);
+  Hash (endPoint);
+}
+
+void Ipv6EndPointDemux::Hash (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  EndPoints &endPoints = m_keys[MakeKey (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                                         endPoint->GetPeerAddress (), endPoint->GetPeerPort ())];
+  /* the end point is most often the last one allocated */
+  EndPointsI i = endPoints.end ();
+  while (i != endPoints.begin ())
+    {
+      EndPointsI previous = i;
+      previous--;
+      if ((*previous)->m_demuxOrder < endPoint->m_demuxOrder)
+        {
+          break;
+        }
+      i = previous;
+    }
+  endPoint->m_demuxKey = endPoints.insert (i, endPoint);
+}
+
+void Ipv6EndPointDemux::Unhash (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  EndPointsByKey::iterator it = m_keys.find (MakeKey (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                                                      endPoint->GetPeerAddress (), endPoint->GetPeerPort ()));
+  NS_ASSERT (it != m_keys.end ());
+  it->second.erase (endPoint->m_demuxKey);
+  if (it->second.empty ())
+    {
+      m_keys.erase (it);
+    }
+}
+
+bool Ipv6EndPointDemux::SelectBound (const EndPointKey &key, Ptr<Ipv6Interface> incomingInterface,
+                                     EndPoints &selected) const
+{
+  EndPointsByKey::const_iterator it = m_keys.find (key);
+  if (it == m_keys.end ())
+    {
+      return false;
+    }
+  for (EndPoints::const_iterator i = it->second.begin (); i != it->second.end (); i++)
+    {
+      Ipv6EndPoint *endP = *i;
+      if (endP->GetBoundNetDevice ())
+        {
+          if (!incomingInterface)
+            {
+              continue;
+            }
+          if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
+            {
+              NS_LOG_LOGIC ("Skipping endpoint " << endP
+                                                 << " because endpoint is bound to specific device and"
+                                                 << endP->GetBoundNetDevice ()
+                                                 << " does not match packet device " << incomingInterface->GetDevice ());
+              continue;
+            }
+        }
+      selected.push_back (endP);
+    }
+  return !selected.empty ();
+}
+
+} /* namespace ns3 */
@@ -24,6 +24,7 @@
 #include <stdint.h>
 #include <list>
 #include "ns3/ipv6-address.h"
+#include "ns3/sgi-hashmap.h"
 #include "ipv6-interface.h"
 
 namespace ns3 {
@@ -33,6 +34,10 @@ class Ipv6EndPoint;
 /**
  * \class Ipv6EndPointDemux
  * \brief Demultiplexor for end points.
+ *
+ * The end points are indexed by local port and hashed by their
+ * four-tuple, wildcards included, so that a lookup only costs a few hash
+ * probes, whatever the number of sockets of the node.
  */
 class Ipv6EndPointDemux
 {
@@ -137,6 +142,91 @@ public:
   EndPoints GetEndPoints () const;
 
 private:
+  friend class Ipv6EndPoint;
+
+  /**
+   * \brief The four-tuple of an end point, wildcards included.
+   */
+  struct EndPointKey
+  {
+    Ipv6Address localAddress; //!< the local address
+    uint16_t localPort;       //!< the local port
+    Ipv6Address peerAddress;  //!< the peer address
+    uint16_t peerPort;        //!< the peer port
+
+    /**
+     * \param other another four-tuple
+     * \return true if the two four-tuples are equal
+     */
+    bool operator== (const EndPointKey &other) const;
+  };
+
+  /**
+   * \brief Hash function of the four-tuples.
+   */
+  struct EndPointKeyHash
+  {
+    /**
+     * \param key a four-tuple
+     * \return the hash of the four-tuple
+     */
+    size_t operator() (const EndPointKey &key) const;
+  };
+
+  /**
+   * \brief The end points, by four-tuple.
+   */
+  typedef sgi::hash_map<EndPointKey, EndPoints, EndPointKeyHash> EndPointsByKey;
+
+  /**
+   * \brief The end points, by local port.
+   */
+  typedef sgi::hash_map<uint16_t, EndPoints> EndPointsByPort;
+
+  /**
+   * \brief Make a four-tuple.
+   * \param localAddress local address
+   * \param localPort local port
+   * \param peerAddress peer address
+   * \param peerPort peer port
+   * \return the four-tuple
+   */
+  static EndPointKey MakeKey (Ipv6Address localAddress, uint16_t localPort,
+                              Ipv6Address peerAddress, uint16_t peerPort);
+
+  /**
+   * \brief Add a new end point to the list and the indexes.
+   * \param endPoint the end point
+   */
+  void Insert (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Hash an end point by its current four-tuple.
+   *
+   * The end points of a four-tuple are kept in allocation order.
+   *
+   * \param endPoint the end point
+   */
+  void Hash (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Remove an end point from the hash of its current four-tuple.
+   * \param endPoint the end point
+   */
+  void Unhash (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Select the end points of a four-tuple which may receive from an
+   * interface.
+   * \param key the four-tuple
+   * \param incomingInterface the incoming interface
+   * \param selected the end points of the four-tuple which are not bound
+   * to another device, in allocation order
+   * \return true if any end point was selected
+   */
+  bool SelectBound (const EndPointKey &key, Ptr<Ipv6Interface> incomingInterface,
+                    EndPoints &selected) const;
+
   /**
    * \brief Allocate a ephemeral port.
    * \return a port
@@ -162,6 +252,21 @@ private:
    * \brief A list of IPv6 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief The end points of m_endPoints, by local port.
+   */
+  EndPointsByPort m_ports;
+
+  /**
+   * \brief The end points of m_endPoints, by four-tuple.
+   */
+  EndPointsByKey m_keys;
+
+  /**
+   * \brief The rank of the next end point allocated.
+   */
+  uint64_t m_nextOrder;
 };
 
 } /* namespace ns3 */
@@ -19,6 +19,7 @@
  */
 
 #include <list>
+#include <vector>
 #include <ctime>
 
 #include "ns3/log.h"
@@ -311,11 +312,19 @@ TypeId Ipv6ExtensionFragment::GetTypeId ()
   static TypeId tid = TypeId ("ns3::Ipv6ExtensionFragment")
     .SetParent<Ipv6Extension> ()
     .AddConstructor<Ipv6ExtensionFragment> ()
+    .AddAttribute ("MaxReassemblySize",
+                   "The maximum number of bytes held by the fragments of the packets being reassembled: "
+                   "the oldest packets are dropped to make room for new fragments.",
+                   UintegerValue (4194304),
+                   MakeUintegerAccessor (&Ipv6ExtensionFragment::m_maxFragmentsSize),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
 
 Ipv6ExtensionFragment::Ipv6ExtensionFragment ()
+  : m_fragmentsSize (0),
+    m_maxFragmentsSize (4194304)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -331,10 +340,13 @@ void Ipv6ExtensionFragment::DoDispose ()
 
   for (MapFragments_t::iterator it = m_fragments.begin (); it != m_fragments.end (); it++)
     {
+      it->second->CancelTimeout ();
       it->second = 0;
     }
 
   m_fragments.clear ();
+  m_fragmentsOrder.clear ();
+  m_fragmentsSize = 0;
   Ipv6Extension::DoDispose ();
 }
 
@@ -372,17 +384,21 @@ uint8_t Ipv6ExtensionFragment::Process (Ptr<Packet>& packet,
   uint32_t identification = fragmentHeader.GetIdentification ();
   Ipv6Address src = ipv6Header.GetSourceAddress ();
 
-  std::pair<Ipv6Address, uint32_t> fragmentsId = std::pair<Ipv6Address, uint32_t> (src, identification);
+  FragmentsKey_t fragmentsId = FragmentsKey_t (src, identification);
   Ptr<Fragments> fragments;
 
   Ipv6Header ipHeader = ipv6Header;
   ipHeader.SetNextHeader (fragmentHeader.GetNextHeader ());
 
+  EvictFragments (p->GetSize ());
+
   MapFragments_t::iterator it = m_fragments.find (fragmentsId);
   if (it == m_fragments.end ())
     {
       fragments = Create<Fragments> ();
-      m_fragments.insert (std::make_pair (fragmentsId, fragments));
+      fragments->SetIpHeader (ipHeader);
+      fragments->SetOrder (m_fragmentsOrder.insert (m_fragmentsOrder.end (), fragmentsId));
+      it = m_fragments.insert (std::make_pair (fragmentsId, fragments)).first;
       EventId timeout = Simulator::Schedule (Seconds (60),
                                              &Ipv6ExtensionFragment::HandleFragmentsTimeout, this,
                                              fragmentsId, ipHeader);
@@ -393,20 +409,29 @@ uint8_t Ipv6ExtensionFragment::Process (Ptr<Packet>& packet,
       fragments = it->second;
     }
 
+  uint32_t size = fragments->GetSize ();
+  if (!fragments->AddFragment (p, fragmentOffset, moreFragment))
+    {
+      NS_LOG_LOGIC ("Overlapping fragment, dropping the fragments of " << src << " " << identification);
+      RemoveFragments (it);
+      stopProcessing = true;
+      isDropped = true;
+      dropReason = Ipv6L3Protocol::DROP_MALFORMED_HEADER;
+      return 0;
+    }
+
   if (fragmentOffset == 0)
     {
       Ptr<Packet> unfragmentablePart = packet->Copy ();
       unfragmentablePart->RemoveAtEnd (packet->GetSize () - offset);
       fragments->SetUnfragmentablePart (unfragmentablePart);
     }
-
-  fragments->AddFragment (p, fragmentOffset, moreFragment);
+  m_fragmentsSize += fragments->GetSize () - size;
 
   if (fragments->IsEntire ())
     {
       packet = fragments->GetPacket ();
-      fragments->CancelTimeout ();
-      m_fragments.erase (fragmentsId);
+      RemoveFragments (it);
       stopProcessing = false;
     }
   else
@@ -577,8 +602,6 @@ void Ipv6ExtensionFragment::GetFragments (Ptr<Packet> packet, uint32_t maxFragme
       ipv6Header.SetPayloadLength (fragment->GetSize ());
       fragment->AddHeader (ipv6Header);
 
-      std::ostringstream oss;
-      fragment->Print (oss);
       listFragments.push_back (fragment);
     }
   while (moreFragment);
@@ -616,11 +639,78 @@ void Ipv6ExtensionFragment::HandleFragmentsTimeout (std::pair<Ipv6Address, uint3
   ipL3->ReportDrop (ipHeader, packet, Ipv6L3Protocol::DROP_FRAGMENT_TIMEOUT);
 
   // clear the buffers
-  m_fragments.erase (fragmentsId);
+  RemoveFragments (it);
+}
+
+void Ipv6ExtensionFragment::EvictFragments (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+
+  Ptr<Ipv6L3Protocol> ipL3;
+  while (m_fragmentsSize + size > m_maxFragmentsSize && !m_fragmentsOrder.empty ())
+    {
+      MapFragments_t::iterator it = m_fragments.find (m_fragmentsOrder.front ());
+      NS_ASSERT (it != m_fragments.end ());
+      NS_LOG_LOGIC ("Reassembly memory exhausted, dropping the fragments of " << it->first.first << " " << it->first.second);
+      if (ipL3 == 0)
+        {
+          ipL3 = GetNode ()->GetObject<Ipv6L3Protocol> ();
+        }
+      ipL3->ReportDrop (it->second->GetIpHeader (), it->second->GetPartialPacket (), Ipv6L3Protocol::DROP_FRAGMENT_MEMORY);
+      RemoveFragments (it);
+    }
+}
+
+void Ipv6ExtensionFragment::RemoveFragments (MapFragments_t::iterator it)
+{
+  Ptr<Fragments> fragments = it->second;
+  m_fragmentsSize -= fragments->GetSize ();
+  fragments->CancelTimeout ();
+  m_fragmentsOrder.erase (fragments->GetOrder ());
+  m_fragments.erase (it);
+}
+
+size_t Ipv6ExtensionFragment::FragmentsKeyHash::operator() (const FragmentsKey_t &key) const
+{
+  return Ipv6AddressHash () (key.first) ^ (key.second * 2654435761U);
+}
+
+/**
+ * \brief Concatenate packets.
+ *
+ * Appending a packet to another one copies both, so the packets are
+ * concatenated in pairs, then the pairs in pairs and so on: each byte
+ * is copied as many times as there are rounds, rather than once for
+ * each packet appended after it.
+ *
+ * \param packets the packets, in order
+ * \return the concatenation of the packets
+ */
+static Ptr<Packet>
+ConcatenatePackets (std::vector<Ptr<Packet> > &packets)
+{
+  NS_ASSERT (!packets.empty ());
+  std::size_t n = packets.size ();
+  while (n > 1)
+    {
+      std::size_t j = 0;
+      for (std::size_t i = 0; i < n; i += 2, j++)
+        {
+          packets[j] = packets[i];
+          if (i + 1 < n)
+            {
+              packets[j]->AddAtEnd (packets[i + 1]);
+            }
+        }
+      n = j;
+    }
+  return packets[0];
 }
 
 Ipv6ExtensionFragment::Fragments::Fragments ()
-  : m_moreFragment (0)
+  : m_lastFragment (false),
+    m_end (0),
+    m_size (0)
 {
 }
 
@@ -628,24 +718,52 @@ Ipv6ExtensionFragment::Fragments::~Fragments ()
 {
 }
 
-void Ipv6ExtensionFragment::Fragments::AddFragment (Ptr<Packet> fragment, uint16_t fragmentOffset, bool moreFragment)
+bool Ipv6ExtensionFragment::Fragments::AddFragment (Ptr<Packet> fragment, uint16_t fragmentOffset, bool moreFragment)
 {
-  std::list<std::pair<Ptr<Packet>, uint16_t> >::iterator it;
+  uint32_t end = fragmentOffset + fragment->GetSize ();
 
-  for (it = m_packetFragments.begin (); it != m_packetFragments.end (); it++)
+  FragmentsByOffset_t::iterator next = m_packetFragments.upper_bound (fragmentOffset);
+  if (next != m_packetFragments.begin ())
     {
-      if (it->second > fragmentOffset)
+      FragmentsByOffset_t::iterator previous = next;
+      previous--;
+      uint32_t previousEnd = previous->first + previous->second->GetSize ();
+      if (previous->first == fragmentOffset && previousEnd == end)
         {
-          break;
+          // a duplicate is ignored, unless it disagrees on being the last fragment
+          bool last = m_lastFragment && m_end == end;
+          return moreFragment ? !last : last;
+        }
+      if (previousEnd > fragmentOffset)
+        {
+          return false;
         }
     }
+  if (next != m_packetFragments.end () && next->first < end)
+    {
+      return false;
+    }
 
-  if (it == m_packetFragments.end ())
+  if (moreFragment)
     {
-      m_moreFragment = moreFragment;
+      if (m_lastFragment && end > m_end)
+        {
+          return false;
+        }
+    }
+  else
+    {
+      if (m_lastFragment || next != m_packetFragments.end ())
+        {
+          return false;
+        }
+      m_lastFragment = true;
+      m_end = end;
     }
 
-  m_packetFragments.insert (it, std::pair<Ptr<Packet>, uint16_t> (fragment, fragmentOffset));
+  m_packetFragments.insert (next, std::make_pair (fragmentOffset, fragment));
+  m_size += fragment->GetSize ();
+  return true;
 }
 
 void Ipv6ExtensionFragment::Fragments::SetUnfragmentablePart (Ptr<Packet> unfragmentablePart)
@@ -655,65 +773,49 @@ void Ipv6ExtensionFragment::Fragments::SetUnfragmentablePart (Ptr<Packet> unfrag
 
 bool Ipv6ExtensionFragment::Fragments::IsEntire () const
 {
-  bool ret = !m_moreFragment && m_packetFragments.size () > 0;
-
-  if (ret)
-    {
-      uint16_t lastEndOffset = 0;
-
-      for (std::list<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_packetFragments.begin (); it != m_packetFragments.end (); it++)
-        {
-          if (lastEndOffset != it->second)
-            {
-              ret = false;
-              break;
-            }
-
-          lastEndOffset += it->first->GetSize ();
-        }
-    }
-
-  return ret;
+  // the fragments do not overlap: they cover the packet once they add up to its end
+  return m_lastFragment && m_size == m_end && m_unfragmentable;
 }
 
 Ptr<Packet> Ipv6ExtensionFragment::Fragments::GetPacket () const
 {
-  Ptr<Packet> p =  m_unfragmentable->Copy ();
-
-  for (std::list<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_packetFragments.begin (); it != m_packetFragments.end (); it++)
+  std::vector<Ptr<Packet> > packets;
+  packets.reserve (m_packetFragments.size () + 1);
+  packets.push_back (m_unfragmentable->Copy ());
+  for (FragmentsByOffset_t::const_iterator it = m_packetFragments.begin (); it != m_packetFragments.end (); it++)
     {
-      p->AddAtEnd (it->first);
+      packets.push_back (it->second->Copy ());
     }
 
-  return p;
+  return ConcatenatePackets (packets);
 }
 
 Ptr<Packet> Ipv6ExtensionFragment::Fragments::GetPartialPacket () const
 {
-  Ptr<Packet> p;
-
-  if ( m_unfragmentable )
+  if (!m_unfragmentable)
     {
-      p = m_unfragmentable->Copy ();
-    }
-  else
-    {
-      return p;
+      return Create<Packet> ();
     }
 
-  uint16_t lastEndOffset = 0;
-
-  for (std::list<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_packetFragments.begin (); it != m_packetFragments.end (); it++)
+  std::vector<Ptr<Packet> > packets;
+  packets.push_back (m_unfragmentable->Copy ());
+  uint32_t lastEndOffset = 0;
+  for (FragmentsByOffset_t::const_iterator it = m_packetFragments.begin (); it != m_packetFragments.end (); it++)
     {
-      if (lastEndOffset != it->second)
+      if (lastEndOffset != it->first)
         {
           break;
         }
-      p->AddAtEnd (it->first);
-      lastEndOffset += it->first->GetSize ();
+      packets.push_back (it->second->Copy ());
+      lastEndOffset += it->second->GetSize ();
     }
 
-  return p;
+  return ConcatenatePackets (packets);
+}
+
+uint32_t Ipv6ExtensionFragment::Fragments::GetSize () const
+{
+  return m_size + (m_unfragmentable ? m_unfragmentable->GetSize () : 0);
 }
 
 void Ipv6ExtensionFragment::Fragments::SetTimeoutEventId (EventId event)
@@ -728,6 +830,26 @@ void Ipv6ExtensionFragment::Fragments::CancelTimeout ()
   return;
 }
 
+void Ipv6ExtensionFragment::Fragments::SetIpHeader (const Ipv6Header &ipHeader)
+{
+  m_ipHeader = ipHeader;
+}
+
+Ipv6Header Ipv6ExtensionFragment::Fragments::GetIpHeader () const
+{
+  return m_ipHeader;
+}
+
+void Ipv6ExtensionFragment::Fragments::SetOrder (FragmentsOrder_t::iterator order)
+{
+  m_order = order;
+}
+
+Ipv6ExtensionFragment::FragmentsOrder_t::iterator Ipv6ExtensionFragment::Fragments::GetOrder () const
+{
+  return m_order;
+}
+
 
 NS_OBJECT_ENSURE_REGISTERED (Ipv6ExtensionRouting);
 
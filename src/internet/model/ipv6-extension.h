@@ -35,6 +35,7 @@
 #include "ns3/ipv6-address.h"
 #include "ns3/ipv6-l3-protocol.h"
 #include "ns3/traced-callback.h"
+#include "ns3/sgi-hashmap.h"
 
 
 namespace ns3 {
@@ -300,9 +301,35 @@ protected:
   virtual void DoDispose ();
 
 private:
+  /**
+   * \brief The key of the packet fragments: source address and identification.
+   */
+  typedef std::pair<Ipv6Address, uint32_t> FragmentsKey_t;
+
+  /**
+   * \brief Hash of the key of the packet fragments.
+   */
+  struct FragmentsKeyHash
+  {
+    /**
+     * \param key the key of the packet fragments
+     * \return the hash of the key
+     */
+    size_t operator() (const FragmentsKey_t &key) const;
+  };
+
+  /**
+   * \brief Container of the keys of the packet fragments, oldest first.
+   */
+  typedef std::list<FragmentsKey_t> FragmentsOrder_t;
+
   /**
    * \class Fragments
    * \brief A Set of Fragment
+   *
+   * The fragments are kept sorted by offset, without overlap: the
+   * packet is entire once the last fragment has been received and the
+   * fragments add up to its end.
    */
   class Fragments : public SimpleRefCount<Fragments>
   {
@@ -319,11 +346,17 @@ public:
 
     /**
      * \brief Add a fragment.
+     *
+     * A duplicate of a fragment already added is ignored. A fragment
+     * overlapping another one, or ending past the end of the packet,
+     * is rejected (RFC 5722): the whole packet must then be dropped.
+     *
      * \param fragment the fragment
      * \param fragmentOffset the offset of the fragment
      * \param moreFragment the bit "More Fragment"
+     * \return false if the fragment is rejected
      */
-    void AddFragment (Ptr<Packet> fragment, uint16_t fragmentOffset, bool moreFragment);
+    bool AddFragment (Ptr<Packet> fragment, uint16_t fragmentOffset, bool moreFragment);
 
     /**
      * \brief Set the unfragmentable part of the packet.
@@ -345,10 +378,16 @@ public:
 
     /**
      * \brief Get the packet parts so far received.
-     * \return the partial packet
+     * \return the partial packet, empty if the first fragment has not been received
      */
     Ptr<Packet> GetPartialPacket () const;
 
+    /**
+     * \brief Get the bytes held by the fragments.
+     * \return the size of the fragments and of the unfragmentable part
+     */
+    uint32_t GetSize () const;
+
     /**
      * \brief Set the Timeout EventId.
      */
@@ -359,16 +398,55 @@ public:
      */
     void CancelTimeout ();
 
+    /**
+     * \brief Set the IP header of the original packet.
+     * \param ipHeader the IP header
+     */
+    void SetIpHeader (const Ipv6Header &ipHeader);
+
+    /**
+     * \brief Get the IP header of the original packet.
+     * \return the IP header
+     */
+    Ipv6Header GetIpHeader () const;
+
+    /**
+     * \brief Set the position of the fragments in the arrival order.
+     * \param order the position
+     */
+    void SetOrder (FragmentsOrder_t::iterator order);
+
+    /**
+     * \brief Get the position of the fragments in the arrival order.
+     * \return the position
+     */
+    FragmentsOrder_t::iterator GetOrder () const;
+
 private:
     /**
-     * \brief If other fragments will be sent.
+     * \brief Container of the fragments, by offset.
+     */
+    typedef std::map<uint16_t, Ptr<Packet> > FragmentsByOffset_t;
+
+    /**
+     * \brief If the last fragment has been received.
+     */
+    bool m_lastFragment;
+
+    /**
+     * \brief The end of the fragmentable part, known once the last fragment has been received.
      */
-    bool m_moreFragment;
+    uint32_t m_end;
+
+    /**
+     * \brief The bytes of the fragmentable part received.
+     */
+    uint32_t m_size;
 
     /**
      * \brief The current fragments.
      */
-    std::list<std::pair<Ptr<Packet>, uint16_t> > m_packetFragments;
+    FragmentsByOffset_t m_packetFragments;
 
     /**
      * \brief The unfragmentable part.
@@ -379,8 +457,23 @@ private:
      * \brief Timeout handler event
      */
     EventId m_timeoutEventId;
+
+    /**
+     * \brief The IP header of the original packet.
+     */
+    Ipv6Header m_ipHeader;
+
+    /**
+     * \brief The position of the fragments in the arrival order.
+     */
+    FragmentsOrder_t::iterator m_order;
   };
 
+  /**
+   * \brief Container for the packet fragments.
+   */
+  typedef sgi::hash_map<FragmentsKey_t, Ptr<Fragments>, FragmentsKeyHash> MapFragments_t;
+
   /**
    * \brief Process the timeout for packet fragments
    * \param key representing the packet fragments
@@ -389,30 +482,37 @@ private:
   void HandleFragmentsTimeout (std::pair<Ipv6Address, uint32_t> key, Ipv6Header ipHeader);
 
   /**
-   * \brief Get the packet parts so far received.
-   * \return the partial packet
+   * \brief Drop the oldest packet fragments until the fragments of a
+   * new fragment fit in the reassembly memory.
+   * \param size the size of the new fragment
+   */
+  void EvictFragments (uint32_t size);
+
+  /**
+   * \brief Forget packet fragments.
+   * \param it the packet fragments
    */
-  Ptr<Packet> GetPartialPacket () const;
+  void RemoveFragments (MapFragments_t::iterator it);
 
   /**
-   * \brief Set the Timeout EventId.
+   * \brief The hash of fragmented packets.
    */
-  void SetTimeoutEventId (EventId event);
+  MapFragments_t m_fragments;
 
   /**
-   * \brief Cancel the timeout event
+   * \brief The keys of the fragmented packets, in arrival order.
    */
-  void CancelTimeout ();
+  FragmentsOrder_t m_fragmentsOrder;
 
   /**
-   * \brief Container for the packet fragments.
+   * \brief The bytes held by the fragmented packets.
    */
-  typedef std::map<std::pair<Ipv6Address, uint32_t>, Ptr<Fragments> > MapFragments_t;
+  uint32_t m_fragmentsSize;
 
   /**
-   * \brief The hash of fragmented packets.
+   * \brief The maximum number of bytes held by the fragmented packets.
    */
-  MapFragments_t m_fragments;
+  uint32_t m_maxFragmentsSize;
 };
 
 /**
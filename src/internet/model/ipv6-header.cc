@@ -22,7 +22,6 @@
 #include "ns3/log.h"
 #include "ns3/header.h"
 
-#include "ns3/address-utils.h"
 #include "ipv6-header.h"
 
 namespace ns3 {
@@ -39,8 +38,7 @@ Ipv6Header::Ipv6Header ()
     m_nextHeader (0),
     m_hopLimit (0)
 {
-  SetSourceAddress (Ipv6Address ("::"));
-  SetDestinationAddress (Ipv6Address ("::"));
+  // the addresses are "::" by default: no need to parse it
 }
 
 void Ipv6Header::SetTrafficClass (uint8_t traffic)
@@ -147,38 +145,46 @@ uint32_t Ipv6Header::GetSerializedSize () const
 
 void Ipv6Header::Serialize (Buffer::Iterator start) const
 {
-  Buffer::Iterator i = start;
+  // the header is encoded in place, then written at once
+  uint8_t buf[40];
   uint32_t vTcFl = 0; /* version, Traffic Class and Flow Label fields */
 
   vTcFl= (6 << 28) | (m_trafficClass << 20) | (m_flowLabel);
 
-  i.WriteHtonU32 (vTcFl);
-  i.WriteHtonU16 (m_payloadLength);
-  i.WriteU8 (m_nextHeader);
-  i.WriteU8 (m_hopLimit);
+  buf[0] = vTcFl >> 24;
+  buf[1] = vTcFl >> 16;
+  buf[2] = vTcFl >> 8;
+  buf[3] = vTcFl;
+  buf[4] = m_payloadLength >> 8;
+  buf[5] = m_payloadLength;
+  buf[6] = m_nextHeader;
+  buf[7] = m_hopLimit;
 
-  WriteTo (i, m_sourceAddress);
-  WriteTo (i, m_destinationAddress);
+  m_sourceAddress.Serialize (buf + 8);
+  m_destinationAddress.Serialize (buf + 24);
+  start.Write (buf, sizeof (buf));
 }
 
 uint32_t Ipv6Header::Deserialize (Buffer::Iterator start)
 {
-  Buffer::Iterator i = start;
+  // the header is read at once, then decoded in place
+  uint8_t buf[40];
+  start.Read (buf, sizeof (buf));
   uint32_t vTcFl = 0;
 
-  vTcFl = i.ReadNtohU32 ();
+  vTcFl = (buf[0] << 24) | (buf[1] << 16) | (buf[2] << 8) | buf[3];
   m_version = vTcFl >> 28;
 
   NS_ASSERT ((m_version) == 6);
 
   m_trafficClass = (uint8_t)((vTcFl >> 20) & 0x000000ff);
   m_flowLabel = vTcFl & 0xfff00000;
-  m_payloadLength = i.ReadNtohU16 ();
-  m_nextHeader = i.ReadU8 ();
-  m_hopLimit = i.ReadU8 ();
+  m_payloadLength = (buf[4] << 8) | buf[5];
+  m_nextHeader = buf[6];
+  m_hopLimit = buf[7];
 
-  ReadFrom (i, m_sourceAddress);
-  ReadFrom (i, m_destinationAddress);
+  m_sourceAddress.Set (buf + 8);
+  m_destinationAddress.Set (buf + 24);
 
   return GetSerializedSize ();
 }
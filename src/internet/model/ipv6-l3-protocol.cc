@@ -20,6 +20,7 @@
 
 #include "ns3/log.h"
 #include "ns3/node.h"
+#include "ns3/segmentation-offload.h"
 #include "ns3/uinteger.h"
 #include "ns3/vector.h"
 #include "ns3/boolean.h"
@@ -92,6 +93,18 @@ TypeId Ipv6L3Protocol::GetTypeId ()
                    MakeBooleanAccessor (&Ipv6L3Protocol::SetSendIcmpv6Redirect,
                                         &Ipv6L3Protocol::GetSendIcmpv6Redirect),
                    MakeBooleanChecker ())
+    .AddAttribute ("RouteCache",
+                   "Cache the routes of the forwarded packets, by source, destination "
+                   "and input interface, as long as the routing protocol allows it "
+                   "and its routes do not change.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&Ipv6L3Protocol::m_routeCacheEnabled),
+                   MakeBooleanChecker ())
+    .AddAttribute ("RouteCacheSize",
+                   "The maximum number of cached routes, beyond which the cache is flushed.",
+                   UintegerValue (65536),
+                   MakeUintegerAccessor (&Ipv6L3Protocol::m_routeCacheSize),
+                   MakeUintegerChecker<uint32_t> (1))
     .AddTraceSource ("Tx",
                      "Send IPv6 packet to outgoing interface.",
                      MakeTraceSourceAccessor (&Ipv6L3Protocol::m_txTrace),
@@ -120,12 +133,19 @@ TypeId Ipv6L3Protocol::GetTypeId ()
                      "and it is being forward up the stack",
                      MakeTraceSourceAccessor (&Ipv6L3Protocol::m_localDeliverTrace),
                      "ns3::Ipv6L3Protocol::SentTracedCallback")
+    .AddTraceSource ("RouteCache",
+                     "A received unicast IPv6 packet was looked up "
+                     "in the route cache",
+                     MakeTraceSourceAccessor (&Ipv6L3Protocol::m_routeCacheTrace),
+                     "ns3::Ipv6L3Protocol::RouteCacheTracedCallback")
   ;
   return tid;
 }
 
 Ipv6L3Protocol::Ipv6L3Protocol ()
   : m_nInterfaces (0)
+  , m_routeCacheGeneration (0)
+  , m_routeCacheMiss (false)
   , m_ipv4Prefix6Rd (0)
   , m_bRAddress6Rd (0)
 {
@@ -175,6 +195,7 @@ void Ipv6L3Protocol::DoDispose ()
   m_node = 0;
   m_routingProtocol = 0;
   m_pmtuCache = 0;
+  FlushRouteCache ();
   Object::DoDispose ();
 }
 
@@ -183,6 +204,7 @@ void Ipv6L3Protocol::SetRoutingProtocol (Ptr<Ipv6RoutingProtocol> routingProtoco
   NS_LOG_FUNCTION (this << routingProtocol);
   m_routingProtocol = routingProtocol;
   m_routingProtocol->SetIpv6 (this);
+  FlushRouteCache ();
 }
 
 Ptr<Ipv6RoutingProtocol> Ipv6L3Protocol::GetRoutingProtocol () const
@@ -424,6 +446,7 @@ void Ipv6L3Protocol::RemoveAutoconfiguredAddress (uint32_t interface, Ipv6Addres
   NS_LOG_FUNCTION (this << i << address);
   Ptr<Ipv6Interface> interface = GetInterface (i);
   bool ret = interface->AddAddress (address);
+  FlushRouteCache ();
 
   if (m_routingProtocol != 0)
     {
@@ -454,6 +477,7 @@ bool Ipv6L3Protocol::RemoveAddress (uint32_t i, uint32_t addressIndex)
 
   if (address != Ipv6InterfaceAddress ())
     {
+      FlushRouteCache ();
       if (m_routingProtocol != 0)
         {
           m_routingProtocol->NotifyRemoveAddress (i, address);
@@ -477,6 +501,7 @@ Ipv6L3Protocol::RemoveAddress (uint32_t i, Ipv6Address address)
   Ipv6InterfaceAddress ifAddr = interface->RemoveAddress (address);
   if (ifAddr != Ipv6InterfaceAddress ())
   {
+    FlushRouteCache ();
     if (m_routingProtocol != 0)
     {
       m_routingProtocol->NotifyRemoveAddress (i, ifAddr);
@@ -541,6 +566,7 @@ void Ipv6L3Protocol::SetUp (uint32_t i)
   if (interface->GetDevice ()->GetMtu () >= 1280)
     {
       interface->SetUp ();
+      FlushRouteCache ();
 
       if (m_routingProtocol != 0)
         {
@@ -559,6 +585,7 @@ void Ipv6L3Protocol::SetDown (uint32_t i)
   Ptr<Ipv6Interface> interface = GetInterface (i);
 
   interface->SetDown ();
+  FlushRouteCache ();
 
   if (m_routingProtocol != 0)
     {
@@ -617,6 +644,7 @@ void Ipv6L3Protocol::SetForwarding (uint32_t i, bool val)
   NS_LOG_FUNCTION (this << i << val);
   Ptr<Ipv6Interface> interface = GetInterface (i);
   interface->SetForwarding (val);
+  FlushRouteCache ();
 }
 
   bool
@@ -687,6 +715,7 @@ void Ipv6L3Protocol::SetIpForward (bool forward)
     {
       (*it)->SetForwarding (forward);
     }
+  FlushRouteCache ();
 }
 
 bool Ipv6L3Protocol::GetIpForward () const
@@ -1001,11 +1030,33 @@ void Ipv6L3Protocol::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16
         }
     }
 
-  if (!m_routingProtocol->RouteInput (packet, hdr, device,
-                                      MakeCallback (&Ipv6L3Protocol::IpForward, this),
-                                      MakeCallback (&Ipv6L3Protocol::IpMulticastForward, this),
-                                      MakeCallback (&Ipv6L3Protocol::LocalDeliver, this),
-                                      MakeCallback (&Ipv6L3Protocol::RouteInputError, this)))
+  if (m_routeCacheEnabled && !hdr.GetDestinationAddress ().IsMulticast () && CheckRouteCache ())
+    {
+      RouteCacheKey key;
+      key.source = hdr.GetSourceAddress ();
+      key.destination = hdr.GetDestinationAddress ();
+      key.interface = interface;
+      RouteCache::const_iterator it = m_routeCache.find (key);
+      if (it != m_routeCache.end ())
+        {
+          m_routeCacheTrace (hdr, interface, true);
+          RouteCacheEntry entry = it->second;
+          IpForward (entry.idev, entry.route, packet, hdr);
+          return;
+        }
+      m_routeCacheTrace (hdr, interface, false);
+      // IpForward caches the route if RouteInput forwards the packet
+      m_routeCacheKey = key;
+      m_routeCacheMiss = true;
+    }
+
+  bool routed = m_routingProtocol->RouteInput (packet, hdr, device,
+                                               MakeCallback (&Ipv6L3Protocol::IpForward, this),
+                                               MakeCallback (&Ipv6L3Protocol::IpMulticastForward, this),
+                                               MakeCallback (&Ipv6L3Protocol::LocalDeliver, this),
+                                               MakeCallback (&Ipv6L3Protocol::RouteInputError, this));
+  m_routeCacheMiss = false;
+  if (!routed)
     {
       NS_LOG_WARN ("No route found for forwarding packet.  Drop.");
       GetIcmpv6 ()->SendErrorDestinationUnreachable (p->Copy (), hdr.GetSourceAddress (), Icmpv6Header::ICMPV6_NO_ROUTE);
@@ -1080,7 +1131,29 @@ void Ipv6L3Protocol::SendRealOut (Ptr<Ipv6Route> route, Ptr<Packet> packet, Ipv6
       targetMtu = dev->GetMtu ();
     }
 
-  if (packet->GetSize () > targetMtu + 40) /* 40 => size of IPv6 header */
+  // A large send is not fragmented: the device splits it into segments
+  // if it supports it and the path takes its MTU, else it is split here
+  LargeSendTag largeSend;
+  bool isLargeSend = packet->PeekPacketTag (largeSend);
+  if (isLargeSend)
+    {
+      Ptr<SegmentationOffload> offload = m_node->GetObject<SegmentationOffload> ();
+      NS_ASSERT_MSG (offload != 0, "Large send without a SegmentationOffload on the node");
+      Ptr<Packet> largePacket = packet->Copy ();
+      largePacket->AddHeader (ipHeader);
+      if (offload->GetSegmentCount (largePacket, PROT_NUMBER, targetMtu) == 0)
+        { // Sent as a single packet, fragmented below if too large
+          NS_LOG_WARN ("Large send which cannot be split into segments");
+          packet->RemovePacketTag (largeSend);
+          isLargeSend = false;
+        }
+      else if (!dev->SupportsSegmentationOffload () || targetMtu < dev->GetMtu ())
+        {
+          offload->Segment (largePacket, PROT_NUMBER, targetMtu, fragments);
+        }
+    }
+
+  if (!isLargeSend && packet->GetSize () > targetMtu + 40) /* 40 => size of IPv6 header */
     {
       // Router => drop
 
@@ -1211,6 +1284,18 @@ void Ipv6L3Protocol::IpForward (Ptr<const NetDevice> idev, Ptr<Ipv6Route> rtentr
   NS_LOG_FUNCTION (this << rtentry << p << header);
   NS_LOG_INFO ("Forwarding logic for node: " << m_node->GetId ());
 
+  if (m_routeCacheMiss)
+    {
+      m_routeCacheMiss = false;
+      if (m_routeCache.size () >= m_routeCacheSize)
+        {
+          m_routeCache.clear ();
+        }
+      RouteCacheEntry &entry = m_routeCache[m_routeCacheKey];
+      entry.idev = idev;
+      entry.route = rtentry;
+    }
+
   // Drop RFC 3849 packets: 2001:db8::/32
   if (header.GetDestinationAddress().IsDocumentation())
     {
@@ -1518,6 +1603,44 @@ void Ipv6L3Protocol::LocalDeliver (Ptr<const Packet> packet, Ipv6Header const& i
   while (ipv6Extension);
 }
 
+bool Ipv6L3Protocol::CheckRouteCache ()
+{
+  uint32_t generation;
+  if (!m_routingProtocol->GetRouteGeneration (generation))
+    {
+      if (!m_routeCache.empty ())
+        {
+          m_routeCache.clear ();
+        }
+      return false;
+    }
+  if (generation != m_routeCacheGeneration)
+    {
+      NS_LOG_LOGIC ("Routes changed, flushing the route cache");
+      FlushRouteCache ();
+      m_routeCacheGeneration = generation;
+    }
+  return true;
+}
+
+void Ipv6L3Protocol::FlushRouteCache ()
+{
+  NS_LOG_FUNCTION (this);
+  m_routeCache.clear ();
+  m_routeCacheMiss = false;
+}
+
+bool Ipv6L3Protocol::RouteCacheKey::operator== (const RouteCacheKey &other) const
+{
+  return interface == other.interface && destination == other.destination && source == other.source;
+}
+
+size_t Ipv6L3Protocol::RouteCacheKeyHash::operator() (const RouteCacheKey &key) const
+{
+  Ipv6AddressHash hash;
+  return hash (key.destination) ^ (hash (key.source) * 31) ^ key.interface;
+}
+
 void Ipv6L3Protocol::RouteInputError (Ptr<const Packet> p, const Ipv6Header& ipHeader, Socket::SocketErrno sockErrno)
 {
   NS_LOG_FUNCTION (this << p << ipHeader << sockErrno);
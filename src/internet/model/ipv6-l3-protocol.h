@@ -29,6 +29,7 @@
 #include "ns3/ipv6-address.h"
 #include "ns3/ipv6-header.h"
 #include "ns3/ipv6-pmtu-cache.h"
+#include "ns3/sgi-hashmap.h"
 
 class Ipv6L3ProtocolTestCase;
 
@@ -86,6 +87,7 @@ public:
     DROP_UNKNOWN_OPTION, /**< Unknown option */
     DROP_MALFORMED_HEADER, /**< Malformed header */
     DROP_FRAGMENT_TIMEOUT, /**< Fragment timeout */
+    DROP_FRAGMENT_MEMORY, /**< Reassembly memory exhausted */
   };
 
   /**
@@ -428,6 +430,17 @@ public:
    */
   virtual void ReportDrop (Ipv6Header ipHeader, Ptr<Packet> p, DropReason dropReason);
 
+  /**
+   * \brief Flush the route cache.
+   *
+   * The routes cached for the forwarded packets are flushed whenever the
+   * routing protocol reports that its routes changed, or the addresses,
+   * state or forwarding state of the interfaces change through this
+   * class. Code which changes what RouteInput returns in other ways has
+   * to flush the cache itself.
+   */
+  void FlushRouteCache (void);
+
   /**
    * TracedCallback signature for packet sent, forwarded or
    * local-delivered events.
@@ -464,6 +477,16 @@ public:
     (const Ipv6Header & header, const Ptr<const Packet> packet,
      const DropReason reason, const Ptr<const Ipv6> ipv6,
      const uint32_t interface);
+
+  /**
+   * TracedCallback signature for route cache lookups.
+   *
+   * \param [in] header The Ipv6Header.
+   * \param [in] interface The input interface.
+   * \param [in] hit True if the route was found in the cache.
+   */
+  typedef void (* RouteCacheTracedCallback)
+    (const Ipv6Header & header, const uint32_t interface, const bool hit);
    
 protected:
   /**
@@ -529,6 +552,50 @@ private:
   TracedCallback<const Ipv6Header &, Ptr<const Packet>, uint32_t> m_unicastForwardTrace;
   /// Trace of locally delivered packets
   TracedCallback<const Ipv6Header &, Ptr<const Packet>, uint32_t> m_localDeliverTrace;
+  /// Trace of route cache lookups
+  TracedCallback<const Ipv6Header &, uint32_t, bool> m_routeCacheTrace;
+
+  /**
+   * \brief Key of the route cache.
+   */
+  struct RouteCacheKey
+  {
+    Ipv6Address source;      //!< source address of the packets
+    Ipv6Address destination; //!< destination address of the packets
+    uint32_t interface;      //!< input interface of the packets
+
+    /**
+     * \param other another key
+     * \return true if the keys are equal
+     */
+    bool operator== (const RouteCacheKey &other) const;
+  };
+
+  /**
+   * \brief Hash function of the route cache keys.
+   */
+  struct RouteCacheKeyHash
+  {
+    /**
+     * \param key a key
+     * \return the hash of the key
+     */
+    size_t operator() (const RouteCacheKey &key) const;
+  };
+
+  /**
+   * \brief Forwarding decision of RouteInput, as given to IpForward.
+   */
+  struct RouteCacheEntry
+  {
+    Ptr<const NetDevice> idev; //!< input device
+    Ptr<Ipv6Route> route;      //!< route
+  };
+
+  /**
+   * \brief Container of the cached routes.
+   */
+  typedef sgi::hash_map<RouteCacheKey, RouteCacheEntry, RouteCacheKeyHash> RouteCache;
 
   /**
    * \brief Copy constructor.
@@ -621,6 +688,13 @@ private:
    */
   void RouteInputError (Ptr<const Packet> p, const Ipv6Header& ipHeader, Socket::SocketErrno sockErrno);
 
+  /**
+   * \brief Check that the routes of the routing protocol can be cached,
+   * and flush the route cache if they changed.
+   * \return true if the route cache can be used
+   */
+  bool CheckRouteCache ();
+
   /**
    * \brief Add an IPv6 interface to the stack.
    * \param interface interface to add
@@ -734,6 +808,37 @@ private:
    */
   bool m_sendIcmpv6Redirect;
 
+  /**
+   * \brief Route cache state.
+   */
+  bool m_routeCacheEnabled;
+
+  /**
+   * \brief Maximum number of cached routes.
+   */
+  uint32_t m_routeCacheSize;
+
+  /**
+   * \brief Routes of the forwarded packets, by source, destination and
+   * input interface.
+   */
+  RouteCache m_routeCache;
+
+  /**
+   * \brief Generation of the routes of the routing protocol in the cache.
+   */
+  uint32_t m_routeCacheGeneration;
+
+  /**
+   * \brief True while RouteInput looks up a route which is not cached.
+   */
+  bool m_routeCacheMiss;
+
+  /**
+   * \brief Key of the route RouteInput looks up.
+   */
+  RouteCacheKey m_routeCacheKey;
+
     /**
      * \brief ISP prefix for 6rd
      */
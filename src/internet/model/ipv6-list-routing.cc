@@ -43,7 +43,8 @@ Ipv6ListRouting::GetTypeId (void)
 
 
 Ipv6ListRouting::Ipv6ListRouting ()
-  : m_ipv6 (0)
+  : m_ipv6 (0),
+    m_routeGeneration (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -287,6 +288,25 @@ Ipv6ListRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const
   *stream->GetStream () << std::endl;
 }
 
+bool
+Ipv6ListRouting::GetRouteGeneration (uint32_t &generation) const
+{
+  // the generations of the routing protocols only increase, and so does
+  // their sum
+  generation = m_routeGeneration;
+  for (Ipv6RoutingProtocolList::const_iterator i = m_routingProtocols.begin ();
+       i != m_routingProtocols.end (); i++)
+    {
+      uint32_t protocolGeneration;
+      if (!(*i).second->GetRouteGeneration (protocolGeneration))
+        {
+          return false;
+        }
+      generation += protocolGeneration;
+    }
+  return true;
+}
+
 void
 Ipv6ListRouting::SetIpv6 (Ptr<Ipv6> ipv6)
 {
@@ -308,6 +328,7 @@ Ipv6ListRouting::AddRoutingProtocol (Ptr<Ipv6RoutingProtocol> routingProtocol, i
   NS_LOG_FUNCTION (this << routingProtocol->GetInstanceTypeId () << priority);
   m_routingProtocols.push_back (std::make_pair (priority, routingProtocol));
   m_routingProtocols.sort ( Compare );
+  m_routeGeneration++;
   if (m_ipv6 != 0)
     {
       routingProtocol->SetIpv6 (m_ipv6);
@@ -111,6 +111,17 @@ public:
    */
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const;
 
+  /**
+   * \brief Get the generation of the unicast routes of RouteInput.
+   *
+   * The generation changes whenever a routing protocol is added, or the
+   * generation of one of the routing protocols changes.
+   *
+   * \param generation the generation of the routes
+   * \returns true if the routes of all the routing protocols can be cached
+   */
+  virtual bool GetRouteGeneration (uint32_t &generation) const;
+
 protected:
   /**
    * \brief Dispose this object.
@@ -138,6 +149,7 @@ private:
 
   Ipv6RoutingProtocolList m_routingProtocols; //!<  List of routing protocols.
   Ptr<Ipv6> m_ipv6;  //!< Ipv6 this protocol is associated with.
+  uint32_t m_routeGeneration; //!< Number of routing protocols added.
 };
 
 } // namespace ns3
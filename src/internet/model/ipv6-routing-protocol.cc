@@ -36,5 +36,10 @@ TypeId Ipv6RoutingProtocol::GetTypeId ()
   return tid;
 }
 
+bool Ipv6RoutingProtocol::GetRouteGeneration (uint32_t &generation) const
+{
+  return false;
+}
+
 } /* namespace ns3 */
 
@@ -190,6 +190,25 @@ public:
    * \param stream the ostream the Routing table is printed to
    */
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const = 0;
+
+  /**
+   * \brief Get the generation of the unicast routes of RouteInput.
+   *
+   * The IPv6 stack caches the route that RouteInput hands to the unicast
+   * forward callback, and forwards the next packets with the same source,
+   * destination and input interface along it without calling RouteInput,
+   * as long as the generation does not change.
+   *
+   * A routing protocol can let its routes be cached if its unicast
+   * forwarding decisions only depend on these, on the addresses and
+   * forwarding state of the interfaces, and on its routing table, and if
+   * it changes the generation whenever its routing table changes. The
+   * default implementation does not let the routes be cached.
+   *
+   * \param generation the generation of the routes
+   * \returns true if the routes of RouteInput can be cached
+   */
+  virtual bool GetRouteGeneration (uint32_t &generation) const;
 };
 
 } // namespace ns3
@@ -30,6 +30,7 @@
 #include "ns3/ipv6.h"
 #include "ns3/ipv6-header.h"
 #include "ns3/ipv6-routing-protocol.h"
+#include "ns3/ip-fib.h"
 
 namespace ns3 {
 
@@ -251,6 +252,13 @@ public:
    */
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const;
 
+  /**
+   * \brief Get the generation of the unicast routes of RouteInput.
+   * \param generation the number of changes of the network routes
+   * \returns true: the routes can be cached
+   */
+  virtual bool GetRouteGeneration (uint32_t &generation) const;
+
 protected:
   /**
    * \brief Dispose this object.
@@ -298,6 +306,16 @@ private:
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief the network routes, indexed by destination for the lookups.
+   */
+  Ipv6Fib m_fib;
+
+  /**
+   * \brief the number of changes of the network routes.
+   */
+  uint32_t m_routeGeneration;
+
   /**
    * \brief the forwarding table for multicast.
    */
@@ -20,6 +20,7 @@
 
 #include "ns3/log.h"
 #include "ns3/uinteger.h"
+#include "ns3/nstime.h"
 #include "ns3/node.h"
 #include "ns3/names.h"
 
@@ -44,6 +45,12 @@ TypeId NdiscCache::GetTypeId ()
                    UintegerValue (DEFAULT_UNRES_QLEN),
                    MakeUintegerAccessor (&NdiscCache::m_unresQlen),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("TimerResolution",
+                   "Resolution of the NUD timers of the entries: the timers expire at most this late.",
+                   TimeValue (MilliSeconds (10)),
+                   MakeTimeAccessor (&NdiscCache::SetTimerResolution,
+                                     &NdiscCache::GetTimerResolution),
+                   MakeTimeChecker ())
   ;
   return tid;
 } 
@@ -114,15 +121,12 @@ void NdiscCache::Remove (NdiscCache::Entry* entry)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  for (CacheI i = m_ndCache.begin (); i != m_ndCache.end (); i++)
+  CacheI i = m_ndCache.find (entry->GetIpv6Address ());
+  if (i != m_ndCache.end () && (*i).second == entry)
     {
-      if ((*i).second == entry)
-        {
-          m_ndCache.erase (i);
-          entry->ClearWaitingPacket ();
-          delete entry;
-          return;
-        }
+      m_ndCache.erase (i);
+      entry->ClearWaitingPacket ();
+      delete entry;
     }
 }
 
@@ -144,6 +148,18 @@ void NdiscCache::SetUnresQlen (uint32_t unresQlen)
   m_unresQlen = unresQlen;
 }
 
+void NdiscCache::SetTimerResolution (Time resolution)
+{
+  NS_LOG_FUNCTION (this << resolution);
+  m_timers.SetResolution (resolution);
+}
+
+Time NdiscCache::GetTimerResolution () const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return m_timers.GetResolution ();
+}
+
 uint32_t NdiscCache::GetUnresQlen ()
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -197,10 +213,10 @@ NdiscCache::Entry::Entry (NdiscCache* nd)
   : m_ndCache (nd),
     m_waiting (),
     m_router (false),
-    m_reachableTimer (Timer::CANCEL_ON_DESTROY),
-    m_retransTimer (Timer::CANCEL_ON_DESTROY),
-    m_probeTimer (Timer::CANCEL_ON_DESTROY),
-    m_delayTimer (Timer::CANCEL_ON_DESTROY),
+    m_reachableTimer (&nd->m_timers),
+    m_retransTimer (&nd->m_timers),
+    m_probeTimer (&nd->m_timers),
+    m_delayTimer (&nd->m_timers),
     m_lastReachabilityConfirmation (Seconds (0.0)),
     m_nsRetransmit (0)
 {
@@ -379,6 +395,12 @@ void NdiscCache::Entry::SetIpv6Address (Ipv6Address ipv6Address)
   m_ipv6Address = ipv6Address;
 }
 
+Ipv6Address NdiscCache::Entry::GetIpv6Address () const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return m_ipv6Address;
+}
+
 uint8_t NdiscCache::Entry::GetNSRetransmit () const
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -415,9 +437,8 @@ void NdiscCache::Entry::StartReachableTimer ()
     {
       m_reachableTimer.Cancel ();
     }
-  m_reachableTimer.SetFunction (&NdiscCache::Entry::FunctionReachableTimeout, this);
-  m_reachableTimer.SetDelay (MilliSeconds (Icmpv6L4Protocol::REACHABLE_TIME));
-  m_reachableTimer.Schedule ();
+  m_reachableTimer.SetFunction (MakeCallback (&NdiscCache::Entry::FunctionReachableTimeout, this));
+  m_reachableTimer.Schedule (MilliSeconds (Icmpv6L4Protocol::REACHABLE_TIME));
 }
 
 void NdiscCache::Entry::StopReachableTimer ()
@@ -433,9 +454,8 @@ void NdiscCache::Entry::StartProbeTimer ()
     {
       m_probeTimer.Cancel ();
     }
-  m_probeTimer.SetFunction (&NdiscCache::Entry::FunctionProbeTimeout, this);
-  m_probeTimer.SetDelay (MilliSeconds (Icmpv6L4Protocol::RETRANS_TIMER));
-  m_probeTimer.Schedule ();
+  m_probeTimer.SetFunction (MakeCallback (&NdiscCache::Entry::FunctionProbeTimeout, this));
+  m_probeTimer.Schedule (MilliSeconds (Icmpv6L4Protocol::RETRANS_TIMER));
 }
 
 void NdiscCache::Entry::StopProbeTimer ()
@@ -453,9 +473,8 @@ void NdiscCache::Entry::StartDelayTimer ()
     {
       m_delayTimer.Cancel ();
     }
-  m_delayTimer.SetFunction (&NdiscCache::Entry::FunctionDelayTimeout, this);
-  m_delayTimer.SetDelay (Seconds (Icmpv6L4Protocol::DELAY_FIRST_PROBE_TIME));
-  m_delayTimer.Schedule ();
+  m_delayTimer.SetFunction (MakeCallback (&NdiscCache::Entry::FunctionDelayTimeout, this));
+  m_delayTimer.Schedule (Seconds (Icmpv6L4Protocol::DELAY_FIRST_PROBE_TIME));
 }
 
 void NdiscCache::Entry::StopDelayTimer ()
@@ -472,9 +491,8 @@ void NdiscCache::Entry::StartRetransmitTimer ()
     {
       m_retransTimer.Cancel ();
     }
-  m_retransTimer.SetFunction (&NdiscCache::Entry::FunctionRetransmitTimeout, this);
-  m_retransTimer.SetDelay (MilliSeconds (Icmpv6L4Protocol::RETRANS_TIMER));
-  m_retransTimer.Schedule ();
+  m_retransTimer.SetFunction (MakeCallback (&NdiscCache::Entry::FunctionRetransmitTimeout, this));
+  m_retransTimer.Schedule (MilliSeconds (Icmpv6L4Protocol::RETRANS_TIMER));
 }
 
 void NdiscCache::Entry::StopRetransmitTimer ()
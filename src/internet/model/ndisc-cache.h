@@ -29,10 +29,11 @@
 #include "ns3/net-device.h"
 #include "ns3/ipv6-address.h"
 #include "ns3/ptr.h"
-#include "ns3/timer.h"
 #include "ns3/sgi-hashmap.h"
 #include "ns3/output-stream-wrapper.h"
 
+#include "timer-wheel.h"
+
 namespace ns3
 {
 
@@ -344,6 +345,12 @@ public:
      */
     void SetIpv6Address (Ipv6Address ipv6Address);
 
+    /**
+     * \brief Get the IPv6 address.
+     * \return the IPv6 address
+     */
+    Ipv6Address GetIpv6Address () const;
+
 private:
     /**
      * \brief The IPv6 address.
@@ -390,22 +397,22 @@ private:
     /**
      * \brief Reachable timer (used for NUD in REACHABLE state).
      */
-    Timer m_reachableTimer;
+    TimerWheel::Timer m_reachableTimer;
 
     /**
      * \brief Retransmission timer (used for NUD in INCOMPLETE state).
      */
-    Timer m_retransTimer;
+    TimerWheel::Timer m_retransTimer;
 
     /**
      * \brief Probe timer (used for NUD in PROBE state).
      */
-    Timer m_probeTimer;
+    TimerWheel::Timer m_probeTimer;
 
     /**
      * \brief Delay timer (used for NUD when in DELAY state).
      */
-    Timer m_delayTimer;
+    TimerWheel::Timer m_delayTimer;
 
     /**
      * \brief Last time we see a reachability confirmation.
@@ -419,6 +426,8 @@ private:
   };
 
 private:
+  friend class Entry;
+
   /**
    * \brief Neighbor Discovery Cache container
    */
@@ -448,6 +457,18 @@ private:
    */
   void DoDispose ();
 
+  /**
+   * \brief Set the resolution of the timers of the entries.
+   * \param resolution the resolution
+   */
+  void SetTimerResolution (Time resolution);
+
+  /**
+   * \brief Get the resolution of the timers of the entries.
+   * \return the resolution
+   */
+  Time GetTimerResolution () const;
+
   /**
    * \brief The NetDevice.
    */
@@ -467,6 +488,12 @@ private:
    * \brief Max number of packet stored in m_waiting.
    */
   uint32_t m_unresQlen;
+
+  /**
+   * \brief The timers of the entries, which do not schedule any event
+   * of their own.
+   */
+  TimerWheel m_timers;
 };
 
 } /* namespace ns3 */
@@ -43,7 +43,7 @@ NS_LOG_COMPONENT_DEFINE ("RipNg");
 NS_OBJECT_ENSURE_REGISTERED (RipNg);
 
 RipNg::RipNg ()
-  : m_ipv6 (0), m_splitHorizonStrategy (RipNg::POISON_REVERSE), m_initialized (false)
+  : m_routeGeneration (0), m_ipv6 (0), m_splitHorizonStrategy (RipNg::POISON_REVERSE), m_initialized (false)
 {
   m_rng = CreateObject<UniformRandomVariable> ();
 }
@@ -551,6 +551,12 @@ void RipNg::PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const
     }
 }
 
+bool RipNg::GetRouteGeneration (uint32_t &generation) const
+{
+  generation = m_routeGeneration;
+  return true;
+}
+
 void RipNg::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
@@ -560,6 +566,7 @@ void RipNg::DoDispose ()
       delete j->first;
     }
   m_routes.clear ();
+  m_routeGeneration++;
 
   m_nextTriggeredUpdate.Cancel ();
   m_nextUnsolicitedUpdate.Cancel ();
@@ -674,6 +681,7 @@ void RipNg::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, Ip
   route->SetRouteChanged (true);
 
   m_routes.push_back (std::make_pair (route, EventId ()));
+  m_routeGeneration++;
 }
 
 void RipNg::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, uint32_t interface)
@@ -686,6 +694,7 @@ void RipNg::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, ui
   route->SetRouteChanged (true);
 
   m_routes.push_back (std::make_pair (route, EventId ()));
+  m_routeGeneration++;
 }
 
 void RipNg::InvalidateRoute (RipNgRoutingTableEntry *route)
@@ -699,6 +708,7 @@ void RipNg::InvalidateRoute (RipNgRoutingTableEntry *route)
           route->SetRouteStatus (RipNgRoutingTableEntry::RIPNG_INVALID);
           route->SetRouteMetric (16);
           route->SetRouteChanged (true);
+          m_routeGeneration++;
           if (it->second.IsRunning ())
             {
               it->second.Cancel ();
@@ -720,6 +730,7 @@ void RipNg::DeleteRoute (RipNgRoutingTableEntry *route)
         {
           delete route;
           m_routes.erase (it);
+          m_routeGeneration++;
           return;
         }
     }
@@ -1097,6 +1108,7 @@ void RipNg::HandleResponses (RipNgHeader hdr, Ipv6Address senderAddress, uint32_
 
   if (changed)
     {
+      m_routeGeneration++;
       SendTriggeredRouteUpdate ();
     }
 }
@@ -200,6 +200,7 @@ public:
   virtual void SetIpv6 (Ptr<Ipv6> ipv6);
   bool Is6to4PseudoInterface (Ipv6Address address) const;
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const;
+  virtual bool GetRouteGeneration (uint32_t &generation) const;
 
   /**
    * Split Horizon strategy type. See \RFC{2080}.
@@ -377,6 +378,7 @@ private:
   void DeleteRoute (RipNgRoutingTableEntry *route);
 
   Routes m_routes; //!<  the forwarding table for network.
+  uint32_t m_routeGeneration; //!< Number of changes of the forwarding table.
   Ptr<Ipv6> m_ipv6; //!< IPv6 reference
   Time m_startupDelay; //!< Random delay before protocol startup.
   Time m_minTriggeredUpdateDelay; //!< Min cooldown delay after a Triggered Update.
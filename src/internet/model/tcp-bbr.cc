@@ -0,0 +1,267 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#define NS_LOG_APPEND_CONTEXT \
+  if (m_node) { std::clog << Simulator::Now ().GetSeconds () << " [node " << m_node->GetId () << "] "; }
+
+#include "tcp-bbr.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpBbr");
+
+NS_OBJECT_ENSURE_REGISTERED (TcpBbr);
+
+/// Gains of STARTUP, 2/ln(2): the smallest which doubles the delivery rate every round
+static const double BBR_HIGH_GAIN = 2.885;
+/// Gain of the congestion window out of STARTUP
+static const double BBR_CWND_GAIN = 2;
+/// Pacing gains of the rounds of PROBE_BW
+static const double BBR_PACING_GAINS[] = { 1.25, 0.75, 1, 1, 1, 1, 1, 1 };
+/// Number of rounds of the gain cycle of PROBE_BW
+static const uint32_t BBR_CYCLE_LENGTH = sizeof (BBR_PACING_GAINS) / sizeof (BBR_PACING_GAINS[0]);
+
+TypeId
+TcpBbr::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpBbr")
+    .SetParent<TcpNewReno> ()
+    .AddConstructor<TcpBbr> ()
+    .AddAttribute ("BwRounds", "Number of rounds over which the delivery rate is maximized",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&TcpBbr::m_bwRounds),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MinRttWindow", "Time over which the RTT is minimized",
+                   TimeValue (Seconds (10)),
+                   MakeTimeAccessor (&TcpBbr::m_minRttWindow),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+TcpBbr::TcpBbr (void)
+  : m_bwRounds (10), // mute valgrind, actual values set by the attribute system
+    m_mode (STARTUP),
+    m_btlBw (0),
+    m_delivered (0),
+    m_roundDelivered (0),
+    m_fullBw (0),
+    m_fullBwRounds (0),
+    m_cycleIndex (0),
+    m_pacingGain (BBR_HIGH_GAIN),
+    m_cWndGain (BBR_HIGH_GAIN)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpBbr::TcpBbr (const TcpBbr& sock)
+  : TcpNewReno (sock),
+    m_bwRounds (sock.m_bwRounds),
+    m_minRttWindow (sock.m_minRttWindow),
+    m_mode (STARTUP),
+    m_btlBw (0),
+    m_delivered (0),
+    m_roundDelivered (0),
+    m_fullBw (0),
+    m_fullBwRounds (0),
+    m_cycleIndex (0),
+    m_pacingGain (BBR_HIGH_GAIN),
+    m_cWndGain (BBR_HIGH_GAIN)
+{
+  NS_LOG_FUNCTION (this);
+  NS_LOG_LOGIC ("Invoked the copy constructor");
+}
+
+TcpBbr::~TcpBbr (void)
+{
+}
+
+/* BBR relies on pacing rather than on the ACK clock */
+int
+TcpBbr::Listen (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_pacing = true;
+  return TcpNewReno::Listen ();
+}
+
+/* BBR relies on pacing rather than on the ACK clock */
+int
+TcpBbr::Connect (const Address & address)
+{
+  NS_LOG_FUNCTION (this << address);
+  m_pacing = true;
+  return TcpNewReno::Connect (address);
+}
+
+Ptr<TcpSocketBase>
+TcpBbr::Fork (void)
+{
+  return CopyObject<TcpBbr> (this);
+}
+
+TcpBbr::BbrMode_t
+TcpBbr::GetMode (void) const
+{
+  return m_mode;
+}
+
+DataRate
+TcpBbr::GetBottleneckBandwidth (void) const
+{
+  return DataRate (m_btlBw);
+}
+
+Time
+TcpBbr::GetMinRtt (void) const
+{
+  return m_minRtt;
+}
+
+uint32_t
+TcpBbr::GetBdp (double gain) const
+{
+  if (m_btlBw == 0 || m_minRtt.IsZero ())
+    {
+      return 0;
+    }
+  double bdp = m_btlBw / 8.0 * m_minRtt.GetSeconds ();
+  return std::max (4 * m_segmentSize, static_cast<uint32_t> (gain * bdp));
+}
+
+void
+TcpBbr::PktsAcked (uint32_t bytesAcked, Time rtt)
+{
+  NS_LOG_FUNCTION (this << bytesAcked << rtt);
+  Time now = Simulator::Now ();
+  if (!rtt.IsZero () && (m_minRtt.IsZero () || rtt <= m_minRtt || now - m_minRttStamp > m_minRttWindow))
+    {
+      m_minRtt = rtt;
+      m_minRttStamp = now;
+    }
+  m_delivered += bytesAcked;
+  if (m_minRtt.IsZero ())
+    {
+      return;
+    }
+  if (m_roundStart.IsZero ())
+    {
+      m_roundStart = now;
+      m_roundDelivered = m_delivered;
+    }
+  else if (now - m_roundStart >= m_minRtt)
+    {
+      EndRound ();
+    }
+  if (m_mode == DRAIN && BytesInFlight () <= GetBdp (1))
+    { // The queue is drained: cycle around the bandwidth
+      m_mode = PROBE_BW;
+      m_cycleIndex = 0;
+      m_pacingGain = BBR_PACING_GAINS[m_cycleIndex];
+      m_cWndGain = BBR_CWND_GAIN;
+      NS_LOG_INFO ("Queue drained, enter PROBE_BW");
+    }
+}
+
+void
+TcpBbr::EndRound (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now ();
+  uint64_t sample = static_cast<uint64_t> ((m_delivered - m_roundDelivered) * 8 / (now - m_roundStart).GetSeconds ());
+  m_roundStart = now;
+  m_roundDelivered = m_delivered;
+  m_bwSamples.push_back (sample);
+  if (m_bwSamples.size () > m_bwRounds)
+    {
+      m_bwSamples.pop_front ();
+    }
+  m_btlBw = *std::max_element (m_bwSamples.begin (), m_bwSamples.end ());
+  NS_LOG_LOGIC ("Delivery rate " << sample << " bps, bottleneck bandwidth " << m_btlBw << " bps");
+
+  if (m_mode == STARTUP)
+    {
+      if (m_btlBw >= m_fullBw * 1.25)
+        {
+          m_fullBw = m_btlBw;
+          m_fullBwRounds = 0;
+        }
+      else if (++m_fullBwRounds >= 3)
+        { // The pipe is full: drain the queue built meanwhile
+          m_mode = DRAIN;
+          m_pacingGain = 1 / BBR_HIGH_GAIN;
+          m_cWndGain = BBR_HIGH_GAIN;
+          NS_LOG_INFO ("Bandwidth " << m_btlBw << " bps reached, enter DRAIN");
+        }
+    }
+  else if (m_mode == PROBE_BW)
+    {
+      m_cycleIndex = (m_cycleIndex + 1) % BBR_CYCLE_LENGTH;
+      m_pacingGain = BBR_PACING_GAINS[m_cycleIndex];
+    }
+}
+
+void
+TcpBbr::IncreaseWindow (uint32_t bytesAcked)
+{
+  NS_LOG_FUNCTION (this << bytesAcked);
+  uint32_t target = GetBdp (m_cWndGain);
+  if (m_mode == STARTUP)
+    { // Grow as in slow start until the window reaches its target
+      if (target == 0 || m_cWnd < target)
+        {
+          m_cWnd += bytesAcked;
+        }
+    }
+  else
+    {
+      m_cWnd = std::min (m_cWnd.Get () + bytesAcked, target);
+    }
+  m_cWnd = std::max (m_cWnd.Get (), 4 * m_segmentSize);
+  NS_LOG_INFO ("Mode " << m_mode << ", updated to cwnd " << m_cWnd << " target " << target);
+}
+
+/* The losses are not a signal of congestion: keep the window at its target */
+uint32_t
+TcpBbr::ReduceWindow (uint32_t bytesInFlight)
+{
+  NS_LOG_FUNCTION (this << bytesInFlight);
+  uint32_t target = GetBdp (m_cWndGain);
+  if (target == 0)
+    { // No bandwidth estimate yet
+      return TcpNewReno::ReduceWindow (bytesInFlight);
+    }
+  return target;
+}
+
+DataRate
+TcpBbr::GetPacingRate (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_btlBw == 0)
+    { // No bandwidth estimate yet
+      return TcpNewReno::GetPacingRate ();
+    }
+  return DataRate (static_cast<uint64_t> (m_pacingGain * m_btlBw));
+}
+
+} // namespace ns3
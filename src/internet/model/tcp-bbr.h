@@ -0,0 +1,137 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_BBR_H
+#define TCP_BBR_H
+
+#include <deque>
+#include "tcp-newreno.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup socket
+ * \ingroup tcp
+ *
+ * \brief An implementation of a stream socket using TCP.
+ *
+ * This class contains a simplified BBR congestion control: rather than
+ * reacting to the losses, the socket estimates the bottleneck bandwidth,
+ * as the largest delivery rate over the last BwRounds rounds of one RTT,
+ * and the round trip propagation delay, as the smallest RTT over the last
+ * MinRttWindow. It paces the data at a gain times the bandwidth, and
+ * bounds the data in flight by a gain times the bandwidth-delay product.
+ *
+ * The socket starts in STARTUP, with the gains 2/ln(2), until the bandwidth
+ * stops growing by 25% for 3 rounds. It then drains the queue built in
+ * STARTUP in DRAIN, and settles in PROBE_BW, cycling the pacing gain over
+ * 8 rounds to probe for more bandwidth and drain the queue built doing so.
+ * There is no PROBE_RTT state, nor any detection of the application
+ * limited rounds. The socket always paces, whatever the Pacing attribute.
+ * The loss recovery is the one of TcpNewReno, without the reduction of
+ * the window.
+ */
+class TcpBbr : public TcpNewReno
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * Create an unbound tcp socket.
+   */
+  TcpBbr (void);
+  /**
+   * \brief Copy constructor
+   * \param sock the object to copy
+   */
+  TcpBbr (const TcpBbr& sock);
+  virtual ~TcpBbr (void);
+
+  /**
+   * \brief BBR modes
+   */
+  typedef enum
+  {
+    STARTUP,   //!< Grow quickly to fill the pipe
+    DRAIN,     //!< Drain the queue built in STARTUP
+    PROBE_BW   //!< Cycle the pacing gain around the bandwidth
+  } BbrMode_t;
+
+  // From TcpSocketBase
+  virtual int Connect (const Address &address);
+  virtual int Listen (void);
+
+  /**
+   * \returns the current mode
+   */
+  BbrMode_t GetMode (void) const;
+
+  /**
+   * \returns the estimate of the bottleneck bandwidth
+   */
+  DataRate GetBottleneckBandwidth (void) const;
+
+  /**
+   * \returns the estimate of the round trip propagation delay
+   */
+  Time GetMinRtt (void) const;
+
+protected:
+  virtual Ptr<TcpSocketBase> Fork (void); // Call CopyObject<TcpBbr> to clone me
+  virtual DataRate GetPacingRate (void); // Pacing gain times the bandwidth
+
+  // Congestion control hooks of TcpNewReno
+  virtual void PktsAcked (uint32_t bytesAcked, Time rtt);
+  virtual void IncreaseWindow (uint32_t bytesAcked);
+  virtual uint32_t ReduceWindow (uint32_t bytesInFlight);
+
+private:
+  /**
+   * \brief Sample the delivery rate over the round just over and move on
+   *        through the modes
+   */
+  void EndRound (void);
+
+  /**
+   * \param gain the gain
+   * \returns gain times the bandwidth-delay product, at least 4 segments,
+   *          or 0 without a bandwidth estimate
+   */
+  uint32_t GetBdp (double gain) const;
+
+  uint32_t             m_bwRounds;        //!< Rounds over which the delivery rate is maximized
+  Time                 m_minRttWindow;    //!< Time over which the RTT is minimized
+  BbrMode_t            m_mode;            //!< Current mode
+  std::deque<uint64_t> m_bwSamples;       //!< Delivery rate of the last rounds (bps)
+  uint64_t             m_btlBw;           //!< Bottleneck bandwidth estimate (bps)
+  Time                 m_minRtt;          //!< Round trip propagation delay estimate
+  Time                 m_minRttStamp;     //!< Time of the m_minRtt sample
+  uint64_t             m_delivered;       //!< Bytes acknowledged so far
+  uint64_t             m_roundDelivered;  //!< m_delivered at the start of the round
+  Time                 m_roundStart;      //!< Start of the round, zero if none
+  uint64_t             m_fullBw;          //!< Bandwidth at the last 25% growth in STARTUP (bps)
+  uint32_t             m_fullBwRounds;    //!< Rounds without a 25% growth in STARTUP
+  uint32_t             m_cycleIndex;      //!< Phase of the gain cycle in PROBE_BW
+  double               m_pacingGain;      //!< Current pacing gain
+  double               m_cWndGain;        //!< Current congestion window gain
+};
+
+} // namespace ns3
+
+#endif /* TCP_BBR_H */
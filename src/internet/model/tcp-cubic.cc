@@ -0,0 +1,181 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#define NS_LOG_APPEND_CONTEXT \
+  if (m_node) { std::clog << Simulator::Now ().GetSeconds () << " [node " << m_node->GetId () << "] "; }
+
+#include "tcp-cubic.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpCubic");
+
+NS_OBJECT_ENSURE_REGISTERED (TcpCubic);
+
+TypeId
+TcpCubic::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpCubic")
+    .SetParent<TcpNewReno> ()
+    .AddConstructor<TcpCubic> ()
+    .AddAttribute ("C", "Scaling constant of the cubic function",
+                   DoubleValue (0.4),
+                   MakeDoubleAccessor (&TcpCubic::m_c),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("Beta", "Multiplicative decrease factor of the window upon a loss",
+                   DoubleValue (0.7),
+                   MakeDoubleAccessor (&TcpCubic::m_beta),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("FastConvergence", "Enable fast convergence",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&TcpCubic::m_fastConvergence),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+TcpCubic::TcpCubic (void)
+  : m_c (0.4), // mute valgrind, actual values set by the attribute system
+    m_beta (0.7),
+    m_fastConvergence (true),
+    m_wMax (0),
+    m_k (0),
+    m_originPoint (0),
+    m_wEst (0),
+    m_cWndFraction (0),
+    m_epochStart (Seconds (0)),
+    m_delayMin (Seconds (0))
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpCubic::TcpCubic (const TcpCubic& sock)
+  : TcpNewReno (sock),
+    m_c (sock.m_c),
+    m_beta (sock.m_beta),
+    m_fastConvergence (sock.m_fastConvergence),
+    m_wMax (0),
+    m_k (0),
+    m_originPoint (0),
+    m_wEst (0),
+    m_cWndFraction (0),
+    m_epochStart (Seconds (0)),
+    m_delayMin (Seconds (0))
+{
+  NS_LOG_FUNCTION (this);
+  NS_LOG_LOGIC ("Invoked the copy constructor");
+}
+
+TcpCubic::~TcpCubic (void)
+{
+}
+
+Ptr<TcpSocketBase>
+TcpCubic::Fork (void)
+{
+  return CopyObject<TcpCubic> (this);
+}
+
+void
+TcpCubic::PktsAcked (uint32_t bytesAcked, Time rtt)
+{
+  NS_LOG_FUNCTION (this << bytesAcked << rtt);
+  if (!rtt.IsZero () && (m_delayMin.IsZero () || rtt < m_delayMin))
+    {
+      m_delayMin = rtt;
+    }
+}
+
+/* Grow cwnd towards the cubic function of the time since the last loss (RFC8312 sec.4) */
+void
+TcpCubic::IncreaseWindow (uint32_t bytesAcked)
+{
+  NS_LOG_FUNCTION (this << bytesAcked);
+  if (m_cWnd < m_ssThresh)
+    { // Standard slow start
+      TcpNewReno::IncreaseWindow (bytesAcked);
+      return;
+    }
+
+  double cWnd = static_cast<double> (m_cWnd) / m_segmentSize;
+  if (m_epochStart.IsZero ())
+    { // First ACK in congestion avoidance since the last loss
+      m_epochStart = Simulator::Now ();
+      if (cWnd < m_wMax)
+        {
+          m_k = std::pow ((m_wMax - cWnd) / m_c, 1.0 / 3);
+          m_originPoint = m_wMax;
+        }
+      else
+        {
+          m_k = 0;
+          m_originPoint = cWnd;
+        }
+      m_wEst = cWnd;
+    }
+
+  // Window which the cubic function reaches one RTT from now (RFC8312 sec.4.1)
+  double t = (Simulator::Now () - m_epochStart + m_delayMin).GetSeconds ();
+  double target = m_originPoint + m_c * std::pow (t - m_k, 3);
+  // Window of a standard TCP with the same decrease factor (RFC8312 sec.4.2)
+  double segmentsAcked = static_cast<double> (bytesAcked) / m_segmentSize;
+  m_wEst += 3 * (1 - m_beta) / (1 + m_beta) * segmentsAcked / cWnd;
+  target = std::min (std::max (target, m_wEst), 1.5 * cWnd);
+
+  double increment; // In segments
+  if (target > cWnd)
+    { // Reach the target within one RTT
+      increment = (target - cWnd) / cWnd * segmentsAcked;
+    }
+  else
+    { // Plateau: probe very slowly
+      increment = 0.01 * segmentsAcked / cWnd;
+    }
+  m_cWndFraction += increment * m_segmentSize;
+  uint32_t adder = static_cast<uint32_t> (m_cWndFraction);
+  m_cWndFraction -= adder;
+  m_cWnd += adder;
+  NS_LOG_INFO ("In CongAvoid, target " << target << " segments, updated to cwnd " << m_cWnd <<
+               " ssthresh " << m_ssThresh);
+}
+
+/* Reduce cwnd by Beta and remember it as W_max (RFC8312 sec.4.5 and 4.6) */
+uint32_t
+TcpCubic::ReduceWindow (uint32_t bytesInFlight)
+{
+  NS_LOG_FUNCTION (this << bytesInFlight);
+  double cWnd = static_cast<double> (m_cWnd) / m_segmentSize;
+  if (m_fastConvergence && cWnd < m_wMax)
+    { // The available bandwidth shrinks: release some for the new flows
+      m_wMax = cWnd * (1 + m_beta) / 2;
+    }
+  else
+    {
+      m_wMax = cWnd;
+    }
+  m_epochStart = Seconds (0);
+  m_cWndFraction = 0;
+  return std::max (2 * m_segmentSize, static_cast<uint32_t> (m_cWnd * m_beta));
+}
+
+} // namespace ns3
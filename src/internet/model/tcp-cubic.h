@@ -0,0 +1,83 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_CUBIC_H
+#define TCP_CUBIC_H
+
+#include "tcp-newreno.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup socket
+ * \ingroup tcp
+ *
+ * \brief An implementation of a stream socket using TCP.
+ *
+ * This class contains the CUBIC implementation of TCP, as of \RFC{8312}.
+ *
+ * Out of slow start, the congestion window follows a cubic function of
+ * the time elapsed since the last loss, whose plateau is the window at
+ * that loss, W_max: the window grows back quickly to W_max, stays around
+ * it, then probes beyond it. Upon a loss the window is reduced by the
+ * factor Beta, and W_max further when fast convergence is enabled. In
+ * the TCP-friendly region, where a standard TCP would grow faster, the
+ * window grows as the standard TCP would. The loss recovery is the one
+ * of TcpNewReno.
+ */
+class TcpCubic : public TcpNewReno
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * Create an unbound tcp socket.
+   */
+  TcpCubic (void);
+  /**
+   * \brief Copy constructor
+   * \param sock the object to copy
+   */
+  TcpCubic (const TcpCubic& sock);
+  virtual ~TcpCubic (void);
+
+protected:
+  virtual Ptr<TcpSocketBase> Fork (void); // Call CopyObject<TcpCubic> to clone me
+
+  // Congestion control hooks of TcpNewReno
+  virtual void PktsAcked (uint32_t bytesAcked, Time rtt);
+  virtual void IncreaseWindow (uint32_t bytesAcked);
+  virtual uint32_t ReduceWindow (uint32_t bytesInFlight);
+
+private:
+  double   m_c;               //!< Scaling constant C of the cubic function
+  double   m_beta;            //!< Multiplicative decrease factor
+  bool     m_fastConvergence; //!< Reduce W_max further on consecutive losses
+  double   m_wMax;            //!< Window before the last reduction (segments)
+  double   m_k;               //!< Time to grow back to W_max (s)
+  double   m_originPoint;     //!< Plateau of the cubic function (segments)
+  double   m_wEst;            //!< Window of a standard TCP (segments)
+  double   m_cWndFraction;    //!< Increase of cWnd below one byte, not applied yet
+  Time     m_epochStart;      //!< Start of the current epoch, zero if none
+  Time     m_delayMin;        //!< Smallest RTT seen
+};
+
+} // namespace ns3
+
+#endif /* TCP_CUBIC_H */
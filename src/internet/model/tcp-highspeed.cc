@@ -0,0 +1,144 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#define NS_LOG_APPEND_CONTEXT \
+  if (m_node) { std::clog << Simulator::Now ().GetSeconds () << " [node " << m_node->GetId () << "] "; }
+
+#include "tcp-highspeed.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpHighSpeed");
+
+NS_OBJECT_ENSURE_REGISTERED (TcpHighSpeed);
+
+TypeId
+TcpHighSpeed::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpHighSpeed")
+    .SetParent<TcpNewReno> ()
+    .AddConstructor<TcpHighSpeed> ()
+    .AddAttribute ("LowWindow", "Largest window of a standard TCP (segments)",
+                   UintegerValue (38),
+                   MakeUintegerAccessor (&TcpHighSpeed::m_lowWindow),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("HighWindow", "Window at which the decrease factor is HighDecrease (segments)",
+                   UintegerValue (83000),
+                   MakeUintegerAccessor (&TcpHighSpeed::m_highWindow),
+                   MakeUintegerChecker<uint32_t> (2))
+    .AddAttribute ("HighDecrease", "Decrease factor of the window at HighWindow",
+                   DoubleValue (0.1),
+                   MakeDoubleAccessor (&TcpHighSpeed::m_highDecrease),
+                   MakeDoubleChecker<double> (0, 0.5))
+  ;
+  return tid;
+}
+
+TcpHighSpeed::TcpHighSpeed (void)
+  : m_lowWindow (38), // mute valgrind, actual values set by the attribute system
+    m_highWindow (83000),
+    m_highDecrease (0.1),
+    m_cWndFraction (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpHighSpeed::TcpHighSpeed (const TcpHighSpeed& sock)
+  : TcpNewReno (sock),
+    m_lowWindow (sock.m_lowWindow),
+    m_highWindow (sock.m_highWindow),
+    m_highDecrease (sock.m_highDecrease),
+    m_cWndFraction (0)
+{
+  NS_LOG_FUNCTION (this);
+  NS_LOG_LOGIC ("Invoked the copy constructor");
+}
+
+TcpHighSpeed::~TcpHighSpeed (void)
+{
+}
+
+Ptr<TcpSocketBase>
+TcpHighSpeed::Fork (void)
+{
+  return CopyObject<TcpHighSpeed> (this);
+}
+
+/* b(w) is linear in log(w), from 0.5 at LowWindow to HighDecrease at HighWindow (RFC3649 sec.5) */
+double
+TcpHighSpeed::GetDecrease (double w) const
+{
+  if (w <= m_lowWindow)
+    {
+      return 0.5;
+    }
+  double x = (std::log (w) - std::log (static_cast<double> (m_lowWindow))) /
+    (std::log (static_cast<double> (m_highWindow)) - std::log (static_cast<double> (m_lowWindow)));
+  return (m_highDecrease - 0.5) * x + 0.5;
+}
+
+/* a(w) = w^2 * p(w) * 2 * b(w) / (2 - b(w)), with the response function p(w) = 0.078 / w^1.2 (RFC3649 sec.5) */
+double
+TcpHighSpeed::GetIncrease (double w) const
+{
+  if (w <= m_lowWindow)
+    {
+      return 1;
+    }
+  double b = GetDecrease (w);
+  double p = 0.078 / std::pow (w, 1.2);
+  return std::max (1.0, w * w * p * 2 * b / (2 - b));
+}
+
+void
+TcpHighSpeed::IncreaseWindow (uint32_t bytesAcked)
+{
+  NS_LOG_FUNCTION (this << bytesAcked);
+  double cWnd = static_cast<double> (m_cWnd) / m_segmentSize;
+  if (m_cWnd < m_ssThresh || cWnd <= m_lowWindow)
+    { // Standard TCP
+      TcpNewReno::IncreaseWindow (bytesAcked);
+      return;
+    }
+  // Congestion avoidance mode, increase by a(w) segments per RTT, a(w)*segSize*segSize/cwnd per ACK
+  m_cWndFraction += GetIncrease (cWnd) * m_segmentSize / cWnd;
+  uint32_t adder = static_cast<uint32_t> (m_cWndFraction);
+  m_cWndFraction -= adder;
+  m_cWnd += adder;
+  NS_LOG_INFO ("In CongAvoid, updated to cwnd " << m_cWnd << " ssthresh " << m_ssThresh);
+}
+
+uint32_t
+TcpHighSpeed::ReduceWindow (uint32_t bytesInFlight)
+{
+  NS_LOG_FUNCTION (this << bytesInFlight);
+  double cWnd = static_cast<double> (m_cWnd) / m_segmentSize;
+  if (cWnd <= m_lowWindow)
+    {
+      return TcpNewReno::ReduceWindow (bytesInFlight);
+    }
+  m_cWndFraction = 0;
+  return std::max (2 * m_segmentSize, static_cast<uint32_t> (m_cWnd * (1 - GetDecrease (cWnd))));
+}
+
+} // namespace ns3
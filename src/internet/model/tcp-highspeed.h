@@ -0,0 +1,88 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_HIGHSPEED_H
+#define TCP_HIGHSPEED_H
+
+#include "tcp-newreno.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup socket
+ * \ingroup tcp
+ *
+ * \brief An implementation of a stream socket using TCP.
+ *
+ * This class contains the HighSpeed implementation of TCP, as of \RFC{3649}.
+ *
+ * Up to a window of LowWindow segments, HighSpeed TCP is a standard TCP.
+ * Beyond, the window grows by a(w) segments per RTT and is reduced by
+ * the factor b(w) upon a loss, a(w) growing and b(w) shrinking with the
+ * window w, down to HighDecrease at HighWindow segments. a(w) and b(w)
+ * are computed from the formulas of the RFC rather than from its table.
+ * The loss recovery is the one of TcpNewReno.
+ */
+class TcpHighSpeed : public TcpNewReno
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * Create an unbound tcp socket.
+   */
+  TcpHighSpeed (void);
+  /**
+   * \brief Copy constructor
+   * \param sock the object to copy
+   */
+  TcpHighSpeed (const TcpHighSpeed& sock);
+  virtual ~TcpHighSpeed (void);
+
+  /**
+   * \brief The increase of the window per RTT, a(w)
+   * \param w the window (segments)
+   * \returns the increase (segments)
+   */
+  double GetIncrease (double w) const;
+
+  /**
+   * \brief The decrease factor of the window upon a loss, b(w)
+   * \param w the window (segments)
+   * \returns the decrease factor
+   */
+  double GetDecrease (double w) const;
+
+protected:
+  virtual Ptr<TcpSocketBase> Fork (void); // Call CopyObject<TcpHighSpeed> to clone me
+
+  // Congestion control hooks of TcpNewReno
+  virtual void IncreaseWindow (uint32_t bytesAcked);
+  virtual uint32_t ReduceWindow (uint32_t bytesInFlight);
+
+private:
+  uint32_t m_lowWindow;    //!< Largest window of a standard TCP (segments)
+  uint32_t m_highWindow;   //!< Window at which the decrease is HighDecrease (segments)
+  double   m_highDecrease; //!< Decrease factor at HighWindow
+  double   m_cWndFraction; //!< Increase of cWnd below one byte, not applied yet
+};
+
+} // namespace ns3
+
+#endif /* TCP_HIGHSPEED_H */
@@ -40,6 +40,7 @@
 #include "ipv6-l3-protocol.h"
 #include "ipv6-routing-protocol.h"
 #include "tcp-socket-factory-impl.h"
+#include "tcp-segmentation-offload.h"
 #include "tcp-newreno.h"
 #include "rtt-estimator.h"
 
@@ -124,6 +125,10 @@ TcpL4Protocol::NotifyNewAggregate ()
           Ptr<TcpSocketFactoryImpl> tcpFactory = CreateObject<TcpSocketFactoryImpl> ();
           tcpFactory->SetTcp (this);
           node->AggregateObject (tcpFactory);
+          if (node->GetObject<SegmentationOffload> () == 0)
+            { // Splits the large sends of the sockets
+              node->AggregateObject (CreateObject<TcpSegmentationOffload> ());
+            }
         }
     }
 
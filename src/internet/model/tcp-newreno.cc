@@ -127,6 +127,9 @@ TcpNewReno::NewAck (const SequenceNumber32& seq)
                 " cwnd " << m_cWnd <<
                 " ssthresh " << m_ssThresh);
 
+  uint32_t bytesAcked = seq - m_txBuffer->HeadSequence ();
+  PktsAcked (bytesAcked, m_lastRttSample);
+
   // Check for exit condition of fast recovery
   if (m_inFastRec && seq < m_recover)
     { // Partial ACK, partial window deflation (RFC2582 sec.3 bullet #5 paragraph 3)
@@ -144,11 +147,27 @@ TcpNewReno::NewAck (const SequenceNumber32& seq)
       NS_LOG_INFO ("Received full ACK for seq " << seq <<". Leaving fast recovery with cwnd set to " << m_cWnd);
     }
 
+  IncreaseWindow (bytesAcked);
+
+  // Complete newAck processing
+  TcpSocketBase::NewAck (seq);
+}
+
+void
+TcpNewReno::PktsAcked (uint32_t bytesAcked, Time rtt)
+{
+  NS_LOG_FUNCTION (this << bytesAcked << rtt);
+}
+
+void
+TcpNewReno::IncreaseWindow (uint32_t bytesAcked)
+{
+  NS_LOG_FUNCTION (this << bytesAcked);
   // Increase of cwnd based on current phase (slow start or congestion avoidance)
   if (m_cWnd < m_ssThresh)
     { // Slow start mode, add one segSize to cWnd. Default m_ssThresh is 65535. (RFC2001, sec.1)
       m_cWnd += m_segmentSize;
-      NS_LOG_INFO ("In SlowStart, ACK of seq " << seq << "; update cwnd to " << m_cWnd << "; ssthresh " << m_ssThresh);
+      NS_LOG_INFO ("In SlowStart, update cwnd to " << m_cWnd << "; ssthresh " << m_ssThresh);
     }
   else
     { // Congestion avoidance mode, increase by (segSize*segSize)/cwnd. (RFC2581, sec.3.1)
@@ -158,9 +177,26 @@ TcpNewReno::NewAck (const SequenceNumber32& seq)
       m_cWnd += static_cast<uint32_t> (adder);
       NS_LOG_INFO ("In CongAvoid, updated to cwnd " << m_cWnd << " ssthresh " << m_ssThresh);
     }
+}
 
-  // Complete newAck processing
-  TcpSocketBase::NewAck (seq);
+uint32_t
+TcpNewReno::ReduceWindow (uint32_t bytesInFlight)
+{
+  NS_LOG_FUNCTION (this << bytesInFlight);
+  return std::max (2 * m_segmentSize, bytesInFlight / 2);
+}
+
+/* Pace twice the window per RTT in slow start, as the window doubles every RTT */
+DataRate
+TcpNewReno::GetPacingRate (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_rtt == 0 || m_lastRtt.Get ().IsZero ())
+    {
+      return DataRate (0);
+    }
+  double gain = m_cWnd < m_ssThresh ? 2.0 : 1.2;
+  return DataRate (static_cast<uint64_t> (gain * Window () * 8 / m_rtt->GetEstimate ().GetSeconds ()));
 }
 
 /* Cut cwnd and enter fast recovery mode upon triple dupack */
@@ -170,7 +206,7 @@ TcpNewReno::DupAck (const TcpHeader& t, uint32_t count)
   NS_LOG_FUNCTION (this << count);
   if (count == m_retxThresh && !m_inFastRec)
     { // triple duplicate ack triggers fast retransmit (RFC2582 sec.3 bullet #1)
-      m_ssThresh = std::max (2 * m_segmentSize, BytesInFlight () / 2);
+      m_ssThresh = ReduceWindow (BytesInFlight ());
       m_cWnd = m_ssThresh + 3 * m_segmentSize;
       m_recover = m_highTxMark;
       m_inFastRec = true;
@@ -208,7 +244,7 @@ TcpNewReno::Retransmit (void)
   // According to RFC2581 sec.3.1, upon RTO, ssthresh is set to half of flight
   // size and cwnd is set to 1*MSS, then the lost packet is retransmitted and
   // TCP back to slow start
-  m_ssThresh = std::max (2 * m_segmentSize, BytesInFlight () / 2);
+  m_ssThresh = ReduceWindow (BytesInFlight ());
   m_cWnd = m_segmentSize;
   m_nextTxSequence = m_txBuffer->HeadSequence (); // Restart from highest Ack
   NS_LOG_INFO ("RTO. Reset cwnd to " << m_cWnd <<
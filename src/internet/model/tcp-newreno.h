@@ -32,6 +32,11 @@ namespace ns3 {
  * \brief An implementation of a stream socket using TCP.
  *
  * This class contains the NewReno implementation of TCP, as of \RFC{2582}.
+ *
+ * The loss recovery is shared with the other congestion controls, which
+ * derive from this class and override the hooks PktsAcked (),
+ * IncreaseWindow () and ReduceWindow () to change how the window grows
+ * and how much it shrinks upon a loss.
  */
 class TcpNewReno : public TcpSocketBase
 {
@@ -62,6 +67,42 @@ protected:
   virtual void NewAck (SequenceNumber32 const& seq); // Inc cwnd and call NewAck() of parent
   virtual void DupAck (const TcpHeader& t, uint32_t count);  // Halving cwnd and reset nextTxSequence
   virtual void Retransmit (void); // Exit fast recovery upon retransmit timeout
+  virtual DataRate GetPacingRate (void); // Twice the window per RTT in slow start
+
+  // Congestion control hooks
+
+  /**
+   * \brief Take note of the data acknowledged by a new ACK
+   *
+   * Called for every new ACK, in fast recovery too, before the window
+   * is updated. The default does nothing.
+   *
+   * \param bytesAcked the number of bytes newly acknowledged
+   * \param rtt the RTT measured on this ACK, zero if none
+   */
+  virtual void PktsAcked (uint32_t bytesAcked, Time rtt);
+
+  /**
+   * \brief Grow the congestion window upon a new ACK out of fast recovery
+   *
+   * The default is the slow start and the congestion avoidance of \RFC{2581}.
+   *
+   * \param bytesAcked the number of bytes newly acknowledged
+   */
+  virtual void IncreaseWindow (uint32_t bytesAcked);
+
+  /**
+   * \brief React to a loss, and get the new slow start threshold
+   *
+   * Called once per loss event, upon entering fast recovery and upon a
+   * retransmit timeout, so that the congestion controls can also update
+   * their own state for the loss. The default is half the flight size,
+   * as of \RFC{2581}.
+   *
+   * \param bytesInFlight the number of bytes in flight
+   * \returns the new slow start threshold
+   */
+  virtual uint32_t ReduceWindow (uint32_t bytesInFlight);
 
   // Implementing ns3::TcpSocket -- Attribute get/set
   virtual void     SetSegSize (uint32_t size);
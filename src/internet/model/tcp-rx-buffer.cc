@@ -195,6 +195,7 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
   // Insert packet into buffer
   NS_ASSERT (m_data.find (headSeq) == m_data.end ()); // Shouldn't be there yet
   m_data [ headSeq ] = p;
+  m_lastSeq = headSeq;
   NS_LOG_LOGIC ("Buffered packet of seqno=" << headSeq << " len=" << p->GetSize ());
   // Update variables
   m_size += p->GetSize ();      // Occupancy
@@ -264,4 +265,36 @@ TcpRxBuffer::Extract (uint32_t maxSize)
   return outPkt;
 }
 
+TcpRxBuffer::SackList
+TcpRxBuffer::GetSackList (uint32_t maxBlocks) const
+{
+  NS_LOG_FUNCTION (this << maxBlocks);
+
+  SackList blocks;
+  // Out-of-order data starts beyond nextRxSeq; merge the contiguous packets
+  std::map<SequenceNumber32, Ptr<Packet> >::const_iterator i = m_data.upper_bound (m_nextRxSeq);
+  while (i != m_data.end ())
+    {
+      SackBlock block (i->first, i->first + SequenceNumber32 (i->second->GetSize ()));
+      for (++i; i != m_data.end () && i->first == block.second; ++i)
+        {
+          block.second = i->first + SequenceNumber32 (i->second->GetSize ());
+        }
+      if (block.first <= m_lastSeq && m_lastSeq < block.second)
+        {
+          blocks.push_front (block);
+        }
+      else
+        {
+          blocks.push_back (block);
+        }
+    }
+  if (blocks.size () > maxBlocks)
+    {
+      blocks.resize (maxBlocks);
+    }
+  NS_LOG_LOGIC ("Reporting " << blocks.size () << " blocks of out-of-order data");
+  return blocks;
+}
+
 } //namepsace ns3
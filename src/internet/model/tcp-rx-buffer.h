@@ -22,6 +22,8 @@
 #define TCP_RX_BUFFER_H
 
 #include <map>
+#include <list>
+#include <utility>
 #include "ns3/traced-value.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/sequence-number.h"
@@ -124,6 +126,21 @@ public:
    * \returns a packet
    */
   Ptr<Packet> Extract (uint32_t maxSize);
+
+  /// a block of out-of-order data, from the seqnum of its first byte to the one following its last byte
+  typedef std::pair<SequenceNumber32, SequenceNumber32> SackBlock;
+  /// blocks of out-of-order data
+  typedef std::list<SackBlock> SackList;
+
+  /**
+   * Get the blocks of out-of-order data of the buffer, to be reported in the
+   * SACK option. As required by \RFC{2018}, the block of the last packet
+   * inserted comes first; the other blocks follow in sequence order.
+   *
+   * \param maxBlocks maximum number of blocks to return
+   * \returns the blocks
+   */
+  SackList GetSackList (uint32_t maxBlocks) const;
 public:
   /// container for data stored in the buffer
   typedef std::map<SequenceNumber32, Ptr<Packet> >::iterator BufIterator;
@@ -134,6 +151,7 @@ public:
   uint32_t m_maxBuffer;                      //!< Upper bound of the number of data bytes in buffer (RCV.WND)
   uint32_t m_availBytes;                     //!< Number of bytes available to read, i.e. contiguous block at head
   std::map<SequenceNumber32, Ptr<Packet> > m_data; //!< Corresponding data (may be null)
+  SequenceNumber32 m_lastSeq;                //!< Seqnum of the last packet inserted
 };
 
 } //namepsace ns3
@@ -0,0 +1,208 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "tcp-segmentation-offload.h"
+#include "tcp-header.h"
+#include "tcp-l4-protocol.h"
+#include "ipv4-header.h"
+#include "ipv4-l3-protocol.h"
+#include "ipv6-header.h"
+#include "ipv6-l3-protocol.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpSegmentationOffload");
+
+NS_OBJECT_ENSURE_REGISTERED (TcpSegmentationOffload);
+
+TypeId
+TcpSegmentationOffload::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpSegmentationOffload")
+    .SetParent<SegmentationOffload> ()
+    .AddConstructor<TcpSegmentationOffload> ()
+  ;
+  return tid;
+}
+
+TcpSegmentationOffload::TcpSegmentationOffload ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpSegmentationOffload::~TcpSegmentationOffload ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+bool
+TcpSegmentationOffload::Segment (Ptr<const Packet> packet, uint16_t protocolNumber, uint16_t mtu,
+                                 std::list<Ptr<Packet> > &segments) const
+{
+  NS_LOG_FUNCTION (this << packet << protocolNumber << mtu);
+
+  LargeSendTag tag;
+  if (!packet->PeekPacketTag (tag))
+    {
+      return false;
+    }
+  Ptr<Packet> p = packet->Copy ();
+  p->RemovePacketTag (tag);
+
+  if (protocolNumber == Ipv4L3Protocol::PROT_NUMBER)
+    {
+      Ipv4Header ipHeader;
+      p->RemoveHeader (ipHeader);
+      if (ipHeader.GetProtocol () != TcpL4Protocol::PROT_NUMBER)
+        {
+          return false;
+        }
+      TcpHeader tcpHeader;
+      p->RemoveHeader (tcpHeader);
+      uint32_t headerSize = ipHeader.GetSerializedSize () + tcpHeader.GetSerializedSize ();
+      if (mtu <= headerSize)
+        {
+          return false;
+        }
+      if (Node::ChecksumEnabled ())
+        {
+          ipHeader.EnableChecksum ();
+          tcpHeader.EnableChecksums ();
+          tcpHeader.InitializeChecksum (ipHeader.GetSource (), ipHeader.GetDestination (),
+                                        TcpL4Protocol::PROT_NUMBER);
+        }
+
+      std::list<Ptr<Packet> > tcpSegments;
+      SegmentData (p, tcpHeader, std::min<uint32_t> (tag.GetSegmentSize (), mtu - headerSize), tcpSegments);
+      // Each segment takes the next identification, as if sent on its own
+      uint16_t identification = ipHeader.GetIdentification ();
+      for (std::list<Ptr<Packet> >::iterator it = tcpSegments.begin (); it != tcpSegments.end (); ++it)
+        {
+          ipHeader.SetPayloadSize ((*it)->GetSize ());
+          ipHeader.SetIdentification (identification++);
+          (*it)->AddHeader (ipHeader);
+          segments.push_back (*it);
+        }
+      return true;
+    }
+  else if (protocolNumber == Ipv6L3Protocol::PROT_NUMBER)
+    {
+      Ipv6Header ipHeader;
+      p->RemoveHeader (ipHeader);
+      if (ipHeader.GetNextHeader () != TcpL4Protocol::PROT_NUMBER)
+        { // Extension headers are not handled
+          return false;
+        }
+      TcpHeader tcpHeader;
+      p->RemoveHeader (tcpHeader);
+      uint32_t headerSize = ipHeader.GetSerializedSize () + tcpHeader.GetSerializedSize ();
+      if (mtu <= headerSize)
+        {
+          return false;
+        }
+      if (Node::ChecksumEnabled ())
+        {
+          tcpHeader.EnableChecksums ();
+          tcpHeader.InitializeChecksum (ipHeader.GetSourceAddress (), ipHeader.GetDestinationAddress (),
+                                        TcpL4Protocol::PROT_NUMBER);
+        }
+
+      std::list<Ptr<Packet> > tcpSegments;
+      SegmentData (p, tcpHeader, std::min<uint32_t> (tag.GetSegmentSize (), mtu - headerSize), tcpSegments);
+      for (std::list<Ptr<Packet> >::iterator it = tcpSegments.begin (); it != tcpSegments.end (); ++it)
+        {
+          ipHeader.SetPayloadLength ((*it)->GetSize ());
+          (*it)->AddHeader (ipHeader);
+          segments.push_back (*it);
+        }
+      return true;
+    }
+  return false;
+}
+
+uint32_t
+TcpSegmentationOffload::GetSegmentCount (Ptr<const Packet> packet, uint16_t protocolNumber, uint16_t mtu) const
+{
+  NS_LOG_FUNCTION (this << packet << protocolNumber << mtu);
+
+  LargeSendTag tag;
+  if (!packet->PeekPacketTag (tag) || tag.GetSegmentSize () == 0)
+    {
+      return 0;
+    }
+  Ptr<Packet> p = packet->Copy ();
+  uint32_t headerSize = 0;
+  if (protocolNumber == Ipv4L3Protocol::PROT_NUMBER)
+    {
+      Ipv4Header ipHeader;
+      p->RemoveHeader (ipHeader);
+      if (ipHeader.GetProtocol () != TcpL4Protocol::PROT_NUMBER)
+        {
+          return 0;
+        }
+      headerSize = ipHeader.GetSerializedSize ();
+    }
+  else if (protocolNumber == Ipv6L3Protocol::PROT_NUMBER)
+    {
+      Ipv6Header ipHeader;
+      p->RemoveHeader (ipHeader);
+      if (ipHeader.GetNextHeader () != TcpL4Protocol::PROT_NUMBER)
+        {
+          return 0;
+        }
+      headerSize = ipHeader.GetSerializedSize ();
+    }
+  else
+    {
+      return 0;
+    }
+  TcpHeader tcpHeader;
+  p->RemoveHeader (tcpHeader);
+  headerSize += tcpHeader.GetSerializedSize ();
+  if (mtu <= headerSize)
+    {
+      return 0;
+    }
+  uint32_t segmentSize = std::min<uint32_t> (tag.GetSegmentSize (), mtu - headerSize);
+  return (p->GetSize () + segmentSize - 1) / segmentSize;
+}
+
+void
+TcpSegmentationOffload::SegmentData (Ptr<Packet> data, const TcpHeader &tcpHeader, uint32_t segmentSize,
+                                     std::list<Ptr<Packet> > &segments) const
+{
+  NS_LOG_FUNCTION (this << data << tcpHeader << segmentSize);
+  NS_ASSERT (segmentSize > 0);
+
+  uint32_t size = data->GetSize ();
+  for (uint32_t offset = 0; offset < size; offset += segmentSize)
+    {
+      uint32_t length = std::min (segmentSize, size - offset);
+      Ptr<Packet> segment = data->CreateFragment (offset, length);
+      TcpHeader header = tcpHeader;
+      header.SetSequenceNumber (tcpHeader.GetSequenceNumber () + SequenceNumber32 (offset));
+      if (offset + length < size)
+        { // Only the last segment closes the connection
+          header.SetFlags (tcpHeader.GetFlags () & ~TcpHeader::FIN);
+        }
+      segment->AddHeader (header);
+      segments.push_back (segment);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,75 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_SEGMENTATION_OFFLOAD_H
+#define TCP_SEGMENTATION_OFFLOAD_H
+
+#include "ns3/segmentation-offload.h"
+
+namespace ns3 {
+
+class Ipv4Header;
+class Ipv6Header;
+class TcpHeader;
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Splits the TCP large sends of a node into segments
+ *
+ * TcpSocketBase hands down, when its LargeSend attribute is set, several
+ * segments of data at once behind a single TCP header, tagged with a
+ * LargeSendTag. This class, which TcpL4Protocol aggregates to the node,
+ * rebuilds the segments: each gets a copy of the IPv4 or IPv6 header
+ * and of the TCP header, with the payload length, the IPv4 identification
+ * and the sequence number of the segment. The FIN flag is kept on the
+ * last segment only. The segments are thus the ones the socket would
+ * have sent one by one, but for the RTT samples and traces of the socket,
+ * and for the queues and byte tags they went through as a large send
+ * (see SegmentationOffload).
+ */
+class TcpSegmentationOffload : public SegmentationOffload
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpSegmentationOffload ();
+  virtual ~TcpSegmentationOffload ();
+
+  virtual bool Segment (Ptr<const Packet> packet, uint16_t protocolNumber, uint16_t mtu,
+                        std::list<Ptr<Packet> > &segments) const;
+  virtual uint32_t GetSegmentCount (Ptr<const Packet> packet, uint16_t protocolNumber, uint16_t mtu) const;
+
+private:
+  /**
+   * \brief Split the data of a large send behind its TCP header.
+   * \param data the data, with the TCP header removed
+   * \param tcpHeader the TCP header of the large send
+   * \param segmentSize the size of the data of each segment
+   * \param segments the list to which the segments are appended, with
+   * their TCP header only
+   */
+  void SegmentData (Ptr<Packet> data, const TcpHeader &tcpHeader, uint32_t segmentSize,
+                    std::list<Ptr<Packet> > &segments) const;
+};
+
+} // namespace ns3
+
+#endif /* TCP_SEGMENTATION_OFFLOAD_H */
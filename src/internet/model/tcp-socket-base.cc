@@ -40,6 +40,7 @@
 #include "ns3/uinteger.h"
 #include "ns3/double.h"
 #include "ns3/pointer.h"
+#include "ns3/segmentation-offload.h"
 #include "ns3/trace-source-accessor.h"
 #include "tcp-socket-base.h"
 #include "tcp-l4-protocol.h"
@@ -49,6 +50,8 @@
 #include "tcp-header.h"
 #include "tcp-option-winscale.h"
 #include "tcp-option-ts.h"
+#include "tcp-option-sack-permitted.h"
+#include "tcp-option-sack.h"
 #include "rtt-estimator.h"
 
 #include <math.h>
@@ -95,6 +98,23 @@ TcpSocketBase::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&TcpSocketBase::m_timestampEnabled),
                    MakeBooleanChecker ())
+    .AddAttribute ("Sack", "Enable or disable the selective acknowledgment (SACK) option",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpSocketBase::m_sackEnabled),
+                   MakeBooleanChecker ())
+    .AddAttribute ("LargeSend",
+                   "Largest amount of data handed down at once, in several segments which "
+                   "the NetDevice splits (segmentation offload), or 0 to send segment by segment",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&TcpSocketBase::m_largeSend),
+                   MakeUintegerChecker<uint32_t> (0, 65000))
+    .AddAttribute ("Pacing",
+                   "Pace the data over the RTT, in bursts sent by a per-socket timer, "
+                   "instead of sending the whole window at once. TcpBbr, which relies "
+                   "on pacing, sets it when it connects or listens, whatever its value",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpSocketBase::m_pacing),
+                   MakeBooleanChecker ())
     .AddAttribute ("MinRto",
                    "Minimum retransmit timeout value",
                    TimeValue (Seconds (0.2)), // RFC2988 says min RTO=1 sec, but Linux uses 200ms. See http://www.postel.org/pipermail/end2end-interest/2004-November/004402.html
@@ -166,12 +186,16 @@ TcpSocketBase::TcpSocketBase (void)
     m_shutdownRecv (false),
     m_connected (false),
     m_segmentSize (0),
+    m_largeSend (0),
+    m_pacing (false),
     // For attribute initialization consistency (quiet valgrind)
     m_rWnd (0),
     m_sndScaleFactor (0),
     m_rcvScaleFactor (0),
     m_timestampEnabled (true),
-    m_timestampToEcho (0)
+    m_timestampToEcho (0),
+    m_sackEnabled (false),
+    m_highRxt (0)
 
 {
   NS_LOG_FUNCTION (this);
@@ -207,12 +231,16 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_msl (sock.m_msl),
     m_segmentSize (sock.m_segmentSize),
     m_maxWinSize (sock.m_maxWinSize),
+    m_largeSend (sock.m_largeSend),
+    m_pacing (sock.m_pacing),
     m_rWnd (sock.m_rWnd),
     m_winScalingEnabled (sock.m_winScalingEnabled),
     m_sndScaleFactor (sock.m_sndScaleFactor),
     m_rcvScaleFactor (sock.m_rcvScaleFactor),
     m_timestampEnabled (sock.m_timestampEnabled),
-    m_timestampToEcho (sock.m_timestampToEcho)
+    m_timestampToEcho (sock.m_timestampToEcho),
+    m_sackEnabled (sock.m_sackEnabled),
+    m_highRxt (sock.m_highRxt)
 
 {
   NS_LOG_FUNCTION (this);
@@ -1919,13 +1947,23 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
   NS_LOG_FUNCTION (this << seq << maxSize << withAck);
 
   bool isRetransmission = false;
-  if ( seq == m_txBuffer->HeadSequence () )
+  if (seq == m_txBuffer->HeadSequence ())
     {
       isRetransmission = true;
     }
+  else if (m_sackEnabled && seq < m_highTxMark)
+    { // A hole of the SACK scoreboard
+      isRetransmission = true;
+    }
 
   Ptr<Packet> p = m_txBuffer->CopyFromSequence (maxSize, seq);
   uint32_t sz = p->GetSize (); // Size of packet
+  if (sz > m_segmentSize)
+    { // A large send, split into segments by the NetDevice or the IP layer
+      LargeSendTag largeSendTag;
+      largeSendTag.SetSegmentSize (m_segmentSize);
+      p->AddPacketTag (largeSendTag);
+    }
   uint8_t flags = withAck ? TcpHeader::ACK : 0;
   uint32_t remainingData = m_txBuffer->SizeFromSequence (seq + SequenceNumber32 (sz));
 
@@ -2071,9 +2109,36 @@ TcpSocketBase::SendPendingData (bool withAck)
       return false; // Is this the right way to handle this condition?
     }
   uint32_t nPacketsSent = 0;
+  uint32_t retxBytes = 0;
+  if (m_sackEnabled && m_txBuffer->GetSackedBytes () > 0)
+    { // Retransmit the lost holes before any new data
+      retxBytes = SendLostHoles (AvailableWindow (), withAck);
+    }
+  // With pacing, no more than a quantum of new data goes out at once, and
+  // the pacing timer sends the next quantum once the rate allows it. When
+  // the window runs out first, the ACKs clock the data out as usual.
+  DataRate pacingRate;
+  uint32_t quantum = 0;
+  uint32_t pacedBytes = 0;
+  if (m_pacing)
+    {
+      if (m_pacingEvent.IsRunning ())
+        {
+          NS_LOG_LOGIC ("Pacing. Wait for the next burst.");
+          return (retxBytes > 0);
+        }
+      pacingRate = GetPacingRate ();
+      // Quantum of 1 ms at the pacing rate, from 2 segments to 64 KB
+      quantum = std::min<uint64_t> (pacingRate.GetBitRate () / 8000, 65536);
+      if (quantum > 0)
+        {
+          quantum = std::max (quantum, 2 * m_segmentSize);
+        }
+    }
   while (m_txBuffer->SizeFromSequence (m_nextTxSequence))
     {
       uint32_t w = AvailableWindow (); // Get available window size
+      w -= std::min (w, retxBytes);    // Less the retransmitted holes
       NS_LOG_LOGIC ("TcpSocketBase " << this << " SendPendingData" <<
                     " w " << w <<
                     " rxwin " << m_rWnd <<
@@ -2096,12 +2161,60 @@ TcpSocketBase::SendPendingData (bool withAck)
           break;
         }
       uint32_t s = std::min (w, m_segmentSize);  // Send no more than window
+      uint32_t available = m_txBuffer->SizeFromSequence (m_nextTxSequence);
+      if (m_largeSend >= 2 * m_segmentSize && w >= 2 * m_segmentSize && available >= 2 * m_segmentSize)
+        { // Hand down as many whole segments as possible at once, the rest
+          // goes through the checks above on the next round
+          s = std::min (std::min (w, available), m_largeSend) / m_segmentSize * m_segmentSize;
+        }
+      if (quantum > 0)
+        { // Keep the large sends within what is left of the quantum
+          s = std::min (s, std::max (m_segmentSize, (quantum - pacedBytes) / m_segmentSize * m_segmentSize));
+        }
       uint32_t sz = SendDataPacket (m_nextTxSequence, s, withAck);
       nPacketsSent++;                             // Count sent this loop
       m_nextTxSequence += sz;                     // Advance next tx sequence
+      pacedBytes += sz;
+      if (quantum > 0 && pacedBytes >= quantum)
+        { // One timer event per burst, rather than one per segment
+          Time gap = Seconds (pacingRate.CalculateTxTime (pacedBytes));
+          NS_LOG_LOGIC ("Paced " << pacedBytes << " bytes at " << pacingRate << ", next burst in " << gap);
+          m_pacingEvent = Simulator::Schedule (gap, &TcpSocketBase::PacingTimeout, this);
+          break;
+        }
     }
   NS_LOG_LOGIC ("SendPendingData sent " << nPacketsSent << " packets");
-  return (nPacketsSent > 0);
+  return (nPacketsSent > 0 || retxBytes > 0);
+}
+
+uint32_t
+TcpSocketBase::SendLostHoles (uint32_t window, bool withAck)
+{
+  NS_LOG_FUNCTION (this << window << withAck);
+  uint32_t sent = 0;
+  // The holes below HighRxt have been retransmitted already, and the ones
+  // beyond SND.NXT are sent as new data
+  SequenceNumber32 seq = std::max (m_highRxt, m_txBuffer->HeadSequence ());
+  uint32_t size;
+  // A hole is lost when more than (DupThresh - 1) * SMSS bytes above it
+  // are SACKed, DupThresh being 3 (RFC 6675, IsLost ())
+  while ((size = m_txBuffer->GetLostHole (seq, 2 * m_segmentSize)) > 0
+         && seq < m_nextTxSequence)
+    {
+      uint32_t s = std::min (std::min (size, m_segmentSize),
+                             static_cast<uint32_t> (m_nextTxSequence.Get () - seq));
+      if (sent + s > window)
+        {
+          break;
+        }
+      NS_LOG_LOGIC ("TcpSocketBase " << this << " retxing lost hole at seq " << seq);
+      uint32_t sz = SendDataPacket (seq, s, withAck);
+      sent += sz;
+      seq += sz;
+      m_highRxt = seq;
+    }
+  NS_LOG_LOGIC ("SendLostHoles retransmitted " << sent << " bytes");
+  return sent;
 }
 
 uint32_t
@@ -2125,6 +2238,17 @@ TcpSocketBase::Window ()
   return m_rWnd;
 }
 
+DataRate
+TcpSocketBase::GetPacingRate ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_rtt == 0 || m_lastRtt.Get ().IsZero ())
+    {
+      return DataRate (0);
+    }
+  return DataRate (static_cast<uint64_t> (1.2 * Window () * 8 / m_rtt->GetEstimate ().GetSeconds ()));
+}
+
 uint32_t
 TcpSocketBase::AvailableWindow ()
 {
@@ -2258,6 +2382,7 @@ TcpSocketBase::EstimateRtt (const TcpHeader& tcpHeader)
       m_lastRtt = m_rtt->GetEstimate ();
       NS_LOG_FUNCTION(this << m_lastRtt);
     }
+  m_lastRttSample = m;
 }
 
 // Called by the ReceivedAck() when new ACK received and by ProcessSynRcvd()
@@ -2298,6 +2423,7 @@ TcpSocketBase::NewAck (SequenceNumber32 const& ack)
   NS_LOG_LOGIC ("TCP " << this << " NewAck " << ack <<
                 " numberAck " << (ack - m_txBuffer->HeadSequence ())); // Number bytes ack'ed
   m_txBuffer->DiscardUpTo (ack);
+  m_highRxt = std::max (m_highRxt, ack);
   if (GetTxAvailable () > 0)
     {
       NotifySend (GetTxAvailable ());
@@ -2332,6 +2458,12 @@ TcpSocketBase::ReTxTimeout ()
     {
       return;
     }
+  // The SACK information is not relied upon after a timeout (RFC 2018, sec.8)
+  if (m_sackEnabled)
+    {
+      m_txBuffer->ResetScoreboard ();
+      m_highRxt = m_txBuffer->HeadSequence ();
+    }
 
   Retransmit ();
 }
@@ -2400,6 +2532,13 @@ TcpSocketBase::PersistTimeout ()
   m_persistEvent = Simulator::Schedule (m_persistTimeout, &TcpSocketBase::PersistTimeout, this);
 }
 
+void
+TcpSocketBase::PacingTimeout ()
+{
+  NS_LOG_FUNCTION (this);
+  SendPendingData (m_connected);
+}
+
 void
 TcpSocketBase::Retransmit ()
 {
@@ -2434,11 +2573,18 @@ TcpSocketBase::DoRetransmit ()
         }
       return;
     }
+  // With SACK, the oldest packet may have been retransmitted as a hole already
+  if (m_sackEnabled && m_txBuffer->HeadSequence () < m_highRxt)
+    {
+      NS_LOG_LOGIC ("TcpSocketBase " << this << " seq " << m_txBuffer->HeadSequence () << " already retransmitted");
+      return;
+    }
   // Retransmit a data packet: Call SendDataPacket
   NS_LOG_LOGIC ("TcpSocketBase " << this << " retxing seq " << m_txBuffer->HeadSequence ());
   uint32_t sz = SendDataPacket (m_txBuffer->HeadSequence (), m_segmentSize, true);
   // In case of RTO, advance m_nextTxSequence
   m_nextTxSequence = std::max (m_nextTxSequence.Get (), m_txBuffer->HeadSequence () + sz);
+  m_highRxt = std::max (m_highRxt, m_txBuffer->HeadSequence () + sz);
 
 }
 
@@ -2450,6 +2596,7 @@ TcpSocketBase::CancelAllTimers ()
   m_delAckEvent.Cancel ();
   m_lastAckEvent.Cancel ();
   m_timewaitEvent.Cancel ();
+  m_pacingEvent.Cancel ();
 }
 
 /* Move TCP to Time_Wait state and schedule a transition to Closed state */
@@ -2606,6 +2753,15 @@ TcpSocketBase::ReadOptions (const TcpHeader& header)
               ProcessOptionWScale (header.GetOption (TcpOption::WINSCALE));
             }
         }
+
+      if (m_sackEnabled)
+        {
+          m_sackEnabled = header.HasOption (TcpOption::SACKPERMITTED);
+        }
+    }
+  else if (m_sackEnabled && header.HasOption (TcpOption::SACK))
+    {
+      ProcessOptionSack (header.GetOption (TcpOption::SACK));
     }
 
   m_timestampEnabled = false;
@@ -2628,10 +2784,22 @@ TcpSocketBase::AddOptions (TcpHeader& header)
       AddOptionWScale (header);
     }
 
+  // The SACK permitted option is set only on SYN packets
+  if (m_sackEnabled && (header.GetFlags () & TcpHeader::SYN))
+    {
+      AddOptionSackPermitted (header);
+    }
+
   if (m_timestampEnabled)
     {
       AddOptionTimestamp (header);
     }
+
+  // The SACK option takes the space left by the other options
+  if (m_sackEnabled && (header.GetFlags () & (TcpHeader::SYN | TcpHeader::ACK)) == TcpHeader::ACK)
+    {
+      AddOptionSack (header);
+    }
 }
 
 void
@@ -2726,6 +2894,64 @@ TcpSocketBase::AddOptionTimestamp (TcpHeader& header)
                option->GetTimestamp () << " echo=" << m_timestampToEcho);
 }
 
+void
+TcpSocketBase::ProcessOptionSack (const Ptr<const TcpOption> option)
+{
+  NS_LOG_FUNCTION (this << option);
+
+  Ptr<const TcpOptionSack> sack = DynamicCast<const TcpOptionSack> (option);
+  const TcpOptionSack::SackList& blocks = sack->GetSackList ();
+  for (TcpOptionSack::SackList::const_iterator it = blocks.begin (); it != blocks.end (); ++it)
+    {
+      // Do not trust SACKs of data never sent
+      m_txBuffer->AddSackBlock (it->first, std::min (it->second, m_highTxMark.Get ()));
+    }
+
+  NS_LOG_INFO (m_node->GetId () << " Got " << blocks.size () << " SACK blocks, " <<
+               m_txBuffer->GetSackedBytes () << " bytes SACKed");
+}
+
+void
+TcpSocketBase::AddOptionSackPermitted (TcpHeader& header)
+{
+  NS_LOG_FUNCTION (this << header);
+  NS_ASSERT (header.GetFlags () & TcpHeader::SYN);
+
+  Ptr<TcpOptionSackPermitted> option = CreateObject<TcpOptionSackPermitted> ();
+  header.AppendOption (option);
+}
+
+void
+TcpSocketBase::AddOptionSack (TcpHeader& header)
+{
+  NS_LOG_FUNCTION (this << header);
+
+  // Option space left, the header length being rounded up to words
+  uint32_t room = 40 - (header.GetLength () * 4 - 20);
+  if (room < 10)
+    {
+      return;
+    }
+  uint32_t maxBlocks = (room - 2) / 8;
+  if (maxBlocks > TcpOptionSack::MAX_SACK_BLOCKS)
+    {
+      maxBlocks = TcpOptionSack::MAX_SACK_BLOCKS;
+    }
+  TcpRxBuffer::SackList blocks = m_rxBuffer->GetSackList (maxBlocks);
+  if (blocks.empty ())
+    {
+      return;
+    }
+
+  Ptr<TcpOptionSack> option = CreateObject<TcpOptionSack> ();
+  for (TcpRxBuffer::SackList::const_iterator it = blocks.begin (); it != blocks.end (); ++it)
+    {
+      option->AddSackBlock (*it);
+    }
+  header.AppendOption (option);
+  NS_LOG_INFO (m_node->GetId () << " Add option SACK, " << blocks.size () << " blocks");
+}
+
 void
 TcpSocketBase::SetMinRto (Time minRto)
 {
@@ -33,6 +33,7 @@
 #include "ns3/ipv6-header.h"
 #include "ns3/ipv6-interface.h"
 #include "ns3/event-id.h"
+#include "ns3/data-rate.h"
 #include "tcp-tx-buffer.h"
 #include "tcp-rx-buffer.h"
 #include "rtt-estimator.h"
@@ -343,6 +344,16 @@ protected:
    */
   bool SendPendingData (bool withAck = false);
 
+  /**
+   * \brief Retransmit the holes of the SACK scoreboard which are deemed
+   *        lost and have not been retransmitted yet (RFC 6675, NextSeg () rule 1)
+   *
+   * \param window the number of bytes which may be sent
+   * \param withAck forces an ACK to be sent
+   * \returns the number of bytes retransmitted
+   */
+  uint32_t SendLostHoles (uint32_t window, bool withAck);
+
   /**
    * \brief Extract at most maxSize bytes from the TxBuffer at sequence seq, add the
    *        TCP header, and send to TcpL4Protocol
@@ -532,6 +543,16 @@ protected:
    */
   virtual uint16_t AdvertisedWindowSize (void);
 
+  /**
+   * \brief The rate at which the data is paced when the Pacing attribute is set
+   *
+   * The default spreads the window over the smoothed RTT, 20% faster so
+   * that the pacing does not hold back the growth of the window.
+   *
+   * \returns the pacing rate, or 0 bps to send unpaced (no RTT sample yet)
+   */
+  virtual DataRate GetPacingRate (void);
+
 
   // Manage data tx/rx
 
@@ -599,6 +620,11 @@ protected:
    */
   virtual void PersistTimeout (void);
 
+  /**
+   * \brief Send the next burst of paced data
+   */
+  virtual void PacingTimeout (void);
+
   /**
    * \brief Retransmit the oldest packet
    */
@@ -675,6 +701,31 @@ protected:
    */
   void AddOptionTimestamp (TcpHeader& header);
 
+  /**
+   * \brief Process the SACK option from other side
+   *
+   * Mark the blocks reported by the other side as SACKed in the Tx buffer.
+   *
+   * \param option Option from the packet
+   */
+  void ProcessOptionSack (const Ptr<const TcpOption> option);
+  /**
+   * \brief Add the SACK permitted option to the header
+   *
+   * \param header TcpHeader of a SYN packet
+   */
+  void AddOptionSackPermitted (TcpHeader& header);
+  /**
+   * \brief Add the SACK option to the header, if there is out-of-order data
+   *        in the Rx buffer
+   *
+   * Report as many blocks of out-of-order data as fit in the option space
+   * left by the other options.
+   *
+   * \param header TcpHeader to which add the option to
+   */
+  void AddOptionSack (TcpHeader& header);
+
 
 protected:
   // Counters and events
@@ -683,6 +734,7 @@ protected:
   EventId           m_delAckEvent;     //!< Delayed ACK timeout event
   EventId           m_persistEvent;    //!< Persist event: Send 1 byte to probe for a non-zero Rx window
   EventId           m_timewaitEvent;   //!< TIME_WAIT expiration event: Move this socket to CLOSED state
+  EventId           m_pacingEvent;     //!< Pacing event: Send the next burst of paced data
   uint32_t          m_dupAckCount;     //!< Dupack counter
   uint32_t          m_delAckCount;     //!< Delayed ACK counter
   uint32_t          m_delAckMaxCount;  //!< Number of packet to fire an ACK before delay timeout
@@ -693,6 +745,7 @@ protected:
   Time              m_minRto;          //!< minimum value of the Retransmit timeout
   Time              m_clockGranularity; //!< Clock Granularity used in RTO calcs
   TracedValue<Time> m_lastRtt;         //!< Last RTT sample collected
+  Time              m_lastRttSample;   //!< RTT measured on the last ACK, zero if none
   Time              m_delAckTimeout;   //!< Time to delay an ACK
   Time              m_persistTimeout;  //!< Time between sending 1-byte probes
   Time              m_cnTimeout;       //!< Timeout for connection retry
@@ -727,6 +780,8 @@ protected:
   // Window management
   uint32_t              m_segmentSize; //!< Segment size
   uint16_t              m_maxWinSize;  //!< Maximum window size to advertise
+  uint32_t              m_largeSend;   //!< Largest send handed down at once, 0 if disabled
+  bool                  m_pacing;      //!< Pace the data at GetPacingRate ()
   TracedValue<uint32_t> m_rWnd;        //!< Flow control window at remote side
 
   // Options
@@ -736,6 +791,9 @@ protected:
 
   bool     m_timestampEnabled;    //!< Timestamp option enabled
   uint32_t m_timestampToEcho;     //!< Timestamp to echo
+
+  bool             m_sackEnabled; //!< SACK option enabled
+  SequenceNumber32 m_highRxt;     //!< Highest seqno retransmitted from the SACK scoreboard (HighRxt)
 };
 
 } // namespace ns3
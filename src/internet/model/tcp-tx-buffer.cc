@@ -56,7 +56,7 @@ TcpTxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpTxBuffer::TcpTxBuffer (uint32_t n)
-  : m_firstByteSeq (n), m_size (0), m_maxBuffer (32768), m_data (0)
+  : m_firstByteSeq (n), m_size (0), m_maxBuffer (32768), m_sackedBytes (0)
 {
 }
 
@@ -110,7 +110,7 @@ TcpTxBuffer::Add (Ptr<Packet> p)
     {
       if (p->GetSize () > 0)
         {
-          m_data.push_back (p);
+          m_data.insert (m_data.end (), std::make_pair (TailSequence (), p));
           m_size += p->GetSize ();
           NS_LOG_LOGIC ("Updated size=" << m_size << ", lastSeq=" << m_firstByteSeq + SequenceNumber32 (m_size));
         }
@@ -146,56 +146,34 @@ TcpTxBuffer::CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq)
       return Create<Packet> (s);
     }
 
-  // Extract data from the buffer and return
-  uint32_t offset = seq - m_firstByteSeq.Get ();
-  uint32_t count = 0;      // Offset of the first byte of a packet in the buffer
-  uint32_t pktSize = 0;
-  bool beginFound = false;
-  int pktCount = 0;
-  Ptr<Packet> outPacket;
-  NS_LOG_LOGIC ("There are " << m_data.size () << " number of packets in buffer");
-  for (BufIterator i = m_data.begin (); i != m_data.end (); ++i)
+  // The first byte is in the last packet which starts at or before it
+  BufIterator i = m_data.upper_bound (seq);
+  NS_ASSERT (i != m_data.begin ());
+  --i;
+  uint32_t packetOffset = seq - i->first;
+  uint32_t fragmentLength = i->second->GetSize () - packetOffset;
+  NS_LOG_LOGIC ("First byte found in packet of seqno " << i->first << ", packet len=" << i->second->GetSize ());
+  if (fragmentLength >= s)
+    { // Data to be copied falls entirely in this packet
+      return i->second->CreateFragment (packetOffset, s);
+    }
+  // This packet only fulfills part of the request
+  Ptr<Packet> outPacket = i->second->CreateFragment (packetOffset, fragmentLength);
+  uint32_t remaining = s - fragmentLength;
+  for (++i; remaining > 0; ++i)
     {
-      pktCount++;
-      pktSize = (*i)->GetSize ();
-      if (!beginFound)
-        { // Look for first fragment
-          if (count + pktSize > offset)
-            {
-              NS_LOG_LOGIC ("First byte found in packet #" << pktCount << " at buffer offset " << count
-                                                           << ", packet len=" << pktSize);
-              beginFound = true;
-              uint32_t packetOffset = offset - count;
-              uint32_t fragmentLength = count + pktSize - offset;
-              if (fragmentLength >= s)
-                { // Data to be copied falls entirely in this packet
-                  return (*i)->CreateFragment (packetOffset, s);
-                }
-              else
-                { // This packet only fulfills part of the request
-                  outPacket = (*i)->CreateFragment (packetOffset, fragmentLength);
-                }
-              NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
-            }
-        }
-      else if (count + pktSize >= offset + s)
+      NS_ASSERT (i != m_data.end ());
+      uint32_t pktSize = i->second->GetSize ();
+      if (pktSize >= remaining)
         { // Last packet fragment found
-          NS_LOG_LOGIC ("Last byte found in packet #" << pktCount << " at buffer offset " << count
-                                                      << ", packet len=" << pktSize);
-          uint32_t fragmentLength = offset + s - count;
-          Ptr<Packet> endFragment = (*i)->CreateFragment (0, fragmentLength);
-          outPacket->AddAtEnd (endFragment);
-          NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
+          outPacket->AddAtEnd (pktSize == remaining ? i->second : i->second->CreateFragment (0, remaining));
+          remaining = 0;
           break;
         }
-      else
-        {
-          NS_LOG_LOGIC ("Appending to output the packet #" << pktCount << " of offset " << count << " len=" << pktSize);
-          outPacket->AddAtEnd (*i);
-          NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
-        }
-      count += pktSize;
+      outPacket->AddAtEnd (i->second);
+      remaining -= pktSize;
     }
+  NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
   NS_ASSERT (outPacket->GetSize () == s);
   return outPacket;
 }
@@ -204,6 +182,13 @@ void
 TcpTxBuffer::SetHeadSequence (const SequenceNumber32& seq)
 {
   NS_LOG_FUNCTION (this << seq);
+  // Renumber the data buffered before the connection was set up
+  std::map<SequenceNumber32, Ptr<Packet> > data;
+  for (BufIterator i = m_data.begin (); i != m_data.end (); ++i)
+    {
+      data.insert (data.end (), std::make_pair (seq + (i->first - m_firstByteSeq.Get ()), i->second));
+    }
+  m_data.swap (data);
   m_firstByteSeq = seq;
 }
 
@@ -216,40 +201,135 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
   // Cases do not need to scan the buffer
   if (m_firstByteSeq >= seq) return;
 
-  // Scan the buffer and discard packets
-  uint32_t offset = seq - m_firstByteSeq.Get ();  // Number of bytes to remove
-  uint32_t pktSize;
-  NS_LOG_LOGIC ("Offset=" << offset);
+  // Remove the packets which are behind the seqnum. The first remaining
+  // packet is left whole: the data before the head is skipped on copy
   BufIterator i = m_data.begin ();
-  while (i != m_data.end ())
+  while (i != m_data.end () && i->first + SequenceNumber32 (i->second->GetSize ()) <= seq)
+    {
+      NS_LOG_LOGIC ("Removed one packet of seqno " << i->first << ", size " << i->second->GetSize ());
+      m_data.erase (i++);
+    }
+  // The seqnum is past the data when ACKing a FIN
+  uint32_t offset = seq - m_firstByteSeq.Get ();  // Number of bytes to remove
+  m_size -= std::min (offset, m_size);
+  m_firstByteSeq = seq;
+
+  // Forget the SACKed blocks behind the seqnum
+  SackIterator j = m_sacked.begin ();
+  while (j != m_sacked.end () && j->first < seq)
     {
-      if (offset > (*i)->GetSize ())
-        { // This packet is behind the seqnum. Remove this packet from the buffer
-          pktSize = (*i)->GetSize ();
-          m_size -= pktSize;
-          offset -= pktSize;
-          m_firstByteSeq += pktSize;
-          i = m_data.erase (i);
-          NS_LOG_LOGIC ("Removed one packet of size " << pktSize << ", offset=" << offset);
+      if (j->second <= seq)
+        {
+          m_sackedBytes -= j->second - j->first;
+          m_sacked.erase (j++);
         }
-      else if (offset > 0)
-        { // Part of the packet is behind the seqnum. Fragment
-          pktSize = (*i)->GetSize () - offset;
-          *i = (*i)->CreateFragment (offset, pktSize);
-          m_size -= offset;
-          m_firstByteSeq += offset;
-          NS_LOG_LOGIC ("Fragmented one packet by size " << offset << ", new size=" << pktSize);
+      else
+        {
+          SequenceNumber32 tail = j->second;
+          m_sackedBytes -= seq - j->first;
+          m_sacked.erase (j);
+          m_sacked[seq] = tail;
           break;
         }
     }
-  // Catching the case of ACKing a FIN
-  if (m_size == 0)
+  NS_LOG_LOGIC ("size=" << m_size << " headSeq=" << m_firstByteSeq << " maxBuffer=" << m_maxBuffer
+                        <<" numPkts="<< m_data.size () << " sacked=" << m_sackedBytes);
+}
+
+bool
+TcpTxBuffer::AddSackBlock (const SequenceNumber32& head, const SequenceNumber32& tail)
+{
+  NS_LOG_FUNCTION (this << head << tail);
+  SequenceNumber32 first = std::max (head, m_firstByteSeq.Get ());
+  SequenceNumber32 last = std::min (tail, TailSequence ());
+  if (last <= first)
+    {
+      NS_LOG_LOGIC ("Block out of the buffer");
+      return false;
+    }
+
+  // Merge the block with the blocks it overlaps or is adjacent to
+  uint32_t sackedBytes = m_sackedBytes;
+  SackIterator i = m_sacked.upper_bound (first);
+  if (i != m_sacked.begin ())
     {
-      m_firstByteSeq = seq;
+      SackIterator prev = i;
+      --prev;
+      if (prev->second >= first)
+        {
+          first = prev->first;
+          i = prev;
+        }
     }
-  NS_LOG_LOGIC ("size=" << m_size << " headSeq=" << m_firstByteSeq << " maxBuffer=" << m_maxBuffer
-                        <<" numPkts="<< m_data.size ());
-  NS_ASSERT (m_firstByteSeq == seq);
+  while (i != m_sacked.end () && i->first <= last)
+    {
+      last = std::max (last, i->second);
+      m_sackedBytes -= i->second - i->first;
+      m_sacked.erase (i++);
+    }
+  m_sacked[first] = last;
+  m_sackedBytes += last - first;
+  NS_LOG_LOGIC ("SACKed block [" << first << ";" << last << "), sacked=" << m_sackedBytes);
+  return m_sackedBytes > sackedBytes;
+}
+
+uint32_t
+TcpTxBuffer::GetSackedBytes (void) const
+{
+  return m_sackedBytes;
+}
+
+bool
+TcpTxBuffer::IsSacked (const SequenceNumber32& seq) const
+{
+  SackConstIterator i = m_sacked.upper_bound (seq);
+  if (i == m_sacked.begin ())
+    {
+      return false;
+    }
+  --i;
+  return seq < i->second;
+}
+
+uint32_t
+TcpTxBuffer::GetLostHole (SequenceNumber32& seq, uint32_t threshold) const
+{
+  NS_LOG_FUNCTION (this << seq << threshold);
+  SequenceNumber32 first = std::max (seq, m_firstByteSeq.Get ());
+  SackConstIterator i = m_sacked.upper_bound (first);
+  if (i != m_sacked.begin ())
+    {
+      SackConstIterator prev = i;
+      --prev;
+      if (first < prev->second)
+        { // Skip the SACKed block
+          first = prev->second;
+        }
+    }
+  if (i == m_sacked.end ())
+    { // Nothing SACKed above
+      return 0;
+    }
+  // The hole is up to the next SACKed block
+  uint32_t sackedAbove = 0;
+  for (SackConstIterator j = i; j != m_sacked.end (); ++j)
+    {
+      sackedAbove += j->second - j->first;
+    }
+  if (sackedAbove <= threshold)
+    {
+      return 0;
+    }
+  seq = first;
+  return i->first - first;
+}
+
+void
+TcpTxBuffer::ResetScoreboard (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_sacked.clear ();
+  m_sackedBytes = 0;
 }
 
 } // namepsace ns3
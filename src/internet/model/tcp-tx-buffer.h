@@ -21,7 +21,7 @@
 #ifndef TCP_TX_BUFFER_H
 #define TCP_TX_BUFFER_H
 
-#include <list>
+#include <map>
 #include "ns3/traced-value.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/object.h"
@@ -36,6 +36,13 @@ class Packet;
  *
  * \brief class for keeping the data sent by the application to the TCP socket, i.e.
  *        the sending buffer.
+ *
+ * The packets of the buffer are indexed by the sequence number of their
+ * first byte, so that the data of any sequence number is found in
+ * logarithmic time and copied out as fragments of the stored packets.
+ * The buffer also keeps the scoreboard of the data selectively
+ * acknowledged (SACKed) by the receiver (\RFC{2018}), as disjoint blocks
+ * of sequence numbers.
  */
 class TcpTxBuffer : public Object
 {
@@ -127,14 +134,61 @@ public:
    */
   void DiscardUpTo (const SequenceNumber32& seq);
 
+  /**
+   * Mark the data of a block reported by the receiver as SACKed. The
+   * block is clipped to the data of the buffer.
+   *
+   * \param head the sequence number of the first byte of the block
+   * \param tail the sequence number following the last byte of the block
+   * \returns true if any data was not SACKed yet
+   */
+  bool AddSackBlock (const SequenceNumber32& head, const SequenceNumber32& tail);
+
+  /**
+   * Returns the number of SACKed bytes in the buffer
+   * \returns the number of SACKed bytes in the buffer
+   */
+  uint32_t GetSackedBytes (void) const;
+
+  /**
+   * Check whether a byte has been SACKed
+   * \param seq the sequence number of the byte
+   * \returns true if the byte has been SACKed
+   */
+  bool IsSacked (const SequenceNumber32& seq) const;
+
+  /**
+   * Find the first hole of the scoreboard, at or after a sequence number,
+   * which is deemed lost, that is which has more than a number of SACKed
+   * bytes above it (\RFC{6675}, IsLost ()).
+   *
+   * \param seq the sequence number from which to search; set to the first
+   *        byte of the hole when one is found
+   * \param threshold the number of SACKed bytes
+   * \returns the size of the hole, or 0 if there is no lost hole
+   */
+  uint32_t GetLostHole (SequenceNumber32& seq, uint32_t threshold) const;
+
+  /**
+   * Forget the data SACKed by the receiver, as after a retransmission
+   * timeout (\RFC{2018}, section 8).
+   */
+  void ResetScoreboard (void);
+
 private:
-  /// container for data stored in the buffer
-  typedef std::list<Ptr<Packet> >::iterator BufIterator;
+  /// container for data stored in the buffer, by sequence number of their first byte
+  typedef std::map<SequenceNumber32, Ptr<Packet> >::iterator BufIterator;
+  /// container for SACKed blocks, from the sequence number of their first byte to the one following their last byte
+  typedef std::map<SequenceNumber32, SequenceNumber32>::iterator SackIterator;
+  /// const iterator of the SACKed blocks
+  typedef std::map<SequenceNumber32, SequenceNumber32>::const_iterator SackConstIterator;
 
   TracedValue<SequenceNumber32> m_firstByteSeq; //!< Sequence number of the first byte in data (SND.UNA)
   uint32_t m_size;                              //!< Number of data bytes
   uint32_t m_maxBuffer;                         //!< Max number of data bytes in buffer (SND.WND)
-  std::list<Ptr<Packet> > m_data;               //!< Corresponding data (may be null)
+  std::map<SequenceNumber32, Ptr<Packet> > m_data; //!< Corresponding data, the first packet may start before the first byte
+  std::map<SequenceNumber32, SequenceNumber32> m_sacked; //!< SACKed blocks, disjoint and not adjacent
+  uint32_t m_sackedBytes;                       //!< Number of SACKed bytes
 };
 
 } // namepsace ns3
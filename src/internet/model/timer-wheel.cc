@@ -0,0 +1,323 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/simulator.h"
+
+#include "timer-wheel.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TimerWheel");
+
+TimerWheel::Link::Link ()
+  : m_prev (0),
+    m_next (0)
+{
+}
+
+TimerWheel::Timer::Timer (TimerWheel *wheel)
+  : m_wheel (wheel),
+    m_expires (0),
+    m_level0 (false)
+{
+}
+
+TimerWheel::Timer::~Timer ()
+{
+  Cancel ();
+}
+
+void
+TimerWheel::Timer::SetFunction (Callback<void> function)
+{
+  m_function = function;
+}
+
+void
+TimerWheel::Timer::Schedule (Time delay)
+{
+  NS_ASSERT_MSG (!IsRunning (), "Timer already running");
+  m_wheel->Start (this, delay);
+}
+
+void
+TimerWheel::Timer::Cancel ()
+{
+  if (IsRunning ())
+    {
+      m_wheel->Remove (this);
+    }
+}
+
+bool
+TimerWheel::Timer::IsRunning () const
+{
+  return m_next != 0;
+}
+
+TimerWheel::TimerWheel ()
+  : m_resolution (MilliSeconds (10)),
+    m_tick (0),
+    m_nTimers (0),
+    m_nLevel0 (0),
+    m_eventTick (0),
+    m_expiring (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TimerWheel::~TimerWheel ()
+{
+  NS_LOG_FUNCTION (this);
+  m_event.Cancel ();
+  // leave the timers which outlive the wheel unlinked
+  for (std::vector<Link>::iterator slot = m_slots.begin (); slot != m_slots.end (); slot++)
+    {
+      Link *link = slot->m_next;
+      while (link != &(*slot))
+        {
+          Link *next = link->m_next;
+          link->m_prev = 0;
+          link->m_next = 0;
+          link = next;
+        }
+    }
+}
+
+void
+TimerWheel::SetResolution (Time resolution)
+{
+  NS_LOG_FUNCTION (this << resolution);
+  NS_ASSERT_MSG (m_nTimers == 0, "Timers running");
+  NS_ASSERT_MSG (resolution.IsStrictlyPositive (), "Resolution must be positive");
+  m_event.Cancel ();
+  m_resolution = resolution;
+  m_tick = GetCurrentTick ();
+}
+
+Time
+TimerWheel::GetResolution () const
+{
+  return m_resolution;
+}
+
+uint32_t
+TimerWheel::GetNTimers () const
+{
+  return m_nTimers;
+}
+
+uint64_t
+TimerWheel::GetCurrentTick () const
+{
+  return Simulator::Now ().GetTimeStep () / m_resolution.GetTimeStep ();
+}
+
+void
+TimerWheel::Start (Timer *timer, Time delay)
+{
+  NS_LOG_FUNCTION (this << timer << delay);
+
+  if (m_slots.empty ())
+    {
+      m_slots.resize (SLOTS * LEVELS);
+      for (std::vector<Link>::iterator slot = m_slots.begin (); slot != m_slots.end (); slot++)
+        {
+          slot->m_prev = &(*slot);
+          slot->m_next = &(*slot);
+        }
+    }
+  if (m_nTimers == 0)
+    {
+      // nothing to process up to now
+      m_tick = GetCurrentTick ();
+    }
+
+  // rounded up, so that the timer never expires early
+  int64_t resolution = m_resolution.GetTimeStep ();
+  uint64_t expires = ((Simulator::Now () + delay).GetTimeStep () + resolution - 1) / resolution;
+  timer->m_expires = std::max (expires, m_tick + 1);
+  m_nTimers++;
+  Insert (timer);
+
+  if (!m_expiring)
+    {
+      // the timers above the first level are cascaded at the next boundary
+      uint64_t tick = timer->m_level0 ? timer->m_expires : ((m_tick >> SLOT_BITS) + 1) << SLOT_BITS;
+      if (!m_event.IsRunning () || tick < m_eventTick)
+        {
+          ScheduleAt (tick);
+        }
+    }
+}
+
+void
+TimerWheel::Insert (Timer *timer)
+{
+  uint64_t delta = timer->m_expires - m_tick;
+  uint32_t level = 0;
+  while (level < LEVELS - 1 && delta >= (uint64_t (1) << (SLOT_BITS * (level + 1))))
+    {
+      level++;
+    }
+  uint64_t expires = timer->m_expires;
+  if (delta >= (uint64_t (1) << (SLOT_BITS * LEVELS)))
+    {
+      // beyond the span of the wheel: wait in the farthest slot
+      expires = m_tick + (uint64_t (1) << (SLOT_BITS * LEVELS)) - 1;
+    }
+  uint32_t index = (expires >> (SLOT_BITS * level)) & (SLOTS - 1);
+
+  Link *slot = &m_slots[level * SLOTS + index];
+  timer->m_prev = slot->m_prev;
+  timer->m_next = slot;
+  slot->m_prev->m_next = timer;
+  slot->m_prev = timer;
+  timer->m_level0 = (level == 0);
+  if (timer->m_level0)
+    {
+      m_nLevel0++;
+    }
+}
+
+void
+TimerWheel::Remove (Timer *timer)
+{
+  timer->m_prev->m_next = timer->m_next;
+  timer->m_next->m_prev = timer->m_prev;
+  timer->m_prev = 0;
+  timer->m_next = 0;
+  m_nTimers--;
+  if (timer->m_level0)
+    {
+      m_nLevel0--;
+    }
+}
+
+void
+TimerWheel::Detach (Link *slot, Link *list)
+{
+  if (slot->m_next == slot)
+    {
+      return;
+    }
+  list->m_next = slot->m_next;
+  list->m_prev = slot->m_prev;
+  list->m_next->m_prev = list;
+  list->m_prev->m_next = list;
+  slot->m_next = slot;
+  slot->m_prev = slot;
+}
+
+void
+TimerWheel::Cascade (uint32_t level, uint32_t index)
+{
+  Link list;
+  list.m_prev = &list;
+  list.m_next = &list;
+  Detach (&m_slots[level * SLOTS + index], &list);
+  while (list.m_next != &list)
+    {
+      Timer *timer = static_cast<Timer *> (list.m_next);
+      list.m_next = timer->m_next;
+      list.m_next->m_prev = &list;
+      Insert (timer);
+    }
+}
+
+void
+TimerWheel::Expire ()
+{
+  NS_LOG_FUNCTION (this);
+
+  uint64_t now = GetCurrentTick ();
+  m_expiring = true;
+  while (m_tick < now && m_nTimers > 0)
+    {
+      m_tick++;
+      if ((m_tick & (SLOTS - 1)) == 0)
+        {
+          uint32_t level = 1;
+          uint32_t index;
+          do
+            {
+              index = (m_tick >> (SLOT_BITS * level)) & (SLOTS - 1);
+              Cascade (level, index);
+              level++;
+            }
+          while (index == 0 && level < LEVELS);
+        }
+
+      // the timers may cancel each other when they expire
+      Link list;
+      list.m_prev = &list;
+      list.m_next = &list;
+      Detach (&m_slots[m_tick & (SLOTS - 1)], &list);
+      while (list.m_next != &list)
+        {
+          Timer *timer = static_cast<Timer *> (list.m_next);
+          Remove (timer);
+          NS_LOG_LOGIC ("Expire timer " << timer << " at tick " << m_tick);
+          // the function may destroy the timer
+          Callback<void> function = timer->m_function;
+          function ();
+        }
+    }
+  m_expiring = false;
+  if (m_tick < now)
+    {
+      // nothing to process up to now
+      m_tick = now;
+    }
+
+  if (m_nTimers > 0)
+    {
+      ScheduleAt (GetNextTick ());
+    }
+}
+
+void
+TimerWheel::ScheduleAt (uint64_t tick)
+{
+  NS_LOG_FUNCTION (this << tick);
+  m_event.Cancel ();
+  m_eventTick = std::max (tick, GetCurrentTick ());
+  Time at = TimeStep (m_eventTick * m_resolution.GetTimeStep ());
+  m_event = Simulator::Schedule (std::max (at - Simulator::Now (), Seconds (0)), &TimerWheel::Expire, this);
+}
+
+uint64_t
+TimerWheel::GetNextTick () const
+{
+  NS_ASSERT (m_nTimers > 0);
+  bool upper = (m_nTimers > m_nLevel0);
+  for (uint64_t tick = m_tick + 1; tick <= m_tick + SLOTS; tick++)
+    {
+      const Link *slot = &m_slots[tick & (SLOTS - 1)];
+      if ((upper && (tick & (SLOTS - 1)) == 0) || slot->m_next != slot)
+        {
+          return tick;
+        }
+    }
+  NS_ASSERT_MSG (false, "No timer within " << SLOTS << " ticks");
+  return m_tick + SLOTS;
+}
+
+} // namespace ns3
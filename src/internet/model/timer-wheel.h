@@ -0,0 +1,244 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/callback.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup internet
+ *
+ * \brief Hierarchical timing wheel shared by the timers of a neighbor
+ * cache.
+ *
+ * The timers of a wheel do not schedule any simulator event of their
+ * own: their expiration time is rounded up to the resolution of the
+ * wheel (a tick) and they are linked in the slot of that tick. The
+ * wheel has five levels of 64 slots; the first level holds the timers
+ * which expire within 64 ticks, and each of the next levels covers 64
+ * times the span of the previous one, that is 2^30 ticks in all.
+ * Starting or cancelling a timer thus only links or unlinks it, in
+ * constant time.
+ *
+ * The wheel itself schedules a single simulator event, at the first tick
+ * which has timers to expire or at the next 64 ticks boundary, where the
+ * timers of the next level are moved down ("cascaded") towards the first
+ * level. This event is only cancelled and scheduled again when a timer
+ * is started which expires before it. The timers never expire earlier
+ * than their delay, but at most one tick later; the timers which expire
+ * in the same tick run in no particular order.
+ *
+ * A timer may start, cancel or destroy any timer of the wheel, including
+ * itself, when it expires.
+ */
+class TimerWheel
+{
+public:
+  /**
+   * \brief Link of the lists of the slots of the wheel.
+   */
+  class Link
+  {
+public:
+    Link ();
+
+protected:
+    friend class TimerWheel;
+
+    Link *m_prev; //!< previous link of the slot, or 0 if not linked
+    Link *m_next; //!< next link of the slot, or 0 if not linked
+  };
+
+  /**
+   * \brief A timer of a wheel.
+   *
+   * The timer is cancelled when it is destroyed.
+   */
+  class Timer : public Link
+  {
+public:
+    /**
+     * \brief Constructor.
+     * \param wheel the wheel of the timer, which must outlive it
+     */
+    Timer (TimerWheel *wheel);
+    ~Timer ();
+
+    /**
+     * \brief Set the function to invoke when the timer expires.
+     * \param function the function
+     */
+    void SetFunction (Callback<void> function);
+
+    /**
+     * \brief Start the timer, which must not be running.
+     * \param delay the delay after which the timer expires
+     */
+    void Schedule (Time delay);
+
+    /**
+     * \brief Cancel the timer, if it is running.
+     */
+    void Cancel ();
+
+    /**
+     * \return true if the timer is running
+     */
+    bool IsRunning () const;
+
+private:
+    friend class TimerWheel;
+
+    /**
+     * \brief Copy constructor.
+     *
+     * Not implemented to avoid misuse
+     */
+    Timer (Timer const &);
+
+    /**
+     * \brief Copy constructor.
+     *
+     * Not implemented to avoid misuse
+     * \returns
+     */
+    Timer& operator= (Timer const &);
+
+    TimerWheel *m_wheel;       //!< the wheel
+    Callback<void> m_function; //!< the function to invoke
+    uint64_t m_expires;        //!< the tick at which the timer expires
+    bool m_level0;             //!< whether the timer is in the first level
+  };
+
+  TimerWheel ();
+  ~TimerWheel ();
+
+  /**
+   * \brief Set the resolution of the wheel, which must not have any
+   * running timer.
+   * \param resolution the duration of a tick
+   */
+  void SetResolution (Time resolution);
+
+  /**
+   * \return the duration of a tick
+   */
+  Time GetResolution () const;
+
+  /**
+   * \return the number of running timers
+   */
+  uint32_t GetNTimers () const;
+
+private:
+  /// number of bits of the index of a slot in a level
+  static const uint32_t SLOT_BITS = 6;
+  /// number of slots of a level
+  static const uint32_t SLOTS = 1 << SLOT_BITS;
+  /// number of levels
+  static const uint32_t LEVELS = 5;
+
+  /**
+   * \brief Copy constructor.
+   *
+   * Not implemented to avoid misuse
+   */
+  TimerWheel (TimerWheel const &);
+
+  /**
+   * \brief Copy constructor.
+   *
+   * Not implemented to avoid misuse
+   * \returns
+   */
+  TimerWheel& operator= (TimerWheel const &);
+
+  /**
+   * \return the current tick, rounded down
+   */
+  uint64_t GetCurrentTick () const;
+
+  /**
+   * \brief Start a timer, and schedule the event of the wheel if the
+   * timer expires before it.
+   * \param timer the timer
+   * \param delay the delay of the timer
+   */
+  void Start (Timer *timer, Time delay);
+
+  /**
+   * \brief Link a timer in the slot of its expiration tick.
+   * \param timer the timer
+   */
+  void Insert (Timer *timer);
+
+  /**
+   * \brief Unlink a timer from its slot.
+   * \param timer the timer
+   */
+  void Remove (Timer *timer);
+
+  /**
+   * \brief Move the timers of a slot to another list.
+   * \param slot the slot
+   * \param list the list, which must be empty
+   */
+  void Detach (Link *slot, Link *list);
+
+  /**
+   * \brief Move the timers of the slot of a level towards the first level.
+   * \param level the level, above the first one
+   * \param index the index of the slot in the level
+   */
+  void Cascade (uint32_t level, uint32_t index);
+
+  /**
+   * \brief Process the ticks up to the current one and expire their timers.
+   */
+  void Expire ();
+
+  /**
+   * \brief Schedule the event of the wheel at a tick.
+   * \param tick the tick, which may be in the past
+   */
+  void ScheduleAt (uint64_t tick);
+
+  /**
+   * \return the first tick after the processed one which has work to do
+   */
+  uint64_t GetNextTick () const;
+
+  Time m_resolution;           //!< the duration of a tick
+  uint64_t m_tick;             //!< the last processed tick
+  uint32_t m_nTimers;          //!< the number of running timers
+  uint32_t m_nLevel0;          //!< the number of running timers in the first level
+  std::vector<Link> m_slots;   //!< the slots of all the levels, allocated with the first timer
+  EventId m_event;             //!< the event of the wheel
+  uint64_t m_eventTick;        //!< the tick of the event of the wheel
+  bool m_expiring;             //!< whether the timers are being processed
+};
+
+} // namespace ns3
+
+#endif /* TIMER_WHEEL_H */
@@ -0,0 +1,239 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Unit tests of the match precedence of the end point demultiplexers
+
+#include "ns3/test.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv6-end-point-demux.h"
+#include "ns3/ipv6-end-point.h"
+#include "ns3/ipv6-interface.h"
+
+using namespace ns3;
+
+/**
+ * Lookups of the IPv4 demux, as the end points are allocated, connected
+ * and freed.
+ */
+class Ipv4EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv4EndPointDemuxTestCase ();
+  virtual ~Ipv4EndPointDemuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4EndPointDemuxTestCase::Ipv4EndPointDemuxTestCase ()
+  : TestCase ("Match precedence of the IPv4 end point demux")
+{
+}
+
+Ipv4EndPointDemuxTestCase::~Ipv4EndPointDemuxTestCase ()
+{
+}
+
+void
+Ipv4EndPointDemuxTestCase::DoRun (void)
+{
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  Ptr<Ipv4Interface> iface = CreateObject<Ipv4Interface> ();
+  iface->SetDevice (device);
+  iface->AddAddress (Ipv4InterfaceAddress (Ipv4Address ("10.0.0.1"), Ipv4Mask ("255.255.255.0")));
+  Ipv4Address local ("10.0.0.1");
+  Ipv4Address any = Ipv4Address::GetAny ();
+
+  Ipv4EndPointDemux demux;
+  Ipv4EndPoint *listening = demux.Allocate (any, 80);
+  Ipv4EndPoint *bound = demux.Allocate (local, 80);
+  Ipv4EndPoint *connected = demux.Allocate (local, 80, Ipv4Address ("10.0.0.2"), 1000);
+  Ipv4EndPoint *halfConnected = demux.Allocate (any, 80, Ipv4Address ("10.0.0.3"), 2000);
+  NS_TEST_EXPECT_MSG_EQ (demux.Allocate (local, 80), 0, "duplicate address and port allocated");
+  NS_TEST_EXPECT_MSG_EQ (demux.Allocate (local, 80, Ipv4Address ("10.0.0.2"), 1000), 0, "duplicate four-tuple allocated");
+
+  Ipv4EndPointDemux::EndPoints endPoints = demux.Lookup (local, 80, Ipv4Address ("10.0.0.2"), 1000, iface);
+  NS_TEST_EXPECT_MSG_EQ (endPoints.size (), 1, "all four should match");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), connected, "all four should match");
+  endPoints = demux.Lookup (local, 80, Ipv4Address ("10.0.0.3"), 2000, iface);
+  NS_TEST_EXPECT_MSG_EQ (endPoints.size (), 1, "all but the local address should match");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), halfConnected, "all but the local address should match");
+  endPoints = demux.Lookup (local, 80, Ipv4Address ("10.0.0.9"), 5, iface);
+  NS_TEST_EXPECT_MSG_EQ (endPoints.size (), 1, "the local address should match");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), bound, "the local address should match");
+  endPoints = demux.Lookup (Ipv4Address ("10.0.0.7"), 80, Ipv4Address ("10.0.0.9"), 5, iface);
+  NS_TEST_EXPECT_MSG_EQ (endPoints.size (), 1, "the local port should match");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), listening, "the local port should match");
+  endPoints = demux.Lookup (local, 81, Ipv4Address ("10.0.0.2"), 1000, iface);
+  NS_TEST_EXPECT_MSG_EQ (endPoints.size (), 0, "no end point has the port");
+
+  // a subnet-directed broadcast matches the end points bound to the
+  // address of the interface as well as the unbound ones
+  endPoints = demux.Lookup (Ipv4Address ("10.0.0.255"), 80, Ipv4Address ("10.0.0.9"), 5, iface);
+  NS_TEST_EXPECT_MSG_EQ (endPoints.size (), 2, "the broadcast should match both end points");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), listening, "the broadcast should match the listening end point");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.back (), bound, "the broadcast should match the bound end point");
+
+  // connecting an end point moves it to its new four-tuple
+  listening->SetPeer (Ipv4Address ("10.0.0.9"), 5);
+  endPoints = demux.Lookup (Ipv4Address ("10.0.0.7"), 80, Ipv4Address ("10.0.0.9"), 5, iface);
+  NS_TEST_EXPECT_MSG_EQ (endPoints.size (), 1, "the connected end point should match");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), listening, "the connected end point should match");
+  endPoints = demux.Lookup (Ipv4Address ("10.0.0.7"), 80, Ipv4Address ("10.0.0.8"), 5, iface);
+  NS_TEST_EXPECT_MSG_EQ (endPoints.size (), 0, "the connected end point should not match another peer");
+
+  NS_TEST_EXPECT_MSG_EQ (demux.SimpleLookup (local, 80, Ipv4Address ("10.0.0.2"), 1000), connected, "exact match expected");
+  demux.DeAllocate (connected);
+  endPoints = demux.Lookup (local, 80, Ipv4Address ("10.0.0.2"), 1000, iface);
+  NS_TEST_EXPECT_MSG_EQ (endPoints.size (), 1, "the local address should match");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), bound, "the local address should match");
+
+  // the end points of a four-tuple are returned in allocation order,
+  // whatever the order in which they got it
+  Ipv4EndPoint *first = demux.Allocate (any, 90);
+  Ipv4EndPoint *second = demux.Allocate (local, 90);
+  second->SetLocalAddress (any);
+  first->SetLocalAddress (local);
+  first->SetLocalAddress (any);
+  endPoints = demux.Lookup (local, 90, Ipv4Address ("10.0.0.2"), 1000, iface);
+  NS_TEST_EXPECT_MSG_EQ (endPoints.size (), 2, "both end points should match");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), first, "wrong order");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.back (), second, "wrong order");
+
+  // an end point bound to another device does not receive
+  first->BindToNetDevice (CreateObject<SimpleNetDevice> ());
+  endPoints = demux.Lookup (local, 90, Ipv4Address ("10.0.0.2"), 1000, iface);
+  NS_TEST_EXPECT_MSG_EQ (endPoints.size (), 1, "the end point bound to another device should not match");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), second, "the end point bound to another device should not match");
+
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (90), true, "port 90 is used");
+  demux.DeAllocate (first);
+  demux.DeAllocate (second);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (90), false, "port 90 is free");
+  endPoints = demux.GetAllEndPoints ();
+  NS_TEST_EXPECT_MSG_EQ (endPoints.size (), 3, "wrong number of end points");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), listening, "the end points should stay in allocation order");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.back (), halfConnected, "the end points should stay in allocation order");
+
+  // an end point which is not allocated by this demux is left alone
+  Ipv4EndPointDemux other;
+  other.DeAllocate (bound);
+  endPoints = demux.Lookup (local, 80, Ipv4Address ("10.0.0.8"), 5, iface);
+  NS_TEST_EXPECT_MSG_EQ (endPoints.size (), 1, "the end point should still be allocated");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), bound, "the end point should still be allocated");
+}
+
+/**
+ * Lookups of the IPv6 demux, as the end points are allocated, connected
+ * and freed.
+ */
+class Ipv6EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv6EndPointDemuxTestCase ();
+  virtual ~Ipv6EndPointDemuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv6EndPointDemuxTestCase::Ipv6EndPointDemuxTestCase ()
+  : TestCase ("Match precedence of the IPv6 end point demux")
+{
+}
+
+Ipv6EndPointDemuxTestCase::~Ipv6EndPointDemuxTestCase ()
+{
+}
+
+void
+Ipv6EndPointDemuxTestCase::DoRun (void)
+{
+  Ptr<Ipv6Interface> iface = CreateObject<Ipv6Interface> ();
+  iface->SetDevice (CreateObject<SimpleNetDevice> ());
+  Ipv6Address local ("2001:1::1");
+  Ipv6Address any = Ipv6Address::GetAny ();
+
+  Ipv6EndPointDemux demux;
+  Ipv6EndPoint *listening = demux.Allocate (any, 80);
+  Ipv6EndPoint *bound = demux.Allocate (local, 80);
+  Ipv6EndPoint *connected = demux.Allocate (local, 80, Ipv6Address ("2001:1::2"), 1000);
+  Ipv6EndPoint *halfConnected = demux.Allocate (any, 80, Ipv6Address ("2001:1::3"), 2000);
+  Ipv6EndPoint *routers = demux.Allocate (Ipv6Address::GetAllRoutersMulticast (), 521);
+
+  Ipv6EndPointDemux::EndPoints endPoints = demux.Lookup (local, 80, Ipv6Address ("2001:1::2"), 1000, iface);
+  NS_TEST_EXPECT_MSG_EQ (endPoints.size (), 1, "all four should match");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), connected, "all four should match");
+  endPoints = demux.Lookup (local, 80, Ipv6Address ("2001:1::3"), 2000, iface);
+  NS_TEST_EXPECT_MSG_EQ (endPoints.size (), 1, "all but the local address should match");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), halfConnected, "all but the local address should match");
+  endPoints = demux.Lookup (local, 80, Ipv6Address ("2001:1::9"), 5, iface);
+  NS_TEST_EXPECT_MSG_EQ (endPoints.size (), 1, "the local address should match");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), bound, "the local address should match");
+  endPoints = demux.Lookup (Ipv6Address ("2001:1::7"), 80, Ipv6Address ("2001:1::9"), 5, iface);
+  NS_TEST_EXPECT_MSG_EQ (endPoints.size (), 1, "the local port should match");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), listening, "the local port should match");
+  endPoints = demux.Lookup (Ipv6Address::GetAllRoutersMulticast (), 521, Ipv6Address ("fe80::1"), 521, iface);
+  NS_TEST_EXPECT_MSG_EQ (endPoints.size (), 1, "the all-routers end point should match");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), routers, "the all-routers end point should match");
+  endPoints = demux.Lookup (local, 521, Ipv6Address ("fe80::1"), 521, iface);
+  NS_TEST_EXPECT_MSG_EQ (endPoints.size (), 0, "the all-routers end point should only match its address");
+
+  // connecting an end point moves it to its new four-tuple
+  bound->SetPeer (Ipv6Address ("2001:1::9"), 5);
+  endPoints = demux.Lookup (local, 80, Ipv6Address ("2001:1::8"), 5, iface);
+  NS_TEST_EXPECT_MSG_EQ (endPoints.size (), 1, "the local port should match");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), listening, "the local port should match");
+  NS_TEST_EXPECT_MSG_EQ (demux.SimpleLookup (local, 80, Ipv6Address ("2001:1::9"), 5), bound, "exact match expected");
+
+  // an end point bound to a device does not receive from another one,
+  // nor when the incoming interface is unknown
+  listening->BindToNetDevice (CreateObject<SimpleNetDevice> ());
+  endPoints = demux.Lookup (Ipv6Address ("2001:1::7"), 80, Ipv6Address ("2001:1::9"), 5, iface);
+  NS_TEST_EXPECT_MSG_EQ (endPoints.size (), 0, "the end point bound to another device should not match");
+  listening->BindToNetDevice (iface->GetDevice ());
+  endPoints = demux.Lookup (Ipv6Address ("2001:1::7"), 80, Ipv6Address ("2001:1::9"), 5, iface);
+  NS_TEST_EXPECT_MSG_EQ (endPoints.size (), 1, "the end point bound to the device should match");
+  endPoints = demux.Lookup (Ipv6Address ("2001:1::7"), 80, Ipv6Address ("2001:1::9"), 5, 0);
+  NS_TEST_EXPECT_MSG_EQ (endPoints.size (), 0, "the end point bound to the device should not match");
+
+  demux.DeAllocate (connected);
+  endPoints = demux.Lookup (local, 80, Ipv6Address ("2001:1::2"), 1000, iface);
+  NS_TEST_EXPECT_MSG_EQ (endPoints.size (), 1, "the local port should match");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), listening, "the local port should match");
+  NS_TEST_EXPECT_MSG_EQ (demux.GetEndPoints ().size (), 4, "wrong number of end points");
+}
+
+/**
+ * End point demux TestSuite
+ */
+class IpEndPointDemuxTestSuite : public TestSuite
+{
+public:
+  IpEndPointDemuxTestSuite ();
+};
+
+IpEndPointDemuxTestSuite::IpEndPointDemuxTestSuite ()
+  : TestSuite ("ip-end-point-demux", UNIT)
+{
+  AddTestCase (new Ipv4EndPointDemuxTestCase, TestCase::QUICK);
+  AddTestCase (new Ipv6EndPointDemuxTestCase, TestCase::QUICK);
+}
+
+static IpEndPointDemuxTestSuite ipEndPointDemuxTestSuite;
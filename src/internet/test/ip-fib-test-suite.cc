@@ -0,0 +1,377 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Unit tests of the forwarding information base of the routing protocols
+
+#include <list>
+#include <vector>
+
+#include "ns3/test.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv6-address.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "ns3/ipv6-routing-table-entry.h"
+#include "ns3/ip-fib.h"
+
+using namespace ns3;
+
+/**
+ * Longest prefix match, metric and interface selection of the IPv4 FIB.
+ */
+class IpFibIpv4LongestTestCase : public TestCase
+{
+public:
+  IpFibIpv4LongestTestCase ();
+  virtual ~IpFibIpv4LongestTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+IpFibIpv4LongestTestCase::IpFibIpv4LongestTestCase ()
+  : TestCase ("Longest prefix match of the IPv4 FIB")
+{
+}
+
+IpFibIpv4LongestTestCase::~IpFibIpv4LongestTestCase ()
+{
+}
+
+void
+IpFibIpv4LongestTestCase::DoRun (void)
+{
+  Ipv4RoutingTableEntry def = Ipv4RoutingTableEntry::CreateNetworkRouteTo (Ipv4Address::GetZero (), Ipv4Mask::GetZero (), Ipv4Address ("1.0.0.1"), 1);
+  Ipv4RoutingTableEntry r8 = Ipv4RoutingTableEntry::CreateNetworkRouteTo (Ipv4Address ("10.0.0.0"), Ipv4Mask ("255.0.0.0"), 2);
+  Ipv4RoutingTableEntry r16a = Ipv4RoutingTableEntry::CreateNetworkRouteTo (Ipv4Address ("10.1.0.0"), Ipv4Mask ("255.255.0.0"), 3);
+  Ipv4RoutingTableEntry r16b = Ipv4RoutingTableEntry::CreateNetworkRouteTo (Ipv4Address ("10.1.0.0"), Ipv4Mask ("255.255.0.0"), 4);
+  // not masked, as the routing protocols allow it
+  Ipv4RoutingTableEntry r16c = Ipv4RoutingTableEntry::CreateNetworkRouteTo (Ipv4Address ("10.1.7.7"), Ipv4Mask ("255.255.0.0"), 5);
+  Ipv4RoutingTableEntry host = Ipv4RoutingTableEntry::CreateHostRouteTo (Ipv4Address ("10.1.2.3"), 6);
+
+  Ipv4Fib fib;
+  fib.Add (def.GetDestNetwork (), def.GetDestNetworkMask (), 1, 0, &def);
+  fib.Add (r8.GetDestNetwork (), r8.GetDestNetworkMask (), 2, 5, &r8);
+  fib.Add (r16a.GetDestNetwork (), r16a.GetDestNetworkMask (), 3, 10, &r16a);
+  fib.Add (r16b.GetDestNetwork (), r16b.GetDestNetworkMask (), 4, 5, &r16b);
+  fib.Add (r16c.GetDestNetwork (), r16c.GetDestNetworkMask (), 5, 5, &r16c);
+  NS_TEST_ASSERT_MSG_EQ (fib.GetNRoutes (), 5, "wrong number of routes");
+
+  // lowest metric, then last added
+  NS_TEST_EXPECT_MSG_EQ (fib.LookupLongest (Ipv4Address ("10.1.2.3")), &r16c, "wrong route");
+  NS_TEST_EXPECT_MSG_EQ (fib.LookupLongest (Ipv4Address ("10.1.2.3"), 3), &r16a, "wrong route on interface 3");
+  NS_TEST_EXPECT_MSG_EQ (fib.LookupLongest (Ipv4Address ("10.1.2.3"), 2), &r8, "wrong route on interface 2");
+  NS_TEST_EXPECT_MSG_EQ (fib.LookupLongest (Ipv4Address ("10.1.2.3"), 7), 0, "no route expected on interface 7");
+  NS_TEST_EXPECT_MSG_EQ (fib.LookupLongest (Ipv4Address ("10.2.0.1")), &r8, "wrong route");
+  NS_TEST_EXPECT_MSG_EQ (fib.LookupLongest (Ipv4Address ("11.0.0.1")), &def, "wrong route");
+
+  fib.Add (host.GetDestNetwork (), host.GetDestNetworkMask (), 6, 100, &host);
+  NS_TEST_EXPECT_MSG_EQ (fib.LookupLongest (Ipv4Address ("10.1.2.3")), &host, "the host route is longer");
+  NS_TEST_EXPECT_MSG_EQ (fib.LookupLongest (Ipv4Address ("10.1.2.4")), &r16c, "wrong route");
+
+  std::vector<Ipv4RoutingTableEntry *> all;
+  fib.LookupAll (Ipv4Address ("10.1.2.3"), Ipv4Fib::ANY_INTERFACE, all);
+  NS_TEST_ASSERT_MSG_EQ (all.size (), 6, "all the routes match");
+  NS_TEST_EXPECT_MSG_EQ (all[0], &def, "not in the order of insertion");
+  NS_TEST_EXPECT_MSG_EQ (all[1], &r8, "not in the order of insertion");
+  NS_TEST_EXPECT_MSG_EQ (all[2], &r16a, "not in the order of insertion");
+  NS_TEST_EXPECT_MSG_EQ (all[5], &host, "not in the order of insertion");
+
+  NS_TEST_EXPECT_MSG_EQ (fib.Remove (r16c.GetDestNetwork (), r16c.GetDestNetworkMask (), &r16c), true, "route not removed");
+  NS_TEST_EXPECT_MSG_EQ (fib.Remove (r16c.GetDestNetwork (), r16c.GetDestNetworkMask (), &r16c), false, "route removed twice");
+  NS_TEST_EXPECT_MSG_EQ (fib.LookupLongest (Ipv4Address ("10.1.2.4")), &r16b, "wrong route");
+  fib.Remove (r16a.GetDestNetwork (), r16a.GetDestNetworkMask (), &r16a);
+  fib.Remove (r16b.GetDestNetwork (), r16b.GetDestNetworkMask (), &r16b);
+  NS_TEST_EXPECT_MSG_EQ (fib.LookupLongest (Ipv4Address ("10.1.2.4")), &r8, "wrong route");
+  NS_TEST_EXPECT_MSG_EQ (fib.GetNRoutes (), 3, "wrong number of routes");
+
+  fib.Clear ();
+  NS_TEST_EXPECT_MSG_EQ (fib.GetNRoutes (), 0, "routes left");
+  NS_TEST_EXPECT_MSG_EQ (fib.LookupLongest (Ipv4Address ("11.0.0.1")), 0, "routes left");
+}
+
+/**
+ * A route of the linear reference table.
+ */
+template <typename Address, typename Mask, typename Entry>
+struct ReferenceRoute
+{
+  Address network;    //!< the destination network
+  Mask mask;          //!< the destination network mask
+  uint32_t interface; //!< the output interface
+  uint32_t metric;    //!< the metric
+  Entry *entry;       //!< the routing table entry
+};
+
+/**
+ * Compare the lookups of a FIB with a linear walk through the same
+ * routes, as Ipv4StaticRouting, Ipv6StaticRouting and Ipv4GlobalRouting
+ * used to do, with random routes which overlap a lot, and random removals.
+ */
+template <typename Fib, typename Address, typename Mask, typename Entry>
+class IpFibRandomTestCase : public TestCase
+{
+public:
+  /**
+   * \param name the name of the test
+   * \param lengths the prefix lengths of the routes
+   */
+  IpFibRandomTestCase (std::string name, std::vector<uint8_t> lengths);
+  virtual ~IpFibRandomTestCase ();
+
+private:
+  /// the routes of the reference table
+  typedef std::list<ReferenceRoute<Address, Mask, Entry> > Routes;
+
+  virtual void DoRun (void);
+
+  /**
+   * \return a random address, in a small range so that the routes overlap
+   */
+  Address GetRandomAddress (void);
+  /**
+   * \param length a prefix length
+   * \return the mask
+   */
+  Mask GetMask (uint8_t length);
+  /**
+   * \param network the destination network
+   * \param mask the destination network mask
+   * \param interface the output interface
+   * \return a new routing table entry
+   */
+  Entry *CreateEntry (Address network, Mask mask, uint32_t interface);
+
+  /**
+   * The reference longest prefix match.
+   * \param routes the routes
+   * \param dest the destination address
+   * \param interface the output interface, or ANY_INTERFACE
+   * \return the selected route
+   */
+  static Entry *LookupLongest (const Routes &routes, Address dest, uint32_t interface);
+
+  std::vector<uint8_t> m_lengths;     //!< the prefix lengths of the routes
+  Ptr<UniformRandomVariable> m_rng;   //!< the random draws
+};
+
+template <typename Fib, typename Address, typename Mask, typename Entry>
+IpFibRandomTestCase<Fib, Address, Mask, Entry>::IpFibRandomTestCase (std::string name, std::vector<uint8_t> lengths)
+  : TestCase (name),
+    m_lengths (lengths)
+{
+}
+
+template <typename Fib, typename Address, typename Mask, typename Entry>
+IpFibRandomTestCase<Fib, Address, Mask, Entry>::~IpFibRandomTestCase ()
+{
+}
+
+template <>
+Ipv4Address
+IpFibRandomTestCase<Ipv4Fib, Ipv4Address, Ipv4Mask, Ipv4RoutingTableEntry>::GetRandomAddress (void)
+{
+  // 10.0-3.0-3.0-7
+  return Ipv4Address (0x0a000000 | (m_rng->GetInteger (0, 3) << 16) | (m_rng->GetInteger (0, 3) << 8) | m_rng->GetInteger (0, 7));
+}
+
+template <>
+Ipv4Mask
+IpFibRandomTestCase<Ipv4Fib, Ipv4Address, Ipv4Mask, Ipv4RoutingTableEntry>::GetMask (uint8_t length)
+{
+  return Ipv4Mask (length ? 0xffffffff << (32 - length) : 0);
+}
+
+template <>
+Ipv4RoutingTableEntry *
+IpFibRandomTestCase<Ipv4Fib, Ipv4Address, Ipv4Mask, Ipv4RoutingTableEntry>::CreateEntry (Ipv4Address network, Ipv4Mask mask, uint32_t interface)
+{
+  return new Ipv4RoutingTableEntry (Ipv4RoutingTableEntry::CreateNetworkRouteTo (network, mask, interface));
+}
+
+template <>
+Ipv6Address
+IpFibRandomTestCase<Ipv6Fib, Ipv6Address, Ipv6Prefix, Ipv6RoutingTableEntry>::GetRandomAddress (void)
+{
+  // 2001:db8:0-3::0-3:0-7
+  uint8_t address[16] = { 0x20, 0x01, 0x0d, 0xb8 };
+  address[5] = m_rng->GetInteger (0, 3);
+  address[13] = m_rng->GetInteger (0, 3);
+  address[15] = m_rng->GetInteger (0, 7);
+  return Ipv6Address (address);
+}
+
+template <>
+Ipv6Prefix
+IpFibRandomTestCase<Ipv6Fib, Ipv6Address, Ipv6Prefix, Ipv6RoutingTableEntry>::GetMask (uint8_t length)
+{
+  return Ipv6Prefix (length);
+}
+
+template <>
+Ipv6RoutingTableEntry *
+IpFibRandomTestCase<Ipv6Fib, Ipv6Address, Ipv6Prefix, Ipv6RoutingTableEntry>::CreateEntry (Ipv6Address network, Ipv6Prefix mask, uint32_t interface)
+{
+  return new Ipv6RoutingTableEntry (Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, mask, interface));
+}
+
+template <typename Fib, typename Address, typename Mask, typename Entry>
+Entry *
+IpFibRandomTestCase<Fib, Address, Mask, Entry>::LookupLongest (const Routes &routes, Address dest, uint32_t interface)
+{
+  Entry *result = 0;
+  uint16_t longestMask = 0;
+  uint32_t shortestMetric = 0xffffffff;
+  for (typename Routes::const_iterator it = routes.begin (); it != routes.end (); it++)
+    {
+      Mask mask = it->mask;
+      uint16_t maskLen = mask.GetPrefixLength ();
+      if (!mask.IsMatch (dest, it->network))
+        {
+          continue;
+        }
+      if (interface != Fib::ANY_INTERFACE && interface != it->interface)
+        {
+          continue;
+        }
+      if (maskLen < longestMask)
+        {
+          continue;
+        }
+      if (maskLen > longestMask)
+        {
+          shortestMetric = 0xffffffff;
+        }
+      longestMask = maskLen;
+      if (it->metric > shortestMetric)
+        {
+          continue;
+        }
+      shortestMetric = it->metric;
+      result = it->entry;
+    }
+  return result;
+}
+
+template <typename Fib, typename Address, typename Mask, typename Entry>
+void
+IpFibRandomTestCase<Fib, Address, Mask, Entry>::DoRun (void)
+{
+  m_rng = CreateObject<UniformRandomVariable> ();
+  m_rng->SetStream (1);
+
+  Fib fib;
+  Routes routes;
+  for (uint32_t round = 0; round < 20; round++)
+    {
+      // add routes
+      for (uint32_t i = 0; i < 50; i++)
+        {
+          ReferenceRoute<Address, Mask, Entry> route;
+          route.network = GetRandomAddress ();
+          route.mask = GetMask (m_lengths[m_rng->GetInteger (0, m_lengths.size () - 1)]);
+          route.interface = m_rng->GetInteger (0, 3);
+          route.metric = m_rng->GetInteger (0, 2);
+          route.entry = CreateEntry (route.network, route.mask, route.interface);
+          fib.Add (route.network, route.mask, route.interface, route.metric, route.entry);
+          routes.push_back (route);
+        }
+      // remove some of them
+      for (typename Routes::iterator it = routes.begin (); it != routes.end (); )
+        {
+          if (m_rng->GetInteger (0, 3) == 0)
+            {
+              NS_TEST_ASSERT_MSG_EQ (fib.Remove (it->network, it->mask, it->entry), true, "route not found");
+              delete it->entry;
+              it = routes.erase (it);
+            }
+          else
+            {
+              it++;
+            }
+        }
+      NS_TEST_ASSERT_MSG_EQ (fib.GetNRoutes (), routes.size (), "wrong number of routes");
+
+      for (uint32_t i = 0; i < 200; i++)
+        {
+          Address dest = GetRandomAddress ();
+          uint32_t interface = m_rng->GetInteger (0, 1) ? Fib::ANY_INTERFACE : m_rng->GetInteger (0, 3);
+          NS_TEST_ASSERT_MSG_EQ (fib.LookupLongest (dest, interface), LookupLongest (routes, dest, interface),
+                                 "not the route of the linear lookup to " << dest);
+
+          std::vector<Entry *> all;
+          fib.LookupAll (dest, interface, all);
+          std::vector<Entry *> expected;
+          for (typename Routes::const_iterator it = routes.begin (); it != routes.end (); it++)
+            {
+              if (it->mask.IsMatch (dest, it->network)
+                  && (interface == Fib::ANY_INTERFACE || interface == it->interface))
+                {
+                  expected.push_back (it->entry);
+                }
+            }
+          NS_TEST_ASSERT_MSG_EQ (all.size (), expected.size (), "not all the matching routes to " << dest);
+          for (uint32_t j = 0; j < all.size (); j++)
+            {
+              NS_TEST_ASSERT_MSG_EQ (all[j], expected[j], "not in the order of insertion");
+            }
+        }
+    }
+
+  for (typename Routes::iterator it = routes.begin (); it != routes.end (); it++)
+    {
+      delete it->entry;
+    }
+}
+
+/**
+ * FIB TestSuite
+ */
+class IpFibTestSuite : public TestSuite
+{
+public:
+  IpFibTestSuite ();
+};
+
+IpFibTestSuite::IpFibTestSuite ()
+  : TestSuite ("ip-fib", UNIT)
+{
+  AddTestCase (new IpFibIpv4LongestTestCase, TestCase::QUICK);
+
+  std::vector<uint8_t> v4Lengths;
+  v4Lengths.push_back (0);
+  v4Lengths.push_back (8);
+  v4Lengths.push_back (16);
+  v4Lengths.push_back (22);
+  v4Lengths.push_back (24);
+  v4Lengths.push_back (30);
+  v4Lengths.push_back (32);
+  AddTestCase (new IpFibRandomTestCase<Ipv4Fib, Ipv4Address, Ipv4Mask, Ipv4RoutingTableEntry> ("Random IPv4 routes against a linear lookup", v4Lengths),
+               TestCase::QUICK);
+
+  std::vector<uint8_t> v6Lengths;
+  v6Lengths.push_back (0);
+  v6Lengths.push_back (32);
+  v6Lengths.push_back (48);
+  v6Lengths.push_back (64);
+  v6Lengths.push_back (110);
+  v6Lengths.push_back (126);
+  v6Lengths.push_back (128);
+  AddTestCase (new IpFibRandomTestCase<Ipv6Fib, Ipv6Address, Ipv6Prefix, Ipv6RoutingTableEntry> ("Random IPv6 routes against a linear lookup", v6Lengths),
+               TestCase::QUICK);
+}
+
+static IpFibTestSuite ipFibTestSuite;
@@ -49,6 +49,7 @@ using namespace ns3;
 class Ipv6ForwardingTest : public TestCase
 {
   Ptr<Packet> m_receivedPacket;
+  uint32_t m_routeCacheHits;
   void DoSendData (Ptr<Socket> socket, std::string to);
   void SendData (Ptr<Socket> socket, std::string to);
 
@@ -57,10 +58,12 @@ public:
   Ipv6ForwardingTest ();
 
   void ReceivePkt (Ptr<Socket> socket);
+  void RouteCacheLookup (const Ipv6Header &header, uint32_t interface, bool hit);
 };
 
 Ipv6ForwardingTest::Ipv6ForwardingTest ()
-  : TestCase ("IPv6 forwarding")
+  : TestCase ("IPv6 forwarding"),
+    m_routeCacheHits (0)
 {
 }
 
@@ -75,6 +78,15 @@ void Ipv6ForwardingTest::ReceivePkt (Ptr<Socket> socket)
   (void) availableData;
 }
 
+void
+Ipv6ForwardingTest::RouteCacheLookup (const Ipv6Header &header, uint32_t interface, bool hit)
+{
+  if (hit)
+    {
+      m_routeCacheHits++;
+    }
+}
+
 void
 Ipv6ForwardingTest::DoSendData (Ptr<Socket> socket, std::string to)
 {
@@ -185,6 +197,22 @@ Ipv6ForwardingTest::DoRun (void)
 
   m_receivedPacket->RemoveAllByteTags ();
 
+  // Route cache test: the route of the previous packet is cached
+  fwNode->GetObject<Ipv6L3Protocol> ()->TraceConnectWithoutContext ("RouteCache", MakeCallback (&Ipv6ForwardingTest::RouteCacheLookup, this));
+  SendData (txSocket, "2001:1::2");
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacket->GetSize (), 123, "IPv6 Forwarding with the route cache");
+  NS_TEST_EXPECT_MSG_EQ (m_routeCacheHits, 1, "IPv6 route cache hit");
+
+  m_receivedPacket->RemoveAllByteTags ();
+
+  // ... and flushed when the forwarding is turned off
+  ipv6->SetAttribute("IpForward", BooleanValue (false));
+  SendData (txSocket, "2001:1::2");
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacket->GetSize (), 0, "IPv6 Forwarding off with the route cache");
+  NS_TEST_EXPECT_MSG_EQ (m_routeCacheHits, 1, "IPv6 route cache flushed");
+
+  m_receivedPacket->RemoveAllByteTags ();
+
   Simulator::Destroy ();
 
 }
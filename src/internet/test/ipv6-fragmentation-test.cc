@@ -55,6 +55,9 @@
 
 #include "ns3/ipv6-l3-protocol.h"
 #include "ns3/icmpv6-l4-protocol.h"
+#include "ns3/ipv6-extension.h"
+#include "ns3/ipv6-extension-demux.h"
+#include "ns3/ipv6-extension-header.h"
 
 #include <string>
 #include <limits>
@@ -485,11 +488,156 @@ Ipv6FragmentationTest::DoRun (void)
   Simulator::Destroy ();
 }
 //-----------------------------------------------------------------------------
+/**
+ * Reassembly of fragments handed directly to Ipv6ExtensionFragment:
+ * out of order and duplicate fragments, overlapping fragments and the
+ * reassembly memory budget.
+ */
+class Ipv6ReassemblyTest : public TestCase
+{
+public:
+  Ipv6ReassemblyTest ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \param offset the offset of the fragment in m_data
+   * \param size the size of the fragment
+   * \param more the bit "More Fragment"
+   * \param identification the identification of the packet
+   * \return the fragment, with its fragment header
+   */
+  Ptr<Packet> MakeFragment (uint16_t offset, uint16_t size, bool more, uint32_t identification);
+  /**
+   * \param packet the fragment, replaced by the packet once reassembled
+   * \param source the source of the packet
+   * \param isDropped set if the packet is dropped
+   * \return true if the packet is reassembled
+   */
+  bool Deliver (Ptr<Packet> &packet, Ipv6Address source, bool &isDropped);
+  void Drop (const Ipv6Header &header, Ptr<const Packet> packet, Ipv6L3Protocol::DropReason reason,
+             Ptr<Ipv6> ipv6, uint32_t interface);
+
+  Ptr<Ipv6ExtensionFragment> m_fragment;
+  uint8_t m_data[3000];
+  uint32_t m_memoryDrops;
+};
+
+Ipv6ReassemblyTest::Ipv6ReassemblyTest ()
+  : TestCase ("Reassembly of IPv6 fragments"),
+    m_memoryDrops (0)
+{
+}
+
+Ptr<Packet>
+Ipv6ReassemblyTest::MakeFragment (uint16_t offset, uint16_t size, bool more, uint32_t identification)
+{
+  Ptr<Packet> p = Create<Packet> (m_data + offset, size);
+  Ipv6ExtensionFragmentHeader header;
+  header.SetNextHeader (UdpL4Protocol::PROT_NUMBER);
+  header.SetOffset (offset);
+  header.SetMoreFragment (more);
+  header.SetIdentification (identification);
+  p->AddHeader (header);
+  return p;
+}
+
+bool
+Ipv6ReassemblyTest::Deliver (Ptr<Packet> &packet, Ipv6Address source, bool &isDropped)
+{
+  Ipv6Header ip;
+  ip.SetSourceAddress (source);
+  ip.SetDestinationAddress (Ipv6Address ("2001::1"));
+  ip.SetNextHeader (Ipv6ExtensionFragment::EXT_NUMBER);
+  ip.SetPayloadLength (packet->GetSize ());
+  uint8_t nextHeader;
+  bool stopProcessing = false;
+  Ipv6L3Protocol::DropReason dropReason;
+  isDropped = false;
+  m_fragment->Process (packet, 0, ip, ip.GetDestinationAddress (), &nextHeader, stopProcessing, isDropped, dropReason);
+  return !stopProcessing;
+}
+
+void
+Ipv6ReassemblyTest::Drop (const Ipv6Header &header, Ptr<const Packet> packet, Ipv6L3Protocol::DropReason reason,
+                          Ptr<Ipv6> ipv6, uint32_t interface)
+{
+  if (reason == Ipv6L3Protocol::DROP_FRAGMENT_MEMORY)
+    {
+      m_memoryDrops++;
+    }
+}
+
+void
+Ipv6ReassemblyTest::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  AddInternetStack (node);
+  node->GetObject<Ipv6L3Protocol> ()->TraceConnectWithoutContext ("Drop", MakeCallback (&Ipv6ReassemblyTest::Drop, this));
+  m_fragment = DynamicCast<Ipv6ExtensionFragment> (node->GetObject<Ipv6ExtensionDemux> ()->GetExtension (Ipv6ExtensionFragment::EXT_NUMBER));
+  NS_TEST_ASSERT_MSG_NE (m_fragment, 0, "No fragment extension");
+  for (uint32_t i = 0; i < sizeof (m_data); i++)
+    {
+      m_data[i] = i * 7;
+    }
+  Ipv6Address a ("2001::2");
+  Ipv6Address b ("2001::3");
+  bool isDropped;
+  uint8_t buffer[sizeof (m_data)];
+
+  // out of order, with a duplicate
+  Ptr<Packet> p = MakeFragment (2000, 1000, false, 1);
+  NS_TEST_EXPECT_MSG_EQ (Deliver (p, a, isDropped), false, "Packet reassembled from its last fragment");
+  p = MakeFragment (0, 1000, true, 1);
+  NS_TEST_EXPECT_MSG_EQ (Deliver (p, a, isDropped), false, "Packet reassembled without its second fragment");
+  p = MakeFragment (0, 1000, true, 1);
+  NS_TEST_EXPECT_MSG_EQ (Deliver (p, a, isDropped), false, "Packet reassembled from a duplicate");
+  NS_TEST_EXPECT_MSG_EQ (isDropped, false, "Duplicate fragment dropped");
+  p = MakeFragment (1000, 1000, true, 1);
+  NS_TEST_EXPECT_MSG_EQ (Deliver (p, a, isDropped), true, "Packet not reassembled");
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), sizeof (m_data), "Reassembled packet of the wrong size");
+  p->CopyData (buffer, sizeof (buffer));
+  NS_TEST_EXPECT_MSG_EQ (memcmp (m_data, buffer, sizeof (m_data)), 0, "Reassembled packet with the wrong data");
+
+  // overlapping fragments drop the packet, the next fragments start over
+  p = MakeFragment (0, 1000, true, 2);
+  Deliver (p, a, isDropped);
+  p = MakeFragment (504, 1000, true, 2);
+  NS_TEST_EXPECT_MSG_EQ (Deliver (p, a, isDropped), false, "Packet reassembled from overlapping fragments");
+  NS_TEST_EXPECT_MSG_EQ (isDropped, true, "Overlapping fragment not dropped");
+  p = MakeFragment (1000, 2000, false, 2);
+  NS_TEST_EXPECT_MSG_EQ (Deliver (p, a, isDropped), false, "Packet reassembled from the fragments of a dropped packet");
+  p = MakeFragment (0, 1000, true, 2);
+  NS_TEST_EXPECT_MSG_EQ (Deliver (p, a, isDropped), true, "Packet not reassembled after a drop");
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), sizeof (m_data), "Reassembled packet of the wrong size");
+
+  // the oldest packet is dropped to make room for the fragments of a new one
+  m_fragment->SetAttribute ("MaxReassemblySize", UintegerValue (2500));
+  p = MakeFragment (0, 1000, true, 3);
+  Deliver (p, a, isDropped);
+  p = MakeFragment (0, 1000, true, 3);
+  Deliver (p, b, isDropped);
+  NS_TEST_EXPECT_MSG_EQ (m_memoryDrops, 0, "Packet dropped within the reassembly memory");
+  p = MakeFragment (0, 1000, true, 4);
+  Deliver (p, a, isDropped);
+  NS_TEST_EXPECT_MSG_EQ (m_memoryDrops, 1, "Oldest packet not dropped");
+  p = MakeFragment (1000, 200, false, 3);
+  NS_TEST_EXPECT_MSG_EQ (Deliver (p, b, isDropped), true, "Packet of b not reassembled");
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 1200, "Reassembled packet of the wrong size");
+  p = MakeFragment (1000, 200, false, 3);
+  NS_TEST_EXPECT_MSG_EQ (Deliver (p, a, isDropped), false, "Packet of a reassembled after its drop");
+  NS_TEST_EXPECT_MSG_EQ (m_memoryDrops, 1, "Packet dropped within the reassembly memory");
+
+  m_fragment = 0;
+  Simulator::Destroy ();
+}
+//-----------------------------------------------------------------------------
 class Ipv6FragmentationTestSuite : public TestSuite
 {
 public:
   Ipv6FragmentationTestSuite () : TestSuite ("ipv6-fragmentation", UNIT)
   {
     AddTestCase (new Ipv6FragmentationTest, TestCase::QUICK);
+    AddTestCase (new Ipv6ReassemblyTest, TestCase::QUICK);
   }
 } g_ipv6fragmentationTestSuite;
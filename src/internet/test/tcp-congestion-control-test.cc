@@ -0,0 +1,339 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Unit tests of the congestion control hooks of NewReno, HighSpeed, CUBIC and BBR
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/tcp-newreno.h"
+#include "ns3/tcp-highspeed.h"
+#include "ns3/tcp-cubic.h"
+#include "ns3/tcp-bbr.h"
+
+using namespace ns3;
+
+/**
+ * A socket whose congestion control hooks are driven by the tests
+ * rather than by the ACKs of a connection.
+ */
+template <class T>
+class TcpCongestionControlProbe : public T
+{
+public:
+  /**
+   * Set the window of the socket.
+   * \param cWnd the congestion window (bytes)
+   * \param ssThresh the slow start threshold (bytes)
+   * \param segmentSize the segment size (bytes)
+   */
+  void SetWindow (uint32_t cWnd, uint32_t ssThresh, uint32_t segmentSize)
+  {
+    this->m_segmentSize = segmentSize;
+    this->m_cWnd = cWnd;
+    this->m_ssThresh = ssThresh;
+  }
+  /**
+   * \return the congestion window (bytes)
+   */
+  uint32_t GetCWnd (void)
+  {
+    return this->m_cWnd;
+  }
+  /**
+   * Acknowledge new data, out of fast recovery.
+   * \param bytesAcked the number of bytes newly acknowledged
+   * \param rtt the RTT measured
+   */
+  void Ack (uint32_t bytesAcked, Time rtt)
+  {
+    this->PktsAcked (bytesAcked, rtt);
+    this->IncreaseWindow (bytesAcked);
+  }
+  /**
+   * Lose a segment: set the slow start threshold and the window as upon
+   * the end of the fast recovery.
+   * \param bytesInFlight the number of bytes in flight
+   */
+  void Loss (uint32_t bytesInFlight)
+  {
+    this->m_ssThresh = this->ReduceWindow (bytesInFlight);
+    this->m_cWnd = this->m_ssThresh;
+  }
+  /**
+   * \return the pacing rate
+   */
+  DataRate GetRate (void)
+  {
+    return this->GetPacingRate ();
+  }
+};
+
+/**
+ * NewReno: slow start, congestion avoidance and halving of the flight size.
+ */
+class TcpNewRenoHooksTestCase : public TestCase
+{
+public:
+  TcpNewRenoHooksTestCase ();
+  virtual ~TcpNewRenoHooksTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpNewRenoHooksTestCase::TcpNewRenoHooksTestCase ()
+  : TestCase ("NewReno congestion control hooks")
+{
+}
+
+TcpNewRenoHooksTestCase::~TcpNewRenoHooksTestCase ()
+{
+}
+
+void
+TcpNewRenoHooksTestCase::DoRun (void)
+{
+  Ptr<TcpCongestionControlProbe<TcpNewReno> > socket = CreateObject<TcpCongestionControlProbe<TcpNewReno> > ();
+  socket->SetWindow (10000, 20000, 1000);
+  socket->Ack (1000, MilliSeconds (100));
+  NS_TEST_EXPECT_MSG_EQ (socket->GetCWnd (), 11000, "One segment per ACK in slow start");
+  socket->SetWindow (20000, 10000, 1000);
+  socket->Ack (1000, MilliSeconds (100));
+  NS_TEST_EXPECT_MSG_EQ (socket->GetCWnd (), 20050, "segSize*segSize/cwnd per ACK in congestion avoidance");
+  socket->Loss (20000);
+  NS_TEST_EXPECT_MSG_EQ (socket->GetCWnd (), 10000, "Flight size not halved");
+  socket->Loss (3000);
+  NS_TEST_EXPECT_MSG_EQ (socket->GetCWnd (), 2000, "Less than two segments");
+}
+
+/**
+ * HighSpeed: a(w) and b(w) as in the table of RFC 3649, and a standard
+ * TCP up to LowWindow.
+ */
+class TcpHighSpeedHooksTestCase : public TestCase
+{
+public:
+  TcpHighSpeedHooksTestCase ();
+  virtual ~TcpHighSpeedHooksTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpHighSpeedHooksTestCase::TcpHighSpeedHooksTestCase ()
+  : TestCase ("HighSpeed congestion control hooks")
+{
+}
+
+TcpHighSpeedHooksTestCase::~TcpHighSpeedHooksTestCase ()
+{
+}
+
+void
+TcpHighSpeedHooksTestCase::DoRun (void)
+{
+  Ptr<TcpCongestionControlProbe<TcpHighSpeed> > socket = CreateObject<TcpCongestionControlProbe<TcpHighSpeed> > ();
+  // RFC3649 Appendix B
+  NS_TEST_EXPECT_MSG_EQ_TOL (socket->GetIncrease (118), 2, 0.1, "Wrong a(118)");
+  NS_TEST_EXPECT_MSG_EQ_TOL (socket->GetDecrease (118), 0.44, 0.01, "Wrong b(118)");
+  NS_TEST_EXPECT_MSG_EQ_TOL (socket->GetIncrease (1058), 8, 0.1, "Wrong a(1058)");
+  NS_TEST_EXPECT_MSG_EQ_TOL (socket->GetDecrease (1058), 0.33, 0.01, "Wrong b(1058)");
+  NS_TEST_EXPECT_MSG_EQ_TOL (socket->GetIncrease (10661), 30, 0.5, "Wrong a(10661)");
+  NS_TEST_EXPECT_MSG_EQ_TOL (socket->GetDecrease (10661), 0.21, 0.01, "Wrong b(10661)");
+  NS_TEST_EXPECT_MSG_EQ_TOL (socket->GetDecrease (83000), 0.1, 0.001, "Wrong b(83000)");
+
+  // Standard TCP up to LowWindow
+  socket->SetWindow (30000, 10000, 1000);
+  socket->Ack (1000, MilliSeconds (100));
+  NS_TEST_EXPECT_MSG_EQ (socket->GetCWnd (), 30033, "Not a standard TCP below LowWindow");
+  socket->Loss (30000);
+  NS_TEST_EXPECT_MSG_EQ (socket->GetCWnd (), 15000, "Not a standard TCP below LowWindow");
+
+  // a(w) segments per window of ACKs beyond
+  socket->SetWindow (1058000, 10000, 1000);
+  for (uint32_t i = 0; i < 1058; i++)
+    {
+      socket->Ack (1000, MilliSeconds (100));
+    }
+  NS_TEST_EXPECT_MSG_EQ_TOL (socket->GetCWnd (), 1066000, 200, "Not a(w) segments per RTT");
+  socket->SetWindow (1058000, 10000, 1000);
+  socket->Loss (1058000);
+  NS_TEST_EXPECT_MSG_EQ_TOL (socket->GetCWnd (), 1058000 * (1 - 0.327), 1000, "Not reduced by b(w)");
+}
+
+/**
+ * CUBIC: reduction by Beta, then growth back to the window at the loss
+ * along the cubic function.
+ */
+class TcpCubicHooksTestCase : public TestCase
+{
+public:
+  TcpCubicHooksTestCase ();
+  virtual ~TcpCubicHooksTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Acknowledge a tenth of the window every 10 ms, i.e. a window per RTT of
+   * 100 ms, until the end time, then record the window.
+   * \param socket the socket
+   * \param end the end time
+   * \param cWnd where to record the window
+   */
+  void AckUntil (Ptr<TcpCongestionControlProbe<TcpCubic> > socket, Time end, uint32_t *cWnd);
+};
+
+TcpCubicHooksTestCase::TcpCubicHooksTestCase ()
+  : TestCase ("CUBIC congestion control hooks")
+{
+}
+
+TcpCubicHooksTestCase::~TcpCubicHooksTestCase ()
+{
+}
+
+void
+TcpCubicHooksTestCase::AckUntil (Ptr<TcpCongestionControlProbe<TcpCubic> > socket, Time end, uint32_t *cWnd)
+{
+  socket->Ack (socket->GetCWnd () / 10, MilliSeconds (100));
+  if (Simulator::Now () + MilliSeconds (10) <= end)
+    {
+      Simulator::Schedule (MilliSeconds (10), &TcpCubicHooksTestCase::AckUntil, this, socket, end, cWnd);
+    }
+  else
+    {
+      *cWnd = socket->GetCWnd ();
+    }
+}
+
+void
+TcpCubicHooksTestCase::DoRun (void)
+{
+  Ptr<TcpCongestionControlProbe<TcpCubic> > socket = CreateObject<TcpCongestionControlProbe<TcpCubic> > ();
+  socket->SetWindow (100000, 10000, 1000);
+  socket->Ack (1000, MilliSeconds (100));
+  socket->Loss (100000);
+  NS_TEST_ASSERT_MSG_EQ (socket->GetCWnd (), 70000, "Not reduced by Beta");
+
+  // K = cbrt (W_max * (1 - Beta) / C) = 4.22 s, the RTT of 100 ms being looked ahead
+  uint32_t cWnd1 = 0;
+  uint32_t cWnd2 = 0;
+  uint32_t cWndK = 0;
+  uint32_t cWnd6 = 0;
+  Simulator::Schedule (Seconds (1), &TcpCubicHooksTestCase::AckUntil, this, socket, Seconds (2), &cWnd1);
+  Simulator::Schedule (Seconds (2.01), &TcpCubicHooksTestCase::AckUntil, this, socket, Seconds (3), &cWnd2);
+  Simulator::Schedule (Seconds (3.01), &TcpCubicHooksTestCase::AckUntil, this, socket, Seconds (5.12), &cWndK);
+  Simulator::Schedule (Seconds (5.13), &TcpCubicHooksTestCase::AckUntil, this, socket, Seconds (7), &cWnd6);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_GT (cWnd1 - 70000, cWnd2 - cWnd1, "Growth not concave below W_max");
+  NS_TEST_EXPECT_MSG_EQ_TOL (cWndK, 100000, 2000, "W_max not reached after K");
+  NS_TEST_EXPECT_MSG_GT (cWnd6, cWndK + 1000, "No probing beyond W_max");
+
+  // Fast convergence: a loss below W_max lowers W_max further
+  socket->SetWindow (90000, 10000, 1000);
+  socket->Loss (90000);
+  NS_TEST_EXPECT_MSG_EQ_TOL (socket->GetCWnd (), 63000, 1, "Not reduced by Beta");
+}
+
+/**
+ * BBR: estimates of the bandwidth and of the RTT, modes, pacing rate and
+ * window bound by the bandwidth-delay product.
+ */
+class TcpBbrHooksTestCase : public TestCase
+{
+public:
+  TcpBbrHooksTestCase ();
+  virtual ~TcpBbrHooksTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Acknowledge 1250 bytes every ms, i.e. deliver 10 Mbps, until the end time.
+   * \param socket the socket
+   * \param end the end time
+   */
+  void Deliver (Ptr<TcpCongestionControlProbe<TcpBbr> > socket, Time end);
+};
+
+TcpBbrHooksTestCase::TcpBbrHooksTestCase ()
+  : TestCase ("BBR congestion control hooks")
+{
+}
+
+TcpBbrHooksTestCase::~TcpBbrHooksTestCase ()
+{
+}
+
+void
+TcpBbrHooksTestCase::Deliver (Ptr<TcpCongestionControlProbe<TcpBbr> > socket, Time end)
+{
+  socket->Ack (1250, MilliSeconds (50));
+  if (Simulator::Now () < end)
+    {
+      Simulator::Schedule (MilliSeconds (1), &TcpBbrHooksTestCase::Deliver, this, socket, end);
+    }
+}
+
+void
+TcpBbrHooksTestCase::DoRun (void)
+{
+  Ptr<TcpCongestionControlProbe<TcpBbr> > socket = CreateObject<TcpCongestionControlProbe<TcpBbr> > ();
+  socket->SetWindow (10000, 65535, 1000);
+  NS_TEST_EXPECT_MSG_EQ (socket->GetMode (), TcpBbr::STARTUP, "Not in STARTUP");
+  socket->Ack (1000, MilliSeconds (60));
+  NS_TEST_EXPECT_MSG_EQ (socket->GetCWnd (), 11000, "Not as slow start in STARTUP");
+
+  Simulator::Schedule (MilliSeconds (1), &TcpBbrHooksTestCase::Deliver, this, socket, Seconds (1));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (socket->GetMinRtt (), MilliSeconds (50), "Wrong RTT estimate");
+  NS_TEST_EXPECT_MSG_EQ_TOL (socket->GetBottleneckBandwidth ().GetBitRate (), 10e6, 0.3e6, "Wrong bandwidth estimate");
+  // The bandwidth stopped growing and nothing is in flight: through DRAIN to PROBE_BW
+  NS_TEST_EXPECT_MSG_EQ (socket->GetMode (), TcpBbr::PROBE_BW, "Not in PROBE_BW");
+  // Twice the bandwidth-delay product of 62500 bytes
+  NS_TEST_EXPECT_MSG_EQ_TOL (socket->GetCWnd (), 125000, 4000, "Window not bound by the BDP");
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (socket->GetRate ().GetBitRate (), 7.5e6 * 0.97, "Pacing rate too low");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (socket->GetRate ().GetBitRate (), 12.5e6 * 1.03, "Pacing rate too high");
+  // No reduction upon a loss
+  socket->Loss (125000);
+  NS_TEST_EXPECT_MSG_EQ_TOL (socket->GetCWnd (), 125000, 4000, "Window reduced upon a loss");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * TCP congestion control TestSuite
+ */
+class TcpCongestionControlTestSuite : public TestSuite
+{
+public:
+  TcpCongestionControlTestSuite ();
+};
+
+TcpCongestionControlTestSuite::TcpCongestionControlTestSuite ()
+  : TestSuite ("tcp-congestion-control", UNIT)
+{
+  AddTestCase (new TcpNewRenoHooksTestCase, TestCase::QUICK);
+  AddTestCase (new TcpHighSpeedHooksTestCase, TestCase::QUICK);
+  AddTestCase (new TcpCubicHooksTestCase, TestCase::QUICK);
+  AddTestCase (new TcpBbrHooksTestCase, TestCase::QUICK);
+}
+
+static TcpCongestionControlTestSuite tcpCongestionControlTestSuite;
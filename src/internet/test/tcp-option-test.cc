@@ -22,6 +22,7 @@
 #include "ns3/tcp-option.h"
 #include "ns3/private/tcp-option-winscale.h"
 #include "ns3/private/tcp-option-ts.h"
+#include "ns3/private/tcp-option-sack.h"
 
 #include <string.h>
 
@@ -160,6 +161,85 @@ TcpOptionTSTestCase::DoTeardown ()
 {
 }
 
+class TcpOptionSackTestCase : public TestCase
+{
+public:
+  TcpOptionSackTestCase (std::string name, uint32_t nBlocks, uint32_t seq);
+
+  void TestSerialize ();
+  void TestDeserialize ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  TcpOptionSack::SackList m_blocks;
+  Buffer m_buffer;
+};
+
+
+TcpOptionSackTestCase::TcpOptionSackTestCase (std::string name, uint32_t nBlocks,
+                                              uint32_t seq)
+  : TestCase (name)
+{
+  for (uint32_t i = 0; i < nBlocks; ++i)
+    {
+      SequenceNumber32 left (seq + 2000 * i);
+      m_blocks.push_back (TcpOptionSack::SackBlock (left, left + SequenceNumber32 (1000)));
+    }
+}
+
+void
+TcpOptionSackTestCase::DoRun ()
+{
+  TestSerialize ();
+  TestDeserialize ();
+}
+
+void
+TcpOptionSackTestCase::TestSerialize ()
+{
+  TcpOptionSack opt;
+
+  for (TcpOptionSack::SackList::iterator it = m_blocks.begin (); it != m_blocks.end (); ++it)
+    {
+      opt.AddSackBlock (*it);
+    }
+  NS_TEST_EXPECT_MSG_EQ (opt.GetNumSackBlocks (), m_blocks.size (), "Blocks aren't saved correctly");
+  NS_TEST_EXPECT_MSG_EQ (opt.GetSerializedSize (), 2 + 8 * m_blocks.size (), "Wrong size");
+
+  m_buffer.AddAtStart (opt.GetSerializedSize ());
+
+  opt.Serialize (m_buffer.Begin ());
+}
+
+void
+TcpOptionSackTestCase::TestDeserialize ()
+{
+  TcpOptionSack opt;
+
+  Buffer::Iterator start = m_buffer.Begin ();
+  uint8_t kind = start.PeekU8 ();
+
+  NS_TEST_EXPECT_MSG_EQ (kind, TcpOption::SACK, "Different kind found");
+
+  uint32_t size = opt.Deserialize (start);
+
+  NS_TEST_EXPECT_MSG_EQ (size, 2 + 8 * m_blocks.size (), "Different size found");
+  NS_TEST_ASSERT_MSG_EQ (opt.GetNumSackBlocks (), m_blocks.size (), "Different number of blocks found");
+  TcpOptionSack::SackList::const_iterator found = opt.GetSackList ().begin ();
+  for (TcpOptionSack::SackList::iterator it = m_blocks.begin (); it != m_blocks.end (); ++it, ++found)
+    {
+      NS_TEST_EXPECT_MSG_EQ (found->first, it->first, "Different left edge found");
+      NS_TEST_EXPECT_MSG_EQ (found->second, it->second, "Different right edge found");
+    }
+}
+
+void
+TcpOptionSackTestCase::DoTeardown ()
+{
+}
+
 static class TcpOptionTestSuite : public TestSuite
 {
 public:
@@ -182,6 +262,12 @@ public:
                                               x->GetInteger ()), TestCase::QUICK);
       }
 
+    for (uint32_t i = 1; i <= TcpOptionSack::MAX_SACK_BLOCKS; ++i)
+      {
+        AddTestCase (new TcpOptionSackTestCase ("Testing serialization of SACK "
+                                                "blocks", i, x->GetInteger ()), TestCase::QUICK);
+      }
+
   }
 
 } g_TcpOptionTestSuite;
@@ -0,0 +1,330 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Tests of the bursts of data sent by a pacing socket
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/data-rate.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/tcp-l4-protocol.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-newreno.h"
+
+using namespace ns3;
+
+/**
+ * A NewReno socket paced at a fixed rate.
+ */
+class TcpPacingTestSocket : public TcpNewReno
+{
+public:
+  static TypeId GetTypeId (void);
+
+  TcpPacingTestSocket ();
+  /**
+   * \brief Copy constructor
+   * \param sock the object to copy
+   */
+  TcpPacingTestSocket (const TcpPacingTestSocket& sock);
+
+protected:
+  virtual Ptr<TcpSocketBase> Fork (void);
+  virtual DataRate GetPacingRate (void);
+
+private:
+  DataRate m_rate; //!< the pacing rate
+};
+
+TypeId
+TcpPacingTestSocket::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpPacingTestSocket")
+    .SetParent<TcpNewReno> ()
+    .AddConstructor<TcpPacingTestSocket> ()
+    .AddAttribute ("Rate", "The pacing rate",
+                   DataRateValue (DataRate ("1Mbps")),
+                   MakeDataRateAccessor (&TcpPacingTestSocket::m_rate),
+                   MakeDataRateChecker ())
+  ;
+  return tid;
+}
+
+TcpPacingTestSocket::TcpPacingTestSocket ()
+{
+}
+
+TcpPacingTestSocket::TcpPacingTestSocket (const TcpPacingTestSocket& sock)
+  : TcpNewReno (sock),
+    m_rate (sock.m_rate)
+{
+}
+
+Ptr<TcpSocketBase>
+TcpPacingTestSocket::Fork (void)
+{
+  return CopyObject<TcpPacingTestSocket> (this);
+}
+
+DataRate
+TcpPacingTestSocket::GetPacingRate (void)
+{
+  return m_rate;
+}
+
+/**
+ * The data sent at once by the socket.
+ */
+struct TcpPacingTestBurst
+{
+  Time time;      //!< the time of the burst
+  uint32_t bytes; //!< the bytes of data sent
+};
+
+/**
+ * Bursts of a socket paced at a fixed rate, over a 20 ms RTT.
+ *
+ * A burst is at most a quantum of 1 ms at the pacing rate, from 2 segments
+ * to 64 KB, rounded up to whole segments, also when the socket hands
+ * down large sends. The next burst follows a burst of a whole quantum by
+ * the time it takes at the pacing rate, as the ACKs received meanwhile
+ * do not send anything. When the window runs out before the quantum, the
+ * ACKs clock the data out instead, as without pacing.
+ */
+class TcpPacingTestCase : public TestCase
+{
+public:
+  /**
+   * \param rate the pacing rate
+   * \param initialCwnd the initial window (segments)
+   * \param largeSend the LargeSend attribute of the socket
+   * \param size the number of bytes to send
+   */
+  TcpPacingTestCase (DataRate rate, uint32_t initialCwnd, uint32_t largeSend, uint32_t size);
+  virtual ~TcpPacingTestCase ();
+
+private:
+  static std::string BuildNameString (DataRate rate, uint32_t initialCwnd, uint32_t largeSend);
+  virtual void DoRun (void);
+
+  /**
+   * Record a data segment sent.
+   * \param p the packet, with its IPv4 header
+   * \param ipv4 the IPv4 stack
+   * \param interface the interface
+   */
+  void Tx (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface);
+  /**
+   * Set the receive callback of the accepted socket.
+   * \param socket the accepted socket
+   * \param from the address of the peer
+   */
+  void Accept (Ptr<Socket> socket, const Address &from);
+  /**
+   * Read the data received.
+   * \param socket the receiving socket
+   */
+  void Receive (Ptr<Socket> socket);
+
+  DataRate m_rate;
+  uint32_t m_initialCwnd;
+  uint32_t m_largeSend;
+  uint32_t m_size;
+  uint32_t m_segmentSize;
+  std::vector<TcpPacingTestBurst> m_bursts; //!< the bursts sent
+  uint32_t m_largestSegment;                //!< the largest segment sent
+  uint32_t m_received;                      //!< the number of bytes received
+};
+
+std::string
+TcpPacingTestCase::BuildNameString (DataRate rate, uint32_t initialCwnd, uint32_t largeSend)
+{
+  std::ostringstream oss;
+  oss << "Pacing at " << rate.GetBitRate () << " bps, initial window of " << initialCwnd << " segments";
+  if (largeSend > 0)
+    {
+      oss << ", large sends of " << largeSend << " bytes";
+    }
+  return oss.str ();
+}
+
+TcpPacingTestCase::TcpPacingTestCase (DataRate rate, uint32_t initialCwnd, uint32_t largeSend, uint32_t size)
+  : TestCase (BuildNameString (rate, initialCwnd, largeSend)),
+    m_rate (rate),
+    m_initialCwnd (initialCwnd),
+    m_largeSend (largeSend),
+    m_size (size),
+    m_segmentSize (500),
+    m_largestSegment (0),
+    m_received (0)
+{
+}
+
+TcpPacingTestCase::~TcpPacingTestCase ()
+{
+}
+
+void
+TcpPacingTestCase::Tx (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  Ptr<Packet> copy = p->Copy ();
+  Ipv4Header ipHeader;
+  copy->RemoveHeader (ipHeader);
+  TcpHeader tcpHeader;
+  copy->RemoveHeader (tcpHeader);
+  if (copy->GetSize () == 0)
+    {
+      return;
+    }
+  if (m_bursts.empty () || m_bursts.back ().time != Simulator::Now ())
+    {
+      TcpPacingTestBurst burst;
+      burst.time = Simulator::Now ();
+      burst.bytes = 0;
+      m_bursts.push_back (burst);
+    }
+  m_bursts.back ().bytes += copy->GetSize ();
+  m_largestSegment = std::max (m_largestSegment, copy->GetSize ());
+}
+
+void
+TcpPacingTestCase::Accept (Ptr<Socket> socket, const Address &from)
+{
+  socket->SetRecvCallback (MakeCallback (&TcpPacingTestCase::Receive, this));
+}
+
+void
+TcpPacingTestCase::Receive (Ptr<Socket> socket)
+{
+  Ptr<Packet> p;
+  while ((p = socket->Recv ()))
+    {
+      m_received += p->GetSize ();
+    }
+}
+
+void
+TcpPacingTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper helper;
+  helper.SetNetDevicePointToPointMode (true);
+  helper.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (10)));
+  NetDeviceContainer devices = helper.Install (nodes);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.0");
+  address.Assign (devices);
+  nodes.Get (0)->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext ("Tx", MakeCallback (&TcpPacingTestCase::Tx, this));
+
+  Ptr<Socket> server = nodes.Get (1)->GetObject<TcpSocketFactory> ()->CreateSocket ();
+  server->SetAttribute ("RcvBufSize", UintegerValue (2 * m_size));
+  server->Bind (InetSocketAddress (Ipv4Address::GetAny (), 50000));
+  server->Listen ();
+  server->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                             MakeCallback (&TcpPacingTestCase::Accept, this));
+
+  Ptr<Socket> source = nodes.Get (0)->GetObject<TcpL4Protocol> ()->CreateSocket (TcpPacingTestSocket::GetTypeId ());
+  source->SetAttribute ("Rate", DataRateValue (m_rate));
+  source->SetAttribute ("Pacing", BooleanValue (true));
+  source->SetAttribute ("LargeSend", UintegerValue (m_largeSend));
+  source->SetAttribute ("SegmentSize", UintegerValue (m_segmentSize));
+  source->SetAttribute ("InitialCwnd", UintegerValue (m_initialCwnd));
+  source->SetAttribute ("SndBufSize", UintegerValue (2 * m_size));
+  source->Bind ();
+  source->Connect (InetSocketAddress (Ipv4Address ("10.0.0.2"), 50000));
+  NS_TEST_ASSERT_MSG_EQ (source->Send (Create<Packet> (m_size)), static_cast<int> (m_size), "data not queued");
+
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_received, m_size, "data lost");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (m_largestSegment, m_segmentSize, "segment larger than the segment size");
+
+  uint32_t quantum = std::max<uint64_t> (std::min<uint64_t> (m_rate.GetBitRate () / 8000, 65536), 2 * m_segmentSize);
+  uint32_t initialWindow = m_initialCwnd * m_segmentSize;
+  NS_TEST_ASSERT_MSG_GT (m_bursts.size (), 1, "all the data sent at once");
+  NS_TEST_EXPECT_MSG_EQ (m_bursts[0].bytes, std::min (initialWindow, (quantum + m_segmentSize - 1) / m_segmentSize * m_segmentSize),
+                         "the first burst is not a quantum or the initial window");
+  uint32_t paced = 0;
+  for (uint32_t i = 0; i < m_bursts.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_LT (m_bursts[i].bytes, quantum + m_segmentSize, "burst " << i << " larger than a quantum");
+      if (i + 1 < m_bursts.size () && m_bursts[i].bytes >= quantum)
+        {
+          Time gap = Seconds (m_rate.CalculateTxTime (m_bursts[i].bytes));
+          NS_TEST_EXPECT_MSG_GT_OR_EQ (m_bursts[i + 1].time - m_bursts[i].time, gap, "burst " << i + 1 << " not paced");
+          paced++;
+        }
+    }
+  if (initialWindow >= quantum)
+    {
+      NS_TEST_EXPECT_MSG_GT (paced, 0, "no burst paced");
+    }
+  else
+    {
+      // The window runs out first: the next data waits for the ACK of the
+      // first burst
+      NS_TEST_EXPECT_MSG_EQ (paced, 0, "burst paced by the timer");
+      NS_TEST_EXPECT_MSG_GT_OR_EQ (m_bursts[1].time - m_bursts[0].time, MilliSeconds (20), "data not clocked by the ACKs");
+    }
+
+  Simulator::Destroy ();
+}
+
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * TCP pacing TestSuite
+ */
+class TcpPacingTestSuite : public TestSuite
+{
+public:
+  TcpPacingTestSuite ();
+};
+
+TcpPacingTestSuite::TcpPacingTestSuite ()
+  : TestSuite ("tcp-pacing", UNIT)
+{
+  // Quanta of 2 segments, 5000 bytes and 64 KB
+  AddTestCase (new TcpPacingTestCase (DataRate ("1Mbps"), 20, 0, 50000), TestCase::QUICK);
+  AddTestCase (new TcpPacingTestCase (DataRate ("40Mbps"), 20, 0, 200000), TestCase::QUICK);
+  AddTestCase (new TcpPacingTestCase (DataRate ("1Gbps"), 200, 0, 400000), TestCase::QUICK);
+  // Large sends within the quantum
+  AddTestCase (new TcpPacingTestCase (DataRate ("40Mbps"), 20, 4000, 200000), TestCase::QUICK);
+  // The window runs out before the quantum
+  AddTestCase (new TcpPacingTestCase (DataRate ("1Gbps"), 4, 0, 20000), TestCase::QUICK);
+}
+
+static TcpPacingTestSuite tcpPacingTestSuite;
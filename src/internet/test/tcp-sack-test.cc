@@ -0,0 +1,543 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Unit tests of the Tx buffer index, of the SACK scoreboard and of the
+// SACK blocks of the Rx buffer, and of the retransmissions of a SACK socket
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/pointer.h"
+#include "ns3/data-rate.h"
+#include "ns3/error-model.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-tx-buffer.h"
+#include "ns3/tcp-rx-buffer.h"
+
+using namespace ns3;
+
+/**
+ * \return a packet of data whose bytes are the low byte of their offset in
+ * the stream
+ * \param offset the offset of the first byte
+ * \param size the size of the packet
+ */
+static Ptr<Packet>
+CreateStreamPacket (uint32_t offset, uint32_t size)
+{
+  std::vector<uint8_t> data (size);
+  for (uint32_t i = 0; i < size; i++)
+    {
+      data[i] = static_cast<uint8_t> (offset + i);
+    }
+  return Create<Packet> (&data[0], size);
+}
+
+/**
+ * Data copied out of the Tx buffer, across packet boundaries, before and
+ * after the head is discarded.
+ */
+class TcpTxBufferCopyTestCase : public TestCase
+{
+public:
+  TcpTxBufferCopyTestCase ();
+  virtual ~TcpTxBufferCopyTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Check the data copied from a sequence number
+   * \param buffer the buffer
+   * \param seq the sequence number
+   * \param size the size to copy
+   */
+  void CheckCopy (Ptr<TcpTxBuffer> buffer, uint32_t seq, uint32_t size);
+};
+
+TcpTxBufferCopyTestCase::TcpTxBufferCopyTestCase ()
+  : TestCase ("Data copied out of the indexed Tx buffer")
+{
+}
+
+TcpTxBufferCopyTestCase::~TcpTxBufferCopyTestCase ()
+{
+}
+
+void
+TcpTxBufferCopyTestCase::CheckCopy (Ptr<TcpTxBuffer> buffer, uint32_t seq, uint32_t size)
+{
+  // the stream starts at sequence number 1, after the SYN
+  uint32_t expected = std::min (size, buffer->SizeFromSequence (SequenceNumber32 (seq)));
+  Ptr<Packet> p = buffer->CopyFromSequence (size, SequenceNumber32 (seq));
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), expected, "wrong size copied from " << seq);
+  std::vector<uint8_t> data (expected + 1);
+  p->CopyData (&data[0], expected);
+  for (uint32_t i = 0; i < expected; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (data[i]), ((seq - 1 + i) & 0xff),
+                             "wrong byte " << i << " copied from " << seq);
+    }
+}
+
+void
+TcpTxBufferCopyTestCase::DoRun (void)
+{
+  Ptr<TcpTxBuffer> buffer = CreateObject<TcpTxBuffer> ();
+  buffer->SetMaxBufferSize (100000);
+
+  // packets written before the connection is set up are renumbered
+  const uint32_t sizes[] = { 100, 1, 536, 1000, 2, 300, 5000, 7 };
+  const uint32_t nSizes = sizeof (sizes) / sizeof (sizes[0]);
+  uint32_t offset = 0;
+  for (uint32_t i = 0; i < nSizes; i++)
+    {
+      if (i == 2)
+        {
+          buffer->SetHeadSequence (SequenceNumber32 (1));
+        }
+      NS_TEST_ASSERT_MSG_EQ (buffer->Add (CreateStreamPacket (offset, sizes[i])), true, "packet not added");
+      offset += sizes[i];
+    }
+  NS_TEST_ASSERT_MSG_EQ (buffer->Size (), offset, "wrong size");
+  NS_TEST_ASSERT_MSG_EQ (buffer->TailSequence (), SequenceNumber32 (1 + offset), "wrong tail");
+
+  const uint32_t copies[] = { 1, 99, 100, 536, 1460, 10000 };
+  const uint32_t nCopies = sizeof (copies) / sizeof (copies[0]);
+  for (uint32_t seq = 1; seq < 1 + offset; seq += 97)
+    {
+      for (uint32_t j = 0; j < nCopies; j++)
+        {
+          CheckCopy (buffer, seq, copies[j]);
+        }
+    }
+
+  // the head is discarded within and across packets
+  const uint32_t acks[] = { 51, 101, 102, 700, 1639, 1640, 2000, 6000, 1 + offset };
+  const uint32_t nAcks = sizeof (acks) / sizeof (acks[0]);
+  for (uint32_t i = 0; i < nAcks; i++)
+    {
+      buffer->DiscardUpTo (SequenceNumber32 (acks[i]));
+      NS_TEST_ASSERT_MSG_EQ (buffer->HeadSequence (), SequenceNumber32 (acks[i]), "wrong head");
+      NS_TEST_ASSERT_MSG_EQ (buffer->Size (), 1 + offset - acks[i], "wrong size after discard");
+      for (uint32_t j = 0; j < nCopies; j++)
+        {
+          CheckCopy (buffer, acks[i], copies[j]);
+          if (acks[i] + 13 < 1 + offset)
+            {
+              CheckCopy (buffer, acks[i] + 13, copies[j]);
+            }
+        }
+    }
+}
+
+/**
+ * Blocks SACKed by the receiver merged in the scoreboard, trimmed by the
+ * cumulative acknowledgment, and holes deemed lost.
+ */
+class TcpSackScoreboardTestCase : public TestCase
+{
+public:
+  TcpSackScoreboardTestCase ();
+  virtual ~TcpSackScoreboardTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpSackScoreboardTestCase::TcpSackScoreboardTestCase ()
+  : TestCase ("Blocks of the SACK scoreboard of the Tx buffer")
+{
+}
+
+TcpSackScoreboardTestCase::~TcpSackScoreboardTestCase ()
+{
+}
+
+void
+TcpSackScoreboardTestCase::DoRun (void)
+{
+  Ptr<TcpTxBuffer> buffer = CreateObject<TcpTxBuffer> ();
+  buffer->SetMaxBufferSize (100000);
+  buffer->SetHeadSequence (SequenceNumber32 (1));
+  buffer->Add (Create<Packet> (10000));
+
+  NS_TEST_EXPECT_MSG_EQ (buffer->AddSackBlock (SequenceNumber32 (1001), SequenceNumber32 (2001)), true, "block not SACKed");
+  NS_TEST_EXPECT_MSG_EQ (buffer->AddSackBlock (SequenceNumber32 (1001), SequenceNumber32 (2001)), false, "block SACKed twice");
+  buffer->AddSackBlock (SequenceNumber32 (3001), SequenceNumber32 (4001));
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetSackedBytes (), 2000, "wrong SACKed bytes");
+  // fills the gap between the two blocks
+  buffer->AddSackBlock (SequenceNumber32 (1501), SequenceNumber32 (3501));
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetSackedBytes (), 3000, "blocks not merged");
+  NS_TEST_EXPECT_MSG_EQ (buffer->IsSacked (SequenceNumber32 (1000)), false, "byte before the block SACKed");
+  NS_TEST_EXPECT_MSG_EQ (buffer->IsSacked (SequenceNumber32 (1001)), true, "first byte of the block not SACKed");
+  NS_TEST_EXPECT_MSG_EQ (buffer->IsSacked (SequenceNumber32 (4000)), true, "last byte of the block not SACKed");
+  NS_TEST_EXPECT_MSG_EQ (buffer->IsSacked (SequenceNumber32 (4001)), false, "byte after the block SACKed");
+
+  // the first hole has 3000 bytes SACKed above it
+  SequenceNumber32 seq (1);
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetLostHole (seq, 1072), 1000, "first hole not lost");
+  NS_TEST_EXPECT_MSG_EQ (seq, SequenceNumber32 (1), "wrong first hole");
+  seq = SequenceNumber32 (501);
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetLostHole (seq, 1072), 500, "end of the first hole not lost");
+  NS_TEST_EXPECT_MSG_EQ (seq, SequenceNumber32 (501), "wrong end of the first hole");
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetLostHole (seq, 3000), 0, "hole lost with too few bytes SACKed");
+
+  // the second hole has a single segment SACKed above it
+  buffer->AddSackBlock (SequenceNumber32 (5001), SequenceNumber32 (5537));
+  seq = SequenceNumber32 (2001);
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetLostHole (seq, 1072), 0, "second hole lost");
+  buffer->AddSackBlock (SequenceNumber32 (6001), SequenceNumber32 (7001));
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetLostHole (seq, 1072), 1000, "second hole not lost");
+  NS_TEST_EXPECT_MSG_EQ (seq, SequenceNumber32 (4001), "wrong second hole");
+
+  // blocks beyond the data are clipped
+  buffer->AddSackBlock (SequenceNumber32 (9001), SequenceNumber32 (20001));
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetSackedBytes (), 5536, "block not clipped");
+
+  // the cumulative acknowledgment trims the blocks
+  buffer->DiscardUpTo (SequenceNumber32 (1501));
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetSackedBytes (), 5036, "block not trimmed");
+  NS_TEST_EXPECT_MSG_EQ (buffer->IsSacked (SequenceNumber32 (1501)), true, "head not SACKed");
+  buffer->DiscardUpTo (SequenceNumber32 (5537));
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetSackedBytes (), 2000, "blocks not removed");
+  NS_TEST_EXPECT_MSG_EQ (buffer->AddSackBlock (SequenceNumber32 (1001), SequenceNumber32 (2001)), false,
+                         "block behind the head SACKed");
+
+  buffer->ResetScoreboard ();
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetSackedBytes (), 0, "scoreboard not reset");
+  NS_TEST_EXPECT_MSG_EQ (buffer->IsSacked (SequenceNumber32 (6001)), false, "scoreboard not reset");
+}
+
+/**
+ * Blocks of out-of-order data reported by the Rx buffer.
+ */
+class TcpRxBufferSackTestCase : public TestCase
+{
+public:
+  TcpRxBufferSackTestCase ();
+  virtual ~TcpRxBufferSackTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Add a packet of data to the buffer
+   * \param buffer the buffer
+   * \param seq the sequence number of the packet
+   * \param size the size of the packet
+   */
+  void AddPacket (Ptr<TcpRxBuffer> buffer, uint32_t seq, uint32_t size);
+};
+
+TcpRxBufferSackTestCase::TcpRxBufferSackTestCase ()
+  : TestCase ("Blocks of out-of-order data of the Rx buffer")
+{
+}
+
+TcpRxBufferSackTestCase::~TcpRxBufferSackTestCase ()
+{
+}
+
+void
+TcpRxBufferSackTestCase::AddPacket (Ptr<TcpRxBuffer> buffer, uint32_t seq, uint32_t size)
+{
+  TcpHeader header;
+  header.SetSequenceNumber (SequenceNumber32 (seq));
+  buffer->Add (Create<Packet> (size), header);
+}
+
+void
+TcpRxBufferSackTestCase::DoRun (void)
+{
+  Ptr<TcpRxBuffer> buffer = CreateObject<TcpRxBuffer> ();
+  buffer->SetMaxBufferSize (65535);
+  buffer->SetNextRxSequence (SequenceNumber32 (1));
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetSackList (4).size (), 0, "blocks without out-of-order data");
+
+  AddPacket (buffer, 1001, 500);
+  AddPacket (buffer, 2001, 500);
+  AddPacket (buffer, 2501, 500);
+  AddPacket (buffer, 4001, 500);
+
+  // the block of the last packet comes first, then the blocks in order
+  TcpRxBuffer::SackList blocks = buffer->GetSackList (4);
+  NS_TEST_ASSERT_MSG_EQ (blocks.size (), 3, "wrong number of blocks");
+  TcpRxBuffer::SackList::iterator it = blocks.begin ();
+  NS_TEST_EXPECT_MSG_EQ (it->first, SequenceNumber32 (4001), "wrong first block");
+  NS_TEST_EXPECT_MSG_EQ (it->second, SequenceNumber32 (4501), "wrong first block");
+  ++it;
+  NS_TEST_EXPECT_MSG_EQ (it->first, SequenceNumber32 (1001), "wrong second block");
+  NS_TEST_EXPECT_MSG_EQ (it->second, SequenceNumber32 (1501), "wrong second block");
+  ++it;
+  NS_TEST_EXPECT_MSG_EQ (it->first, SequenceNumber32 (2001), "contiguous packets not merged");
+  NS_TEST_EXPECT_MSG_EQ (it->second, SequenceNumber32 (3001), "contiguous packets not merged");
+
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetSackList (2).size (), 2, "too many blocks");
+
+  // the block of a packet merged with the previous ones comes first
+  AddPacket (buffer, 3001, 500);
+  blocks = buffer->GetSackList (4);
+  NS_TEST_ASSERT_MSG_EQ (blocks.size (), 3, "wrong number of blocks");
+  NS_TEST_EXPECT_MSG_EQ (blocks.front ().first, SequenceNumber32 (2001), "wrong first block");
+  NS_TEST_EXPECT_MSG_EQ (blocks.front ().second, SequenceNumber32 (3501), "wrong first block");
+
+  // in-order data is not reported
+  AddPacket (buffer, 1, 1000);
+  NS_TEST_EXPECT_MSG_EQ (buffer->NextRxSequence (), SequenceNumber32 (1501), "wrong next sequence");
+  blocks = buffer->GetSackList (4);
+  NS_TEST_ASSERT_MSG_EQ (blocks.size (), 2, "wrong number of blocks");
+  NS_TEST_EXPECT_MSG_EQ (blocks.front ().first, SequenceNumber32 (2001), "wrong first block");
+  NS_TEST_EXPECT_MSG_EQ (blocks.back ().first, SequenceNumber32 (4001), "wrong last block");
+}
+
+/**
+ * An error model which records the arrival times of the TCP data
+ * segments, and drops the first copy of the segments at the given
+ * sequence numbers.
+ */
+class TcpSegmentDropModel : public ErrorModel
+{
+public:
+  static TypeId GetTypeId (void);
+
+  TcpSegmentDropModel ();
+  virtual ~TcpSegmentDropModel ();
+
+  /**
+   * Drop the first copy of the segment at a sequence number.
+   * \param seq the sequence number
+   */
+  void Drop (SequenceNumber32 seq);
+
+  /// The arrival times of the data segments, by sequence number
+  std::map<SequenceNumber32, std::vector<Time> > m_arrivals;
+
+private:
+  virtual bool DoCorrupt (Ptr<Packet> p);
+  virtual void DoReset (void);
+
+  std::vector<SequenceNumber32> m_drops; //!< the segments to drop
+};
+
+TypeId
+TcpSegmentDropModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpSegmentDropModel")
+    .SetParent<ErrorModel> ()
+    .AddConstructor<TcpSegmentDropModel> ()
+    ;
+  return tid;
+}
+
+TcpSegmentDropModel::TcpSegmentDropModel ()
+{
+}
+
+TcpSegmentDropModel::~TcpSegmentDropModel ()
+{
+}
+
+void
+TcpSegmentDropModel::Drop (SequenceNumber32 seq)
+{
+  m_drops.push_back (seq);
+}
+
+bool
+TcpSegmentDropModel::DoCorrupt (Ptr<Packet> p)
+{
+  Ptr<Packet> copy = p->Copy ();
+  Ipv4Header ipHeader;
+  copy->RemoveHeader (ipHeader);
+  if (ipHeader.GetProtocol () != 6)
+    {
+      return false;
+    }
+  TcpHeader tcpHeader;
+  copy->RemoveHeader (tcpHeader);
+  if (copy->GetSize () == 0)
+    {
+      return false;
+    }
+  std::vector<Time> &arrivals = m_arrivals[tcpHeader.GetSequenceNumber ()];
+  arrivals.push_back (Simulator::Now ());
+  return (arrivals.size () == 1
+          && std::find (m_drops.begin (), m_drops.end (), tcpHeader.GetSequenceNumber ()) != m_drops.end ());
+}
+
+void
+TcpSegmentDropModel::DoReset (void)
+{
+}
+
+/**
+ * Retransmissions of a SACK socket which loses two segments of its first
+ * window.
+ *
+ * The first hole is retransmitted upon the third duplicate ACK, and the
+ * second one by SendLostHoles as soon as the SACKs show it lost, before
+ * the partial ACK of the first one. Then the retransmission of the
+ * second hole upon the partial ACK (DoRetransmit below HighRxt) must be
+ * suppressed: each hole is retransmitted once, and no other segment is.
+ */
+class TcpSackRetransmissionTestCase : public TestCase
+{
+public:
+  TcpSackRetransmissionTestCase ();
+  virtual ~TcpSackRetransmissionTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Set the receive callback of the accepted socket.
+   * \param socket the accepted socket
+   * \param from the address of the peer
+   */
+  void Accept (Ptr<Socket> socket, const Address &from);
+  /**
+   * Read the data received.
+   * \param socket the receiving socket
+   */
+  void Receive (Ptr<Socket> socket);
+
+  uint32_t m_received; //!< the number of bytes received
+};
+
+TcpSackRetransmissionTestCase::TcpSackRetransmissionTestCase ()
+  : TestCase ("Retransmissions of the holes of the SACK scoreboard"),
+    m_received (0)
+{
+}
+
+TcpSackRetransmissionTestCase::~TcpSackRetransmissionTestCase ()
+{
+}
+
+void
+TcpSackRetransmissionTestCase::Accept (Ptr<Socket> socket, const Address &from)
+{
+  socket->SetRecvCallback (MakeCallback (&TcpSackRetransmissionTestCase::Receive, this));
+}
+
+void
+TcpSackRetransmissionTestCase::Receive (Ptr<Socket> socket)
+{
+  Ptr<Packet> p;
+  while ((p = socket->Recv ()))
+    {
+      m_received += p->GetSize ();
+    }
+}
+
+void
+TcpSackRetransmissionTestCase::DoRun (void)
+{
+  const uint32_t segmentSize = 500;
+  const uint32_t size = 40 * segmentSize;
+  const Time delay = MilliSeconds (10);
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper helper;
+  helper.SetNetDevicePointToPointMode (true);
+  helper.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("10Mbps")));
+  helper.SetChannelAttribute ("Delay", TimeValue (delay));
+  NetDeviceContainer devices = helper.Install (nodes);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.0");
+  address.Assign (devices);
+
+  // Two holes in the first window of 10 segments
+  Ptr<TcpSegmentDropModel> drops = CreateObject<TcpSegmentDropModel> ();
+  SequenceNumber32 hole1 = SequenceNumber32 (1 + 3 * segmentSize);
+  SequenceNumber32 hole2 = SequenceNumber32 (1 + 6 * segmentSize);
+  drops->Drop (hole1);
+  drops->Drop (hole2);
+  devices.Get (1)->SetAttribute ("ReceiveErrorModel", PointerValue (drops));
+
+  Ptr<Socket> server = nodes.Get (1)->GetObject<TcpSocketFactory> ()->CreateSocket ();
+  server->SetAttribute ("Sack", BooleanValue (true));
+  server->Bind (InetSocketAddress (Ipv4Address::GetAny (), 50000));
+  server->Listen ();
+  server->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                             MakeCallback (&TcpSackRetransmissionTestCase::Accept, this));
+
+  Ptr<Socket> source = nodes.Get (0)->GetObject<TcpSocketFactory> ()->CreateSocket ();
+  source->SetAttribute ("Sack", BooleanValue (true));
+  source->SetAttribute ("SegmentSize", UintegerValue (segmentSize));
+  source->SetAttribute ("InitialCwnd", UintegerValue (10));
+  source->Bind ();
+  source->Connect (InetSocketAddress (Ipv4Address ("10.0.0.2"), 50000));
+  source->Send (Create<Packet> (size));
+
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_received, size, "data lost");
+  std::map<SequenceNumber32, std::vector<Time> > &arrivals = drops->m_arrivals;
+  NS_TEST_ASSERT_MSG_EQ (arrivals[hole1].size (), 2, "the first hole not retransmitted once");
+  NS_TEST_ASSERT_MSG_EQ (arrivals[hole2].size (), 2, "the second hole not retransmitted once");
+  NS_TEST_EXPECT_MSG_LT (arrivals[hole2][1], arrivals[hole1][1] + 2 * delay,
+                         "the second hole waited for the partial ACK");
+  NS_TEST_EXPECT_MSG_EQ (arrivals.size (), size / segmentSize, "segments of another size");
+  for (std::map<SequenceNumber32, std::vector<Time> >::iterator it = arrivals.begin (); it != arrivals.end (); ++it)
+    {
+      if (it->first != hole1 && it->first != hole2)
+        {
+          NS_TEST_EXPECT_MSG_EQ (it->second.size (), 1, "segment at " << it->first << " retransmitted");
+        }
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * TCP SACK TestSuite
+ */
+class TcpSackTestSuite : public TestSuite
+{
+public:
+  TcpSackTestSuite ();
+};
+
+TcpSackTestSuite::TcpSackTestSuite ()
+  : TestSuite ("tcp-sack", UNIT)
+{
+  AddTestCase (new TcpTxBufferCopyTestCase, TestCase::QUICK);
+  AddTestCase (new TcpSackScoreboardTestCase, TestCase::QUICK);
+  AddTestCase (new TcpRxBufferSackTestCase, TestCase::QUICK);
+  AddTestCase (new TcpSackRetransmissionTestCase, TestCase::QUICK);
+}
+
+static TcpSackTestSuite tcpSackTestSuite;
@@ -0,0 +1,261 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Unit tests of the split of the TCP large sends into segments
+
+#include <list>
+#include <vector>
+
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/segmentation-offload.h"
+#include "ns3/tcp-segmentation-offload.h"
+#include "ns3/tcp-header.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv6-header.h"
+
+using namespace ns3;
+
+/**
+ * \return a large send of size bytes whose bytes are the low byte of
+ * their offset, tagged with the segment size
+ * \param size the size of the data
+ * \param segmentSize the size of the data of each segment
+ */
+static Ptr<Packet>
+CreateLargeSend (uint32_t size, uint16_t segmentSize)
+{
+  std::vector<uint8_t> data (size);
+  for (uint32_t i = 0; i < size; i++)
+    {
+      data[i] = static_cast<uint8_t> (i);
+    }
+  Ptr<Packet> p = Create<Packet> (&data[0], size);
+  LargeSendTag tag;
+  tag.SetSegmentSize (segmentSize);
+  p->AddPacketTag (tag);
+  return p;
+}
+
+/**
+ * \return a TCP header with the FIN flag, from sequence number 1000
+ */
+static TcpHeader
+CreateTcpHeader (void)
+{
+  TcpHeader header;
+  header.SetSourcePort (1234);
+  header.SetDestinationPort (80);
+  header.SetSequenceNumber (SequenceNumber32 (1000));
+  header.SetAckNumber (SequenceNumber32 (1));
+  header.SetFlags (TcpHeader::ACK | TcpHeader::FIN);
+  header.SetWindowSize (1000);
+  return header;
+}
+
+/**
+ * IPv4 large sends split into segments of the tagged size, or of the
+ * size the MTU takes.
+ */
+class TcpSegmentationOffloadIpv4TestCase : public TestCase
+{
+public:
+  TcpSegmentationOffloadIpv4TestCase ();
+  virtual ~TcpSegmentationOffloadIpv4TestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Split a large send and check its segments.
+   * \param size the size of the data
+   * \param segmentSize the tagged size of the data of each segment
+   * \param mtu the MTU
+   * \param expected the expected size of the data of each segment
+   */
+  void CheckSplit (uint32_t size, uint16_t segmentSize, uint16_t mtu, uint32_t expected);
+};
+
+TcpSegmentationOffloadIpv4TestCase::TcpSegmentationOffloadIpv4TestCase ()
+  : TestCase ("Split of the IPv4 large sends")
+{
+}
+
+TcpSegmentationOffloadIpv4TestCase::~TcpSegmentationOffloadIpv4TestCase ()
+{
+}
+
+void
+TcpSegmentationOffloadIpv4TestCase::CheckSplit (uint32_t size, uint16_t segmentSize, uint16_t mtu, uint32_t expected)
+{
+  Ptr<Packet> p = CreateLargeSend (size, segmentSize);
+  p->AddHeader (CreateTcpHeader ());
+  Ipv4Header ipHeader;
+  ipHeader.SetSource (Ipv4Address ("10.0.0.1"));
+  ipHeader.SetDestination (Ipv4Address ("10.0.0.2"));
+  ipHeader.SetProtocol (6);
+  ipHeader.SetIdentification (65535);
+  ipHeader.SetPayloadSize (p->GetSize ());
+  p->AddHeader (ipHeader);
+
+  Ptr<TcpSegmentationOffload> offload = CreateObject<TcpSegmentationOffload> ();
+  std::list<Ptr<Packet> > segments;
+  NS_TEST_ASSERT_MSG_EQ (offload->Segment (p, 0x0800, mtu, segments), true, "Large send not split");
+  NS_TEST_ASSERT_MSG_EQ (segments.size (), (size + expected - 1) / expected, "Wrong number of segments");
+  NS_TEST_EXPECT_MSG_EQ (offload->GetSegmentCount (p, 0x0800, mtu), segments.size (), "Wrong number of segments announced");
+
+  uint32_t offset = 0;
+  uint16_t identification = 65535;
+  for (std::list<Ptr<Packet> >::iterator it = segments.begin (); it != segments.end (); ++it)
+    {
+      LargeSendTag tag;
+      NS_TEST_EXPECT_MSG_EQ ((*it)->PeekPacketTag (tag), false, "Segment still tagged");
+      NS_TEST_EXPECT_MSG_LT_OR_EQ ((*it)->GetSize (), mtu, "Segment larger than the MTU");
+      Ipv4Header segmentIpHeader;
+      (*it)->RemoveHeader (segmentIpHeader);
+      NS_TEST_EXPECT_MSG_EQ (segmentIpHeader.GetIdentification (), identification++, "Wrong identification");
+      NS_TEST_EXPECT_MSG_EQ (segmentIpHeader.GetPayloadSize (), (*it)->GetSize (), "Wrong payload size");
+      NS_TEST_EXPECT_MSG_EQ (segmentIpHeader.GetDestination (), Ipv4Address ("10.0.0.2"), "Wrong destination");
+      TcpHeader tcpHeader;
+      (*it)->RemoveHeader (tcpHeader);
+      NS_TEST_EXPECT_MSG_EQ (tcpHeader.GetSequenceNumber (), SequenceNumber32 (1000 + offset), "Wrong sequence number");
+      bool last = offset + (*it)->GetSize () == size;
+      NS_TEST_EXPECT_MSG_EQ (((tcpHeader.GetFlags () & TcpHeader::FIN) != 0), last, "FIN on a segment other than the last");
+      NS_TEST_EXPECT_MSG_EQ (((tcpHeader.GetFlags () & TcpHeader::ACK) != 0), true, "ACK lost");
+      NS_TEST_EXPECT_MSG_EQ ((*it)->GetSize (), std::min (expected, size - offset), "Wrong segment size");
+
+      std::vector<uint8_t> data ((*it)->GetSize ());
+      (*it)->CopyData (&data[0], data.size ());
+      for (uint32_t i = 0; i < data.size (); i++)
+        {
+          uint8_t byte = static_cast<uint8_t> (offset + i);
+          if (data[i] != byte)
+            {
+              NS_TEST_EXPECT_MSG_EQ (static_cast<uint32_t> (data[i]), static_cast<uint32_t> (byte),
+                                     "Wrong data at offset " << offset + i);
+              break;
+            }
+        }
+      offset += (*it)->GetSize ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (offset, size, "Data lost");
+}
+
+void
+TcpSegmentationOffloadIpv4TestCase::DoRun (void)
+{
+  // Whole segments and a smaller last one
+  CheckSplit (5000, 1460, 1500, 1460);
+  CheckSplit (2920, 1460, 1500, 1460);
+  // The MTU takes less than the tagged size
+  CheckSplit (5000, 1460, 1000, 960);
+}
+
+/**
+ * IPv6 large sends split into segments, and the packets which are not
+ * TCP large sends left alone.
+ */
+class TcpSegmentationOffloadIpv6TestCase : public TestCase
+{
+public:
+  TcpSegmentationOffloadIpv6TestCase ();
+  virtual ~TcpSegmentationOffloadIpv6TestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpSegmentationOffloadIpv6TestCase::TcpSegmentationOffloadIpv6TestCase ()
+  : TestCase ("Split of the IPv6 large sends")
+{
+}
+
+TcpSegmentationOffloadIpv6TestCase::~TcpSegmentationOffloadIpv6TestCase ()
+{
+}
+
+void
+TcpSegmentationOffloadIpv6TestCase::DoRun (void)
+{
+  Ptr<TcpSegmentationOffload> offload = CreateObject<TcpSegmentationOffload> ();
+
+  Ptr<Packet> p = CreateLargeSend (4000, 1440);
+  p->AddHeader (CreateTcpHeader ());
+  Ipv6Header ipHeader;
+  ipHeader.SetSourceAddress (Ipv6Address ("2001:db8::1"));
+  ipHeader.SetDestinationAddress (Ipv6Address ("2001:db8::2"));
+  ipHeader.SetNextHeader (6);
+  ipHeader.SetHopLimit (64);
+  ipHeader.SetPayloadLength (p->GetSize ());
+  p->AddHeader (ipHeader);
+
+  std::list<Ptr<Packet> > segments;
+  NS_TEST_ASSERT_MSG_EQ (offload->Segment (p, 0x86dd, 1500, segments), true, "Large send not split");
+  NS_TEST_ASSERT_MSG_EQ (segments.size (), 3, "Wrong number of segments");
+  NS_TEST_EXPECT_MSG_EQ (offload->GetSegmentCount (p, 0x86dd, 1500), 3, "Wrong number of segments announced");
+  uint32_t offset = 0;
+  for (std::list<Ptr<Packet> >::iterator it = segments.begin (); it != segments.end (); ++it)
+    {
+      Ipv6Header segmentIpHeader;
+      (*it)->RemoveHeader (segmentIpHeader);
+      NS_TEST_EXPECT_MSG_EQ (segmentIpHeader.GetPayloadLength (), (*it)->GetSize (), "Wrong payload length");
+      NS_TEST_EXPECT_MSG_EQ (segmentIpHeader.GetHopLimit (), 64, "Wrong hop limit");
+      TcpHeader tcpHeader;
+      (*it)->RemoveHeader (tcpHeader);
+      NS_TEST_EXPECT_MSG_EQ (tcpHeader.GetSequenceNumber (), SequenceNumber32 (1000 + offset), "Wrong sequence number");
+      offset += (*it)->GetSize ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (offset, 4000, "Data lost");
+
+  // Not a large send
+  segments.clear ();
+  Ptr<Packet> q = Create<Packet> (4000);
+  q->AddHeader (CreateTcpHeader ());
+  q->AddHeader (ipHeader);
+  NS_TEST_EXPECT_MSG_EQ (offload->Segment (q, 0x86dd, 1500, segments), false, "Packet without tag split");
+  NS_TEST_EXPECT_MSG_EQ (offload->GetSegmentCount (q, 0x86dd, 1500), 0, "Packet without tag split");
+  // Not TCP
+  Ptr<Packet> r = CreateLargeSend (4000, 1440);
+  ipHeader.SetNextHeader (17);
+  r->AddHeader (ipHeader);
+  NS_TEST_EXPECT_MSG_EQ (offload->Segment (r, 0x86dd, 1500, segments), false, "UDP packet split");
+  NS_TEST_EXPECT_MSG_EQ (offload->GetSegmentCount (r, 0x86dd, 1500), 0, "UDP packet split");
+  // Headers larger than the MTU
+  NS_TEST_EXPECT_MSG_EQ (offload->GetSegmentCount (p, 0x86dd, 60), 0, "Split above the MTU");
+  NS_TEST_EXPECT_MSG_EQ (offload->Segment (p, 0x86dd, 60, segments), false, "Split above the MTU");
+  NS_TEST_EXPECT_MSG_EQ (segments.empty (), true, "Segments appended on failure");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * TCP segmentation offload TestSuite
+ */
+class TcpSegmentationOffloadTestSuite : public TestSuite
+{
+public:
+  TcpSegmentationOffloadTestSuite ();
+};
+
+TcpSegmentationOffloadTestSuite::TcpSegmentationOffloadTestSuite ()
+  : TestSuite ("tcp-segmentation-offload", UNIT)
+{
+  AddTestCase (new TcpSegmentationOffloadIpv4TestCase, TestCase::QUICK);
+  AddTestCase (new TcpSegmentationOffloadIpv6TestCase, TestCase::QUICK);
+}
+
+static TcpSegmentationOffloadTestSuite tcpSegmentationOffloadTestSuite;
@@ -0,0 +1,215 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Unit tests of the timer wheel of the neighbor caches
+
+#include <vector>
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/timer-wheel.h"
+
+using namespace ns3;
+
+/**
+ * A timer which records when it expires.
+ */
+class TimerWheelTestTimer
+{
+public:
+  TimerWheelTestTimer (TimerWheel *wheel)
+    : m_timer (wheel),
+      m_count (0)
+  {
+    m_timer.SetFunction (MakeCallback (&TimerWheelTestTimer::Expire, this));
+  }
+  void Start (Time delay)
+  {
+    m_expected = Simulator::Now () + delay;
+    m_timer.Schedule (delay);
+  }
+  void Expire ()
+  {
+    m_expired = Simulator::Now ();
+    m_count++;
+  }
+
+  TimerWheel::Timer m_timer; //!< the timer
+  Time m_expected;           //!< the time at which it should expire
+  Time m_expired;            //!< the time at which it expired
+  uint32_t m_count;          //!< the number of times it expired
+};
+
+/**
+ * Timers of all the levels of the wheel, started at random times, expire
+ * once, neither early nor later than one tick.
+ */
+class TimerWheelExpireTestCase : public TestCase
+{
+public:
+  TimerWheelExpireTestCase ();
+  virtual ~TimerWheelExpireTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TimerWheelExpireTestCase::TimerWheelExpireTestCase ()
+  : TestCase ("Timers of the wheel expire once, within one tick")
+{
+}
+
+TimerWheelExpireTestCase::~TimerWheelExpireTestCase ()
+{
+}
+
+void
+TimerWheelExpireTestCase::DoRun (void)
+{
+  TimerWheel wheel;
+  wheel.SetResolution (MilliSeconds (10));
+
+  // first level, boundaries of the levels, and up to the fourth level
+  const uint32_t delays[] = { 1, 10, 15, 630, 640, 655, 1000, 5000, 30000, 40950, 41000, 100000, 3000000 };
+  const uint32_t nDelays = sizeof (delays) / sizeof (delays[0]);
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+  std::vector<TimerWheelTestTimer *> timers;
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      TimerWheelTestTimer *timer = new TimerWheelTestTimer (&wheel);
+      Time start = MicroSeconds (rng->GetInteger (0, 20000000));
+      Simulator::Schedule (start, &TimerWheelTestTimer::Start, timer, MilliSeconds (delays[i % nDelays]));
+      timers.push_back (timer);
+    }
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (wheel.GetNTimers (), 0, "timers still running");
+  for (uint32_t i = 0; i < timers.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (timers[i]->m_count, 1, "timer " << i << " expired " << timers[i]->m_count << " times");
+      NS_TEST_EXPECT_MSG_EQ ((timers[i]->m_expired >= timers[i]->m_expected), true,
+                             "timer " << i << " expired early at " << timers[i]->m_expired << " instead of " << timers[i]->m_expected);
+      NS_TEST_EXPECT_MSG_EQ ((timers[i]->m_expired < timers[i]->m_expected + MilliSeconds (10)), true,
+                             "timer " << i << " expired late at " << timers[i]->m_expired << " instead of " << timers[i]->m_expected);
+      delete timers[i];
+    }
+  Simulator::Destroy ();
+}
+
+/**
+ * Timers cancelled, restarted and destroyed, including by an expiring
+ * timer.
+ */
+class TimerWheelCancelTestCase : public TestCase
+{
+public:
+  TimerWheelCancelTestCase ();
+  virtual ~TimerWheelCancelTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /// Expire function of the first timer: cancels the second one, destroys
+  /// the third one and restarts itself.
+  void ExpireFirst ();
+
+  TimerWheelTestTimer *m_first;  //!< the first timer
+  TimerWheelTestTimer *m_second; //!< the second timer
+  TimerWheelTestTimer *m_third;  //!< the third timer
+};
+
+TimerWheelCancelTestCase::TimerWheelCancelTestCase ()
+  : TestCase ("Timers of the wheel cancelled, restarted and destroyed")
+{
+}
+
+TimerWheelCancelTestCase::~TimerWheelCancelTestCase ()
+{
+}
+
+void
+TimerWheelCancelTestCase::ExpireFirst ()
+{
+  m_first->Expire ();
+  m_second->m_timer.Cancel ();
+  delete m_third;
+  m_third = 0;
+  if (m_first->m_count == 1)
+    {
+      m_first->Start (Seconds (1));
+    }
+}
+
+void
+TimerWheelCancelTestCase::DoRun (void)
+{
+  TimerWheel wheel;
+  m_first = new TimerWheelTestTimer (&wheel);
+  m_first->m_timer.SetFunction (MakeCallback (&TimerWheelCancelTestCase::ExpireFirst, this));
+  m_second = new TimerWheelTestTimer (&wheel);
+  m_third = new TimerWheelTestTimer (&wheel);
+  TimerWheelTestTimer restarted (&wheel);
+  TimerWheelTestTimer cancelled (&wheel);
+
+  m_first->Start (Seconds (2));
+  m_second->Start (Seconds (3));
+  m_third->Start (Seconds (2.5));
+  cancelled.Start (Seconds (10));
+  restarted.Start (Seconds (30));
+  NS_TEST_ASSERT_MSG_EQ (wheel.GetNTimers (), 5, "wrong number of timers");
+
+  // restarted as the reachable timer of a neighbor cache entry is
+  for (uint32_t i = 1; i < 20; i++)
+    {
+      Simulator::Schedule (Seconds (i), &TimerWheel::Timer::Cancel, &restarted.m_timer);
+      Simulator::Schedule (Seconds (i), &TimerWheelTestTimer::Start, &restarted, Seconds (30));
+    }
+  Simulator::Schedule (Seconds (5), &TimerWheel::Timer::Cancel, &cancelled.m_timer);
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_first->m_count, 2, "first timer not restarted");
+  NS_TEST_EXPECT_MSG_EQ (m_first->m_expired, Seconds (3), "first timer restarted at the wrong time");
+  NS_TEST_EXPECT_MSG_EQ (m_second->m_count, 0, "second timer not cancelled");
+  NS_TEST_EXPECT_MSG_EQ (m_third, 0, "third timer not destroyed");
+  NS_TEST_EXPECT_MSG_EQ (cancelled.m_count, 0, "timer not cancelled");
+  NS_TEST_EXPECT_MSG_EQ (restarted.m_count, 1, "restarted timer expired more than once");
+  NS_TEST_EXPECT_MSG_EQ (restarted.m_expired, Seconds (49), "restarted timer expired at the wrong time");
+  NS_TEST_EXPECT_MSG_EQ (wheel.GetNTimers (), 0, "timers still running");
+
+  delete m_first;
+  delete m_second;
+  Simulator::Destroy ();
+}
+
+/**
+ * TimerWheel TestSuite
+ */
+class TimerWheelTestSuite : public TestSuite
+{
+public:
+  TimerWheelTestSuite ();
+};
+
+TimerWheelTestSuite::TimerWheelTestSuite ()
+  : TestSuite ("timer-wheel", UNIT)
+{
+  AddTestCase (new TimerWheelExpireTestCase, TestCase::QUICK);
+  AddTestCase (new TimerWheelCancelTestCase, TestCase::QUICK);
+}
+
+static TimerWheelTestSuite timerWheelTestSuite;
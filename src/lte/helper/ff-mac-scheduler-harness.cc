@@ -0,0 +1,547 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "ff-mac-scheduler-harness.h"
+#include <ns3/log.h>
+#include <ns3/uinteger.h>
+#include <ns3/double.h>
+#include <ns3/enum.h>
+#include <ns3/ff-mac-sched-sap.h>
+#include <ns3/ff-mac-csched-sap.h>
+#include <ns3/lte-fr-no-op-algorithm.h>
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FfMacSchedulerHarness");
+
+NS_OBJECT_ENSURE_REGISTERED (FfMacSchedulerHarness);
+
+const uint32_t FfMacSchedulerHarness::DL_HARQ_FEEDBACK_DELAY;
+const uint32_t FfMacSchedulerHarness::UL_HARQ_FEEDBACK_DELAY;
+
+
+/**
+ * Keeps the last allocations of the scheduler.
+ */
+class FfMacSchedulerHarness::SchedSapUser : public FfMacSchedSapUser
+{
+public:
+  virtual void SchedDlConfigInd (const struct SchedDlConfigIndParameters& params)
+  {
+    m_dlConfig = params.m_buildDataList;
+  }
+  virtual void SchedUlConfigInd (const struct SchedUlConfigIndParameters& params)
+  {
+    m_ulConfig = params.m_dciList;
+  }
+
+  std::vector<BuildDataListElement_s> m_dlConfig; //!< the DL allocations of the last DL trigger
+  std::vector<UlDciListElement_s> m_ulConfig;     //!< the UL allocations of the last UL trigger
+};
+
+/**
+ * Ignores the confirmations of the scheduler.
+ */
+class FfMacSchedulerHarness::CschedSapUser : public FfMacCschedSapUser
+{
+public:
+  virtual void CschedCellConfigCnf (const struct CschedCellConfigCnfParameters& params)
+  {
+  }
+  virtual void CschedUeConfigCnf (const struct CschedUeConfigCnfParameters& params)
+  {
+  }
+  virtual void CschedLcConfigCnf (const struct CschedLcConfigCnfParameters& params)
+  {
+  }
+  virtual void CschedLcReleaseCnf (const struct CschedLcReleaseCnfParameters& params)
+  {
+  }
+  virtual void CschedUeReleaseCnf (const struct CschedUeReleaseCnfParameters& params)
+  {
+  }
+  virtual void CschedUeConfigUpdateInd (const struct CschedUeConfigUpdateIndParameters& params)
+  {
+  }
+  virtual void CschedCellConfigUpdateInd (const struct CschedCellConfigUpdateIndParameters& params)
+  {
+  }
+};
+
+
+/// the LCID of the data radio bearer of each UE
+static const uint8_t HARNESS_LCID = 3;
+
+/**
+ * \param hash the current hash
+ * \param value a value
+ * \return the hash combined with the value (FNV-1a)
+ */
+static uint64_t
+HashCombine (uint64_t hash, uint64_t value)
+{
+  return (hash ^ value) * 1099511628211ULL;
+}
+
+/**
+ * \param bandwidth a DL bandwidth (RBs)
+ * \return the size of the RBGs (RBs), see 3GPP TS 36.213 table 7.1.6.1-1
+ */
+static uint8_t
+GetRbgSize (uint8_t bandwidth)
+{
+  if (bandwidth <= 10)
+    {
+      return 1;
+    }
+  if (bandwidth <= 26)
+    {
+      return 2;
+    }
+  if (bandwidth <= 63)
+    {
+      return 3;
+    }
+  return 4;
+}
+
+
+double
+FfMacSchedulerHarness::Result::GetLatencyPercentile (double percentile) const
+{
+  if (m_latency.empty ())
+    {
+      return 0;
+    }
+  std::vector<double> sorted (m_latency);
+  std::sort (sorted.begin (), sorted.end ());
+  // nearest-rank percentile
+  double rank = std::ceil (percentile / 100.0 * sorted.size ());
+  uint32_t index = (rank < 1) ? 0 : std::min<uint32_t> ((uint32_t) rank - 1, sorted.size () - 1);
+  return sorted[index];
+}
+
+double
+FfMacSchedulerHarness::Result::GetMeanLatency (void) const
+{
+  if (m_latency.empty ())
+    {
+      return 0;
+    }
+  double sum = 0;
+  for (std::vector<double>::const_iterator it = m_latency.begin (); it != m_latency.end (); ++it)
+    {
+      sum += *it;
+    }
+  return sum / m_latency.size ();
+}
+
+
+FfMacSchedulerHarness::FfMacSchedulerHarness ()
+  : m_stream (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_schedulerFactory.SetTypeId ("ns3::PfFfMacScheduler");
+  m_uniform = CreateObject<UniformRandomVariable> ();
+}
+
+FfMacSchedulerHarness::~FfMacSchedulerHarness ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TypeId
+FfMacSchedulerHarness::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FfMacSchedulerHarness")
+    .SetParent<Object> ()
+    .AddConstructor<FfMacSchedulerHarness> ()
+    .AddAttribute ("NumberOfUes",
+                   "The number of UEs of the cell, with RNTIs from 1.",
+                   UintegerValue (50),
+                   MakeUintegerAccessor (&FfMacSchedulerHarness::m_nUes),
+                   MakeUintegerChecker<uint16_t> (1, 65523))
+    .AddAttribute ("Bandwidth",
+                   "The DL and UL bandwidth of the cell, in RBs.",
+                   UintegerValue (25),
+                   MakeUintegerAccessor (&FfMacSchedulerHarness::m_bandwidth),
+                   MakeUintegerChecker<uint8_t> (6, 100))
+    .AddAttribute ("CqiType",
+                   "The type of the DL CQI reports: wideband (P10) or higher layer configured subband (A30).",
+                   EnumValue (CqiListElement_s::A30),
+                   MakeEnumAccessor (&FfMacSchedulerHarness::m_cqiType),
+                   MakeEnumChecker (CqiListElement_s::P10, "P10",
+                                    CqiListElement_s::A30, "A30"))
+    .AddAttribute ("CqiPeriod",
+                   "The period of the DL CQI reports of each UE, in TTIs.",
+                   UintegerValue (5),
+                   MakeUintegerAccessor (&FfMacSchedulerHarness::m_cqiPeriod),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("BsrPeriod",
+                   "The period of the BSRs of each UE, in TTIs.",
+                   UintegerValue (5),
+                   MakeUintegerAccessor (&FfMacSchedulerHarness::m_bsrPeriod),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("RlcBufferSize",
+                   "The size of the DL and UL buffers reported for each UE, in bytes.",
+                   UintegerValue (100000),
+                   MakeUintegerAccessor (&FfMacSchedulerHarness::m_rlcBufferSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("NackProbability",
+                   "The probability that the HARQ feedback of a TB is a NACK.",
+                   DoubleValue (0.1),
+                   MakeDoubleAccessor (&FfMacSchedulerHarness::m_nackProbability),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+  ;
+  return tid;
+}
+
+void
+FfMacSchedulerHarness::DoDispose ()
+{
+  NS_LOG_FUNCTION (this);
+  m_uniform = 0;
+  Object::DoDispose ();
+}
+
+void
+FfMacSchedulerHarness::SetSchedulerType (std::string type)
+{
+  NS_LOG_FUNCTION (this << type);
+  m_schedulerFactory = ObjectFactory ();
+  m_schedulerFactory.SetTypeId (type);
+}
+
+void
+FfMacSchedulerHarness::SetSchedulerAttribute (std::string n, const AttributeValue &v)
+{
+  NS_LOG_FUNCTION (this << n);
+  m_schedulerFactory.Set (n, v);
+}
+
+int64_t
+FfMacSchedulerHarness::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_stream = stream;
+  return 1;
+}
+
+CqiListElement_s
+FfMacSchedulerHarness::CreateDlCqi (uint16_t rnti, uint8_t meanCqi, uint16_t nRbgs)
+{
+  CqiListElement_s cqi;
+  cqi.m_rnti = rnti;
+  cqi.m_ri = 1;
+  cqi.m_cqiType = m_cqiType;
+  cqi.m_wbPmi = 0;
+  cqi.m_wbCqi.push_back (meanCqi);
+  if (m_cqiType == CqiListElement_s::A30)
+    {
+      cqi.m_sbMeasResult.m_higherLayerSelected.resize (nRbgs);
+      for (uint16_t rbg = 0; rbg < nRbgs; rbg++)
+        {
+          int32_t sbCqi = meanCqi + (int32_t) m_uniform->GetInteger (0, 4) - 2;
+          HigherLayerSelected_s &sb = cqi.m_sbMeasResult.m_higherLayerSelected[rbg];
+          sb.m_sbPmi = 0;
+          sb.m_sbCqi.push_back (std::max (1, std::min (15, sbCqi)));
+        }
+    }
+  return cqi;
+}
+
+FfMacSchedulerHarness::Result
+FfMacSchedulerHarness::Run (uint32_t ttis)
+{
+  NS_LOG_FUNCTION (this << ttis);
+  return Run (m_schedulerFactory.Create<FfMacScheduler> (), ttis);
+}
+
+FfMacSchedulerHarness::Result
+FfMacSchedulerHarness::Run (Ptr<FfMacScheduler> scheduler, uint32_t ttis)
+{
+  NS_LOG_FUNCTION (this << scheduler << ttis);
+  // restart the sequence of the random draws
+  m_uniform->SetStream (m_stream);
+
+  Ptr<LteFfrAlgorithm> ffr = CreateObject<LteFrNoOpAlgorithm> ();
+  scheduler->SetLteFfrSapProvider (ffr->GetLteFfrSapProvider ());
+  ffr->SetLteFfrSapUser (scheduler->GetLteFfrSapUser ());
+  ffr->SetDlBandwidth (m_bandwidth);
+  ffr->SetUlBandwidth (m_bandwidth);
+  scheduler->Initialize ();
+  ffr->Initialize ();
+
+  SchedSapUser schedSapUser;
+  CschedSapUser cschedSapUser;
+  scheduler->SetFfMacSchedSapUser (&schedSapUser);
+  scheduler->SetFfMacCschedSapUser (&cschedSapUser);
+  FfMacSchedSapProvider *sched = scheduler->GetFfMacSchedSapProvider ();
+  FfMacCschedSapProvider *csched = scheduler->GetFfMacCschedSapProvider ();
+
+  FfMacCschedSapProvider::CschedCellConfigReqParameters cellConfig;
+  cellConfig.m_ulBandwidth = m_bandwidth;
+  cellConfig.m_dlBandwidth = m_bandwidth;
+  csched->CschedCellConfigReq (cellConfig);
+
+  FfMacSchedSapProvider::SchedDlRlcBufferReqParameters rlcBuffer;
+  rlcBuffer.m_logicalChannelIdentity = HARNESS_LCID;
+  rlcBuffer.m_rlcTransmissionQueueSize = m_rlcBufferSize;
+  rlcBuffer.m_rlcTransmissionQueueHolDelay = 0;
+  rlcBuffer.m_rlcRetransmissionQueueSize = 0;
+  rlcBuffer.m_rlcRetransmissionHolDelay = 0;
+  rlcBuffer.m_rlcStatusPduSize = 0;
+
+  std::vector<uint8_t> meanCqi (m_nUes + 1);
+  std::vector<double> meanUlSinr (m_nUes + 1);
+  for (uint16_t rnti = 1; rnti <= m_nUes; rnti++)
+    {
+      FfMacCschedSapProvider::CschedUeConfigReqParameters ueConfig;
+      ueConfig.m_rnti = rnti;
+      ueConfig.m_transmissionMode = 0;
+      csched->CschedUeConfigReq (ueConfig);
+
+      FfMacCschedSapProvider::CschedLcConfigReqParameters lcConfig;
+      lcConfig.m_rnti = rnti;
+      lcConfig.m_reconfigureFlag = false;
+      LogicalChannelConfigListElement_s lc;
+      lc.m_logicalChannelIdentity = HARNESS_LCID;
+      lc.m_logicalChannelGroup = 1;
+      lc.m_direction = LogicalChannelConfigListElement_s::DIR_BOTH;
+      lc.m_qosBearerType = LogicalChannelConfigListElement_s::QBT_NON_GBR;
+      lc.m_qci = 9;
+      lc.m_eRabMaximulBitrateUl = 0;
+      lc.m_eRabMaximulBitrateDl = 0;
+      lc.m_eRabGuaranteedBitrateUl = 0;
+      lc.m_eRabGuaranteedBitrateDl = 0;
+      lcConfig.m_logicalChannelConfigList.push_back (lc);
+      csched->CschedLcConfigReq (lcConfig);
+
+      rlcBuffer.m_rnti = rnti;
+      sched->SchedDlRlcBufferReq (rlcBuffer);
+
+      meanCqi[rnti] = m_uniform->GetInteger (1, 15);
+      // roughly the SINR (dB) at which the CQI is reported
+      meanUlSinr[rnti] = 2.0 * meanCqi[rnti] - 10.0;
+    }
+
+  uint16_t nRbgs = (m_bandwidth + GetRbgSize (m_bandwidth) - 1) / GetRbgSize (m_bandwidth);
+  uint8_t bsrId = BufferSizeLevelBsr::BufferSize2BsrId (m_rlcBufferSize);
+
+  // the HARQ feedback and UL CQIs due in each of the next TTIs
+  std::vector<std::vector<DlInfoListElement_s> > dlHarqFeedback (DL_HARQ_FEEDBACK_DELAY + 1);
+  std::vector<std::vector<UlInfoListElement_s> > ulHarqFeedback (UL_HARQ_FEEDBACK_DELAY + 1);
+  std::vector<std::vector<FfMacSchedSapProvider::SchedUlCqiInfoReqParameters> > ulCqis (UL_HARQ_FEEDBACK_DELAY + 1);
+  // the UEs served in DL in the previous TTI
+  std::vector<uint16_t> served;
+
+  Result result;
+  result.m_ttis = ttis;
+  result.m_dlDcis = 0;
+  result.m_ulDcis = 0;
+  result.m_dlBytes = 0;
+  result.m_ulBytes = 0;
+  result.m_conflicts = 0;
+  result.m_latency.reserve (ttis);
+  result.m_decisions.reserve (ttis);
+
+  uint16_t frame = 1;
+  uint16_t subframe = 1;
+  for (uint32_t tti = 0; tti < ttis; tti++)
+    {
+      uint16_t sfnSf = ((0x3FF & frame) << 4) | (0xF & subframe);
+      uint32_t dlSlot = tti % (DL_HARQ_FEEDBACK_DELAY + 1);
+      uint32_t ulSlot = tti % (UL_HARQ_FEEDBACK_DELAY + 1);
+      uint32_t dlFeedbackSlot = (tti + DL_HARQ_FEEDBACK_DELAY) % (DL_HARQ_FEEDBACK_DELAY + 1);
+      uint32_t ulFeedbackSlot = (tti + UL_HARQ_FEEDBACK_DELAY) % (UL_HARQ_FEEDBACK_DELAY + 1);
+
+      // DL: CQI reports, buffer reports of the UEs served, and trigger
+      FfMacSchedSapProvider::SchedDlCqiInfoReqParameters dlCqiInfo;
+      dlCqiInfo.m_sfnSf = sfnSf;
+      for (uint32_t rnti = 1 + tti % m_cqiPeriod; rnti <= m_nUes; rnti += m_cqiPeriod)
+        {
+          dlCqiInfo.m_cqiList.push_back (CreateDlCqi (rnti, meanCqi[rnti], nRbgs));
+        }
+      if (!dlCqiInfo.m_cqiList.empty ())
+        {
+          sched->SchedDlCqiInfoReq (dlCqiInfo);
+        }
+      for (std::vector<uint16_t>::const_iterator it = served.begin (); it != served.end (); ++it)
+        {
+          rlcBuffer.m_rnti = *it;
+          sched->SchedDlRlcBufferReq (rlcBuffer);
+        }
+
+      FfMacSchedSapProvider::SchedDlTriggerReqParameters dlTrigger;
+      dlTrigger.m_sfnSf = sfnSf;
+      dlTrigger.m_dlInfoList.swap (dlHarqFeedback[dlSlot]);
+      std::clock_t start = std::clock ();
+      sched->SchedDlTriggerReq (dlTrigger);
+      std::clock_t elapsed = std::clock () - start;
+
+      // UL: CQIs of past allocations, BSRs, and trigger
+      for (uint32_t i = 0; i < ulCqis[ulSlot].size (); i++)
+        {
+          sched->SchedUlCqiInfoReq (ulCqis[ulSlot][i]);
+        }
+      ulCqis[ulSlot].clear ();
+      FfMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters ulMacCtrlInfo;
+      ulMacCtrlInfo.m_sfnSf = sfnSf;
+      for (uint32_t rnti = 1 + tti % m_bsrPeriod; rnti <= m_nUes; rnti += m_bsrPeriod)
+        {
+          MacCeListElement_s bsr;
+          bsr.m_rnti = rnti;
+          bsr.m_macCeType = MacCeListElement_s::BSR;
+          bsr.m_macCeValue.m_bufferStatus.push_back (0);
+          bsr.m_macCeValue.m_bufferStatus.push_back (bsrId);
+          bsr.m_macCeValue.m_bufferStatus.push_back (0);
+          bsr.m_macCeValue.m_bufferStatus.push_back (0);
+          ulMacCtrlInfo.m_macCeList.push_back (bsr);
+        }
+      if (!ulMacCtrlInfo.m_macCeList.empty ())
+        {
+          sched->SchedUlMacCtrlInfoReq (ulMacCtrlInfo);
+        }
+
+      FfMacSchedSapProvider::SchedUlTriggerReqParameters ulTrigger;
+      ulTrigger.m_sfnSf = sfnSf;
+      ulTrigger.m_ulInfoList.swap (ulHarqFeedback[ulSlot]);
+      start = std::clock ();
+      sched->SchedUlTriggerReq (ulTrigger);
+      elapsed += std::clock () - start;
+      result.m_latency.push_back (elapsed * 1e6 / CLOCKS_PER_SEC);
+
+      // collect the DL allocations
+      uint64_t hash = 14695981039346656037ULL;
+      uint32_t usedRbgs = 0;
+      served.clear ();
+      for (std::vector<BuildDataListElement_s>::const_iterator it = schedSapUser.m_dlConfig.begin ();
+           it != schedSapUser.m_dlConfig.end (); ++it)
+        {
+          const DlDciListElement_s &dci = it->m_dci;
+          hash = HashCombine (hash, it->m_rnti);
+          hash = HashCombine (hash, dci.m_rbBitmap);
+          hash = HashCombine (hash, dci.m_harqProcess);
+          if ((usedRbgs & dci.m_rbBitmap) != 0 || (dci.m_rbBitmap >> nRbgs) != 0)
+            {
+              NS_LOG_WARN ("TTI " << tti << ": DL allocation of RNTI " << it->m_rnti << " overlaps another one");
+              result.m_conflicts++;
+            }
+          usedRbgs |= dci.m_rbBitmap;
+
+          DlInfoListElement_s feedback;
+          feedback.m_rnti = it->m_rnti;
+          feedback.m_harqProcessId = dci.m_harqProcess;
+          for (uint32_t tb = 0; tb < dci.m_tbsSize.size (); tb++)
+            {
+              hash = HashCombine (hash, dci.m_tbsSize[tb]);
+              hash = HashCombine (hash, dci.m_mcs[tb]);
+              hash = HashCombine (hash, dci.m_ndi[tb]);
+              result.m_dlBytes += dci.m_tbsSize[tb];
+              bool nack = m_uniform->GetValue () < m_nackProbability;
+              feedback.m_harqStatus.push_back (nack ? DlInfoListElement_s::NACK : DlInfoListElement_s::ACK);
+            }
+          dlHarqFeedback[dlFeedbackSlot].push_back (feedback);
+          served.push_back (it->m_rnti);
+          result.m_dlDcis++;
+        }
+      schedSapUser.m_dlConfig.clear ();
+
+      // collect the UL allocations
+      std::vector<bool> usedRbs (m_bandwidth, false);
+      FfMacSchedSapProvider::SchedUlCqiInfoReqParameters ulCqi;
+      ulCqi.m_sfnSf = sfnSf;
+      ulCqi.m_ulCqi.m_type = UlCqi_s::PUSCH;
+      ulCqi.m_ulCqi.m_sinr.resize (m_bandwidth, LteFfConverter::double2fpS11dot3 (LteFfConverter::getMinFpS11dot3Value ()));
+      for (std::vector<UlDciListElement_s>::const_iterator it = schedSapUser.m_ulConfig.begin ();
+           it != schedSapUser.m_ulConfig.end (); ++it)
+        {
+          hash = HashCombine (hash, it->m_rnti);
+          hash = HashCombine (hash, it->m_rbStart);
+          hash = HashCombine (hash, it->m_rbLen);
+          hash = HashCombine (hash, it->m_mcs);
+          hash = HashCombine (hash, it->m_tbSize);
+          hash = HashCombine (hash, it->m_ndi);
+          result.m_ulBytes += it->m_tbSize;
+          result.m_ulDcis++;
+          bool conflict = false;
+          for (uint32_t rb = it->m_rbStart; rb < (uint32_t) it->m_rbStart + it->m_rbLen; rb++)
+            {
+              if (rb >= m_bandwidth || usedRbs[rb])
+                {
+                  conflict = true;
+                  continue;
+                }
+              usedRbs[rb] = true;
+              double sinr = meanUlSinr[it->m_rnti] + m_uniform->GetValue (-3.0, 3.0);
+              ulCqi.m_ulCqi.m_sinr[rb] = LteFfConverter::double2fpS11dot3 (sinr);
+            }
+          if (conflict)
+            {
+              NS_LOG_WARN ("TTI " << tti << ": UL allocation of RNTI " << it->m_rnti << " overlaps another one");
+              result.m_conflicts++;
+            }
+
+          UlInfoListElement_s feedback;
+          feedback.m_rnti = it->m_rnti;
+          bool nack = m_uniform->GetValue () < m_nackProbability;
+          feedback.m_receptionStatus = nack ? UlInfoListElement_s::NotOk : UlInfoListElement_s::Ok;
+          feedback.m_tpc = 1;
+          ulHarqFeedback[ulFeedbackSlot].push_back (feedback);
+        }
+      if (!schedSapUser.m_ulConfig.empty ())
+        {
+          ulCqis[ulFeedbackSlot].push_back (ulCqi);
+        }
+      schedSapUser.m_ulConfig.clear ();
+      result.m_decisions.push_back (hash);
+
+      if (++subframe > 10)
+        {
+          subframe = 1;
+          frame = (frame % 1024) + 1;
+        }
+    }
+
+  scheduler->Dispose ();
+  ffr->Dispose ();
+  return result;
+}
+
+uint32_t
+FfMacSchedulerHarness::CheckDeterminism (uint32_t ttis)
+{
+  NS_LOG_FUNCTION (this << ttis);
+  Result first = Run (ttis);
+  Result second = Run (ttis);
+  for (uint32_t tti = 0; tti < ttis; tti++)
+    {
+      if (first.m_decisions[tti] != second.m_decisions[tti])
+        {
+          NS_LOG_WARN ("the decisions differ at TTI " << tti);
+          return tti;
+        }
+    }
+  return ttis;
+}
+
+} // namespace ns3
@@ -0,0 +1,174 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FF_MAC_SCHEDULER_HARNESS_H
+#define FF_MAC_SCHEDULER_HARNESS_H
+
+#include <ns3/object.h>
+#include <ns3/object-factory.h>
+#include <ns3/random-variable-stream.h>
+#include <ns3/ff-mac-scheduler.h>
+#include <ns3/ff-mac-common.h>
+#include <ns3/lte-common.h>
+
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup lte
+ *
+ * This helper drives a FfMacScheduler through its CSCHED and SCHED SAPs
+ * alone, without PHY, channel nor RLC, in order to benchmark its
+ * decisions in isolation.
+ *
+ * Every TTI, the harness feeds the scheduler with the messages the eNB
+ * MAC would send, in the same order: the DL CQI reports (P10 wideband
+ * or A30 subband, every CqiPeriod TTIs per UE), the DL HARQ feedback,
+ * the PUSCH UL CQIs and UL HARQ feedback of the UL allocations, and the
+ * buffer status reports. The traffic is a full buffer: the RLC buffer of
+ * a UE is reported full again after each of its DL allocations, and
+ * the UL BSRs always report RlcBufferSize bytes. The HARQ feedback of an
+ * allocation is received DL_HARQ_FEEDBACK_DELAY or UL_HARQ_FEEDBACK_DELAY
+ * TTIs after it, and is a NACK with probability NackProbability. Each UE
+ * has a mean CQI drawn at the beginning of a run, around which its
+ * reports fluctuate.
+ *
+ * All the random draws are made from a stream set with AssignStreams,
+ * so that two runs with the same parameters feed the scheduler exactly
+ * the same messages, and a deterministic scheduler must then take the
+ * same decisions.
+ */
+class FfMacSchedulerHarness : public Object
+{
+public:
+  /**
+   * The outcome of a run.
+   */
+  struct Result
+  {
+    uint32_t m_ttis;                    //!< the number of TTIs scheduled
+    uint64_t m_dlDcis;                  //!< the number of DL allocations
+    uint64_t m_ulDcis;                  //!< the number of UL allocations
+    uint64_t m_dlBytes;                 //!< the sum of the DL TB sizes (bytes)
+    uint64_t m_ulBytes;                 //!< the sum of the UL TB sizes (bytes)
+    uint32_t m_conflicts;               //!< the number of allocations overlapping another one, or out of the band
+    std::vector<double> m_latency;      //!< the processor time of the DL and UL triggers, per TTI (us)
+    std::vector<uint64_t> m_decisions;  //!< a hash of the allocations, per TTI
+
+    /**
+     * \param percentile the percentile, between 0 and 100
+     * \return the given percentile of the per-TTI latency (us)
+     */
+    double GetLatencyPercentile (double percentile) const;
+    /**
+     * \return the mean per-TTI latency (us)
+     */
+    double GetMeanLatency (void) const;
+  };
+
+  FfMacSchedulerHarness ();
+  virtual ~FfMacSchedulerHarness ();
+
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+  virtual void DoDispose (void);
+
+  /**
+   * \param type the TypeId of the FfMacScheduler created by Run (uint32_t)
+   */
+  void SetSchedulerType (std::string type);
+  /**
+   * \param n the name of the attribute
+   * \param v the value of the attribute, set on the schedulers created by Run (uint32_t)
+   */
+  void SetSchedulerAttribute (std::string n, const AttributeValue &v);
+
+  /**
+   * Run a new scheduler of the type set with SetSchedulerType.
+   *
+   * \param ttis the number of TTIs to schedule
+   * \return the outcome of the run
+   */
+  Result Run (uint32_t ttis);
+  /**
+   * Run the given scheduler, which must not have been configured yet.
+   * The scheduler is disposed of at the end of the run.
+   *
+   * \param scheduler the scheduler
+   * \param ttis the number of TTIs to schedule
+   * \return the outcome of the run
+   */
+  Result Run (Ptr<FfMacScheduler> scheduler, uint32_t ttis);
+
+  /**
+   * Run two new schedulers of the type set with SetSchedulerType, and
+   * check that they take the same decisions.
+   *
+   * \param ttis the number of TTIs to schedule
+   * \return the index of the first TTI where the decisions differ, or
+   *         ttis if they are all the same
+   */
+  uint32_t CheckDeterminism (uint32_t ttis);
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  /// delay between a DL allocation and its HARQ feedback (TTIs)
+  static const uint32_t DL_HARQ_FEEDBACK_DELAY = 4;
+  /// delay between a UL allocation and its HARQ feedback and CQI (TTIs), as expected by the schedulers
+  static const uint32_t UL_HARQ_FEEDBACK_DELAY = HARQ_PERIOD;
+
+private:
+  class SchedSapUser;
+  class CschedSapUser;
+
+  /**
+   * Build the A30 or P10 CQI report of a UE.
+   *
+   * \param rnti the RNTI of the UE
+   * \param meanCqi the mean CQI of the UE
+   * \param nRbgs the number of RBGs of the DL band
+   * \return the report
+   */
+  CqiListElement_s CreateDlCqi (uint16_t rnti, uint8_t meanCqi, uint16_t nRbgs);
+
+  ObjectFactory m_schedulerFactory;   //!< the factory of the schedulers created by Run (uint32_t)
+  Ptr<UniformRandomVariable> m_uniform; //!< draws the CQIs and the HARQ feedback
+  int64_t m_stream;                   //!< the stream of m_uniform, set again at each run
+
+  uint16_t m_nUes;                    //!< the number of UEs
+  uint8_t m_bandwidth;                //!< the DL and UL bandwidth (RBs)
+  CqiListElement_s::CqiType_e m_cqiType; //!< the type of the DL CQI reports
+  uint32_t m_cqiPeriod;               //!< the period of the CQI reports of a UE (TTIs)
+  uint32_t m_bsrPeriod;               //!< the period of the BSRs of a UE (TTIs)
+  uint32_t m_rlcBufferSize;           //!< the size of the DL and UL buffers (bytes)
+  double m_nackProbability;           //!< the probability of a HARQ NACK
+};
+
+} // namespace ns3
+
+#endif // FF_MAC_SCHEDULER_HARNESS_H
@@ -59,6 +59,7 @@
 #include <ns3/epc-helper.h>
 #include <iostream>
 #include <ns3/buildings-propagation-loss-model.h>
+#include <ns3/cached-propagation-loss-model.h>
 #include <ns3/lte-spectrum-value-helper.h>
 #include <ns3/epc-x2.h>
 
@@ -100,6 +101,12 @@ LteHelper::DoInitialize (void)
       NS_LOG_LOGIC (this << " using a PropagationLossModel in DL");
       Ptr<PropagationLossModel> dlPlm = m_downlinkPathlossModel->GetObject<PropagationLossModel> ();
       NS_ASSERT_MSG (dlPlm != 0, " " << m_downlinkPathlossModel << " is neither PropagationLossModel nor SpectrumPropagationLossModel");
+      if (m_usePathlossCache)
+        {
+          Ptr<CachedPropagationLossModel> cache = CreateObject<CachedPropagationLossModel> ();
+          cache->SetPropagationLossModel (dlPlm);
+          dlPlm = cache;
+        }
       m_downlinkChannel->AddPropagationLossModel (dlPlm);
     }
 
@@ -115,6 +122,12 @@ LteHelper::DoInitialize (void)
       NS_LOG_LOGIC (this << " using a PropagationLossModel in UL");
       Ptr<PropagationLossModel> ulPlm = m_uplinkPathlossModel->GetObject<PropagationLossModel> ();
       NS_ASSERT_MSG (ulPlm != 0, " " << m_uplinkPathlossModel << " is neither PropagationLossModel nor SpectrumPropagationLossModel");
+      if (m_usePathlossCache)
+        {
+          Ptr<CachedPropagationLossModel> cache = CreateObject<CachedPropagationLossModel> ();
+          cache->SetPropagationLossModel (ulPlm);
+          ulPlm = cache;
+        }
       m_uplinkChannel->AddPropagationLossModel (ulPlm);
     }
   if (!m_fadingModelType.empty ())
@@ -200,6 +213,15 @@ TypeId LteHelper::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&LteHelper::m_usePdschForCqiGeneration),
                    MakeBooleanChecker ())
+    .AddAttribute ("UsePathlossCache",
+                   "If true, and if the pathloss model is a PropagationLossModel, "
+                   "the loss of each eNB-UE pair is cached by a CachedPropagationLossModel "
+                   "and only computed again once the UE moved by more than "
+                   "ns3::CachedPropagationLossModel::InvalidationDistance or "
+                   "changed building, instead of at every transmission.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&LteHelper::m_usePathlossCache),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
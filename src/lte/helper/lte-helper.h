@@ -737,6 +737,12 @@ private:
    * DL-CQI will be calculated from PDCCH as signal and PDCCH as interference.
    */
   bool m_usePdschForCqiGeneration;
+  /**
+   * The `UsePathlossCache` attribute. If true, the PropagationLossModel of
+   * the downlink and uplink channels is wrapped in a
+   * CachedPropagationLossModel.
+   */
+  bool m_usePathlossCache;
 
 }; // end of `class LteHelper`
 
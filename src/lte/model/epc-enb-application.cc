@@ -36,6 +36,8 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("EpcEnbApplication");
 
 EpcEnbApplication::EpsFlowId_t::EpsFlowId_t ()
+  : m_rnti (0),
+    m_bid (0)
 {
 }
 
@@ -182,7 +184,7 @@ EpcEnbApplication::DoPathSwitchRequest (EpcEnbS1SapProvider::PathSwitchRequestPa
       EpsFlowId_t rbid (params.rnti, bit->epsBearerId);
       // side effect: create entries if not exist
       m_rbidTeidMap[params.rnti][bit->epsBearerId] = teid;
-      m_teidRbidMap[teid] = rbid;
+      SetRbid (teid, rbid);
 
       EpcS1apSapMme::ErabSwitchedInDownlinkItem erab;
       erab.erabId = bit->epsBearerId;
@@ -200,7 +202,7 @@ void
 EpcEnbApplication::DoUeContextRelease (uint16_t rnti)
 {
   NS_LOG_FUNCTION (this << rnti);
-  std::map<uint16_t, std::map<uint8_t, uint32_t> >::iterator rntiIt = m_rbidTeidMap.find (rnti);
+  RntiMap<std::map<uint8_t, uint32_t> >::iterator rntiIt = m_rbidTeidMap.find (rnti);
   if (rntiIt != m_rbidTeidMap.end ())
     {
       for (std::map<uint8_t, uint32_t>::iterator bidIt = rntiIt->second.begin ();
@@ -208,7 +210,7 @@ EpcEnbApplication::DoUeContextRelease (uint16_t rnti)
            ++bidIt)
         {
           uint32_t teid = bidIt->second;
-          m_teidRbidMap.erase (teid);
+          RemoveRbid (teid);
         }
       m_rbidTeidMap.erase (rntiIt);
     }
@@ -243,7 +245,7 @@ EpcEnbApplication::DoInitialContextSetupRequest (uint64_t mmeUeS1Id, uint16_t en
       EpsFlowId_t rbid (rnti, erabIt->erabId);
       // side effect: create entries if not exist
       m_rbidTeidMap[rnti][erabIt->erabId] = params.gtpTeid;
-      m_teidRbidMap[params.gtpTeid] = rbid;
+      SetRbid (params.gtpTeid, rbid);
 
     }
 }
@@ -280,7 +282,7 @@ EpcEnbApplication::RecvFromLteSocket (Ptr<Socket> socket)
   uint16_t rnti = tag.GetRnti ();
   uint8_t bid = tag.GetBid ();
   NS_LOG_LOGIC ("received packet with RNTI=" << (uint32_t) rnti << ", BID=" << (uint32_t)  bid);
-  std::map<uint16_t, std::map<uint8_t, uint32_t> >::iterator rntiIt = m_rbidTeidMap.find (rnti);
+  RntiMap<std::map<uint8_t, uint32_t> >::iterator rntiIt = m_rbidTeidMap.find (rnti);
   if (rntiIt == m_rbidTeidMap.end ())
     {
       NS_LOG_WARN ("UE context not found, discarding packet");
@@ -303,15 +305,15 @@ EpcEnbApplication::RecvFromS1uSocket (Ptr<Socket> socket)
   GtpuHeader gtpu;
   packet->RemoveHeader (gtpu);
   uint32_t teid = gtpu.GetTeid ();
-  std::map<uint32_t, EpsFlowId_t>::iterator it = m_teidRbidMap.find (teid);
-  NS_ASSERT (it != m_teidRbidMap.end ());
+  EpsFlowId_t rbid = GetRbid (teid);
+  NS_ASSERT (rbid.m_rnti != 0);
 
   /// \internal
   /// Workaround for \bugid{231}
   SocketAddressTag tag;
   packet->RemovePacketTag (tag);
   
-  SendToLteSocket (packet, it->second.m_rnti, it->second.m_bid);
+  SendToLteSocket (packet, rbid.m_rnti, rbid.m_bid);
 }
 
 void 
@@ -342,6 +344,50 @@ EpcEnbApplication::SendToS1uSocket (Ptr<Packet> packet, uint32_t teid)
     m_s1uSocket->SendTo (packet, flags, Inet6SocketAddress(m_sgwS1uAddress6, m_gtpuUdpPort));
 }
 
+EpcEnbApplication::EpsFlowId_t
+EpcEnbApplication::GetRbid (uint32_t teid) const
+{
+  if (teid < MAX_INDEXED_TEID)
+    {
+      return (teid < m_rbidByTeid.size ()) ? m_rbidByTeid[teid] : EpsFlowId_t ();
+    }
+  std::map<uint32_t, EpsFlowId_t>::const_iterator it = m_teidRbidMap.find (teid);
+  return (it != m_teidRbidMap.end ()) ? it->second : EpsFlowId_t ();
+}
+
+void
+EpcEnbApplication::SetRbid (uint32_t teid, EpsFlowId_t rbid)
+{
+  if (teid < MAX_INDEXED_TEID)
+    {
+      if (teid >= m_rbidByTeid.size ())
+        {
+          m_rbidByTeid.resize (teid + 1);
+        }
+      m_rbidByTeid[teid] = rbid;
+    }
+  else
+    {
+      m_teidRbidMap[teid] = rbid;
+    }
+}
+
+void
+EpcEnbApplication::RemoveRbid (uint32_t teid)
+{
+  if (teid < MAX_INDEXED_TEID)
+    {
+      if (teid < m_rbidByTeid.size ())
+        {
+          m_rbidByTeid[teid] = EpsFlowId_t ();
+        }
+    }
+  else
+    {
+      m_teidRbidMap.erase (teid);
+    }
+}
+
 void
 EpcEnbApplication::DoReleaseIndication (uint64_t imsi, uint16_t rnti, uint8_t bearerId)
 {
@@ -34,7 +34,9 @@
 #include <ns3/eps-bearer.h>
 #include <ns3/epc-enb-s1-sap.h>
 #include <ns3/epc-s1ap-sap.h>
+#include <ns3/lte-rnti-map.h>
 #include <map>
+#include <vector>
 
 namespace ns3 {
 class EpcEnbS1SapUser;
@@ -198,6 +200,28 @@ private:
    */
   void SetupS1Bearer (uint32_t teid, uint16_t rnti, uint8_t bid);
 
+  /**
+   * \param teid the S1-U TEID of a bearer
+   * \return the RNTI and BID of the bearer, with a RNTI of 0 if the
+   *         TEID is unknown
+   */
+  EpsFlowId_t GetRbid (uint32_t teid) const;
+
+  /**
+   * Store the RNTI and BID of a S1-U TEID
+   *
+   * \param teid the S1-U TEID of the bearer
+   * \param rbid the RNTI and BID of the bearer
+   */
+  void SetRbid (uint32_t teid, EpsFlowId_t rbid);
+
+  /**
+   * Forget a S1-U TEID
+   *
+   * \param teid the S1-U TEID of the bearer
+   */
+  void RemoveRbid (uint32_t teid);
+
   /**
    * raw packet socket to send and receive the packets to and from the LTE radio interface
    */
@@ -245,13 +269,24 @@ private:
    * map of maps telling for each RNTI and BID the corresponding  S1-U TEID
    * 
    */
-  std::map<uint16_t, std::map<uint8_t, uint32_t> > m_rbidTeidMap;  
+  RntiMap<std::map<uint8_t, uint32_t> > m_rbidTeidMap;
 
   /**
-   * map telling for each S1-U TEID the corresponding RNTI,BID
-   * 
+   * The SGW allocates the TEIDs sequentially, so that the RNTI,BID of
+   * the TEIDs below MAX_INDEXED_TEID are stored in a table indexed by
+   * TEID, where a RNTI of 0 marks a free entry. The higher TEIDs are
+   * stored in m_teidRbidMap.
+   */
+  std::vector<EpsFlowId_t> m_rbidByTeid;
+
+  /**
+   * map telling for each S1-U TEID not lower than MAX_INDEXED_TEID the
+   * corresponding RNTI,BID
    */
   std::map<uint32_t, EpsFlowId_t> m_teidRbidMap;
+
+  /// the first TEID not stored in m_rbidByTeid
+  static const uint32_t MAX_INDEXED_TEID = 0x10000;
  
   /**
    * UDP port to be used for GTP
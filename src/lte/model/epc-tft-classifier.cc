@@ -30,17 +30,37 @@
 #include "epc-tft.h"
 #include "ns3/log.h"
 #include "ns3/packet.h"
-#include "ns3/ipv4-header.h"
-#include "ns3/udp-header.h"
-#include "ns3/tcp-header.h"
 #include "ns3/udp-l4-protocol.h"
 #include "ns3/tcp-l4-protocol.h"
 
+#include <algorithm>
+#include <cstring>
+
 NS_LOG_COMPONENT_DEFINE ("EpcTftClassifier");
 
 namespace ns3 {
 
+/**
+ * \param address an IPv6 address
+ * \param prefix an IPv6 prefix
+ * \param masked an IPv6 address masked with prefix
+ * \return true if address is in the network of masked
+ */
+static bool
+MatchesPrefix (const uint8_t *address, const uint8_t *prefix, const uint8_t *masked)
+{
+  for (uint32_t i = 0; i < 16; i++)
+    {
+      if ((address[i] & prefix[i]) != masked[i])
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
 EpcTftClassifier::EpcTftClassifier ()
+  : m_compiled (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -51,6 +71,7 @@ EpcTftClassifier::Add (Ptr<EpcTft> tft, uint32_t id)
   NS_LOG_FUNCTION (this << tft);
   
   m_tftMap[id] = tft;  
+  m_compiled = false;
   
   // simple sanity check: there shouldn't be more than 16 bearers (hence TFTs) per UE
   NS_ASSERT (m_tftMap.size () <= 16);
@@ -61,6 +82,135 @@ EpcTftClassifier::Delete (uint32_t id)
 {
   NS_LOG_FUNCTION (this << id);
   m_tftMap.erase (id);
+  m_compiled = false;
+}
+
+void
+EpcTftClassifier::Compile (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // the rules of each direction are listed by decreasing TFT
+  // identifier, since filter priority is not implemented properly. This
+  // way, since the default bearer is expected to be added first, it will
+  // be evaluated last.
+  std::vector<uint32_t> rules[2];
+  m_rules.clear ();
+  std::map <uint32_t, Ptr<EpcTft> >::const_reverse_iterator it;
+  for (it = m_tftMap.rbegin (); it != m_tftMap.rend (); ++it)
+    {
+      std::list<EpcTft::PacketFilter> filters = it->second->GetPacketFilters ();
+      for (std::list<EpcTft::PacketFilter>::const_iterator f = filters.begin (); f != filters.end (); ++f)
+        {
+          Rule rule;
+          rule.id = it->first;
+          rule.isIpv4 = f->isIpv4;
+          rule.remoteMask = f->remoteMask.Get ();
+          rule.remoteAddress = f->remoteAddress.Get () & rule.remoteMask;
+          rule.localMask = f->localMask.Get ();
+          rule.localAddress = f->localAddress.Get () & rule.localMask;
+          uint8_t remoteAddress6[16];
+          uint8_t localAddress6[16];
+          f->remotePrefix.GetBytes (rule.remotePrefix);
+          f->remoteAddress6.GetBytes (remoteAddress6);
+          f->localPrefix.GetBytes (rule.localPrefix);
+          f->localAddress6.GetBytes (localAddress6);
+          for (uint32_t i = 0; i < 16; i++)
+            {
+              rule.remoteAddress6[i] = remoteAddress6[i] & rule.remotePrefix[i];
+              rule.localAddress6[i] = localAddress6[i] & rule.localPrefix[i];
+            }
+          rule.remotePortStart = f->remotePortStart;
+          rule.remotePortEnd = f->remotePortEnd;
+          rule.localPortStart = f->localPortStart;
+          rule.localPortEnd = f->localPortEnd;
+          rule.typeOfServiceMask = f->typeOfServiceMask;
+          rule.typeOfService = f->typeOfService & f->typeOfServiceMask;
+
+          uint32_t index = m_rules.size ();
+          m_rules.push_back (rule);
+          if (f->direction & EpcTft::UPLINK)
+            {
+              rules[0].push_back (index);
+            }
+          if (f->direction & EpcTft::DOWNLINK)
+            {
+              rules[1].push_back (index);
+            }
+        }
+    }
+
+  for (uint32_t d = 0; d < 2; d++)
+    {
+      // index the rules by the port which splits them into the smallest
+      // sets
+      Table byLocalPort;
+      byLocalPort.byLocalPort = true;
+      uint32_t localMax = BuildIntervals (byLocalPort, rules[d]);
+      Table byRemotePort;
+      byRemotePort.byLocalPort = false;
+      uint32_t remoteMax = BuildIntervals (byRemotePort, rules[d]);
+      if ((remoteMax < localMax)
+          || ((remoteMax == localMax) && (byRemotePort.candidates.size () < byLocalPort.candidates.size ())))
+        {
+          m_tables[d] = byRemotePort;
+        }
+      else
+        {
+          m_tables[d] = byLocalPort;
+        }
+      NS_LOG_LOGIC ("direction " << d << ": " << rules[d].size () << " rules, "
+                                 << m_tables[d].starts.size () << " intervals of the "
+                                 << (m_tables[d].byLocalPort ? "local" : "remote") << " port");
+    }
+  m_compiled = true;
+}
+
+uint32_t
+EpcTftClassifier::BuildIntervals (Table &table, const std::vector<uint32_t> &rules) const
+{
+  NS_LOG_FUNCTION (this << table.byLocalPort);
+
+  // the intervals start at 0 and at the start and after the end of the
+  // port range of each rule, so that the same rules apply to all the
+  // ports of an interval
+  table.starts.clear ();
+  table.starts.push_back (0);
+  for (std::vector<uint32_t>::const_iterator it = rules.begin (); it != rules.end (); ++it)
+    {
+      const Rule &rule = m_rules[*it];
+      uint16_t start = table.byLocalPort ? rule.localPortStart : rule.remotePortStart;
+      uint16_t end = table.byLocalPort ? rule.localPortEnd : rule.remotePortEnd;
+      table.starts.push_back (start);
+      if (end < 65535)
+        {
+          table.starts.push_back (end + 1);
+        }
+    }
+  std::sort (table.starts.begin (), table.starts.end ());
+  table.starts.erase (std::unique (table.starts.begin (), table.starts.end ()), table.starts.end ());
+
+  uint32_t maxCandidates = 0;
+  table.offsets.clear ();
+  table.candidates.clear ();
+  for (std::vector<uint16_t>::const_iterator port = table.starts.begin (); port != table.starts.end (); ++port)
+    {
+      uint32_t offset = table.candidates.size ();
+      table.offsets.push_back (offset);
+      for (std::vector<uint32_t>::const_iterator it = rules.begin (); it != rules.end (); ++it)
+        {
+          const Rule &rule = m_rules[*it];
+          uint16_t start = table.byLocalPort ? rule.localPortStart : rule.remotePortStart;
+          uint16_t end = table.byLocalPort ? rule.localPortEnd : rule.remotePortEnd;
+          if ((start <= *port) && (*port <= end))
+            {
+              table.candidates.push_back (*it);
+            }
+        }
+      maxCandidates = std::max<uint32_t> (maxCandidates, table.candidates.size () - offset);
+    }
+  table.offsets.push_back (table.candidates.size ());
+  return maxCandidates;
 }
  
 uint32_t 
@@ -68,61 +218,66 @@ EpcTftClassifier::Classify (Ptr<Packet> p, EpcTft::Direction direction)
 {
   NS_LOG_FUNCTION (this << p << direction);
 
-  Ptr<Packet> pCopy = p->Copy ();
+  if (!m_compiled)
+    {
+      Compile ();
+    }
 
-  uint8_t byteBuffer[1];
-  pCopy->CopyData (byteBuffer, 1);
-  uint8_t version = byteBuffer[0] >> 4;
+  // the IP header, including the IPv4 options, followed by the ports of
+  // the transport header, which are read in place without copying the
+  // packet nor deserializing its headers
+  uint8_t buffer[64];
+  uint32_t size = p->CopyData (buffer, sizeof (buffer));
+  std::memset (buffer + size, 0, sizeof (buffer) - size);
+  uint8_t version = buffer[0] >> 4;
   NS_LOG_INFO ("Version: " << int (version));
 
-  Ipv4Address ipv4LocalAddress;
-  Ipv4Address ipv4RemoteAddress;
-  Ipv6Address ipv6LocalAddress;
-  Ipv6Address ipv6RemoteAddress;
-  uint8_t protocol;
-  uint8_t tos;
-  uint16_t localPort = 0;
-  uint16_t remotePort = 0;
+  uint32_t ipv4LocalAddress = 0;
+  uint32_t ipv4RemoteAddress = 0;
+  uint8_t *ipv6LocalAddress = 0;
+  uint8_t *ipv6RemoteAddress = 0;
+  uint8_t protocol = 0;
+  uint8_t tos = 0;
+  uint32_t headerSize = 0;
 
   switch (version)
     {
     case 4: // Ipv4
       {
-        Ipv4Header ipv4Header;
-        pCopy->RemoveHeader (ipv4Header);
-
+        uint32_t source = ((uint32_t) buffer[12] << 24) | (buffer[13] << 16) | (buffer[14] << 8) | buffer[15];
+        uint32_t destination = ((uint32_t) buffer[16] << 24) | (buffer[17] << 16) | (buffer[18] << 8) | buffer[19];
         if (direction ==  EpcTft::UPLINK)
           {
-            ipv4LocalAddress = ipv4Header.GetSource ();
-            ipv4RemoteAddress = ipv4Header.GetDestination ();
+            ipv4LocalAddress = source;
+            ipv4RemoteAddress = destination;
           }
         else
           {
             NS_ASSERT (direction ==  EpcTft::DOWNLINK);
-            ipv4RemoteAddress = ipv4Header.GetSource ();
-            ipv4LocalAddress = ipv4Header.GetDestination ();
+            ipv4RemoteAddress = source;
+            ipv4LocalAddress = destination;
           }
-        protocol = ipv4Header.GetProtocol ();
-        tos = ipv4Header.GetTos ();
+        protocol = buffer[9];
+        tos = buffer[1];
+        headerSize = (buffer[0] & 0x0f) * 4;
         break;
       }
     case 6: // Ipv6
       {
-        Ipv6Header ipv6Header;
-        pCopy->RemoveHeader (ipv6Header);
         if (direction ==  EpcTft::UPLINK)
           {
-            ipv6LocalAddress = ipv6Header.GetSourceAddress ();
-            ipv6RemoteAddress = ipv6Header.GetDestinationAddress ();
+            ipv6LocalAddress = buffer + 8;
+            ipv6RemoteAddress = buffer + 24;
           }
         else
           {
             NS_ASSERT (direction ==  EpcTft::DOWNLINK);
-            ipv6RemoteAddress = ipv6Header.GetSourceAddress ();
-            ipv6LocalAddress = ipv6Header.GetDestinationAddress ();
+            ipv6RemoteAddress = buffer + 8;
+            ipv6LocalAddress = buffer + 24;
           }
-        protocol = ipv6Header.GetNextHeader ();
-        tos = ipv6Header.GetTrafficClass ();
+        protocol = buffer[6];
+        tos = ((buffer[0] & 0x0f) << 4) | (buffer[1] >> 4);
+        headerSize = 40;
       }
       break;
     default:
@@ -130,96 +285,76 @@ EpcTftClassifier::Classify (Ptr<Packet> p, EpcTft::Direction direction)
       break; // never reached.
     }
 
-  if (protocol == UdpL4Protocol::PROT_NUMBER)
-    {
-      UdpHeader udpHeader;
-      pCopy->RemoveHeader (udpHeader);
-
-      if (direction == EpcTft::UPLINK)
-        {
-          localPort = udpHeader.GetSourcePort ();
-          remotePort = udpHeader.GetDestinationPort ();
-        }
-      else
-        {
-          remotePort = udpHeader.GetSourcePort ();
-          localPort = udpHeader.GetDestinationPort ();
-        }
-    }
-  else if (protocol == TcpL4Protocol::PROT_NUMBER)
-    {
-      TcpHeader tcpHeader;
-      pCopy->RemoveHeader (tcpHeader);
-      if (direction == EpcTft::UPLINK)
-        {
-          localPort = tcpHeader.GetSourcePort ();
-          remotePort = tcpHeader.GetDestinationPort ();
-        }
-      else
-        {
-          remotePort = tcpHeader.GetSourcePort ();
-          localPort = tcpHeader.GetDestinationPort ();
-        }
-    }
-  else
+  if ((protocol != UdpL4Protocol::PROT_NUMBER) && (protocol != TcpL4Protocol::PROT_NUMBER))
     {
       NS_LOG_INFO ("Unknown protocol: " << protocol);
       return 0;  // no match
     }
 
+  // UDP and TCP headers both start with the source and destination ports
+  uint16_t sourcePort = (buffer[headerSize] << 8) | buffer[headerSize + 1];
+  uint16_t destinationPort = (buffer[headerSize + 2] << 8) | buffer[headerSize + 3];
+  uint16_t localPort = (direction == EpcTft::UPLINK) ? sourcePort : destinationPort;
+  uint16_t remotePort = (direction == EpcTft::UPLINK) ? destinationPort : sourcePort;
+
   switch (version)
     {
     case 4:
       NS_LOG_INFO ("Classifing packet:"
-                     << " localAddr="  << ipv4LocalAddress
-                     << " remoteAddr=" << ipv4RemoteAddress
+                     << " localAddr="  << Ipv4Address (ipv4LocalAddress)
+                     << " remoteAddr=" << Ipv4Address (ipv4RemoteAddress)
                      << " localPort="  << localPort
                      << " remotePort=" << remotePort
                      << " tos=0x" << (uint16_t) tos );
       break;
     case 6:
       NS_LOG_INFO ("Classifing packet:"
-                     << " localAddr="  << ipv6LocalAddress
-                     << " remoteAddr=" << ipv6RemoteAddress
+                     << " localAddr="  << Ipv6Address (ipv6LocalAddress)
+                     << " remoteAddr=" << Ipv6Address (ipv6RemoteAddress)
                      << " localPort="  << localPort
                      << " remotePort=" << remotePort
                      << " tos=0x" << (uint16_t) tos );
       break;
     }
 
+  // now it is possible to classify the packet, against the rules which
+  // may match its port only
+  const Table &table = m_tables[(direction == EpcTft::UPLINK) ? 0 : 1];
+  uint16_t port = table.byLocalPort ? localPort : remotePort;
+  uint32_t interval = std::upper_bound (table.starts.begin (), table.starts.end (), port) - table.starts.begin () - 1;
+  NS_LOG_LOGIC ("interval " << interval << ": " << table.offsets[interval + 1] - table.offsets[interval] << " rules");
 
-    // now it is possible to classify the packet!
-    // we use a reverse iterator since filter priority is not implemented properly.
-    // This way, since the default bearer is expected to be added first, it will be evaluated last.
-    std::map <uint32_t, Ptr<EpcTft> >::const_reverse_iterator it;
-    NS_LOG_LOGIC ("TFT MAP size: " << m_tftMap.size ());
-
-    for (it = m_tftMap.rbegin (); it != m_tftMap.rend (); ++it)
-      {
-        NS_LOG_LOGIC ("TFT id: " << it->first );
-        NS_LOG_LOGIC (" Ptr<EpcTft>: " << it->second);
-        Ptr<EpcTft> tft = it->second;
-        switch (version)
-          {
-          case 4:
-            if (tft->Matches (direction, ipv4RemoteAddress, ipv4LocalAddress, remotePort, localPort, tos))
-              {
-                NS_LOG_LOGIC ("matches with TFT ID = " << it->first);
-                return it->first; // the id of the matching TFT
-              }
-            break;
-          case 6:
-            if (tft->Matches (direction, ipv6RemoteAddress, ipv6LocalAddress, remotePort, localPort, tos))
-              {
-                NS_LOG_LOGIC ("matches with TFT ID = " << it->first);
-                return it->first; // the id of the matching TFT
-              }
-            break;
-          }
+  for (uint32_t c = table.offsets[interval]; c < table.offsets[interval + 1]; c++)
+    {
+      const Rule &rule = m_rules[table.candidates[c]];
+      if ((remotePort < rule.remotePortStart) || (remotePort > rule.remotePortEnd)
+          || (localPort < rule.localPortStart) || (localPort > rule.localPortEnd)
+          || ((tos & rule.typeOfServiceMask) != rule.typeOfService))
+        {
+          continue;
+        }
+      bool matches;
+      if (version == 4)
+        {
+          NS_ASSERT_MSG (rule.isIpv4, "Ipv6 type filter being checked for Ipv4 packet");
+          matches = ((ipv4RemoteAddress & rule.remoteMask) == rule.remoteAddress)
+            && ((ipv4LocalAddress & rule.localMask) == rule.localAddress);
+        }
+      else
+        {
+          NS_ASSERT_MSG (!rule.isIpv4, "Ipv4 type filter being checked for Ipv6 packet");
+          matches = MatchesPrefix (ipv6RemoteAddress, rule.remotePrefix, rule.remoteAddress6)
+            && MatchesPrefix (ipv6LocalAddress, rule.localPrefix, rule.localAddress6);
+        }
+      if (matches)
+        {
+          NS_LOG_LOGIC ("matches with TFT ID = " << rule.id);
+          return rule.id; // the id of the matching TFT
+        }
+    }
+  NS_LOG_LOGIC ("no match");
+  return 0;  // no match
+}
 
-      }
-    NS_LOG_LOGIC ("no match");
-    return 0;  // no match
 
-}
 } // namespace ns3
@@ -28,6 +28,7 @@
 #include "ns3/epc-tft.h"
 
 #include <map>
+#include <vector>
 
 
 namespace ns3 {
@@ -37,8 +38,15 @@ class Packet;
 
 /**
  * \brief classifies IP packets accoding to Traffic Flow Templates (TFTs)
- * 
- * \note this implementation works with IPv4 only.
+ *
+ * The packet filters of the TFTs are compiled, on the first
+ * classification after a TFT is added or deleted, into a table per
+ * direction. The table splits the range of either the
+ * local or the remote port, whichever discriminates the filters better,
+ * into intervals, each listing the filters which may match a port of
+ * the interval, with their addresses already masked. A packet is then
+ * only checked against the filters of the interval of its port. The
+ * TFTs must hence not be modified once added to the classifier.
  */
 class EpcTftClassifier : public SimpleRefCount<EpcTftClassifier>
 {
@@ -61,7 +69,7 @@ public:
    */
   void Delete (uint32_t id);
   
-
+  
   /** 
    * classify an IP packet
    * 
@@ -74,7 +82,61 @@ public:
 protected:
   
   std::map <uint32_t, Ptr<EpcTft> > m_tftMap;
-  
+
+private:
+
+  /**
+   * A packet filter of a TFT, with its addresses masked
+   */
+  struct Rule
+  {
+    uint32_t id;                   ///< the identifier of the TFT
+    bool isIpv4;                   ///< whether the filter is IPv4 based or IPv6
+    uint32_t remoteAddress;        ///< masked IPv4 address of the remote host
+    uint32_t remoteMask;           ///< IPv4 address mask of the remote host
+    uint32_t localAddress;         ///< masked IPv4 address of the UE
+    uint32_t localMask;            ///< IPv4 address mask of the UE
+    uint8_t remoteAddress6[16];    ///< masked IPv6 address of the remote host
+    uint8_t remotePrefix[16];      ///< IPv6 prefix of the remote host
+    uint8_t localAddress6[16];     ///< masked IPv6 address of the UE
+    uint8_t localPrefix[16];       ///< IPv6 prefix of the UE
+    uint16_t remotePortStart;      ///< start of the port number range of the remote host
+    uint16_t remotePortEnd;        ///< end of the port number range of the remote host
+    uint16_t localPortStart;       ///< start of the port number range of the UE
+    uint16_t localPortEnd;         ///< end of the port number range of the UE
+    uint8_t typeOfService;         ///< masked type of service field
+    uint8_t typeOfServiceMask;     ///< type of service field mask
+  };
+
+  /**
+   * The rules applying to a direction, by port interval
+   */
+  struct Table
+  {
+    bool byLocalPort;                 ///< whether the intervals split the local port range, or the remote one
+    std::vector<uint16_t> starts;     ///< the first port of each interval, in increasing order, from 0
+    std::vector<uint32_t> offsets;    ///< the index in candidates of the first rule of each interval, and the size of candidates
+    std::vector<uint32_t> candidates; ///< the indexes in m_rules of the rules which may match, by decreasing TFT identifier
+  };
+
+  /**
+   * Compile the packet filters of the TFTs of m_tftMap into m_rules and
+   * m_tables
+   */
+  void Compile (void);
+
+  /**
+   * Build the intervals of a table
+   *
+   * \param table the table, whose byLocalPort is set
+   * \param rules the indexes in m_rules of the rules of the table, by decreasing TFT identifier
+   * \return the highest number of rules of an interval
+   */
+  uint32_t BuildIntervals (Table &table, const std::vector<uint32_t> &rules) const;
+
+  std::vector<Rule> m_rules;  ///< the compiled packet filters
+  Table m_tables[2];          ///< the tables of the uplink and of the downlink
+  bool m_compiled;            ///< whether m_rules and m_tables are up to date with m_tftMap
 };
 
 
@@ -205,6 +205,11 @@ public:
                 uint8_t typeOfService);
 
 
+  /**
+   * \return the packet filters of the TFT, by increasing precedence
+   */
+  std::list<PacketFilter> GetPacketFilters () const;
+
 private:
 
   std::list<PacketFilter> m_filters;
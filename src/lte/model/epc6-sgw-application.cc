@@ -138,10 +138,10 @@ Epc6SgwApplication::RecvFromTunDevice (Ptr<Packet> packet, const Address& source
 {
   NS_LOG_FUNCTION (this << source << dest << packet << packet->GetSize () << protocolNumber);
 
-  // get IP address of UE
-  Ptr<Packet> pCopy = packet->Copy ();
+  // get IP address of UE: the header is only read, so that the packet
+  // needs not be copied
   Ipv6Header ipv6Header;
-  pCopy->RemoveHeader (ipv6Header);
+  packet->PeekHeader (ipv6Header);
   Ipv6Address ueAddr =  ipv6Header.GetDestinationAddress ();
   NS_LOG_LOGIC ("packet addressed to UE " << ueAddr);
 
@@ -152,7 +152,7 @@ Epc6SgwApplication::RecvFromTunDevice (Ptr<Packet> packet, const Address& source
     buf[i] = 0;
   Ipv6Address uePrefix (buf);
   // find corresponding UeInfo address
-  std::map<Ipv6Address, Ptr<UeInfo> >::iterator it = m_ueInfoByPrefixMap.find (uePrefix);
+  sgi::hash_map<Ipv6Address, Ptr<UeInfo>, Ipv6AddressHash>::iterator it = m_ueInfoByPrefixMap.find (uePrefix);
   if (it == m_ueInfoByPrefixMap.end ())
     {        
       NS_LOG_WARN ("unknown UE address " << ueAddr) ;
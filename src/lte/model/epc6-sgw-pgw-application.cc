@@ -135,15 +135,15 @@ Epc6SgwPgwApplication::RecvFromTunDevice (Ptr<Packet> packet, const Address& sou
 {
   NS_LOG_FUNCTION (this << source << dest << packet << packet->GetSize () << protocolNumber);
 
-  // get IP address of UE
-  Ptr<Packet> pCopy = packet->Copy ();
+  // get IP address of UE: the header is only read, so that the packet
+  // needs not be copied
   Ipv6Header ipv6Header;
-  pCopy->RemoveHeader (ipv6Header);
+  packet->PeekHeader (ipv6Header);
   Ipv6Address ueAddr =  ipv6Header.GetDestinationAddress ();
   NS_LOG_LOGIC ("packet addressed to UE " << ueAddr);
 
   // find corresponding UeInfo address
-  std::map<Ipv6Address, Ptr<UeInfo> >::iterator it = m_ueInfoByAddrMap.find (ueAddr);
+  sgi::hash_map<Ipv6Address, Ptr<UeInfo>, Ipv6AddressHash>::iterator it = m_ueInfoByAddrMap.find (ueAddr);
   if (it == m_ueInfoByAddrMap.end ())
     {        
       NS_LOG_WARN ("unknown UE address " << ueAddr) ;
@@ -36,6 +36,7 @@
 #include <ns3/application.h>
 #include <ns3/epc-s1ap-sap.h>
 #include <ns3/epc-s11-sap.h>
+#include <ns3/sgi-hashmap.h>
 #include <map>
 
 namespace ns3 {
@@ -237,7 +238,7 @@ private:
   /**
    * Map telling for each UE address the corresponding UE info 
    */
-  std::map<Ipv6Address, Ptr<UeInfo> > m_ueInfoByAddrMap;
+  sgi::hash_map<Ipv6Address, Ptr<UeInfo>, Ipv6AddressHash> m_ueInfoByAddrMap;
 
   /**
    * Map telling for each IMSI the corresponding UE info 
@@ -23,6 +23,7 @@
 #define FF_MAC_SCHEDULER_H
 
 #include <ns3/object.h>
+#include <ns3/lte-rnti-map.h>
 
 
 namespace ns3 {
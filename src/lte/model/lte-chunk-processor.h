@@ -69,6 +69,8 @@ public:
     * \brief Collect SpectrumValue and duration of signal
     *
     * Passed values are collected in m_sumValues and m_totDuration variables.
+    * m_sumValues is kept from one calculation to the next, and accumulates
+    * the values in place.
     */
   virtual void EvaluateChunk (const SpectrumValue& sinr, Time duration);
 
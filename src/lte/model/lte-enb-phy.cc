@@ -501,10 +501,10 @@ LteEnbPhy::ReceiveLteControlMessage (Ptr<LteControlMessage> msg)
 }
 
 void
-LteEnbPhy::ReceiveLteControlMessageList (std::list<Ptr<LteControlMessage> > msgList)
+LteEnbPhy::ReceiveLteControlMessageList (const std::list<Ptr<LteControlMessage> >& msgList)
 {
   NS_LOG_FUNCTION (this);
-  std::list<Ptr<LteControlMessage> >::iterator it;
+  std::list<Ptr<LteControlMessage> >::const_iterator it;
   for (it = msgList.begin (); it != msgList.end (); it++)
     {
       switch ((*it)->GetMessageType ())
@@ -266,7 +266,7 @@ public:
   /**
   * \brief PhySpectrum received a new list of LteControlMessage
   */
-  virtual void ReceiveLteControlMessageList (std::list<Ptr<LteControlMessage> >);
+  virtual void ReceiveLteControlMessageList (const std::list<Ptr<LteControlMessage> >&);
 
   // inherited from LtePhy
   virtual void GenerateCtrlCqiReport (const SpectrumValue& sinr);
@@ -27,7 +27,7 @@
 #include <ns3/nstime.h>
 #include <ns3/spectrum-value.h>
 
-#include <list>
+#include <vector>
 
 namespace ns3 {
 
@@ -143,15 +143,15 @@ private:
 
   /** all the processor instances that need to be notified whenever
   a new interference chunk is calculated */
-  std::list<Ptr<LteChunkProcessor> > m_rsPowerChunkProcessorList;
+  std::vector<Ptr<LteChunkProcessor> > m_rsPowerChunkProcessorList;
 
   /** all the processor instances that need to be notified whenever
       a new SINR chunk is calculated */
-  std::list<Ptr<LteChunkProcessor> > m_sinrChunkProcessorList;
+  std::vector<Ptr<LteChunkProcessor> > m_sinrChunkProcessorList;
 
   /** all the processor instances that need to be notified whenever
       a new interference chunk is calculated */
-  std::list<Ptr<LteChunkProcessor> > m_interfChunkProcessorList;
+  std::vector<Ptr<LteChunkProcessor> > m_interfChunkProcessorList;
 
 
 };
@@ -323,82 +323,94 @@ static const double cEcrTable [9][38] = {
 };
 
 
-double 
-LteMiErrorModel::Mib (const SpectrumValue& sinr, const std::vector<int>& map, uint8_t mcs)
+/**
+ * \param sinrLin the SINR of a RB (linear units)
+ * \param mcs the MCS of the TB
+ * \return the mutual information of the RB for the modulation of the MCS
+ */
+static double
+RbMi (double sinrLin, uint8_t mcs)
 {
-  NS_LOG_FUNCTION (sinr << &map << (uint32_t) mcs);
-  
   double MI;
-  double MIsum = 0.0;
-  SpectrumValue sinrCopy = sinr;
-  
-  for (uint32_t i = 0; i < map.size (); i++)
+  if (mcs <= MI_QPSK_MAX_ID) // QPSK
     {
-      double sinrLin = sinrCopy[map.at (i)];
-      if (mcs <= MI_QPSK_MAX_ID) // QPSK
-        {
 
-          if (sinrLin > MI_map_qpsk_axis[MI_MAP_QPSK_SIZE-1])
+      if (sinrLin > MI_map_qpsk_axis[MI_MAP_QPSK_SIZE-1])
+        {
+          MI = 1;
+        }
+      else 
+        { 
+          // since the values in MI_map_qpsk_axis are uniformly spaced, we have
+          // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
+          // the scaling coefficient is always the same, so we use a static const
+          // to speed up the calculation
+          static const double scalingCoeffQpsk = 
+            (MI_MAP_QPSK_SIZE - 1) / (MI_map_qpsk_axis[MI_MAP_QPSK_SIZE-1] - MI_map_qpsk_axis[0]);
+          double sinrIndexDouble = (sinrLin -  MI_map_qpsk_axis[0]) * scalingCoeffQpsk + 1;
+          uint32_t sinrIndex = std::max(0.0, std::floor (sinrIndexDouble));
+          NS_ASSERT_MSG (sinrIndex < MI_MAP_QPSK_SIZE, "MI map out of data");
+          MI = MI_map_qpsk[sinrIndex];
+        }
+    }
+  else
+    {
+      if (mcs > MI_QPSK_MAX_ID && mcs <= MI_16QAM_MAX_ID )	// 16-QAM
+        {
+          if (sinrLin > MI_map_16qam_axis[MI_MAP_16QAM_SIZE-1])
             {
               MI = 1;
             }
           else 
-            { 
-              // since the values in MI_map_qpsk_axis are uniformly spaced, we have
+            {
+              // since the values in MI_map_16QAM_axis are uniformly spaced, we have
               // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
               // the scaling coefficient is always the same, so we use a static const
               // to speed up the calculation
-              static const double scalingCoeffQpsk = 
-                (MI_MAP_QPSK_SIZE - 1) / (MI_map_qpsk_axis[MI_MAP_QPSK_SIZE-1] - MI_map_qpsk_axis[0]);
-              double sinrIndexDouble = (sinrLin -  MI_map_qpsk_axis[0]) * scalingCoeffQpsk + 1;
+              static const double scalingCoeff16qam = 
+                (MI_MAP_16QAM_SIZE - 1) / (MI_map_16qam_axis[MI_MAP_16QAM_SIZE-1] - MI_map_16qam_axis[0]);
+              double sinrIndexDouble = (sinrLin -  MI_map_16qam_axis[0]) * scalingCoeff16qam + 1;
               uint32_t sinrIndex = std::max(0.0, std::floor (sinrIndexDouble));
-              NS_ASSERT_MSG (sinrIndex < MI_MAP_QPSK_SIZE, "MI map out of data");
-              MI = MI_map_qpsk[sinrIndex];
+              NS_ASSERT_MSG (sinrIndex < MI_MAP_16QAM_SIZE, "MI map out of data");
+              MI = MI_map_16qam[sinrIndex];
             }
         }
-      else
+      else // 64-QAM
         {
-          if (mcs > MI_QPSK_MAX_ID && mcs <= MI_16QAM_MAX_ID )	// 16-QAM
+          if (sinrLin > MI_map_64qam_axis[MI_MAP_64QAM_SIZE-1])
             {
-              if (sinrLin > MI_map_16qam_axis[MI_MAP_16QAM_SIZE-1])
-                {
-                  MI = 1;
-                }
-              else 
-                {
-                  // since the values in MI_map_16QAM_axis are uniformly spaced, we have
-                  // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
-                  // the scaling coefficient is always the same, so we use a static const
-                  // to speed up the calculation
-                  static const double scalingCoeff16qam = 
-                    (MI_MAP_16QAM_SIZE - 1) / (MI_map_16qam_axis[MI_MAP_16QAM_SIZE-1] - MI_map_16qam_axis[0]);
-                  double sinrIndexDouble = (sinrLin -  MI_map_16qam_axis[0]) * scalingCoeff16qam + 1;
-                  uint32_t sinrIndex = std::max(0.0, std::floor (sinrIndexDouble));
-                  NS_ASSERT_MSG (sinrIndex < MI_MAP_16QAM_SIZE, "MI map out of data");
-                  MI = MI_map_16qam[sinrIndex];
-                }
+              MI = 1;
             }
-          else // 64-QAM
+          else
             {
-              if (sinrLin > MI_map_64qam_axis[MI_MAP_64QAM_SIZE-1])
-                {
-                  MI = 1;
-                }
-              else
-                {
-                  // since the values in MI_map_64QAM_axis are uniformly spaced, we have
-                  // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
-                  // the scaling coefficient is always the same, so we use a static const
-                  // to speed up the calculation
-                  static const double scalingCoeff64qam = 
-                    (MI_MAP_64QAM_SIZE - 1) / (MI_map_64qam_axis[MI_MAP_64QAM_SIZE-1] - MI_map_64qam_axis[0]);
-                  double sinrIndexDouble = (sinrLin -  MI_map_64qam_axis[0]) * scalingCoeff64qam + 1;
-                  uint32_t sinrIndex = std::max(0.0, std::floor (sinrIndexDouble));
-                  NS_ASSERT_MSG (sinrIndex < MI_MAP_64QAM_SIZE, "MI map out of data");
-                  MI = MI_map_64qam[sinrIndex];
-                }
+              // since the values in MI_map_64QAM_axis are uniformly spaced, we have
+              // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
+              // the scaling coefficient is always the same, so we use a static const
+              // to speed up the calculation
+              static const double scalingCoeff64qam = 
+                (MI_MAP_64QAM_SIZE - 1) / (MI_map_64qam_axis[MI_MAP_64QAM_SIZE-1] - MI_map_64qam_axis[0]);
+              double sinrIndexDouble = (sinrLin -  MI_map_64qam_axis[0]) * scalingCoeff64qam + 1;
+              uint32_t sinrIndex = std::max(0.0, std::floor (sinrIndexDouble));
+              NS_ASSERT_MSG (sinrIndex < MI_MAP_64QAM_SIZE, "MI map out of data");
+              MI = MI_map_64qam[sinrIndex];
             }
         }
+    }
+  return MI;
+}
+
+double 
+LteMiErrorModel::Mib (const SpectrumValue& sinr, const std::vector<int>& map, uint8_t mcs)
+{
+  NS_LOG_FUNCTION (sinr << &map << (uint32_t) mcs);
+  
+  double MI;
+  double MIsum = 0.0;
+  
+  for (uint32_t i = 0; i < map.size (); i++)
+    {
+      double sinrLin = sinr[map.at (i)];
+      MI = RbMi (sinrLin, mcs);
       NS_LOG_LOGIC (" RB " << map.at (i) << "Minimum SNR = " << 10 * std::log10 (sinrLin) << " dB, " << sinrLin << " V, MCS = " << (uint16_t)mcs << ", MI = " << MI);
       MIsum += MI;
     }
@@ -407,6 +419,34 @@ LteMiErrorModel::Mib (const SpectrumValue& sinr, const std::vector<int>& map, ui
   return MI;
 }
 
+double 
+LteMiErrorModel::Mib (const SpectrumValue& sinr, const std::vector<int>& map, uint8_t mcs, MiPerRb_t& miPerRb)
+{
+  NS_LOG_FUNCTION (sinr << &map << (uint32_t) mcs);
+
+  std::vector<double>& rbMi = miPerRb.mi[(mcs <= MI_QPSK_MAX_ID) ? 0 : ((mcs <= MI_16QAM_MAX_ID) ? 1 : 2)];
+  size_t nRbs = sinr.ConstValuesEnd () - sinr.ConstValuesBegin ();
+  if (rbMi.size () != nRbs)
+    {
+      rbMi.assign (nRbs, -1.0);
+    }
+  double MIsum = 0.0;
+  for (uint32_t i = 0; i < map.size (); i++)
+    {
+      double& MI = rbMi.at (map.at (i));
+      if (MI < 0.0)
+        {
+          // first TB of this modulation on this RB
+          MI = RbMi (sinr[map.at (i)], mcs);
+        }
+      MIsum += MI;
+    }
+  double MI = MIsum / map.size ();
+  NS_LOG_LOGIC (" MI = " << MI);
+  return MI;
+}
+
+
 
 double 
 LteMiErrorModel::MappingMiBler (double mib, uint8_t ecrId, uint16_t cbSize)
@@ -545,12 +585,16 @@ LteMiErrorModel::GetPcfichPdcchError (const SpectrumValue& sinr)
 
 
 
-TbStats_t
-LteMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint16_t size, uint8_t mcs, HarqProcessInfoList_t miHistory)
+/**
+ * \param tbMi the mean mutual information of the RBs of the TB
+ * \param size the size in bytes of the TB
+ * \param mcs the MCS of the TB
+ * \param miHistory MI of past transmissions (in case of retx)
+ * \return the TB error rate and MI
+ */
+static TbStats_t
+GetTbStatsFromMi (double tbMi, uint16_t size, uint8_t mcs, const HarqProcessInfoList_t& miHistory)
 {
-  NS_LOG_FUNCTION (sinr << &map << (uint32_t) size << (uint32_t) mcs);
-
-  double tbMi = Mib(sinr, map, mcs);
   double MI = 0.0;
   double Reff = 0.0;
   NS_ASSERT (mcs < 29);
@@ -714,15 +758,15 @@ LteMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const std:
 
   if (C!=1)
     {
-      double cbler = MappingMiBler (MI, ecrId, Kplus);
+      double cbler = LteMiErrorModel::MappingMiBler (MI, ecrId, Kplus);
       errorRate *= pow (1.0 - cbler, Cplus);
-      cbler = MappingMiBler (MI, ecrId, Kminus);
+      cbler = LteMiErrorModel::MappingMiBler (MI, ecrId, Kminus);
       errorRate *= pow (1.0 - cbler, Cminus);
       errorRate = 1.0 - errorRate;
     }
   else
     {
-      errorRate = MappingMiBler (MI, ecrId, Kplus);
+      errorRate = LteMiErrorModel::MappingMiBler (MI, ecrId, Kplus);
     }
 
   NS_LOG_LOGIC (" Error rate " << errorRate);
@@ -732,6 +776,20 @@ LteMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const std:
   return ret;
 }
 
+TbStats_t
+LteMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint16_t size, uint8_t mcs, HarqProcessInfoList_t miHistory)
+{
+  NS_LOG_FUNCTION (sinr << &map << (uint32_t) size << (uint32_t) mcs);
+  return GetTbStatsFromMi (Mib (sinr, map, mcs), size, mcs, miHistory);
+}
+
+TbStats_t
+LteMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint16_t size, uint8_t mcs, const HarqProcessInfoList_t& miHistory, MiPerRb_t& miPerRb)
+{
+  NS_LOG_FUNCTION (sinr << &map << (uint32_t) size << (uint32_t) mcs);
+  return GetTbStatsFromMi (Mib (sinr, map, mcs, miPerRb), size, mcs, miHistory);
+}
+
 
   
 
@@ -61,6 +61,18 @@ struct TbStats_t
   double tbler;
   double mi;
 };
+
+/**
+ * The mutual information of the RBs of a SINR, for QPSK, 16-QAM and
+ * 64-QAM, filled on demand by the LteMiErrorModel methods taking it, so
+ * that the MI of a RB is looked up once per modulation for all the TBs
+ * evaluated with the same SINR. A negative value means not evaluated
+ * yet. A MiPerRb_t must be used with a single SINR.
+ */
+struct MiPerRb_t
+{
+  std::vector<double> mi[3]; ///< the MI of each RB, for QPSK, 16-QAM and 64-QAM
+};
   
 
 
@@ -80,6 +92,16 @@ public:
    * \return the mmib
    */
   static double Mib (const SpectrumValue& sinr, const std::vector<int>& map, uint8_t mcs);
+  /**
+   * \brief find the mmib of the specified TB, looking up the MI of each RB
+   * only if no TB with the same modulation did already
+   * \param sinr the perceived sinrs in the whole bandwidth
+   * \param map the actives RBs for the TB
+   * \param mcs the MCS of the TB
+   * \param miPerRb the MI of the RBs already evaluated with this sinr
+   * \return the mmib
+   */
+  static double Mib (const SpectrumValue& sinr, const std::vector<int>& map, uint8_t mcs, MiPerRb_t& miPerRb);
   /** 
    * \brief map the mmib (mean mutual information per bit) for different MCS
    * \param mib mean mutual information per bit of a code-block
@@ -99,6 +121,19 @@ public:
    * \return the TB error rate and MI
    */
   static TbStats_t GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint16_t size, uint8_t mcs, HarqProcessInfoList_t miHistory);
+
+  /**
+   * \brief run the error-model algorithm for one of several TBs received
+   * with the same SINR, sharing the MI of the RBs between them
+   * \param sinr the perceived sinrs in the whole bandwidth
+   * \param map the actives RBs for the TB
+   * \param size the size in bytes of the TB
+   * \param mcs the MCS of the TB
+   * \param miHistory  MI of past transmissions (in case of retx)
+   * \param miPerRb the MI of the RBs already evaluated with this sinr
+   * \return the TB error rate and MI
+   */
+  static TbStats_t GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint16_t size, uint8_t mcs, const HarqProcessInfoList_t& miHistory, MiPerRb_t& miPerRb);
   
   /** 
   * \brief run the error-model algorithm for the specified PCFICH+PDCCH channels
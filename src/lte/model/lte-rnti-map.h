@@ -0,0 +1,415 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LTE_RNTI_MAP_H
+#define LTE_RNTI_MAP_H
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup lte
+ *
+ * The per-UE state of an eNB entity (e.g., a FF MAC scheduler or the
+ * EPC eNB application), stored in a dense array with a hash index by
+ * RNTI.
+ *
+ * The state of the UEs is contiguous in memory and a lookup is a probe
+ * of a small open addressing table instead of a search in a std::map.
+ * The eNB allocates the RNTIs cyclically over the whole 16 bit range, so
+ * the memory used grows with the number of UEs stored, not with their
+ * RNTIs. The interface is the subset of the std::map <uint16_t, T>
+ * interface used in the LTE module, with the same semantics: the
+ * elements are iterated in increasing RNTI order, and erasing an element
+ * only invalidates the iterators to that element. The iterators of end ()
+ * remain valid when elements are inserted. As with a std::vector, the
+ * references to the elements are invalidated by insert and erase.
+ */
+template <class T>
+class RntiMap
+{
+public:
+  typedef uint16_t key_type;
+  typedef T mapped_type;
+  typedef std::pair<uint16_t, T> value_type;
+  typedef std::size_t size_type;
+
+  class const_iterator;
+
+  /// Iterator over the elements of a RntiMap
+  class iterator
+  {
+public:
+    iterator ()
+      : m_map (0),
+        m_rnti (End),
+        m_order (0)
+    {
+    }
+    value_type & operator* () const
+    {
+      return m_map->m_values[m_map->Find (m_rnti)];
+    }
+    value_type * operator-> () const
+    {
+      return &m_map->m_values[m_map->Find (m_rnti)];
+    }
+    iterator & operator++ ()
+    {
+      m_order = m_map->Next (m_rnti, m_order);
+      m_rnti = m_map->RntiAt (m_order);
+      return *this;
+    }
+    iterator operator++ (int)
+    {
+      iterator tmp = *this;
+      ++*this;
+      return tmp;
+    }
+    bool operator== (const iterator &o) const
+    {
+      return m_rnti == o.m_rnti;
+    }
+    bool operator!= (const iterator &o) const
+    {
+      return m_rnti != o.m_rnti;
+    }
+    bool operator== (const const_iterator &o) const
+    {
+      return m_rnti == o.m_rnti;
+    }
+    bool operator!= (const const_iterator &o) const
+    {
+      return m_rnti != o.m_rnti;
+    }
+private:
+    friend class RntiMap;
+    friend class const_iterator;
+    iterator (RntiMap *map, uint32_t rnti, uint32_t order)
+      : m_map (map),
+        m_rnti (rnti),
+        m_order (order)
+    {
+    }
+    RntiMap *m_map;   //!< the map
+    uint32_t m_rnti;  //!< the RNTI of the element, or End
+    uint32_t m_order; //!< the position of the RNTI in m_order when the iterator was last moved
+  };
+
+  /// Constant iterator over the elements of a RntiMap
+  class const_iterator
+  {
+public:
+    const_iterator ()
+      : m_map (0),
+        m_rnti (End),
+        m_order (0)
+    {
+    }
+    const_iterator (const iterator &o)
+      : m_map (o.m_map),
+        m_rnti (o.m_rnti),
+        m_order (o.m_order)
+    {
+    }
+    const value_type & operator* () const
+    {
+      return m_map->m_values[m_map->Find (m_rnti)];
+    }
+    const value_type * operator-> () const
+    {
+      return &m_map->m_values[m_map->Find (m_rnti)];
+    }
+    const_iterator & operator++ ()
+    {
+      m_order = m_map->Next (m_rnti, m_order);
+      m_rnti = m_map->RntiAt (m_order);
+      return *this;
+    }
+    const_iterator operator++ (int)
+    {
+      const_iterator tmp = *this;
+      ++*this;
+      return tmp;
+    }
+    bool operator== (const const_iterator &o) const
+    {
+      return m_rnti == o.m_rnti;
+    }
+    bool operator!= (const const_iterator &o) const
+    {
+      return m_rnti != o.m_rnti;
+    }
+private:
+    friend class RntiMap;
+    friend class iterator;
+    const_iterator (const RntiMap *map, uint32_t rnti, uint32_t order)
+      : m_map (map),
+        m_rnti (rnti),
+        m_order (order)
+    {
+    }
+    const RntiMap *m_map; //!< the map
+    uint32_t m_rnti;      //!< the RNTI of the element, or End
+    uint32_t m_order;     //!< the position of the RNTI in m_order when the iterator was last moved
+  };
+
+  RntiMap ()
+  {
+  }
+
+  iterator begin ()
+  {
+    return iterator (this, RntiAt (0), 0);
+  }
+  const_iterator begin () const
+  {
+    return const_iterator (this, RntiAt (0), 0);
+  }
+  iterator end ()
+  {
+    return iterator (this, End, 0);
+  }
+  const_iterator end () const
+  {
+    return const_iterator (this, End, 0);
+  }
+
+  size_type size () const
+  {
+    return m_values.size ();
+  }
+  bool empty () const
+  {
+    return m_values.empty ();
+  }
+  size_type count (uint16_t rnti) const
+  {
+    return Find (rnti) != NotFound ? 1 : 0;
+  }
+
+  iterator find (uint16_t rnti)
+  {
+    return iterator (this, Find (rnti) != NotFound ? rnti : End, 0);
+  }
+  const_iterator find (uint16_t rnti) const
+  {
+    return const_iterator (this, Find (rnti) != NotFound ? rnti : End, 0);
+  }
+
+  /**
+   * \param value the RNTI and the state of the UE
+   * \return an iterator to the element of the RNTI, and false if the
+   *         map already contained it, in which case it is unchanged
+   */
+  std::pair<iterator, bool> insert (const value_type &value)
+  {
+    uint16_t rnti = value.first;
+    if (Find (rnti) != NotFound)
+      {
+        return std::make_pair (iterator (this, rnti, 0), false);
+      }
+    Add (value);
+    return std::make_pair (iterator (this, rnti, 0), true);
+  }
+
+  mapped_type & operator[] (uint16_t rnti)
+  {
+    uint32_t slot = Find (rnti);
+    if (slot == NotFound)
+      {
+        slot = Add (value_type (rnti, T ()));
+      }
+    return m_values[slot].second;
+  }
+
+  void erase (iterator it)
+  {
+    Release (it.m_rnti);
+  }
+  size_type erase (uint16_t rnti)
+  {
+    if (Find (rnti) == NotFound)
+      {
+        return 0;
+      }
+    Release (rnti);
+    return 1;
+  }
+
+  void clear ()
+  {
+    m_values.clear ();
+    m_order.clear ();
+    m_index.clear ();
+  }
+
+private:
+  /// RNTI of the end iterator, beyond any RNTI
+  static const uint32_t End = 0x10000;
+  /// slot of an RNTI which is not stored
+  static const uint32_t NotFound = 0xffffffff;
+
+  /**
+   * \param rnti an RNTI
+   * \return the slot of the RNTI in the hash index
+   */
+  uint32_t Home (uint16_t rnti) const
+  {
+    return rnti & (m_index.size () - 1);
+  }
+  /**
+   * \param rnti an RNTI, or End
+   * \return the position of the RNTI in m_values, or NotFound
+   */
+  uint32_t Find (uint32_t rnti) const
+  {
+    if (m_index.empty () || rnti >= End)
+      {
+        return NotFound;
+      }
+    uint32_t mask = m_index.size () - 1;
+    for (uint32_t i = Home (rnti); m_index[i] != 0; i = (i + 1) & mask)
+      {
+        if (m_values[m_index[i] - 1].first == rnti)
+          {
+            return m_index[i] - 1;
+          }
+      }
+    return NotFound;
+  }
+  /**
+   * \param order a position in m_order
+   * \return the RNTI at that position, or End
+   */
+  uint32_t RntiAt (uint32_t order) const
+  {
+    return order < m_order.size () ? m_order[order] : End;
+  }
+  /**
+   * \param rnti the RNTI of an iterator
+   * \param order the position of that RNTI in m_order, if unchanged
+   * \return the position in m_order of the lowest RNTI stored which is
+   *         higher than rnti
+   */
+  uint32_t Next (uint32_t rnti, uint32_t order) const
+  {
+    if (order < m_order.size () && m_order[order] == rnti)
+      {
+        return order + 1;
+      }
+    return std::upper_bound (m_order.begin (), m_order.end (), rnti) - m_order.begin ();
+  }
+  /**
+   * Store the slot of an element in the hash index.
+   * \param slot the position of the element in m_values
+   */
+  void Link (uint32_t slot)
+  {
+    uint32_t mask = m_index.size () - 1;
+    uint32_t i = Home (m_values[slot].first);
+    while (m_index[i] != 0)
+      {
+        i = (i + 1) & mask;
+      }
+    m_index[i] = slot + 1;
+  }
+  /**
+   * Add an element which is not stored yet.
+   * \param value the RNTI and the state of the UE
+   * \return the position of the element in m_values
+   */
+  uint32_t Add (const value_type &value)
+  {
+    m_values.push_back (value);
+    m_order.insert (std::upper_bound (m_order.begin (), m_order.end (), value.first), value.first);
+    uint32_t slot = m_values.size () - 1;
+    if (2 * m_values.size () > m_index.size ())
+      {
+        // keep the load of the index below one half
+        std::size_t n = 8;
+        while (n < 4 * m_values.size ())
+          {
+            n *= 2;
+          }
+        m_index.assign (n, 0);
+        for (uint32_t s = 0; s < m_values.size (); s++)
+          {
+            Link (s);
+          }
+      }
+    else
+      {
+        Link (slot);
+      }
+    return slot;
+  }
+  /**
+   * Remove the given RNTI: the last element of m_values is moved to
+   * its slot, and the index is repaired by shifting back the entries
+   * which follow it in its probe sequence.
+   * \param rnti the RNTI, which must be stored
+   */
+  void Release (uint16_t rnti)
+  {
+    uint32_t mask = m_index.size () - 1;
+    uint32_t i = Home (rnti);
+    while (m_values[m_index[i] - 1].first != rnti)
+      {
+        i = (i + 1) & mask;
+      }
+    uint32_t slot = m_index[i] - 1;
+    for (uint32_t j = (i + 1) & mask; m_index[j] != 0; j = (j + 1) & mask)
+      {
+        uint32_t k = Home (m_values[m_index[j] - 1].first);
+        // the entry at j stays put if its home is cyclically in (i, j]
+        if ((i <= j) ? (i < k && k <= j) : (i < k || k <= j))
+          {
+            continue;
+          }
+        m_index[i] = m_index[j];
+        i = j;
+      }
+    m_index[i] = 0;
+
+    uint32_t last = m_values.size () - 1;
+    if (slot != last)
+      {
+        uint32_t h = Home (m_values[last].first);
+        while (m_index[h] != last + 1)
+          {
+            h = (h + 1) & mask;
+          }
+        m_index[h] = slot + 1;
+        m_values[slot] = m_values[last];
+      }
+    m_values.pop_back ();
+    m_order.erase (std::lower_bound (m_order.begin (), m_order.end (), rnti));
+  }
+
+  std::vector<value_type> m_values; //!< the RNTIs and the state of the UEs, in no particular order
+  std::vector<uint16_t> m_order;    //!< the RNTIs stored, in increasing order
+  std::vector<uint32_t> m_index;    //!< hash index: 1 + the position in m_values of each RNTI, or 0
+};
+
+} // namespace ns3
+
+#endif /* LTE_RNTI_MAP_H */
@@ -24,6 +24,7 @@
 #include <ns3/object-factory.h>
 #include <ns3/log.h>
 #include <cmath>
+#include <algorithm>
 #include <ns3/simulator.h>
 #include <ns3/trace-source-accessor.h>
 #include <ns3/antenna-model.h>
@@ -109,13 +110,110 @@ operator < (const TbId_t& a, const TbId_t& b)
   return ( (a.m_rnti < b.m_rnti) || ( (a.m_rnti == b.m_rnti) && (a.m_layer < b.m_layer) ) );
 }
 
+/// orders the TBs of an ExpectedTbSlots by id
+struct TbIdLess
+{
+  bool operator () (const ExpectedTbSlots::value_type &a, const TbId_t &b) const
+  {
+    return a.first < b;
+  }
+};
+
+/**
+ * Swap two TBs without copying their RB maps.
+ *
+ * \param a a TB
+ * \param b another TB
+ */
+static void
+SwapTbs (ExpectedTbSlots::value_type &a, ExpectedTbSlots::value_type &b)
+{
+  std::vector<int> aMap;
+  std::vector<int> bMap;
+  aMap.swap (a.second.rbBitmap);
+  bMap.swap (b.second.rbBitmap);
+  std::swap (a, b);
+  a.second.rbBitmap.swap (bMap);
+  b.second.rbBitmap.swap (aMap);
+}
+
+ExpectedTbSlots::ExpectedTbSlots ()
+  : m_size (0)
+{
+}
+
+ExpectedTbSlots::iterator
+ExpectedTbSlots::begin ()
+{
+  return m_slots.begin ();
+}
+
+ExpectedTbSlots::iterator
+ExpectedTbSlots::end ()
+{
+  return m_slots.begin () + m_size;
+}
+
+std::size_t
+ExpectedTbSlots::size () const
+{
+  return m_size;
+}
+
+std::size_t
+ExpectedTbSlots::capacity () const
+{
+  return m_slots.size ();
+}
+
+ExpectedTbSlots::iterator
+ExpectedTbSlots::find (const TbId_t &tbId)
+{
+  iterator it = std::lower_bound (begin (), end (), tbId, TbIdLess ());
+  if ((it != end ()) && ((*it).first == tbId))
+    {
+      return it;
+    }
+  return end ();
+}
+
+tbInfo_t &
+ExpectedTbSlots::Insert (const TbId_t &tbId)
+{
+  iterator it = std::lower_bound (begin (), end (), tbId, TbIdLess ());
+  if ((it != end ()) && ((*it).first == tbId))
+    {
+      return (*it).second;
+    }
+  std::size_t index = it - begin ();
+  if (m_size == m_slots.size ())
+    {
+      m_slots.push_back (value_type ());
+    }
+  // move the first free slot to index, after the TBs with a lower id
+  for (std::size_t i = m_size; i > index; i--)
+    {
+      SwapTbs (m_slots[i], m_slots[i - 1]);
+    }
+  m_size++;
+  m_slots[index].first = tbId;
+  return m_slots[index].second;
+}
+
+void
+ExpectedTbSlots::clear ()
+{
+  m_size = 0;
+}
+
 NS_OBJECT_ENSURE_REGISTERED (LteSpectrumPhy);
 
 LteSpectrumPhy::LteSpectrumPhy ()
   : m_state (IDLE),
     m_cellId (0),
   m_transmissionMode (0),
-  m_layersNum (1)
+  m_layersNum (1),
+  m_rxAllocations (0)
 {
   NS_LOG_FUNCTION (this);
   m_random = CreateObject<UniformRandomVariable> ();
@@ -151,7 +249,7 @@ void LteSpectrumPhy::DoDispose ()
   m_ltePhyTxEndCallback      = MakeNullCallback< void, Ptr<const Packet> > ();
   m_ltePhyRxDataEndErrorCallback = MakeNullCallback< void > ();
   m_ltePhyRxDataEndOkCallback    = MakeNullCallback< void, Ptr<Packet> >  ();
-  m_ltePhyRxCtrlEndOkCallback = MakeNullCallback< void, std::list<Ptr<LteControlMessage> > > ();
+  m_ltePhyRxCtrlEndOkCallback = MakeNullCallback< void, const std::list<Ptr<LteControlMessage> >& > ();
   m_ltePhyRxCtrlEndErrorCallback = MakeNullCallback< void > ();
   m_ltePhyDlHarqFeedbackCallback = MakeNullCallback< void, DlInfoListElement_s > ();
   m_ltePhyUlHarqFeedbackCallback = MakeNullCallback< void, UlInfoListElement_s > ();
@@ -225,6 +323,11 @@ LteSpectrumPhy::GetTypeId (void)
                      "DL reception PHY layer statistics.",
                      MakeTraceSourceAccessor (&LteSpectrumPhy::m_ulPhyReception),
                      "ns3::PhyReceptionStatParameters::TracedCallback")
+    .AddTraceSource ("RxAllocations",
+                     "Number of TB slots, RB maps, control message nodes and burst list entries "
+                     "allocated by the reception of a subframe, fired at the end of the RX of its data.",
+                     MakeTraceSourceAccessor (&LteSpectrumPhy::m_rxAllocationsTrace),
+                     "ns3::LteSpectrumPhy::RxAllocationsTracedCallback")
   ;
   return tid;
 }
@@ -315,7 +418,7 @@ LteSpectrumPhy::Reset ()
   m_endRxDataEvent.Cancel ();
   m_endRxDlCtrlEvent.Cancel ();
   m_endRxUlSrsEvent.Cancel ();
-  m_rxControlMessageList.clear ();
+  ClearRxControlMessages ();
   m_expectedTbs.clear ();
   m_txControlMessageList.clear ();
   m_rxPacketBurstList.clear ();
@@ -701,13 +804,17 @@ LteSpectrumPhy::StartRxData (Ptr<LteSpectrumSignalParametersDataFrame> params)
               ChangeState (RX_DATA);
               if (params->packetBurst)
                 {
+                  if (m_rxPacketBurstList.size () == m_rxPacketBurstList.capacity ())
+                    {
+                      m_rxAllocations++;
+                    }
                   m_rxPacketBurstList.push_back (params->packetBurst);
                   m_interferenceData->StartRx (params->psd);
                   
                   m_phyRxStartTrace (params->packetBurst);
                 }
                 NS_LOG_DEBUG (this << " insert msgs " << params->ctrlMsgList.size ());
-              m_rxControlMessageList.insert (m_rxControlMessageList.end (), params->ctrlMsgList.begin (), params->ctrlMsgList.end ());
+              AppendRxControlMessages (params->ctrlMsgList);
               
               NS_LOG_LOGIC (this << " numSimultaneousRxEvents = " << m_rxPacketBurstList.size ());
             }
@@ -790,7 +897,7 @@ LteSpectrumPhy::StartRxCtrl (Ptr<SpectrumSignalParameters> params)
             if (dl==true)
               {
                 // store the DCIs
-                m_rxControlMessageList = lteDlCtrlRxParams->ctrlMsgList;
+                AppendRxControlMessages (lteDlCtrlRxParams->ctrlMsgList);
                 m_endRxDlCtrlEvent = Simulator::Schedule (params->duration, &LteSpectrumPhy::EndRxDlCtrl, this);
               }
             else
@@ -839,22 +946,34 @@ LteSpectrumPhy::UpdateSinrPerceived (const SpectrumValue& sinr)
 
 
 void
-LteSpectrumPhy::AddExpectedTb (uint16_t  rnti, uint8_t ndi, uint16_t size, uint8_t mcs, std::vector<int> map, uint8_t layer, uint8_t harqId,uint8_t rv,  bool downlink)
+LteSpectrumPhy::AddExpectedTb (uint16_t  rnti, uint8_t ndi, uint16_t size, uint8_t mcs, const std::vector<int>& map, uint8_t layer, uint8_t harqId,uint8_t rv,  bool downlink)
 {
   NS_LOG_FUNCTION (this << " rnti: " << rnti << " NDI " << (uint16_t)ndi << " size " << size << " mcs " << (uint16_t)mcs << " layer " << (uint16_t)layer << " rv " << (uint16_t)rv);
   TbId_t tbId;
   tbId.m_rnti = rnti;
   tbId.m_layer = layer;
-  expectedTbs_t::iterator it;
-  it = m_expectedTbs.find (tbId);
-  if (it != m_expectedTbs.end ())
+  // an entry with the same id migth be a TB of an unreceived packet (due
+  // to high progpalosses): its slot is overwritten
+  std::size_t slots = m_expectedTbs.capacity ();
+  tbInfo_t& tbInfo = m_expectedTbs.Insert (tbId);
+  if (m_expectedTbs.capacity () > slots)
     {
-      // migth be a TB of an unreceived packet (due to high progpalosses)
-      m_expectedTbs.erase (it);
+      m_rxAllocations++;
     }
-  // insert new entry
-  tbInfo_t tbInfo = {ndi, size, mcs, map, harqId, rv, 0.0, downlink, false, false};
-  m_expectedTbs.insert (std::pair<TbId_t, tbInfo_t> (tbId,tbInfo));
+  if (map.size () > tbInfo.rbBitmap.capacity ())
+    {
+      m_rxAllocations++;
+    }
+  tbInfo.ndi = ndi;
+  tbInfo.size = size;
+  tbInfo.mcs = mcs;
+  tbInfo.rbBitmap.assign (map.begin (), map.end ());
+  tbInfo.harqProcessId = harqId;
+  tbInfo.rv = rv;
+  tbInfo.mi = 0.0;
+  tbInfo.downlink = downlink;
+  tbInfo.corrupt = false;
+  tbInfo.harqFeedbackSent = false;
 }
 
 
@@ -877,6 +996,9 @@ LteSpectrumPhy::EndRxData ()
   NS_LOG_DEBUG (this << " txMode " << (uint16_t)m_transmissionMode << " gain " << m_txModeGain.at (m_transmissionMode));
   NS_ASSERT (m_transmissionMode < m_txModeGain.size ());
   m_sinrPerceived *= m_txModeGain.at (m_transmissionMode);
+  // all the TBs are evaluated with the same SINR: the MI of each RB is
+  // looked up once per modulation and shared between them
+  MiPerRb_t miPerRb;
   
   while (itTb!=m_expectedTbs.end ())
     {
@@ -897,7 +1019,7 @@ LteSpectrumPhy::EndRxData ()
                   harqInfoList = m_harqPhyModule->GetHarqProcessInfoUl ((*itTb).first.m_rnti, ulHarqId);
                 }
             }
-          TbStats_t tbStats = LteMiErrorModel::GetTbDecodificationStats (m_sinrPerceived, (*itTb).second.rbBitmap, (*itTb).second.size, (*itTb).second.mcs, harqInfoList);
+          TbStats_t tbStats = LteMiErrorModel::GetTbDecodificationStats (m_sinrPerceived, (*itTb).second.rbBitmap, (*itTb).second.size, (*itTb).second.mcs, harqInfoList, miPerRb);
           (*itTb).second.mi = tbStats.mi;
           (*itTb).second.corrupt = m_random->GetValue () > tbStats.tbler ? false : true;
           NS_LOG_DEBUG (this << "RNTI " << (*itTb).first.m_rnti << " size " << (*itTb).second.size << " mcs " << (uint32_t)(*itTb).second.mcs << " bitmap " << (*itTb).second.rbBitmap.size () << " layer " << (uint16_t)(*itTb).first.m_layer << " TBLER " << tbStats.tbler << " corrupted " << (*itTb).second.corrupt);
@@ -930,7 +1052,7 @@ LteSpectrumPhy::EndRxData ()
       itTb++;
     }
     std::map <uint16_t, DlInfoListElement_s> harqDlInfoMap;
-    for (std::list<Ptr<PacketBurst> >::const_iterator i = m_rxPacketBurstList.begin (); 
+    for (std::vector<Ptr<PacketBurst> >::const_iterator i = m_rxPacketBurstList.begin (); 
     i != m_rxPacketBurstList.end (); ++i)
       {
         for (std::list<Ptr<Packet> >::const_iterator j = (*i)->Begin (); j != (*i)->End (); ++j)
@@ -1051,8 +1173,10 @@ LteSpectrumPhy::EndRxData ()
     }
   ChangeState (IDLE);
   m_rxPacketBurstList.clear ();
-  m_rxControlMessageList.clear ();
+  ClearRxControlMessages ();
   m_expectedTbs.clear ();
+  m_rxAllocationsTrace (m_rxAllocations);
+  m_rxAllocations = 0;
 }
 
 
@@ -1102,7 +1226,38 @@ LteSpectrumPhy::EndRxDlCtrl ()
         }
     }
   ChangeState (IDLE);
-  m_rxControlMessageList.clear ();
+  ClearRxControlMessages ();
+}
+
+void
+LteSpectrumPhy::AppendRxControlMessages (const std::list<Ptr<LteControlMessage> >& msgList)
+{
+  NS_LOG_FUNCTION (this << msgList.size ());
+  for (std::list<Ptr<LteControlMessage> >::const_iterator it = msgList.begin (); it != msgList.end (); ++it)
+    {
+      if (m_spareControlMessageList.empty ())
+        {
+          m_rxControlMessageList.push_back (*it);
+          m_rxAllocations++;
+        }
+      else
+        {
+          m_rxControlMessageList.splice (m_rxControlMessageList.end (), m_spareControlMessageList, m_spareControlMessageList.begin ());
+          m_rxControlMessageList.back () = *it;
+        }
+    }
+}
+
+void
+LteSpectrumPhy::ClearRxControlMessages ()
+{
+  NS_LOG_FUNCTION (this);
+  // release the messages, but keep the nodes
+  for (std::list<Ptr<LteControlMessage> >::iterator it = m_rxControlMessageList.begin (); it != m_rxControlMessageList.end (); ++it)
+    {
+      *it = 0;
+    }
+  m_spareControlMessageList.splice (m_spareControlMessageList.end (), m_rxControlMessageList);
 }
 
 void
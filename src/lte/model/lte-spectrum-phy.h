@@ -38,6 +38,8 @@
 #include <ns3/lte-interference.h>
 #include "ns3/random-variable-stream.h"
 #include <map>
+#include <list>
+#include <vector>
 #include <ns3/ff-mac-common.h>
 #include <ns3/lte-harq-phy.h>
 #include <ns3/lte-common.h>
@@ -72,7 +74,62 @@ struct tbInfo_t
   bool harqFeedbackSent;
 };
 
-typedef std::map<TbId_t, tbInfo_t> expectedTbs_t;
+/**
+ * The TBs expected by a LteSpectrumPhy in the current subframe, sorted
+ * by TbId_t. The slots of the TBs are kept when the container is
+ * cleared, together with the memory of their RB maps, so that once it
+ * has held as many TBs as a subframe needs, adding TBs does not allocate
+ * any memory.
+ */
+class ExpectedTbSlots
+{
+public:
+  typedef std::pair<TbId_t, tbInfo_t> value_type; //!< a TB and its information
+  typedef std::vector<value_type>::iterator iterator; //!< iterator over the TBs
+
+  ExpectedTbSlots ();
+
+  /**
+   * \return an iterator to the TB with the lowest TbId_t
+   */
+  iterator begin ();
+  /**
+   * \return an iterator past the last TB
+   */
+  iterator end ();
+  /**
+   * \return the number of TBs
+   */
+  std::size_t size () const;
+  /**
+   * \return the number of slots, used or not
+   */
+  std::size_t capacity () const;
+  /**
+   * \param tbId the id of a TB
+   * \return an iterator to the TB, or end () if there is none
+   */
+  iterator find (const TbId_t &tbId);
+  /**
+   * Add a TB, or reuse the slot of the TB with the same id. The caller
+   * must set all the fields of the information, whose RB map is the one
+   * of a previous TB.
+   *
+   * \param tbId the id of the TB
+   * \return the information of the TB
+   */
+  tbInfo_t & Insert (const TbId_t &tbId);
+  /**
+   * Remove all the TBs, keeping their slots.
+   */
+  void clear ();
+
+private:
+  std::vector<value_type> m_slots; //!< the TBs in the first m_size slots, sorted by TbId_t, then the free slots
+  std::size_t m_size;              //!< the number of TBs
+};
+
+typedef ExpectedTbSlots expectedTbs_t;
 
 
 class LteNetDevice;
@@ -112,7 +169,7 @@ typedef Callback< void, Ptr<Packet> > LtePhyRxDataEndOkCallback;
 *
 * @param packet the received Packet
 */
-typedef Callback< void, std::list<Ptr<LteControlMessage> > > LtePhyRxCtrlEndOkCallback;
+typedef Callback< void, const std::list<Ptr<LteControlMessage> >& > LtePhyRxCtrlEndOkCallback;
 
 /**
 * This method is used by the LteSpectrumPhy to notify the PHY that a
@@ -169,6 +226,15 @@ public:
   static TypeId GetTypeId (void);
   virtual void DoDispose ();
 
+  /**
+   * TracedCallback signature for the number of allocations made by the
+   * reception of a subframe.
+   *
+   * \param [in] allocations the number of TB slots, RB maps, control
+   *              message nodes and burst list entries allocated
+   */
+  typedef void (* RxAllocationsTracedCallback)(uint32_t allocations);
+
   // inherited from SpectrumPhy
   void SetChannel (Ptr<SpectrumChannel> c);
   void SetMobility (Ptr<MobilityModel> m);
@@ -382,7 +448,7 @@ public:
   * \param harqId the id of the HARQ process (valid only for DL)
   * \param downlink true when the TB is for DL
   */
-  void AddExpectedTb (uint16_t  rnti, uint8_t ndi, uint16_t size, uint8_t mcs, std::vector<int> map, uint8_t layer, uint8_t harqId, uint8_t rv, bool downlink);
+  void AddExpectedTb (uint16_t  rnti, uint8_t ndi, uint16_t size, uint8_t mcs, const std::vector<int>& map, uint8_t layer, uint8_t harqId, uint8_t rv, bool downlink);
 
 
   /** 
@@ -426,6 +492,19 @@ private:
   void EndRxUlSrs ();
   
   void SetTxModeGain (uint8_t txMode, double gain);
+
+  /**
+   * Append control messages to m_rxControlMessageList, reusing the nodes
+   * kept in m_spareControlMessageList.
+   *
+   * \param msgList the messages
+   */
+  void AppendRxControlMessages (const std::list<Ptr<LteControlMessage> >& msgList);
+  /**
+   * Clear m_rxControlMessageList, keeping its nodes in
+   * m_spareControlMessageList.
+   */
+  void ClearRxControlMessages ();
   
 
   Ptr<MobilityModel> m_mobility;
@@ -437,10 +516,11 @@ private:
   Ptr<const SpectrumModel> m_rxSpectrumModel;
   Ptr<SpectrumValue> m_txPsd;
   Ptr<PacketBurst> m_txPacketBurst;
-  std::list<Ptr<PacketBurst> > m_rxPacketBurstList;
+  std::vector<Ptr<PacketBurst> > m_rxPacketBurstList;
   
   std::list<Ptr<LteControlMessage> > m_txControlMessageList;
   std::list<Ptr<LteControlMessage> > m_rxControlMessageList;
+  std::list<Ptr<LteControlMessage> > m_spareControlMessageList; //!< nodes of the previous m_rxControlMessageList, holding null pointers
   
   
   State m_state;
@@ -496,6 +576,13 @@ private:
    */
   TracedCallback<PhyReceptionStatParameters> m_ulPhyReception;
 
+  /**
+   * Trace of the number of allocations made by the reception of each
+   * subframe, fired at the end of the RX of the data.
+   */
+  TracedCallback<uint32_t> m_rxAllocationsTrace;
+  uint32_t m_rxAllocations; //!< the allocations made since the last data RX ended
+
   EventId m_endTxEvent;
   EventId m_endRxDataEvent;
   EventId m_endRxDlCtrlEvent;
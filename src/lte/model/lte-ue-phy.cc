@@ -833,11 +833,11 @@ LteUePhy::DoSendRachPreamble (uint32_t raPreambleId, uint32_t raRnti)
 
 
 void
-LteUePhy::ReceiveLteControlMessageList (std::list<Ptr<LteControlMessage> > msgList)
+LteUePhy::ReceiveLteControlMessageList (const std::list<Ptr<LteControlMessage> >& msgList)
 {
   NS_LOG_FUNCTION (this);
 
-  std::list<Ptr<LteControlMessage> >::iterator it;
+  std::list<Ptr<LteControlMessage> >::const_iterator it;
   for (it = msgList.begin (); it != msgList.end (); it++)
     {
       Ptr<LteControlMessage> msg = (*it);
@@ -196,7 +196,7 @@ public:
   virtual void ReportRsReceivedPower (const SpectrumValue& power);
 
   // callbacks for LteSpectrumPhy
-  virtual void ReceiveLteControlMessageList (std::list<Ptr<LteControlMessage> >);
+  virtual void ReceiveLteControlMessageList (const std::list<Ptr<LteControlMessage> >&);
   virtual void ReceivePss (uint16_t cellId, Ptr<SpectrumValue> p);
 
 
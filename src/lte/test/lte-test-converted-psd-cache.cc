@@ -0,0 +1,129 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/test.h>
+#include <ns3/log.h>
+#include <ns3/simulator.h>
+#include <ns3/node-container.h>
+#include <ns3/net-device-container.h>
+#include <ns3/mobility-helper.h>
+#include <ns3/lte-helper.h>
+#include <ns3/lte-enb-net-device.h>
+#include <ns3/lte-enb-phy.h>
+#include <ns3/lte-spectrum-phy.h>
+#include <ns3/eps-bearer.h>
+#include <ns3/spectrum-analyzer.h>
+#include <ns3/wifi-spectrum-value-helper.h>
+#include <ns3/multi-model-spectrum-channel.h>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("LteTestConvertedPsdCache");
+
+/**
+ * Check that MultiModelSpectrumChannel reuses the conversion of the
+ * LTE tx PSDs to the SpectrumModel of a Wi-Fi receiver.
+ *
+ * The LTE PHYs build a new SpectrumValue for each subframe, but only
+ * a few distinct PSDs are transmitted by an eNB serving a single UE:
+ * after the first subframes, the conversions of the downlink PSDs to
+ * the Wi-Fi SpectrumModel of a spectrum analyzer placed next to the eNB
+ * must be found in the cache of the channel.
+ */
+class LteConvertedPsdCacheTestCase : public TestCase
+{
+public:
+  LteConvertedPsdCacheTestCase ();
+  virtual ~LteConvertedPsdCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+LteConvertedPsdCacheTestCase::LteConvertedPsdCacheTestCase ()
+  : TestCase ("Reuse of the LTE downlink PSDs converted to a Wi-Fi SpectrumModel")
+{
+}
+
+LteConvertedPsdCacheTestCase::~LteConvertedPsdCacheTestCase ()
+{
+}
+
+void
+LteConvertedPsdCacheTestCase::DoRun (void)
+{
+  Ptr<LteHelper> lteHelper = CreateObject<LteHelper> ();
+  lteHelper->SetSpectrumChannelType ("ns3::MultiModelSpectrumChannel");
+
+  NodeContainer enbNodes;
+  enbNodes.Create (1);
+  NodeContainer ueNodes;
+  ueNodes.Create (1);
+  NodeContainer analyzerNodes;
+  analyzerNodes.Create (1);
+
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (enbNodes);
+  mobility.Install (ueNodes);
+  mobility.Install (analyzerNodes);
+  ueNodes.Get (0)->GetObject<MobilityModel> ()->SetPosition (Vector (100.0, 0.0, 1.5));
+  analyzerNodes.Get (0)->GetObject<MobilityModel> ()->SetPosition (Vector (10.0, 10.0, 1.5));
+
+  NetDeviceContainer enbDevs = lteHelper->InstallEnbDevice (enbNodes);
+  NetDeviceContainer ueDevs = lteHelper->InstallUeDevice (ueNodes);
+  lteHelper->Attach (ueDevs, enbDevs.Get (0));
+  lteHelper->ActivateDataRadioBearer (ueDevs, EpsBearer (EpsBearer::NGBR_VIDEO_TCP_DEFAULT));
+
+  Ptr<MultiModelSpectrumChannel> channel = enbDevs.Get (0)->GetObject<LteEnbNetDevice> ()->GetPhy ()
+    ->GetDownlinkSpectrumPhy ()->GetChannel ()->GetObject<MultiModelSpectrumChannel> ();
+  NS_TEST_ASSERT_MSG_NE (channel, 0, "the downlink channel is not a MultiModelSpectrumChannel");
+
+  WifiSpectrumValue5MhzFactory wifiFactory;
+  Ptr<const SpectrumModel> wifiModel = wifiFactory.CreateConstant (0.0)->GetSpectrumModel ();
+  Ptr<SpectrumAnalyzer> analyzer = CreateObject<SpectrumAnalyzer> ();
+  analyzer->SetRxSpectrumModel (ConstCast<SpectrumModel> (wifiModel));
+  analyzer->SetMobility (analyzerNodes.Get (0)->GetObject<MobilityModel> ());
+  analyzer->SetChannel (channel);
+  channel->AddRx (analyzer);
+
+  Simulator::Stop (Seconds (0.2));
+  Simulator::Run ();
+
+  uint64_t hits = channel->GetConvertedPsdCacheHits ();
+  uint64_t misses = channel->GetConvertedPsdCacheMisses ();
+  NS_LOG_INFO ("hits " << hits << " misses " << misses);
+  // one subframe per ms, with at least the control region
+  NS_TEST_ASSERT_MSG_GT (hits + misses, 190, "too few conversions");
+  NS_TEST_ASSERT_MSG_GT (hits, 9 * misses, "the converted PSDs are not reused");
+
+  Simulator::Destroy ();
+}
+
+
+class LteConvertedPsdCacheTestSuite : public TestSuite
+{
+public:
+  LteConvertedPsdCacheTestSuite ();
+};
+
+LteConvertedPsdCacheTestSuite::LteConvertedPsdCacheTestSuite ()
+  : TestSuite ("lte-converted-psd-cache", SYSTEM)
+{
+  AddTestCase (new LteConvertedPsdCacheTestCase (), TestCase::QUICK);
+}
+
+static LteConvertedPsdCacheTestSuite lteConvertedPsdCacheTestSuite;
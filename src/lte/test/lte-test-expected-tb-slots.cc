@@ -0,0 +1,281 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/test.h>
+#include <ns3/log.h>
+#include <ns3/simulator.h>
+#include <ns3/random-variable-stream.h>
+#include <ns3/node-container.h>
+#include <ns3/net-device-container.h>
+#include <ns3/mobility-helper.h>
+#include <ns3/lte-helper.h>
+#include <ns3/lte-ue-net-device.h>
+#include <ns3/lte-ue-phy.h>
+#include <ns3/lte-enb-net-device.h>
+#include <ns3/lte-enb-phy.h>
+#include <ns3/lte-spectrum-phy.h>
+#include <ns3/eps-bearer.h>
+
+#include <map>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("LteTestExpectedTbSlots");
+
+/**
+ * Check ExpectedTbSlots against a std::map of the same TBs.
+ *
+ * Each of 2000 random subframes clears the containers and adds up to 12
+ * TBs of 8 RNTIs and 2 layers, some of them twice, in which case the
+ * second TB overwrites the first one. After each subframe, the TBs must
+ * be visited in the same order and hold the same information as in the
+ * map, and find () must return the same TBs. Clearing must keep the
+ * slots, which are only added for a subframe holding more TBs than all
+ * the previous ones.
+ */
+class LteExpectedTbSlotsTestCase : public TestCase
+{
+public:
+  LteExpectedTbSlotsTestCase ();
+  virtual ~LteExpectedTbSlotsTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+LteExpectedTbSlotsTestCase::LteExpectedTbSlotsTestCase ()
+  : TestCase ("ExpectedTbSlots against std::map")
+{
+}
+
+LteExpectedTbSlotsTestCase::~LteExpectedTbSlotsTestCase ()
+{
+}
+
+void
+LteExpectedTbSlotsTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rv = CreateObject<UniformRandomVariable> ();
+  rv->SetStream (1);
+
+  ExpectedTbSlots slots;
+  std::map<TbId_t, tbInfo_t> reference;
+  std::size_t busiest = 0;
+  uint32_t overwritten = 0;
+  for (uint32_t subframe = 0; subframe < 2000; subframe++)
+    {
+      std::size_t capacity = slots.capacity ();
+      slots.clear ();
+      reference.clear ();
+      NS_TEST_ASSERT_MSG_EQ (slots.size (), 0, "TBs left after clear ()");
+      NS_TEST_ASSERT_MSG_EQ (slots.capacity (), capacity, "slots released by clear ()");
+      NS_TEST_ASSERT_MSG_EQ ((slots.begin () == slots.end ()), true, "TBs visited after clear ()");
+
+      uint32_t nTbs = rv->GetInteger (0, 12);
+      for (uint32_t i = 0; i < nTbs; i++)
+        {
+          TbId_t tbId (rv->GetInteger (1, 8), rv->GetInteger (0, 1));
+          if (reference.find (tbId) != reference.end ())
+            {
+              overwritten++;
+            }
+          tbInfo_t info;
+          info.ndi = rv->GetInteger (0, 1);
+          info.size = rv->GetInteger (0, 10000);
+          info.mcs = rv->GetInteger (0, 28);
+          uint32_t nRbs = rv->GetInteger (1, 25);
+          for (uint32_t rb = 0; rb < nRbs; rb++)
+            {
+              info.rbBitmap.push_back (rv->GetInteger (0, 24));
+            }
+          info.harqProcessId = rv->GetInteger (0, 7);
+          info.rv = rv->GetInteger (0, 3);
+          info.mi = 0;
+          info.downlink = (subframe % 2 == 0);
+          info.corrupt = false;
+          info.harqFeedbackSent = false;
+
+          tbInfo_t &slot = slots.Insert (tbId);
+          slot.ndi = info.ndi;
+          slot.size = info.size;
+          slot.mcs = info.mcs;
+          slot.rbBitmap.assign (info.rbBitmap.begin (), info.rbBitmap.end ());
+          slot.harqProcessId = info.harqProcessId;
+          slot.rv = info.rv;
+          slot.mi = info.mi;
+          slot.downlink = info.downlink;
+          slot.corrupt = info.corrupt;
+          slot.harqFeedbackSent = info.harqFeedbackSent;
+          reference[tbId] = info;
+        }
+
+      NS_TEST_ASSERT_MSG_EQ (slots.size (), reference.size (), "wrong number of TBs in subframe " << subframe);
+      busiest = std::max (busiest, reference.size ());
+      NS_TEST_ASSERT_MSG_EQ (slots.capacity (), busiest, "slots not reused in subframe " << subframe);
+
+      ExpectedTbSlots::iterator it = slots.begin ();
+      for (std::map<TbId_t, tbInfo_t>::iterator ref = reference.begin (); ref != reference.end (); ++ref, ++it)
+        {
+          NS_TEST_ASSERT_MSG_EQ (((*it).first == ref->first), true, "TBs out of order in subframe " << subframe);
+          NS_TEST_ASSERT_MSG_EQ ((uint32_t) (*it).second.ndi, (uint32_t) ref->second.ndi, "wrong NDI");
+          NS_TEST_ASSERT_MSG_EQ ((*it).second.size, ref->second.size, "wrong size");
+          NS_TEST_ASSERT_MSG_EQ ((uint32_t) (*it).second.mcs, (uint32_t) ref->second.mcs, "wrong MCS");
+          NS_TEST_ASSERT_MSG_EQ (((*it).second.rbBitmap == ref->second.rbBitmap), true, "wrong RB map");
+          NS_TEST_ASSERT_MSG_EQ ((uint32_t) (*it).second.harqProcessId, (uint32_t) ref->second.harqProcessId, "wrong HARQ process");
+          NS_TEST_ASSERT_MSG_EQ ((uint32_t) (*it).second.rv, (uint32_t) ref->second.rv, "wrong RV");
+          NS_TEST_ASSERT_MSG_EQ ((*it).second.downlink, ref->second.downlink, "wrong direction");
+        }
+
+      for (uint16_t rnti = 0; rnti <= 9; rnti++)
+        {
+          for (uint8_t layer = 0; layer <= 2; layer++)
+            {
+              TbId_t tbId (rnti, layer);
+              ExpectedTbSlots::iterator found = slots.find (tbId);
+              std::map<TbId_t, tbInfo_t>::iterator ref = reference.find (tbId);
+              if (ref == reference.end ())
+                {
+                  NS_TEST_ASSERT_MSG_EQ ((found == slots.end ()), true, "found an absent TB in subframe " << subframe);
+                }
+              else
+                {
+                  NS_TEST_ASSERT_MSG_EQ ((found != slots.end ()), true, "TB not found in subframe " << subframe);
+                  NS_TEST_ASSERT_MSG_EQ (((*found).first == tbId), true, "found another TB");
+                  NS_TEST_ASSERT_MSG_EQ ((*found).second.size, ref->second.size, "found a stale TB");
+                }
+            }
+        }
+    }
+  NS_TEST_ASSERT_MSG_GT (overwritten, 0, "no TB overwritten");
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (slots.capacity (), 12, "more slots than TBs in a subframe");
+}
+
+
+/**
+ * Check that the reception of the subframes stops allocating memory.
+ *
+ * An eNB serves two UEs, with saturated RLC buffers in both directions.
+ * The RxAllocations trace of the PHYs receiving the data may report
+ * allocations during the first subframes only: once the busiest subframe
+ * has been seen, every later subframe reuses the slots and list nodes.
+ */
+class LteRxAllocationsTestCase : public TestCase
+{
+public:
+  LteRxAllocationsTestCase ();
+  virtual ~LteRxAllocationsTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Record the allocations of a subframe.
+   * \param allocations the number of allocations
+   */
+  void RxAllocations (uint32_t allocations);
+
+  uint32_t m_subframes;     //!< the subframes received
+  uint32_t m_early;         //!< the allocations before the warm-up time
+  uint32_t m_late;          //!< the allocations after the warm-up time
+  uint32_t m_lateSubframes; //!< the subframes received after the warm-up time
+  Time m_warmUp;            //!< the warm-up time
+};
+
+LteRxAllocationsTestCase::LteRxAllocationsTestCase ()
+  : TestCase ("No allocation by the reception of the subframes in steady state"),
+    m_subframes (0),
+    m_early (0),
+    m_late (0),
+    m_lateSubframes (0),
+    m_warmUp (MilliSeconds (200))
+{
+}
+
+LteRxAllocationsTestCase::~LteRxAllocationsTestCase ()
+{
+}
+
+void
+LteRxAllocationsTestCase::RxAllocations (uint32_t allocations)
+{
+  m_subframes++;
+  if (Simulator::Now () < m_warmUp)
+    {
+      m_early += allocations;
+    }
+  else
+    {
+      m_late += allocations;
+      m_lateSubframes++;
+    }
+}
+
+void
+LteRxAllocationsTestCase::DoRun (void)
+{
+  Ptr<LteHelper> lteHelper = CreateObject<LteHelper> ();
+
+  NodeContainer enbNodes;
+  enbNodes.Create (1);
+  NodeContainer ueNodes;
+  ueNodes.Create (2);
+
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (enbNodes);
+  mobility.Install (ueNodes);
+  ueNodes.Get (0)->GetObject<MobilityModel> ()->SetPosition (Vector (100.0, 0.0, 1.5));
+  ueNodes.Get (1)->GetObject<MobilityModel> ()->SetPosition (Vector (0.0, 200.0, 1.5));
+
+  NetDeviceContainer enbDevs = lteHelper->InstallEnbDevice (enbNodes);
+  NetDeviceContainer ueDevs = lteHelper->InstallUeDevice (ueNodes);
+  lteHelper->Attach (ueDevs, enbDevs.Get (0));
+  lteHelper->ActivateDataRadioBearer (ueDevs, EpsBearer (EpsBearer::NGBR_VIDEO_TCP_DEFAULT));
+
+  enbDevs.Get (0)->GetObject<LteEnbNetDevice> ()->GetPhy ()->GetUlSpectrumPhy ()
+    ->TraceConnectWithoutContext ("RxAllocations", MakeCallback (&LteRxAllocationsTestCase::RxAllocations, this));
+  for (uint32_t i = 0; i < ueDevs.GetN (); i++)
+    {
+      ueDevs.Get (i)->GetObject<LteUeNetDevice> ()->GetPhy ()->GetDlSpectrumPhy ()
+        ->TraceConnectWithoutContext ("RxAllocations", MakeCallback (&LteRxAllocationsTestCase::RxAllocations, this));
+    }
+
+  Simulator::Stop (Seconds (0.4));
+  Simulator::Run ();
+
+  NS_LOG_INFO ("subframes " << m_subframes << " early " << m_early << " late " << m_late);
+  NS_TEST_ASSERT_MSG_GT (m_early, 0, "no allocation reported for the first subframes");
+  NS_TEST_ASSERT_MSG_GT (m_lateSubframes, 200, "too few subframes received");
+  NS_TEST_ASSERT_MSG_EQ (m_late, 0, "allocations once the busiest subframe has been seen");
+
+  Simulator::Destroy ();
+}
+
+
+class LteExpectedTbSlotsTestSuite : public TestSuite
+{
+public:
+  LteExpectedTbSlotsTestSuite ();
+};
+
+LteExpectedTbSlotsTestSuite::LteExpectedTbSlotsTestSuite ()
+  : TestSuite ("lte-expected-tb-slots", UNIT)
+{
+  AddTestCase (new LteExpectedTbSlotsTestCase (), TestCase::QUICK);
+  AddTestCase (new LteRxAllocationsTestCase (), TestCase::QUICK);
+}
+
+static LteExpectedTbSlotsTestSuite lteExpectedTbSlotsTestSuite;
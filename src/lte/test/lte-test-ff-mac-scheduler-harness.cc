@@ -0,0 +1,111 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/test.h>
+#include <ns3/log.h>
+#include <ns3/simulator.h>
+#include <ns3/uinteger.h>
+#include <ns3/enum.h>
+#include <ns3/ff-mac-scheduler-harness.h>
+
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("LteTestFfMacSchedulerHarness");
+
+/**
+ * Drive a scheduler with FfMacSchedulerHarness, and check that it
+ * allocates resources in both directions without overlapping
+ * allocations, and that it takes the same decisions in two runs.
+ */
+class LteFfMacSchedulerHarnessTestCase : public TestCase
+{
+public:
+  LteFfMacSchedulerHarnessTestCase (std::string scheduler, CqiListElement_s::CqiType_e cqiType);
+  virtual ~LteFfMacSchedulerHarnessTestCase ();
+
+private:
+  static std::string BuildNameString (std::string scheduler, CqiListElement_s::CqiType_e cqiType);
+  virtual void DoRun (void);
+
+  std::string m_scheduler;
+  CqiListElement_s::CqiType_e m_cqiType;
+};
+
+std::string
+LteFfMacSchedulerHarnessTestCase::BuildNameString (std::string scheduler, CqiListElement_s::CqiType_e cqiType)
+{
+  std::ostringstream oss;
+  oss << scheduler << " with " << ((cqiType == CqiListElement_s::A30) ? "A30" : "P10") << " CQIs";
+  return oss.str ();
+}
+
+LteFfMacSchedulerHarnessTestCase::LteFfMacSchedulerHarnessTestCase (std::string scheduler, CqiListElement_s::CqiType_e cqiType)
+  : TestCase (BuildNameString (scheduler, cqiType)),
+    m_scheduler (scheduler),
+    m_cqiType (cqiType)
+{
+}
+
+LteFfMacSchedulerHarnessTestCase::~LteFfMacSchedulerHarnessTestCase ()
+{
+}
+
+void
+LteFfMacSchedulerHarnessTestCase::DoRun (void)
+{
+  const uint32_t ttis = 300;
+  Ptr<FfMacSchedulerHarness> harness = CreateObject<FfMacSchedulerHarness> ();
+  harness->SetAttribute ("NumberOfUes", UintegerValue (20));
+  harness->SetAttribute ("CqiType", EnumValue (m_cqiType));
+  harness->SetSchedulerType (m_scheduler);
+  harness->AssignStreams (1);
+
+  FfMacSchedulerHarness::Result result = harness->Run (ttis);
+  NS_TEST_ASSERT_MSG_EQ (result.m_latency.size (), ttis, "wrong number of latency samples");
+  NS_TEST_ASSERT_MSG_EQ (result.m_decisions.size (), ttis, "wrong number of decisions");
+  NS_TEST_ASSERT_MSG_GT (result.m_dlDcis, 0, "no DL allocation");
+  NS_TEST_ASSERT_MSG_GT (result.m_ulDcis, 0, "no UL allocation");
+  NS_TEST_ASSERT_MSG_GT (result.m_dlBytes, 0, "no DL data");
+  NS_TEST_ASSERT_MSG_GT (result.m_ulBytes, 0, "no UL data");
+  NS_TEST_ASSERT_MSG_EQ (result.m_conflicts, 0, "overlapping allocations");
+
+  NS_TEST_ASSERT_MSG_EQ (harness->CheckDeterminism (ttis), ttis, "the decisions of two runs differ");
+
+  Simulator::Destroy ();
+}
+
+
+class LteFfMacSchedulerHarnessTestSuite : public TestSuite
+{
+public:
+  LteFfMacSchedulerHarnessTestSuite ();
+};
+
+LteFfMacSchedulerHarnessTestSuite::LteFfMacSchedulerHarnessTestSuite ()
+  : TestSuite ("lte-ff-mac-scheduler-harness", SYSTEM)
+{
+  const char *schedulers[] = { "ns3::PfFfMacScheduler", "ns3::PssFfMacScheduler",
+                               "ns3::CqaFfMacScheduler", "ns3::TtaFfMacScheduler" };
+  for (uint32_t i = 0; i < sizeof (schedulers) / sizeof (schedulers[0]); i++)
+    {
+      AddTestCase (new LteFfMacSchedulerHarnessTestCase (schedulers[i], CqiListElement_s::P10), TestCase::QUICK);
+      AddTestCase (new LteFfMacSchedulerHarnessTestCase (schedulers[i], CqiListElement_s::A30), TestCase::QUICK);
+    }
+}
+
+static LteFfMacSchedulerHarnessTestSuite lteFfMacSchedulerHarnessTestSuite;
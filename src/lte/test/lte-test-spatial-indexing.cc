@@ -0,0 +1,226 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/test.h>
+#include <ns3/log.h>
+#include <ns3/simulator.h>
+#include <ns3/boolean.h>
+#include <ns3/double.h>
+#include <ns3/string.h>
+#include <ns3/node-container.h>
+#include <ns3/net-device-container.h>
+#include <ns3/mobility-helper.h>
+#include <ns3/constant-velocity-mobility-model.h>
+#include <ns3/lte-helper.h>
+#include <ns3/lte-ue-net-device.h>
+#include <ns3/lte-ue-phy.h>
+#include <ns3/lte-enb-net-device.h>
+#include <ns3/lte-enb-phy.h>
+#include <ns3/eps-bearer.h>
+
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("LteTestSpatialIndexing");
+
+/**
+ * A sample of the RSRP/SINR traces of a PHY.
+ */
+struct LteSinrSample
+{
+  Time time;
+  uint16_t cellId;
+  uint16_t rnti;
+  double rsrp;
+  double sinr;
+};
+
+static void
+UeRsrpSinrCallback (std::vector<LteSinrSample> *samples,
+                    uint16_t cellId, uint16_t rnti, double rsrp, double sinr)
+{
+  LteSinrSample sample;
+  sample.time = Simulator::Now ();
+  sample.cellId = cellId;
+  sample.rnti = rnti;
+  sample.rsrp = rsrp;
+  sample.sinr = sinr;
+  samples->push_back (sample);
+}
+
+static void
+EnbUeSinrCallback (std::vector<LteSinrSample> *samples,
+                   uint16_t cellId, uint16_t rnti, double sinr)
+{
+  UeRsrpSinrCallback (samples, cellId, rnti, 0, sinr);
+}
+
+
+/**
+ * Check that culling the receivers of MultiModelSpectrumChannel with its
+ * spatial index does not change the SINR seen by the UEs and the eNBs.
+ *
+ * Three cells are deployed along a line: the first two are 1500 m apart,
+ * close enough to interfere with each other within MaxLossDb, while the
+ * third one is 6000 m away, so that its signals are beyond MaxLossDb in
+ * the other cells. One UE of the first cell moves toward the second one.
+ * The scenario is run with and without spatial indexing, and the DL
+ * RSRP/SINR and UL SRS SINR traces of both runs must be identical.
+ */
+class LteSpatialIndexingTestCase : public TestCase
+{
+public:
+  LteSpatialIndexingTestCase (double cellSize);
+  virtual ~LteSpatialIndexingTestCase ();
+
+private:
+  static std::string BuildNameString (double cellSize);
+  virtual void DoRun (void);
+
+  /**
+   * Run the scenario.
+   *
+   * \param spatialIndexing the value of the SpatialIndexing attribute of the channels
+   * \param samples the samples recorded for each UE, then each eNB
+   */
+  void RunScenario (bool spatialIndexing, std::vector<std::vector<LteSinrSample> > &samples);
+
+  double m_cellSize;
+};
+
+std::string
+LteSpatialIndexingTestCase::BuildNameString (double cellSize)
+{
+  std::ostringstream oss;
+  oss << "Spatial indexing of the spectrum channel with cells of " << cellSize << " m";
+  return oss.str ();
+}
+
+LteSpatialIndexingTestCase::LteSpatialIndexingTestCase (double cellSize)
+  : TestCase (BuildNameString (cellSize)),
+    m_cellSize (cellSize)
+{
+}
+
+LteSpatialIndexingTestCase::~LteSpatialIndexingTestCase ()
+{
+}
+
+void
+LteSpatialIndexingTestCase::RunScenario (bool spatialIndexing, std::vector<std::vector<LteSinrSample> > &samples)
+{
+  Ptr<LteHelper> lteHelper = CreateObject<LteHelper> ();
+  lteHelper->SetAttribute ("PathlossModel", StringValue ("ns3::FriisPropagationLossModel"));
+  lteHelper->SetSpectrumChannelAttribute ("MaxLossDb", DoubleValue (110.0));
+  lteHelper->SetSpectrumChannelAttribute ("SpatialIndexing", BooleanValue (spatialIndexing));
+  lteHelper->SetSpectrumChannelAttribute ("SpatialCellSize", DoubleValue (m_cellSize));
+
+  const double enbX[3] = { 0.0, 1500.0, 7500.0 };
+  const uint32_t uesPerEnb = 2;
+
+  NodeContainer enbNodes;
+  enbNodes.Create (3);
+  NodeContainer ueNodes;
+  ueNodes.Create (3 * uesPerEnb);
+
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (enbNodes);
+  mobility.SetMobilityModel ("ns3::ConstantVelocityMobilityModel");
+  mobility.Install (ueNodes);
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      enbNodes.Get (i)->GetObject<MobilityModel> ()->SetPosition (Vector (enbX[i], 0.0, 30.0));
+      for (uint32_t j = 0; j < uesPerEnb; j++)
+        {
+          ueNodes.Get (i * uesPerEnb + j)->GetObject<MobilityModel> ()
+            ->SetPosition (Vector (enbX[i] + 200.0, (j == 0) ? 150.0 : -150.0, 1.5));
+        }
+    }
+  // the first UE crosses several cells of the index
+  ueNodes.Get (0)->GetObject<ConstantVelocityMobilityModel> ()->SetVelocity (Vector (400.0, 0.0, 0.0));
+
+  NetDeviceContainer enbDevs = lteHelper->InstallEnbDevice (enbNodes);
+  NetDeviceContainer ueDevs = lteHelper->InstallUeDevice (ueNodes);
+  lteHelper->AssignStreams (enbDevs, 1);
+  lteHelper->AssignStreams (ueDevs, 1000);
+  for (uint32_t i = 0; i < ueDevs.GetN (); i++)
+    {
+      lteHelper->Attach (ueDevs.Get (i), enbDevs.Get (i / uesPerEnb));
+    }
+  lteHelper->ActivateDataRadioBearer (ueDevs, EpsBearer (EpsBearer::NGBR_VIDEO_TCP_DEFAULT));
+
+  samples.clear ();
+  samples.resize (ueDevs.GetN () + enbDevs.GetN ());
+  for (uint32_t i = 0; i < ueDevs.GetN (); i++)
+    {
+      ueDevs.Get (i)->GetObject<LteUeNetDevice> ()->GetPhy ()
+        ->TraceConnectWithoutContext ("ReportCurrentCellRsrpSinr",
+                                      MakeBoundCallback (&UeRsrpSinrCallback, &samples[i]));
+    }
+  for (uint32_t i = 0; i < enbDevs.GetN (); i++)
+    {
+      enbDevs.Get (i)->GetObject<LteEnbNetDevice> ()->GetPhy ()
+        ->TraceConnectWithoutContext ("ReportUeSinr",
+                                      MakeBoundCallback (&EnbUeSinrCallback, &samples[ueDevs.GetN () + i]));
+    }
+
+  Simulator::Stop (Seconds (0.5));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+LteSpatialIndexingTestCase::DoRun (void)
+{
+  std::vector<std::vector<LteSinrSample> > reference;
+  RunScenario (false, reference);
+  std::vector<std::vector<LteSinrSample> > indexed;
+  RunScenario (true, indexed);
+
+  NS_TEST_ASSERT_MSG_EQ (indexed.size (), reference.size (), "wrong number of traced PHYs");
+  for (uint32_t i = 0; i < reference.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_GT (reference[i].size (), 0, "no sample for PHY " << i);
+      NS_TEST_ASSERT_MSG_EQ (indexed[i].size (), reference[i].size (), "wrong number of samples for PHY " << i);
+      for (uint32_t j = 0; j < reference[i].size (); j++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (indexed[i][j].time, reference[i][j].time, "PHY " << i << " sample " << j);
+          NS_TEST_ASSERT_MSG_EQ (indexed[i][j].cellId, reference[i][j].cellId, "PHY " << i << " sample " << j);
+          NS_TEST_ASSERT_MSG_EQ (indexed[i][j].rnti, reference[i][j].rnti, "PHY " << i << " sample " << j);
+          NS_TEST_ASSERT_MSG_EQ (indexed[i][j].rsrp, reference[i][j].rsrp, "PHY " << i << " sample " << j);
+          NS_TEST_ASSERT_MSG_EQ (indexed[i][j].sinr, reference[i][j].sinr, "PHY " << i << " sample " << j);
+        }
+    }
+}
+
+
+class LteSpatialIndexingTestSuite : public TestSuite
+{
+public:
+  LteSpatialIndexingTestSuite ();
+};
+
+LteSpatialIndexingTestSuite::LteSpatialIndexingTestSuite ()
+  : TestSuite ("lte-spatial-indexing", SYSTEM)
+{
+  AddTestCase (new LteSpatialIndexingTestCase (500.0), TestCase::QUICK);
+  AddTestCase (new LteSpatialIndexingTestCase (50.0), TestCase::QUICK);
+}
+
+static LteSpatialIndexingTestSuite lteSpatialIndexingTestSuite;
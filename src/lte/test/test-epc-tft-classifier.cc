@@ -24,6 +24,7 @@
 #include "ns3/log.h"
 #include "ns3/packet.h"
 #include "ns3/ipv4-header.h"
+#include "ns3/ipv6-header.h"
 #include "ns3/udp-header.h"
 #include "ns3/tcp-header.h"
 #include "ns3/udp-l4-protocol.h"
@@ -135,6 +136,165 @@ EpcTftClassifierTestCase::DoRun (void)
 
 
 
+class EpcTftClassifierIpv6TestCase : public TestCase
+{
+public:
+  EpcTftClassifierIpv6TestCase (Ptr<EpcTftClassifier> c,
+                                EpcTft::Direction d,
+                                Ipv6Address sa,
+                                Ipv6Address da,
+                                uint16_t sp,
+                                uint16_t dp,
+                                uint8_t tos,
+                                uint32_t tftId);
+  virtual ~EpcTftClassifierIpv6TestCase ();
+
+private:
+
+  Ptr<EpcTftClassifier> m_c;
+  EpcTft::Direction m_d;
+  uint8_t m_tftId;
+  Ipv6Header m_ipHeader;
+  UdpHeader m_udpHeader;
+
+  static std::string BuildNameString (Ptr<EpcTftClassifier> c,
+                                      EpcTft::Direction d,
+                                      Ipv6Address sa,
+                                      Ipv6Address da,
+                                      uint16_t sp,
+                                      uint16_t dp,
+                                      uint8_t tos,
+                                      uint32_t tftId);
+  virtual void DoRun (void);
+};
+
+EpcTftClassifierIpv6TestCase::EpcTftClassifierIpv6TestCase (Ptr<EpcTftClassifier> c,
+                                                            EpcTft::Direction d,
+                                                            Ipv6Address sa,
+                                                            Ipv6Address da,
+                                                            uint16_t sp,
+                                                            uint16_t dp,
+                                                            uint8_t tos,
+                                                            uint32_t tftId)
+  : TestCase (BuildNameString (c, d, sa, da, sp, dp, tos, tftId)),
+    m_c (c),
+    m_d (d),
+    m_tftId (tftId)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_ipHeader.SetSourceAddress (sa);
+  m_ipHeader.SetDestinationAddress (da);
+  m_ipHeader.SetTrafficClass (tos);
+
+  m_udpHeader.SetSourcePort (sp);
+  m_udpHeader.SetDestinationPort (dp);
+}
+
+EpcTftClassifierIpv6TestCase::~EpcTftClassifierIpv6TestCase ()
+{
+}
+
+std::string
+EpcTftClassifierIpv6TestCase::BuildNameString (Ptr<EpcTftClassifier> c,
+                                               EpcTft::Direction d,
+                                               Ipv6Address sa,
+                                               Ipv6Address da,
+                                               uint16_t sp,
+                                               uint16_t dp,
+                                               uint8_t tos,
+                                               uint32_t tftId)
+{
+  std::ostringstream oss;
+  oss << c
+      << "  d = " << d
+      << ", sa = " << sa
+      << ", da = " << da
+      << ", sp = " << sp
+      << ", dp = " << dp
+      << ", tos = 0x" << std::hex << (int) tos
+      << " --> tftId = " << tftId;
+  return oss.str ();
+}
+
+void
+EpcTftClassifierIpv6TestCase::DoRun (void)
+{
+  ns3::PacketMetadata::Enable ();
+
+  Ptr<Packet> udpPacket = Create<Packet> ();
+  m_ipHeader.SetNextHeader (UdpL4Protocol::PROT_NUMBER);
+  m_ipHeader.SetPayloadLength (m_udpHeader.GetSerializedSize ());
+  udpPacket->AddHeader (m_udpHeader);
+  udpPacket->AddHeader (m_ipHeader);
+  NS_LOG_LOGIC (this << *udpPacket);
+  uint32_t obtainedTftId = m_c ->Classify (udpPacket, m_d);
+  NS_TEST_ASSERT_MSG_EQ (obtainedTftId, m_tftId, "bad classification of UDP packet");
+}
+
+
+
+/**
+ * Check that the classifier follows the TFTs deleted and added after
+ * the first classification.
+ */
+class EpcTftClassifierUpdateTestCase : public TestCase
+{
+public:
+  EpcTftClassifierUpdateTestCase ();
+  virtual ~EpcTftClassifierUpdateTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+EpcTftClassifierUpdateTestCase::EpcTftClassifierUpdateTestCase ()
+  : TestCase ("TFTs deleted and added after the first classification")
+{
+}
+
+EpcTftClassifierUpdateTestCase::~EpcTftClassifierUpdateTestCase ()
+{
+}
+
+void
+EpcTftClassifierUpdateTestCase::DoRun (void)
+{
+  Ptr<EpcTftClassifier> c = Create<EpcTftClassifier> ();
+  c->Add (EpcTft::Default (), 1);
+  Ptr<EpcTft> tft = Create<EpcTft> ();
+  EpcTft::PacketFilter pf;
+  pf.localPortStart = 2000;
+  pf.localPortEnd = 2999;
+  tft->Add (pf);
+  c->Add (tft, 2);
+
+  Ipv4Header ipHeader;
+  ipHeader.SetSource (Ipv4Address ("1.1.1.1"));
+  ipHeader.SetDestination (Ipv4Address ("7.0.0.2"));
+  ipHeader.SetProtocol (UdpL4Protocol::PROT_NUMBER);
+  UdpHeader udpHeader;
+  udpHeader.SetSourcePort (80);
+  udpHeader.SetDestinationPort (2345);
+  Ptr<Packet> udpPacket = Create<Packet> ();
+  udpPacket->AddHeader (udpHeader);
+  udpPacket->AddHeader (ipHeader);
+
+  NS_TEST_ASSERT_MSG_EQ (c->Classify (udpPacket, EpcTft::DOWNLINK), 2, "bad classification before deleting the TFT");
+  c->Delete (2);
+  NS_TEST_ASSERT_MSG_EQ (c->Classify (udpPacket, EpcTft::DOWNLINK), 1, "bad classification after deleting the TFT");
+  c->Add (tft, 3);
+  NS_TEST_ASSERT_MSG_EQ (c->Classify (udpPacket, EpcTft::DOWNLINK), 3, "bad classification after adding the TFT again");
+  c->Delete (1);
+  udpHeader.SetDestinationPort (3000);
+  udpPacket = Create<Packet> ();
+  udpPacket->AddHeader (udpHeader);
+  udpPacket->AddHeader (ipHeader);
+  NS_TEST_ASSERT_MSG_EQ (c->Classify (udpPacket, EpcTft::DOWNLINK), 0, "bad classification after deleting the default TFT");
+}
+
+
+
 
 class EpcTftClassifierTestSuite : public TestSuite
 {
@@ -328,4 +488,42 @@ EpcTftClassifierTestSuite::EpcTftClassifierTestSuite ()
   AddTestCase (new EpcTftClassifierTestCase (c4, EpcTft::UPLINK,   Ipv4Address ("9.1.1.1"), Ipv4Address ("8.1.1.1"),     9,     5897,     0,    2), TestCase::QUICK);
   AddTestCase (new EpcTftClassifierTestCase (c4, EpcTft::DOWNLINK, Ipv4Address ("9.1.1.1"), Ipv4Address ("8.1.1.1"),  5897,       10,     0,    2), TestCase::QUICK);
 
+
+  ///////////////////////////////////////////
+  // check IPv6 TFTs
+  ///////////////////////////////////////////
+
+  Ptr<EpcTftClassifier> c5 = Create<EpcTftClassifier> ();
+  c5->Add (EpcTft::Default (false), 1);
+
+  Ptr<EpcTft> tft5_2 = Create<EpcTft> ();
+  EpcTft::PacketFilter pf5_2_1 (false);
+  pf5_2_1.remoteAddress6.Set ("2001:db8:1::");
+  pf5_2_1.remotePrefix = Ipv6Prefix (48);
+  pf5_2_1.localPortStart = 5000;
+  pf5_2_1.localPortEnd   = 5009;
+  tft5_2->Add (pf5_2_1);
+  c5->Add (tft5_2, 2);
+
+  Ptr<EpcTft> tft5_3 = Create<EpcTft> ();
+  EpcTft::PacketFilter pf5_3_1 (false);
+  pf5_3_1.direction = EpcTft::UPLINK;
+  pf5_3_1.remotePortStart = 80;
+  pf5_3_1.remotePortEnd   = 80;
+  pf5_3_1.typeOfService = 0xb8;
+  pf5_3_1.typeOfServiceMask = 0xfc;
+  tft5_3->Add (pf5_3_1);
+  c5->Add (tft5_3, 3);
+
+  // ----------------------------------------classifier---direction--------------src address-------------------dst address-------src port--dst port--ToS--TFT id
+  AddTestCase (new EpcTftClassifierIpv6TestCase (c5, EpcTft::DOWNLINK, Ipv6Address ("2001:db8:1::7"), Ipv6Address ("b0::2"),       80,     5003,     0,    2), TestCase::QUICK);
+  AddTestCase (new EpcTftClassifierIpv6TestCase (c5, EpcTft::DOWNLINK, Ipv6Address ("2001:db8:2::7"), Ipv6Address ("b0::2"),       80,     5003,     0,    1), TestCase::QUICK);
+  AddTestCase (new EpcTftClassifierIpv6TestCase (c5, EpcTft::DOWNLINK, Ipv6Address ("2001:db8:1::7"), Ipv6Address ("b0::2"),       80,     5010,     0,    1), TestCase::QUICK);
+  AddTestCase (new EpcTftClassifierIpv6TestCase (c5, EpcTft::DOWNLINK, Ipv6Address ("2001:db8:1::7"), Ipv6Address ("b0::2"),     5003,       80,  0xb8,    1), TestCase::QUICK);
+  AddTestCase (new EpcTftClassifierIpv6TestCase (c5, EpcTft::UPLINK,   Ipv6Address ("b0::2"),         Ipv6Address ("2001:db8:1::7"), 5003,     80,  0xb8,    3), TestCase::QUICK);
+  AddTestCase (new EpcTftClassifierIpv6TestCase (c5, EpcTft::UPLINK,   Ipv6Address ("b0::2"),         Ipv6Address ("2001:db8:1::7"), 5003,     80,     0,    2), TestCase::QUICK);
+  AddTestCase (new EpcTftClassifierIpv6TestCase (c5, EpcTft::UPLINK,   Ipv6Address ("b0::2"),         Ipv6Address ("2001:db8:3::1"), 6000,     80,  0xb9,    3), TestCase::QUICK);
+  AddTestCase (new EpcTftClassifierIpv6TestCase (c5, EpcTft::UPLINK,   Ipv6Address ("b0::2"),         Ipv6Address ("2001:db8:3::1"), 6000,     81,  0xb8,    1), TestCase::QUICK);
+
+  AddTestCase (new EpcTftClassifierUpdateTestCase (), TestCase::QUICK);
 }
@@ -1152,6 +1152,22 @@ void
 Buffer::Iterator::Read (uint8_t *buffer, uint32_t size)
 {
   NS_LOG_FUNCTION (this << &buffer << size);
+  if (m_current >= m_dataStart && m_current + size <= m_dataEnd)
+    {
+      if (m_current + size <= m_zeroStart)
+        {
+          memcpy (buffer, &m_data[m_current], size);
+          m_current += size;
+          return;
+        }
+      else if (m_current >= m_zeroEnd)
+        {
+          memcpy (buffer, &m_data[m_current - (m_zeroEnd - m_zeroStart)], size);
+          m_current += size;
+          return;
+        }
+    }
+  // across the zero area, or out of bounds
   for (uint32_t i = 0; i < size; i++)
     {
       buffer[i] = ReadU8 ();
@@ -335,6 +335,17 @@ public:
    */
   virtual bool SupportsSendFrom (void) const = 0;
 
+  /**
+   * \return true if this interface splits the large sends (the packets
+   *         carrying a LargeSendTag) into segments itself, false otherwise.
+   *
+   * The large sends given to an interface which does not support it are
+   * split by the network layer. The default implementation returns false.
+   *
+   * \see SegmentationOffload
+   */
+  virtual bool SupportsSegmentationOffload (void) const;
+
 };
 
 } // namespace ns3
@@ -0,0 +1,106 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "segmentation-offload.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SegmentationOffload");
+
+LargeSendTag::LargeSendTag ()
+  : m_segmentSize (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+LargeSendTag::SetSegmentSize (uint16_t segmentSize)
+{
+  NS_LOG_FUNCTION (this << segmentSize);
+  m_segmentSize = segmentSize;
+}
+
+uint16_t
+LargeSendTag::GetSegmentSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_segmentSize;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (LargeSendTag);
+
+TypeId
+LargeSendTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LargeSendTag")
+    .SetParent<Tag> ()
+    .AddConstructor<LargeSendTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+LargeSendTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+LargeSendTag::GetSerializedSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return 2;
+}
+
+void
+LargeSendTag::Serialize (TagBuffer i) const
+{
+  NS_LOG_FUNCTION (this << &i);
+  i.WriteU16 (m_segmentSize);
+}
+
+void
+LargeSendTag::Deserialize (TagBuffer i)
+{
+  NS_LOG_FUNCTION (this << &i);
+  m_segmentSize = i.ReadU16 ();
+}
+
+void
+LargeSendTag::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << "SegmentSize=" << m_segmentSize;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (SegmentationOffload);
+
+TypeId
+SegmentationOffload::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SegmentationOffload")
+    .SetParent<Object> ()
+  ;
+  return tid;
+}
+
+SegmentationOffload::~SegmentationOffload ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+} // namespace ns3
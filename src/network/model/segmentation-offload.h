@@ -0,0 +1,154 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SEGMENTATION_OFFLOAD_H
+#define SEGMENTATION_OFFLOAD_H
+
+#include <stdint.h>
+#include <list>
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/tag.h"
+#include "packet.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief This class implements a tag that marks a packet as a large send,
+ * which holds the data of several segments of a transport protocol
+ * behind a single set of headers
+ *
+ * The tag carries the size of the data of each segment. The packet goes
+ * through the network layer as a whole and is split into segments of that
+ * size by the SegmentationOffload aggregated to the node, either by the
+ * NetDevice when it supports it, or else by the network layer.
+ */
+class LargeSendTag : public Tag
+{
+public:
+  LargeSendTag ();
+
+  /**
+   * \brief Set the size of the data of each segment
+   *
+   * \param segmentSize the size of the data of each segment
+   */
+  void SetSegmentSize (uint16_t segmentSize);
+
+  /**
+   * \brief Get the size of the data of each segment
+   *
+   * \returns the size of the data of each segment
+   */
+  uint16_t GetSegmentSize (void) const;
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  // inherited function, no need to doc.
+  virtual TypeId GetInstanceTypeId (void) const;
+
+  // inherited function, no need to doc.
+  virtual uint32_t GetSerializedSize (void) const;
+
+  // inherited function, no need to doc.
+  virtual void Serialize (TagBuffer i) const;
+
+  // inherited function, no need to doc.
+  virtual void Deserialize (TagBuffer i);
+
+  // inherited function, no need to doc.
+  virtual void Print (std::ostream &os) const;
+
+private:
+  uint16_t m_segmentSize; //!< the size of the data of each segment
+};
+
+/**
+ * \ingroup network
+ *
+ * \brief Splits the large sends of a node into the packets sent on the
+ * wire
+ *
+ * The protocols which send large sends aggregate an implementation of
+ * this class to the node, so that the NetDevices which support the
+ * segmentation offload find it with GetObject<SegmentationOffload> ().
+ * A NetDevice which supports it (see NetDevice::SupportsSegmentationOffload)
+ * splits each packet carrying a LargeSendTag only when it is about to
+ * transmit it, so that each segment takes the wire for its own
+ * transmission time. A large send which cannot be split is dropped by
+ * the NetDevice, with its MacTxDrop trace.
+ *
+ * The segments are not exactly the packets the protocol would have sent
+ * one by one:
+ * - a large send takes a single slot of a queue which counts packets,
+ *   such as a DropTailQueue in packet mode, and is dropped whole when the
+ *   queue is full;
+ * - the byte tags of a large send are copied into each of its segments.
+ *   The FlowMonitor probes, which tag the packets sent with a packet ID,
+ *   thus count a single packet received per large send, of the size of
+ *   its first segment, and ignore the other segments.
+ */
+class SegmentationOffload : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual ~SegmentationOffload ();
+
+  /**
+   * \brief Split a large send into segments.
+   *
+   * The packets of the segments come in order, each with its own network
+   * and transport headers, and without the LargeSendTag.
+   *
+   * \param packet the large send, starting with its network header
+   * \param protocolNumber the protocol number of the network header
+   * \param mtu the largest packet the device sends
+   * \param segments the list to which the segments are appended
+   * \return false if the packet cannot be split, in which case nothing
+   * is appended
+   */
+  virtual bool Segment (Ptr<const Packet> packet, uint16_t protocolNumber, uint16_t mtu,
+                        std::list<Ptr<Packet> > &segments) const = 0;
+
+  /**
+   * \brief Get the number of segments a large send is split into.
+   *
+   * The network layer gives each segment its own identification, and
+   * sends the large sends which cannot be split as a single packet.
+   *
+   * \param packet the large send, starting with its network header
+   * \param protocolNumber the protocol number of the network header
+   * \param mtu the largest packet the device sends
+   * \return the number of segments Segment returns, or 0 if the packet
+   * cannot be split
+   */
+  virtual uint32_t GetSegmentCount (Ptr<const Packet> packet, uint16_t protocolNumber, uint16_t mtu) const = 0;
+};
+
+} // namespace ns3
+
+#endif /* SEGMENTATION_OFFLOAD_H */
@@ -340,6 +340,31 @@ BufferTest::DoRun (void)
   val2 <<= 8;
   val2 |= i.ReadU8 ();
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
+
+  // Read before, across and after the zero area
+  buffer = Buffer (3);
+  buffer.AddAtStart (2);
+  i = buffer.Begin ();
+  i.WriteU8 (0x1);
+  i.WriteU8 (0x2);
+  buffer.AddAtEnd (2);
+  i = buffer.End ();
+  i.Prev (2);
+  i.WriteU8 (0x3);
+  i.WriteU8 (0x4);
+  uint8_t read[7];
+  i = buffer.Begin ();
+  i.Read (read, 2);
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)read[1], 0x2, "Bad Read() before the zero area");
+  i = buffer.Begin ();
+  i.Read (read, 7);
+  uint8_t expected[7] = { 0x1, 0x2, 0x00, 0x00, 0x00, 0x3, 0x4 };
+  NS_TEST_EXPECT_MSG_EQ (memcmp (read, expected, 7), 0, "Bad Read() across the zero area");
+  i = buffer.End ();
+  i.Prev (2);
+  i.Read (read, 2);
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)read[0], 0x3, "Bad Read() after the zero area");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)read[1], 0x4, "Bad Read() after the zero area");
 }
 //-----------------------------------------------------------------------------
 class BufferTestSuite : public TestSuite
@@ -48,7 +48,8 @@ TypeId Ipv6StaticSourceRouting::GetTypeId ()
 }
 
 Ipv6StaticSourceRouting::Ipv6StaticSourceRouting ()
-  : m_ipv6 (0)
+  : m_routeGeneration (0),
+    m_ipv6 (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -96,6 +97,7 @@ void Ipv6StaticSourceRouting::AddNetworkRouteFrom (Ipv6Address network, Ipv6Pref
   Ipv6RoutingTableEntry* route = new Ipv6RoutingTableEntry ();
   *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, nextHop, interface);
   m_networkRoutes.push_back (std::make_pair (route, metric));
+  m_routeGeneration++;
 }
 
 void Ipv6StaticSourceRouting::AddNetworkRouteFrom (Ipv6Address network, Ipv6Prefix networkPrefix, Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse, uint32_t metric)
@@ -104,6 +106,7 @@ void Ipv6StaticSourceRouting::AddNetworkRouteFrom (Ipv6Address network, Ipv6Pref
   Ipv6RoutingTableEntry* route = new Ipv6RoutingTableEntry ();
   *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, nextHop, interface, prefixToUse);
   m_networkRoutes.push_back (std::make_pair (route, metric));
+  m_routeGeneration++;
 }
 
 void Ipv6StaticSourceRouting::AddNetworkRouteFrom (Ipv6Address network, Ipv6Prefix networkPrefix, uint32_t interface, uint32_t metric)
@@ -112,6 +115,7 @@ void Ipv6StaticSourceRouting::AddNetworkRouteFrom (Ipv6Address network, Ipv6Pref
   Ipv6RoutingTableEntry* route = new Ipv6RoutingTableEntry ();
   *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, interface);
   m_networkRoutes.push_back (std::make_pair (route, metric));
+  m_routeGeneration++;
 }
 
 Ptr<Ipv6Route> Ipv6StaticSourceRouting::LookupStatic (Ipv6Address src, Ipv6Address dst)
@@ -187,6 +191,7 @@ void Ipv6StaticSourceRouting::DoDispose ()
       delete j->first;
     }
   m_networkRoutes.clear ();
+  m_routeGeneration++;
   m_ipv6 = 0;
   Ipv6RoutingProtocol::DoDispose ();
 }
@@ -240,6 +245,7 @@ void Ipv6StaticSourceRouting::RemoveRoute (uint32_t index)
         {
           delete it->first;
           m_networkRoutes.erase (it);
+          m_routeGeneration++;
           return;
         }
       tmp++;
@@ -259,6 +265,7 @@ void Ipv6StaticSourceRouting::RemoveRoute (Ipv6Address network, Ipv6Prefix prefi
         {
           delete it->first;
           m_networkRoutes.erase (it);
+          m_routeGeneration++;
           return;
         }
     }
@@ -415,5 +422,11 @@ void Ipv6StaticSourceRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream
     }
 }
 
+bool Ipv6StaticSourceRouting::GetRouteGeneration (uint32_t &generation) const
+{
+  generation = m_routeGeneration;
+  return true;
+}
+
 } /* namespace ns3 */
 
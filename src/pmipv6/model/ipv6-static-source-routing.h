@@ -173,6 +173,7 @@ public:
   virtual void NotifyRemoveRoute (Ipv6Address dst, Ipv6Prefix mask, Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse = Ipv6Address::GetZero ());
   virtual void SetIpv6 (Ptr<Ipv6> ipv6);
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const;
+  virtual bool GetRouteGeneration (uint32_t &generation) const;
 
 protected:
   /**
@@ -198,6 +199,11 @@ private:
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief the number of changes of the forwarding table.
+   */
+  uint32_t m_routeGeneration;
+
   /**
    * \brief Ipv6 reference.
    */
@@ -101,8 +101,7 @@ void LteUnicastRadvd::StartApplication ()
   // Make sure that the m_sendRA trace callback is registered with Epc6 SendRA function.
   for (RadvdInterfaceListCI it = m_configurations.begin () ; it != m_configurations.end () ; it++)
     {
-      m_eventIds[(*it)->GetId ()] = EventId ();
-      ScheduleTransmit (Seconds (0.), (*it), m_eventIds[(*it)->GetId ()], Ipv6Address::GetAllNodesMulticast (), true); 
+      ScheduleTransmit (Seconds (0.), (*it));
     }
 }
 
@@ -111,115 +110,15 @@ void LteUnicastRadvd::StopApplication ()
   NS_LOG_FUNCTION_NOARGS ();
   
   m_isAppStarted = false;
-  for (EventIdMapI it = m_eventIds.begin () ; it != m_eventIds.end () ; ++it)
-    {
-      Simulator::Cancel ((*it).second);
-    }
-  m_eventIds.clear ();
+  CancelTransmits ();
 }
 
-void LteUnicastRadvd::Send (Ptr<UnicastRadvdInterface> config, Ipv6Address dst, bool reschedule)
+void LteUnicastRadvd::Send (Ptr<UnicastRadvdInterface> config, Ptr<Packet> p)
 {
-  NS_LOG_FUNCTION (this << dst);
-  NS_ASSERT (m_eventIds[config->GetId ()].IsExpired ());
+  NS_LOG_FUNCTION (this << config << p);
   NS_ASSERT (config->GetInterfaceType () == UnicastRadvdInterface::LTE);
-  
-  Ipv6Header ipv6Hdr;
-  
-  Icmpv6RA raHdr;
-  Icmpv6OptionLinkLayerAddress llaHdr;
-  Icmpv6OptionMtu mtuHdr;
-  Icmpv6OptionPrefixInformation prefixHdr;
 
-  if (m_eventIds.size () == 0)
-    {
-      return;
-    }
-
-  std::list<Ptr<RadvdPrefix> > prefixes = config->GetPrefixes ();
-  Ptr<Packet> p = Create<Packet> ();
-  Ptr<Ipv6> ipv6 = GetNode ()->GetObject<Ipv6> ();
-
-  /* set RA header information */
-  raHdr.SetFlagM (config->IsManagedFlag ());
-  raHdr.SetFlagO (config->IsOtherConfigFlag ());
-  raHdr.SetFlagH (config->IsHomeAgentFlag ());
-  raHdr.SetCurHopLimit (config->GetCurHopLimit ());
-  raHdr.SetLifeTime (config->GetDefaultLifeTime ());
-  raHdr.SetReachableTime (config->GetReachableTime ());
-  raHdr.SetRetransmissionTime (config->GetRetransTimer ());
-
-//  if (config->IsSourceLLAddress ())
-//    {
-//      /* Get L2 address from NetDevice */
-//      Address addr = ipv6->GetNetDevice (config->GetInterface ())->GetAddress ();
-//      llaHdr = Icmpv6OptionLinkLayerAddress (true, addr);
-//      p->AddHeader (llaHdr);
-//    }
-
-  if (config->GetLinkMtu ())
-    {
-      NS_ASSERT (config->GetLinkMtu () >= 1280);
-      mtuHdr = Icmpv6OptionMtu (config->GetLinkMtu ());
-      p->AddHeader (mtuHdr);
-    }
-
-  /* add list of prefixes */
-  for (std::list<Ptr<RadvdPrefix> >::const_iterator jt = prefixes.begin () ; jt != prefixes.end () ; jt++)
-    {
-      uint8_t flags = 0;
-      prefixHdr = Icmpv6OptionPrefixInformation ();
-      prefixHdr.SetPrefix ((*jt)->GetNetwork ());
-      prefixHdr.SetPrefixLength ((*jt)->GetPrefixLength ());
-      prefixHdr.SetValidTime ((*jt)->GetValidLifeTime ());
-      prefixHdr.SetPreferredTime ((*jt)->GetPreferredLifeTime ());
-
-      if ((*jt)->IsOnLinkFlag ())
-        {
-          flags += 1 << 7;
-        }
-
-      if ((*jt)->IsAutonomousFlag ())
-        {
-          flags += 1 << 6;
-        }
-
-      if ((*jt)->IsRouterAddrFlag ())
-        {
-          flags += 1 << 5;
-        }
-
-      prefixHdr.SetFlags (flags);
-
-      p->AddHeader (prefixHdr);
-    }
-
-  Ipv6Address src = ipv6->GetAddress (config->GetInterface (), 0).GetAddress ();
-
-  /* as we know interface index that will be used to send RA and 
-   * we always send RA with router's link-local address, we can 
-   * calculate checksum here.
-   */
-  raHdr.CalculatePseudoHeaderChecksum (src, dst, p->GetSize () + raHdr.GetSerializedSize (), 58 /* ICMPv6 */);
-  p->AddHeader (raHdr);
-
-  ipv6Hdr.SetSourceAddress (src);
-  ipv6Hdr.SetDestinationAddress (dst);
-  ipv6Hdr.SetNextHeader (58 /* ICMPv6 */);
-  ipv6Hdr.SetPayloadLength (p->GetSize());
-  ipv6Hdr.SetHopLimit (255);
-  
-  p->AddHeader (ipv6Hdr);
-  
   m_sendRA (p, config->GetTunnelId (), config->GetImsi ());
-  if (reschedule)
-    {
-      UniformRandomVariable rnd;
-      uint64_t delay = static_cast<uint64_t> (rnd.GetValue (config->GetMinRtrAdvInterval (), config->GetMaxRtrAdvInterval ()) + 0.5);
-      NS_LOG_INFO ("Reschedule in " << delay);
-      Time t = MilliSeconds (delay);
-      ScheduleTransmit (t, config, m_eventIds[config->GetId ()], dst, reschedule);
-    }
 }
 
 bool
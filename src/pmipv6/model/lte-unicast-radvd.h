@@ -74,12 +74,11 @@ protected:
   virtual void DoDispose ();
 
   /**
-   * \brief Send a packet.
+   * \brief Send a RA through the bearer of the configuration.
    * \param config interface configuration
-   * \param dst destination address (default ff02::1)
-   * \param reschedule if true another send will be reschedule (periodic)
+   * \param p the RA, with its IPv6 header
    */
-  virtual void Send (Ptr<UnicastRadvdInterface> config, Ipv6Address dst = Ipv6Address::GetAllNodesMulticast (), bool reschedule = false);
+  virtual void Send (Ptr<UnicastRadvdInterface> config, Ptr<Packet> p);
 
   virtual bool IsAppStarted ();
 
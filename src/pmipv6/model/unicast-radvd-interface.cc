@@ -32,6 +32,7 @@ uint32_t UnicastRadvdInterface::m_idGen = 1;
 UnicastRadvdInterface::UnicastRadvdInterface(uint32_t interface, enum UnicastRadvdInterface::InterfaceType interfaceType)
  : RadvdInterface(interface),
    m_interfaceType (interfaceType),
+   m_raChangeCount (0),
    m_id (m_idGen++)
 {
 
@@ -40,6 +41,7 @@ UnicastRadvdInterface::UnicastRadvdInterface(uint32_t interface, enum UnicastRad
 UnicastRadvdInterface::UnicastRadvdInterface(uint32_t interface, uint32_t maxRtrAdvInterval, uint32_t minRtrAdvInterval, enum UnicastRadvdInterface::InterfaceType interfaceType)
  : RadvdInterface(interface, maxRtrAdvInterval, minRtrAdvInterval),
    m_interfaceType (interfaceType),
+   m_raChangeCount (0),
    m_id (m_idGen++)
 {
   
@@ -85,4 +87,21 @@ void UnicastRadvdInterface::SetImsi (uint64_t imsi)
   m_imsi = imsi;
 }
 
+Ptr<Packet> UnicastRadvdInterface::GetRa (Ipv6Address src, Ipv6Address dst) const
+{
+  if (m_raSource != src || m_raDestination != dst || m_raChangeCount != GetChangeCount ())
+    {
+      return 0;
+    }
+  return m_ra;
+}
+
+void UnicastRadvdInterface::SetRa (Ptr<Packet> ra, Ipv6Address src, Ipv6Address dst)
+{
+  m_ra = ra;
+  m_raSource = src;
+  m_raDestination = dst;
+  m_raChangeCount = GetChangeCount ();
+}
+
 }
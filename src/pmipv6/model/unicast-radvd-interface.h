@@ -26,6 +26,8 @@
 #define UNICAST_RADVD_INTERFACE_H
 
 #include "ns3/radvd-interface.h"
+#include "ns3/packet.h"
+#include "ns3/ipv6-address.h"
 
 namespace ns3
 {
@@ -64,11 +66,32 @@ public:
 
   void SetImsi (uint64_t imsi);
 
+  /**
+   * \brief Get the RA built for this configuration.
+   * \param src source address of the RA
+   * \param dst destination address of the RA
+   * \return the RA, or 0 if it was not built for these addresses or if
+   * the configuration or its prefixes changed since it was built
+   */
+  Ptr<Packet> GetRa (Ipv6Address src, Ipv6Address dst) const;
+
+  /**
+   * \brief Keep the RA built for this configuration.
+   * \param ra the RA, with its IPv6 header
+   * \param src source address of the RA
+   * \param dst destination address of the RA
+   */
+  void SetRa (Ptr<Packet> ra, Ipv6Address src, Ipv6Address dst);
+
 private:
   enum InterfaceType m_interfaceType;
   Address m_physicalAddress;
   uint32_t m_teid;
   uint64_t m_imsi;
+  Ptr<Packet> m_ra;
+  Ipv6Address m_raSource;
+  Ipv6Address m_raDestination;
+  uint32_t m_raChangeCount;
 
 protected:
   uint32_t m_id;
@@ -29,6 +29,9 @@
 #include "ns3/packet.h"
 #include "ns3/net-device.h"
 #include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/pointer.h"
+#include "ns3/trace-source-accessor.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/inet6-socket-address.h"
 #include "ns3/ipv6.h"
@@ -50,41 +53,58 @@ TypeId UnicastRadvd::GetTypeId ()
 {
   static TypeId tid = TypeId ("ns3::UnicastRadvd")
     .SetParent<Application> ()
+    .AddAttribute ("AdvertisementJitter",
+                   "Uniform variable to provide jitter between min and max values of AdvInterval",
+                   StringValue ("ns3::UniformRandomVariable"),
+                   MakePointerAccessor (&UnicastRadvd::m_jitter),
+                   MakePointerChecker<UniformRandomVariable> ())
+    .AddAttribute ("BatchInterval",
+                   "The periodic RAs are sent in batches at multiples of this interval, "
+                   "at most this late. Zero sends each RA when it is due.",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&UnicastRadvd::m_batchInterval),
+                   MakeTimeChecker ())
+    .AddTraceSource ("TxRa",
+                     "A RA is sent, with its delay from the time it was due.",
+                     MakeTraceSourceAccessor (&UnicastRadvd::m_txRaTrace))
     ;
   return tid;
 }
 
+UnicastRadvd::UnicastRadvd ()
+  : m_sending (false)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+}
+
 void UnicastRadvd::DoDispose ()
 {
   NS_LOG_FUNCTION_NOARGS ();
+  CancelTransmits ();
   for (RadvdInterfaceListI it = m_configurations.begin () ; it != m_configurations.end () ; ++it)
     {
       *it = 0;
     }
   m_configurations.clear ();
+  m_jitter = 0;
   Application::DoDispose ();
 }
 
+int64_t UnicastRadvd::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_jitter->SetStream (stream);
+  return 1;
+}
+
 void UnicastRadvd::StartApplication ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-
-//  for (RadvdInterfaceListCI it = m_configurations.begin () ; it != m_configurations.end () ; it++)
-//    {
-//      m_eventIds[(*it)->GetId ()] = EventId ();
-//      ScheduleTransmit (Seconds (0.), (*it), m_eventIds[(*it)->GetId ()], Ipv6Address::GetAllNodesMulticast (), true);
-//    }
 }
 
 void UnicastRadvd::StopApplication ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  
-//  for (EventIdMapI it = m_eventIds.begin () ; it != m_eventIds.end () ; ++it)
-//    {
-//      Simulator::Cancel ((*it).second);
-//    }
-//  m_eventIds.clear ();
 }
 
 void UnicastRadvd::AddConfiguration (Ptr<UnicastRadvdInterface> routerInterface)
@@ -95,12 +115,7 @@ void UnicastRadvd::AddConfiguration (Ptr<UnicastRadvdInterface> routerInterface)
   if (IsAppStarted ())
     {
       NS_LOG_LOGIC ("Application is already started. Adding and Scheduling.");
-      if (m_eventIds.find(routerInterface->GetId()) != m_eventIds.end() )
-        {
-          m_eventIds[routerInterface->GetId()].Cancel();
-        }
-      m_eventIds[routerInterface->GetId()] = EventId();
-      ScheduleTransmit (Seconds (0.), routerInterface, m_eventIds[routerInterface->GetId ()], Ipv6Address::GetAllNodesMulticast (), true); 
+      ScheduleTransmit (Seconds (0.), routerInterface);
     }
 }
 
@@ -108,10 +123,7 @@ void UnicastRadvd::RemoveConfiguration (Ptr<UnicastRadvdInterface> routerInterfa
 {
   NS_LOG_FUNCTION ( this << routerInterface );
   
-  if ( m_eventIds.find(routerInterface->GetId()) != m_eventIds.end() )
-    {
-      m_eventIds[routerInterface->GetId()].Cancel();
-    }
+  Cancel (routerInterface);
   m_configurations.remove (routerInterface);
 }
 
@@ -129,10 +141,187 @@ void UnicastRadvd::RemoveConfiguration (int32_t ifIndex)
     }
 }
   
-void UnicastRadvd::ScheduleTransmit (Time dt, Ptr<UnicastRadvdInterface> config, EventId& eventId, Ipv6Address dst, bool reschedule)
+void UnicastRadvd::ScheduleTransmit (Time dt, Ptr<UnicastRadvdInterface> config)
+{
+  NS_LOG_FUNCTION (this << dt << config);
+  Time due = Simulator::Now () + dt;
+  Schedule (config, due, due);
+}
+
+void UnicastRadvd::CancelTransmits ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_schedule.clear ();
+  m_scheduled.clear ();
+  m_batchEvent.Cancel ();
+}
+
+void UnicastRadvd::Schedule (Ptr<UnicastRadvdInterface> config, Time due, Time batch)
 {
-  NS_LOG_FUNCTION (this << dt);
-  eventId = Simulator::Schedule (dt, &UnicastRadvd::Send, this, config, dst, reschedule);
+  NS_LOG_FUNCTION (this << config << due << batch);
+  Cancel (config);
+
+  ScheduledRa ra;
+  ra.config = config;
+  ra.due = due;
+  RaScheduleI it = m_schedule.insert (std::make_pair (batch, ra));
+  m_scheduled[config->GetId ()] = it;
+
+  /* the batch being sent schedules the next one when it is done */
+  if (!m_sending && (it == m_schedule.begin () || !m_batchEvent.IsRunning ()))
+    {
+      m_batchEvent.Cancel ();
+      m_batchEvent = Simulator::Schedule (m_schedule.begin ()->first - Simulator::Now (), &UnicastRadvd::SendBatch, this);
+    }
+}
+
+void UnicastRadvd::Cancel (Ptr<UnicastRadvdInterface> config)
+{
+  NS_LOG_FUNCTION (this << config);
+  ScheduledRaMapI it = m_scheduled.find (config->GetId ());
+  if (it != m_scheduled.end ())
+    {
+      m_schedule.erase (it->second);
+      m_scheduled.erase (it);
+    }
+}
+
+void UnicastRadvd::SendBatch ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Time now = Simulator::Now ();
+
+  m_sending = true;
+  while (!m_schedule.empty () && m_schedule.begin ()->first <= now)
+    {
+      ScheduledRa ra = m_schedule.begin ()->second;
+      m_scheduled.erase (ra.config->GetId ());
+      m_schedule.erase (m_schedule.begin ());
+
+      Ptr<Packet> p = GetRa (ra.config, Ipv6Address::GetAllNodesMulticast ());
+      NS_LOG_LOGIC ("Send RA");
+      Send (ra.config, p->Copy ());
+      m_txRaTrace (p, now - ra.due);
+
+      uint64_t delay = static_cast<uint64_t> (m_jitter->GetValue (ra.config->GetMinRtrAdvInterval (), ra.config->GetMaxRtrAdvInterval ()) + 0.5);
+      NS_LOG_INFO ("Reschedule in " << delay);
+      Time due = now + MilliSeconds (delay);
+      Time batch = due;
+      if (m_batchInterval.IsStrictlyPositive ())
+        {
+          int64_t interval = m_batchInterval.GetTimeStep ();
+          batch = TimeStep ((due.GetTimeStep () + interval - 1) / interval * interval);
+        }
+      Schedule (ra.config, due, batch);
+    }
+  m_sending = false;
+
+  if (!m_schedule.empty ())
+    {
+      m_batchEvent = Simulator::Schedule (m_schedule.begin ()->first - now, &UnicastRadvd::SendBatch, this);
+    }
+}
+
+Ptr<Packet> UnicastRadvd::GetRa (Ptr<UnicastRadvdInterface> config, Ipv6Address dst)
+{
+  NS_LOG_FUNCTION (this << config << dst);
+  Ptr<Ipv6> ipv6 = GetNode ()->GetObject<Ipv6> ();
+  Ipv6Address src = ipv6->GetAddress (config->GetInterface (), 0).GetAddress ();
+
+  Ptr<Packet> p = config->GetRa (src, dst);
+  if (!p)
+    {
+      p = BuildRa (config, src, dst);
+      config->SetRa (p, src, dst);
+    }
+  return p;
+}
+
+Ptr<Packet> UnicastRadvd::BuildRa (Ptr<UnicastRadvdInterface> config, Ipv6Address src, Ipv6Address dst)
+{
+  NS_LOG_FUNCTION (this << config << src << dst);
+
+  Ipv6Header ipv6Hdr;
+  
+  Icmpv6RA raHdr;
+  Icmpv6OptionLinkLayerAddress llaHdr;
+  Icmpv6OptionMtu mtuHdr;
+  Icmpv6OptionPrefixInformation prefixHdr;
+
+  std::list<Ptr<RadvdPrefix> > prefixes = config->GetPrefixes ();
+  Ptr<Packet> p = Create<Packet> ();
+  Ptr<Ipv6> ipv6 = GetNode ()->GetObject<Ipv6> ();
+
+  /* set RA header information */
+  raHdr.SetFlagM (config->IsManagedFlag ());
+  raHdr.SetFlagO (config->IsOtherConfigFlag ());
+  raHdr.SetFlagH (config->IsHomeAgentFlag ());
+  raHdr.SetCurHopLimit (config->GetCurHopLimit ());
+  raHdr.SetLifeTime (config->GetDefaultLifeTime ());
+  raHdr.SetReachableTime (config->GetReachableTime ());
+  raHdr.SetRetransmissionTime (config->GetRetransTimer ());
+
+  /* the LTE bearers do not have any link-layer address */
+  if (config->IsSourceLLAddress () && config->GetInterfaceType () == UnicastRadvdInterface::REGULAR)
+    {
+      /* Get L2 address from NetDevice */
+      Address addr = ipv6->GetNetDevice (config->GetInterface ())->GetAddress ();
+      llaHdr = Icmpv6OptionLinkLayerAddress (true, addr);
+      p->AddHeader (llaHdr);
+    }
+
+  if (config->GetLinkMtu ())
+    {
+      NS_ASSERT (config->GetLinkMtu () >= 1280);
+      mtuHdr = Icmpv6OptionMtu (config->GetLinkMtu ());
+      p->AddHeader (mtuHdr);
+    }
+
+  /* add list of prefixes */
+  for (std::list<Ptr<RadvdPrefix> >::const_iterator jt = prefixes.begin () ; jt != prefixes.end () ; jt++)
+    {
+      uint8_t flags = 0;
+      prefixHdr = Icmpv6OptionPrefixInformation ();
+      prefixHdr.SetPrefix ((*jt)->GetNetwork ());
+      prefixHdr.SetPrefixLength ((*jt)->GetPrefixLength ());
+      prefixHdr.SetValidTime ((*jt)->GetValidLifeTime ());
+      prefixHdr.SetPreferredTime ((*jt)->GetPreferredLifeTime ());
+
+      if ((*jt)->IsOnLinkFlag ())
+        {
+          flags += 1 << 7;
+        }
+
+      if ((*jt)->IsAutonomousFlag ())
+        {
+          flags += 1 << 6;
+        }
+
+      if ((*jt)->IsRouterAddrFlag ())
+        {
+          flags += 1 << 5;
+        }
+
+      prefixHdr.SetFlags (flags);
+
+      p->AddHeader (prefixHdr);
+    }
+
+  /* as we know interface index that will be used to send RA and 
+   * we always send RA with router's link-local address, we can 
+   * calculate checksum here.
+   */
+  raHdr.CalculatePseudoHeaderChecksum (src, dst, p->GetSize () + raHdr.GetSerializedSize (), 58 /* ICMPv6 */);
+  p->AddHeader (raHdr);
+
+  ipv6Hdr.SetSourceAddress (src);
+  ipv6Hdr.SetDestinationAddress (dst);
+  ipv6Hdr.SetNextHeader (58 /* ICMPv6 */);
+  ipv6Hdr.SetPayloadLength (p->GetSize());
+  ipv6Hdr.SetHopLimit (255);
+  
+  p->AddHeader (ipv6Hdr);
+  return p;
 }
 
 } /* namespace ns3 */
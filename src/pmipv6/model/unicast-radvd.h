@@ -29,6 +29,10 @@
 
 #include "ns3/application.h"
 #include "ns3/socket.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/traced-callback.h"
 
 #include "unicast-radvd-interface.h"
 
@@ -44,6 +48,12 @@ namespace ns3
  * \ingroup unicast-radvd
  * \class UnicastRadvd
  * \brief Router advertisement daemon with MAC unicast.
+ *
+ * The daemon sends one RA per configuration, that is per mobile node.
+ * The periodic RAs of all the configurations are sent in batches, at
+ * multiples of the "BatchInterval" attribute: a single event sends all
+ * the RAs due since the previous batch, at most one interval late. The
+ * RA of each configuration is built once and copied for each send.
  */
 class UnicastRadvd : public Application
 {
@@ -54,6 +64,11 @@ public:
    */
   static TypeId GetTypeId (void);
 
+  /**
+   * \brief Constructor.
+   */
+  UnicastRadvd ();
+
   /**
    * \brief Default value for maximum delay of RA (ms)
    */
@@ -61,6 +76,9 @@ public:
 
   /**
    * \brief Add configuration for an interface;
+   *
+   * The RA of the configuration is built when it is first sent, and
+   * reused until the configuration or its prefixes change.
    * \param routerInterface configuration
    */
   void AddConfiguration (Ptr<UnicastRadvdInterface> routerInterface);
@@ -68,36 +86,50 @@ public:
   void RemoveConfiguration (Ptr<UnicastRadvdInterface> routerInterface);
   void RemoveConfiguration (int32_t ifIndex);
 
+  /**
+   * \brief Assign a fixed random variable stream number to the random
+   * variables used by this model.
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
 protected:
   typedef std::list<Ptr<UnicastRadvdInterface> > RadvdInterfaceList;
   typedef std::list<Ptr<UnicastRadvdInterface> >::iterator RadvdInterfaceListI;
   typedef std::list<Ptr<UnicastRadvdInterface> >::const_iterator RadvdInterfaceListCI;
 
-  typedef std::map<uint32_t, EventId> EventIdMap;
-  typedef std::map<uint32_t, EventId>::iterator EventIdMapI;
-  typedef std::map<uint32_t, EventId>::const_iterator EventIdMapCI;
   /**
    * \brief Dispose the instance.
    */
   virtual void DoDispose ();
 
   /**
-   * \brief Schedule sending a packet.
-   * \param dt interval between packet
+   * \brief Schedule the periodic RAs of a configuration.
+   * \param dt delay of the first RA
+   * \param config interface configuration
+   */
+  void ScheduleTransmit (Time dt, Ptr<UnicastRadvdInterface> config);
+
+  /**
+   * \brief Cancel the RAs of all the configurations.
+   */
+  void CancelTransmits ();
+
+  /**
+   * \brief Get the RA of a configuration, built at the first call.
    * \param config interface configuration
-   * \param eventId event ID associated
-   * \param dst IPv6 destination address
-   * \param reschedule if true another send will be reschedule (periodic)
+   * \param dst destination address
+   * \return the RA, with its IPv6 header
    */
-  void ScheduleTransmit (Time dt, Ptr<UnicastRadvdInterface> config, EventId& eventId, Ipv6Address dst = Ipv6Address::GetAllNodesMulticast (), bool reschedule = false);
+  Ptr<Packet> GetRa (Ptr<UnicastRadvdInterface> config, Ipv6Address dst);
 
   /**
-   * \brief Send a packet.
+   * \brief Send a RA.
    * \param config interface configuration
-   * \param dst destination address (default ff02::1)
-   * \param reschedule if true another send will be reschedule (periodic)
+   * \param p the RA, with its IPv6 header
    */
-  virtual void Send (Ptr<UnicastRadvdInterface> config, Ipv6Address dst = Ipv6Address::GetAllNodesMulticast (), bool reschedule = false) = 0;
+  virtual void Send (Ptr<UnicastRadvdInterface> config, Ptr<Packet> p) = 0;
 
   virtual bool IsAppStarted () = 0;
 
@@ -106,12 +138,21 @@ protected:
    */
   RadvdInterfaceList m_configurations;
 
+private:
   /**
-   * \brief Event ID map.
+   * \brief A RA to send.
    */
-  EventIdMap m_eventIds;
+  struct ScheduledRa
+  {
+    Ptr<UnicastRadvdInterface> config; //!< interface configuration
+    Time due;                          //!< time at which the RA is due
+  };
+
+  typedef std::multimap<Time, ScheduledRa> RaSchedule;
+  typedef std::multimap<Time, ScheduledRa>::iterator RaScheduleI;
+  typedef std::map<uint32_t, RaScheduleI> ScheduledRaMap;
+  typedef std::map<uint32_t, RaScheduleI>::iterator ScheduledRaMapI;
 
-private:
   /**
    * \brief Start the application.
    */
@@ -122,6 +163,68 @@ private:
    */
   virtual void StopApplication ();
 
+  /**
+   * \brief Schedule the next RA of a configuration.
+   * \param config interface configuration
+   * \param due time at which the RA is due
+   * \param batch time at which the RA is sent, due or later
+   */
+  void Schedule (Ptr<UnicastRadvdInterface> config, Time due, Time batch);
+
+  /**
+   * \brief Cancel the next RA of a configuration.
+   * \param config interface configuration
+   */
+  void Cancel (Ptr<UnicastRadvdInterface> config);
+
+  /**
+   * \brief Send the RAs which are due and schedule the next ones.
+   */
+  void SendBatch ();
+
+  /**
+   * \brief Build the RA of a configuration.
+   * \param config interface configuration
+   * \param src source address
+   * \param dst destination address
+   * \return the RA, with its IPv6 header
+   */
+  Ptr<Packet> BuildRa (Ptr<UnicastRadvdInterface> config, Ipv6Address src, Ipv6Address dst);
+
+  /**
+   * \brief The RAs to send, by time at which they are sent.
+   */
+  RaSchedule m_schedule;
+
+  /**
+   * \brief The scheduled RA of each configuration, by configuration ID.
+   */
+  ScheduledRaMap m_scheduled;
+
+  /**
+   * \brief The event of the next batch of RAs.
+   */
+  EventId m_batchEvent;
+
+  /**
+   * \brief Whether a batch of RAs is being sent.
+   */
+  bool m_sending;
+
+  /**
+   * \brief The periodic RAs are sent at multiples of this interval.
+   */
+  Time m_batchInterval;
+
+  /**
+   * \brief Variable to provide jitter in advertisement interval.
+   */
+  Ptr<UniformRandomVariable> m_jitter;
+
+  /**
+   * \brief Trace of the RAs sent, with their delay from the time they were due.
+   */
+  TracedCallback<Ptr<const Packet>, Time> m_txRaTrace;
 };
 
 } /* namespace ns3 */
@@ -0,0 +1,259 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include "ns3/node.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/mac48-address.h"
+#include "ns3/ipv6.h"
+#include "ns3/ipv6-header.h"
+#include "ns3/icmpv6-header.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/unicast-radvd.h"
+#include "ns3/unicast-radvd-interface.h"
+
+#include <set>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * A RA sent by a UnicastRadvdTestDaemon.
+ */
+struct UnicastRadvdTestRa
+{
+  uint32_t id;       //!< the ID of the configuration
+  Time time;         //!< the time at which the RA was sent
+  Time delay;        //!< the delay reported by the TxRa trace
+  uint8_t hopLimit;  //!< the current hop limit advertised
+};
+
+/**
+ * A UnicastRadvd which records its RAs instead of sending them.
+ */
+class UnicastRadvdTestDaemon : public UnicastRadvd
+{
+public:
+  static TypeId GetTypeId (void);
+
+  std::vector<UnicastRadvdTestRa> m_sent; //!< the RAs sent
+
+  /**
+   * Record the delay of the last RA sent.
+   * \param p the RA
+   * \param delay its delay from the time it was due
+   */
+  void TxRa (Ptr<const Packet> p, Time delay);
+
+protected:
+  virtual void Send (Ptr<UnicastRadvdInterface> config, Ptr<Packet> p);
+  virtual bool IsAppStarted ();
+};
+
+TypeId
+UnicastRadvdTestDaemon::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::UnicastRadvdTestDaemon")
+    .SetParent<UnicastRadvd> ()
+    .AddConstructor<UnicastRadvdTestDaemon> ()
+    ;
+  return tid;
+}
+
+void
+UnicastRadvdTestDaemon::Send (Ptr<UnicastRadvdInterface> config, Ptr<Packet> p)
+{
+  Ipv6Header ipv6Header;
+  p->RemoveHeader (ipv6Header);
+  Icmpv6RA raHeader;
+  p->RemoveHeader (raHeader);
+
+  UnicastRadvdTestRa ra;
+  ra.id = config->GetId ();
+  ra.time = Simulator::Now ();
+  ra.hopLimit = raHeader.GetCurHopLimit ();
+  m_sent.push_back (ra);
+}
+
+void
+UnicastRadvdTestDaemon::TxRa (Ptr<const Packet> p, Time delay)
+{
+  m_sent.back ().delay = delay;
+}
+
+bool
+UnicastRadvdTestDaemon::IsAppStarted ()
+{
+  return true;
+}
+
+
+/**
+ * Check the batches of periodic RAs of UnicastRadvd.
+ *
+ * Three configurations, with an advertisement interval between 1000 and
+ * 1001 ms, are added 10 ms apart. At 2.5 s, the second one is removed
+ * and the hop limit of the third one is changed. The first RA of each
+ * configuration must be sent at once, and the next ones at multiples of
+ * the batch interval, at most one interval after they are due, as
+ * reported by the TxRa trace. No RA must be sent for the removed
+ * configuration, and the RAs of the third one must advertise the new
+ * hop limit.
+ */
+class UnicastRadvdBatchTestCase : public TestCase
+{
+public:
+  UnicastRadvdBatchTestCase (Time batchInterval);
+  virtual ~UnicastRadvdBatchTestCase ();
+
+private:
+  static std::string BuildNameString (Time batchInterval);
+  virtual void DoRun (void);
+
+  Time m_batchInterval;
+};
+
+std::string
+UnicastRadvdBatchTestCase::BuildNameString (Time batchInterval)
+{
+  std::ostringstream oss;
+  oss << "UnicastRadvd RAs with a batch interval of " << batchInterval.GetMilliSeconds () << " ms";
+  return oss.str ();
+}
+
+UnicastRadvdBatchTestCase::UnicastRadvdBatchTestCase (Time batchInterval)
+  : TestCase (BuildNameString (batchInterval)),
+    m_batchInterval (batchInterval)
+{
+}
+
+UnicastRadvdBatchTestCase::~UnicastRadvdBatchTestCase ()
+{
+}
+
+void
+UnicastRadvdBatchTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  device->SetAddress (Mac48Address::Allocate ());
+  node->AddDevice (device);
+  Ptr<Ipv6> ipv6 = node->GetObject<Ipv6> ();
+  uint32_t ifIndex = ipv6->AddInterface (device);
+  ipv6->SetUp (ifIndex);
+
+  Ptr<UnicastRadvdTestDaemon> radvd = CreateObject<UnicastRadvdTestDaemon> ();
+  radvd->SetAttribute ("BatchInterval", TimeValue (m_batchInterval));
+  radvd->AssignStreams (1);
+  radvd->TraceConnectWithoutContext ("TxRa", MakeCallback (&UnicastRadvdTestDaemon::TxRa, radvd));
+  node->AddApplication (radvd);
+
+  std::vector<Ptr<UnicastRadvdInterface> > configs;
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      configs.push_back (Create<UnicastRadvdInterface> (ifIndex, 1001, 1000));
+      Simulator::Schedule (MilliSeconds (10 * i), &UnicastRadvd::AddConfiguration, radvd, configs[i]);
+    }
+  Time change = Seconds (2.5);
+  Simulator::Schedule (change, static_cast<void (UnicastRadvd::*) (Ptr<UnicastRadvdInterface>)> (&UnicastRadvd::RemoveConfiguration),
+                       radvd, configs[1]);
+  Simulator::Schedule (change, &UnicastRadvdInterface::SetCurHopLimit, configs[2], 32);
+
+  Simulator::Stop (Seconds (6.0));
+  Simulator::Run ();
+
+  std::vector<UnicastRadvdTestRa> &sent = radvd->m_sent;
+  std::vector<uint32_t> count (3, 0);
+  std::vector<Time> last (3);
+  std::set<Time> batches;
+  uint32_t periodic = 0;
+  for (uint32_t j = 0; j < sent.size (); j++)
+    {
+      const UnicastRadvdTestRa &ra = sent[j];
+      uint32_t i = ra.id - configs[0]->GetId ();
+      NS_TEST_ASSERT_MSG_LT (i, 3, "unknown configuration");
+      if (j > 0)
+        {
+          NS_TEST_ASSERT_MSG_GT_OR_EQ (ra.time, sent[j - 1].time, "RA " << j << " sent out of order");
+        }
+      NS_TEST_ASSERT_MSG_GT_OR_EQ (ra.delay, Seconds (0), "RA " << j << " sent before it is due");
+      if (count[i] == 0)
+        {
+          NS_TEST_ASSERT_MSG_EQ (ra.time, MilliSeconds (10 * i), "the first RA should be sent at once");
+          NS_TEST_ASSERT_MSG_EQ (ra.delay, Seconds (0), "the first RA should be sent at once");
+        }
+      else
+        {
+          // the RA was due 1000 or 1001 ms after the previous one
+          Time gap = ra.time - ra.delay - last[i];
+          NS_TEST_ASSERT_MSG_GT_OR_EQ (gap, MilliSeconds (1000), "RA " << j << " due too early");
+          NS_TEST_ASSERT_MSG_LT_OR_EQ (gap, MilliSeconds (1001), "RA " << j << " due too late");
+          if (m_batchInterval.IsStrictlyPositive ())
+            {
+              NS_TEST_ASSERT_MSG_LT (ra.delay, m_batchInterval, "RA " << j << " sent more than one interval late");
+              NS_TEST_ASSERT_MSG_EQ (ra.time.GetTimeStep () % m_batchInterval.GetTimeStep (), 0,
+                                     "RA " << j << " not sent at a multiple of the batch interval");
+            }
+          else
+            {
+              NS_TEST_ASSERT_MSG_EQ (ra.delay, Seconds (0), "RA " << j << " should be sent when due");
+            }
+          batches.insert (ra.time);
+          periodic++;
+        }
+      if (i == 1)
+        {
+          NS_TEST_ASSERT_MSG_LT (ra.time, change, "RA sent for a removed configuration");
+        }
+      if (i == 2)
+        {
+          uint32_t hopLimit = (ra.time < change) ? 64 : 32;
+          NS_TEST_ASSERT_MSG_EQ ((uint32_t) ra.hopLimit, hopLimit, "RA " << j << " advertises a stale hop limit");
+        }
+      count[i]++;
+      last[i] = ra.time;
+    }
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (count[0], 5, "too few RAs for the first configuration");
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (count[1], 2, "too few RAs for the removed configuration");
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (count[2], 5, "too few RAs for the changed configuration");
+  if (m_batchInterval.IsStrictlyPositive ())
+    {
+      NS_TEST_ASSERT_MSG_LT (batches.size (), periodic, "the periodic RAs should share batches");
+    }
+
+  Simulator::Destroy ();
+}
+
+
+class UnicastRadvdTestSuite : public TestSuite
+{
+public:
+  UnicastRadvdTestSuite ();
+};
+
+UnicastRadvdTestSuite::UnicastRadvdTestSuite ()
+  : TestSuite ("unicast-radvd", UNIT)
+{
+  AddTestCase (new UnicastRadvdBatchTestCase (MilliSeconds (100)), TestCase::QUICK);
+  AddTestCase (new UnicastRadvdBatchTestCase (Seconds (0)), TestCase::QUICK);
+}
+
+static UnicastRadvdTestSuite unicastRadvdTestSuite;
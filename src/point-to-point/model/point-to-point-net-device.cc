@@ -25,6 +25,7 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/segmentation-offload.h"
 #include "point-to-point-net-device.h"
 #include "point-to-point-channel.h"
 #include "ppp-header.h"
@@ -213,6 +214,7 @@ PointToPointNetDevice::DoDispose ()
   m_channel = 0;
   m_receiveErrorModel = 0;
   m_currentPkt = 0;
+  m_segments.clear ();
   NetDevice::DoDispose ();
 }
 
@@ -279,7 +281,7 @@ PointToPointNetDevice::TransmitComplete (void)
   m_phyTxEndTrace (m_currentPkt);
   m_currentPkt = 0;
 
-  Ptr<Packet> p = m_queue->Dequeue ();
+  Ptr<Packet> p = DequeueFrame ();
   if (p == 0)
     {
       //
@@ -296,6 +298,49 @@ PointToPointNetDevice::TransmitComplete (void)
   TransmitStart (p);
 }
 
+Ptr<Packet>
+PointToPointNetDevice::DequeueFrame (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (!m_segments.empty ())
+    {
+      Ptr<Packet> p = m_segments.front ();
+      m_segments.pop_front ();
+      return p;
+    }
+
+  Ptr<Packet> p;
+  LargeSendTag largeSend;
+  while ((p = m_queue->Dequeue ()) != 0 && p->PeekPacketTag (largeSend))
+    {
+      //
+      // A large send: split it into segments, each of which gets its own
+      // header and takes the wire for its own transmission time.
+      //
+      Ptr<Packet> payload = p->Copy ();
+      uint16_t protocol = 0;
+      ProcessHeader (payload, protocol);
+      Ptr<SegmentationOffload> offload = m_node->GetObject<SegmentationOffload> ();
+      if (offload != 0 && offload->Segment (payload, protocol, m_mtu, m_segments))
+        {
+          for (std::list<Ptr<Packet> >::iterator it = m_segments.begin (); it != m_segments.end (); ++it)
+            {
+              AddHeader (*it, protocol);
+            }
+          p = m_segments.front ();
+          m_segments.pop_front ();
+          return p;
+        }
+      //
+      // It would go out above the MTU: drop it, and try the next packet.
+      //
+      NS_LOG_WARN ("Large send which cannot be split into segments, dropped");
+      m_macTxDropTrace (p);
+    }
+  return p;
+}
+
 bool
 PointToPointNetDevice::Attach (Ptr<PointToPointChannel> ch)
 {
@@ -541,7 +586,11 @@ PointToPointNetDevice::Send (
       // 
       if (m_txMachineState == READY)
         {
-          packet = m_queue->Dequeue ();
+          packet = DequeueFrame ();
+          if (packet == 0)
+            { // A large send which cannot be split, dropped
+              return false;
+            }
           m_snifferTrace (packet);
           m_promiscSnifferTrace (packet);
           return TransmitStart (packet);
@@ -603,6 +652,13 @@ PointToPointNetDevice::SupportsSendFrom (void) const
   return false;
 }
 
+bool
+PointToPointNetDevice::SupportsSegmentationOffload (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return true;
+}
+
 void
 PointToPointNetDevice::DoMpiReceive (Ptr<Packet> p)
 {
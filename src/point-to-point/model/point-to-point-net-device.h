@@ -20,6 +20,7 @@
 #define POINT_TO_POINT_NET_DEVICE_H
 
 #include <cstring>
+#include <list>
 #include "ns3/address.h"
 #include "ns3/node.h"
 #include "ns3/net-device.h"
@@ -194,6 +195,7 @@ public:
 
   virtual void SetPromiscReceiveCallback (PromiscReceiveCallback cb);
   virtual bool SupportsSendFrom (void) const;
+  virtual bool SupportsSegmentationOffload (void) const;
 
 protected:
   /**
@@ -280,6 +282,19 @@ private:
    */
   void TransmitComplete (void);
 
+  /**
+   * Get the Next Frame to Send Down the Wire.
+   *
+   * The frame is the next segment of the large send being transmitted if
+   * any, else the packet at the head of the queue. A large send taken from
+   * the queue is split into segments by the SegmentationOffload of the
+   * node, which are then transmitted one after the other. A large send
+   * which cannot be split is dropped, with the MacTxDrop trace.
+   *
+   * \returns the frame, or 0 if the queue is empty
+   */
+  Ptr<Packet> DequeueFrame (void);
+
   /**
    * \brief Make the link up and running
    *
@@ -462,6 +477,8 @@ private:
 
   Ptr<Packet> m_currentPkt; //!< Current packet processed
 
+  std::list<Ptr<Packet> > m_segments; //!< Segments of the large send being transmitted
+
   /**
    * \brief PPP to Ethernet protocol number mapping
    * \param protocol A PPP protocol number
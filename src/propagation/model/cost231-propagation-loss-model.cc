@@ -180,6 +180,28 @@ Cost231PropagationLossModel::DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel
   return txPowerDbm + GetLoss (a, b);
 }
 
+bool
+Cost231PropagationLossModel::DoCalcRxPowerBatch (const Vector &a,
+                                                 const std::vector<Vector> &b,
+                                                 const std::vector<double> &distances,
+                                                 std::vector<double> &powerDbm) const
+{
+  // Same formula as GetLoss, with the terms which do not depend on the
+  // distance computed once for all the destinations.
+  double frequency_MHz = m_frequency * 1e-6;
+  double C_H = 0.8 + ((1.11 * std::log10(frequency_MHz)) - 0.7) * m_SSAntennaHeight - (1.56 * std::log10(frequency_MHz));
+  double fixed = 46.3 + (33.9 * std::log10(frequency_MHz)) - (13.82 * std::log10 (m_BSAntennaHeight)) - C_H;
+  double slope = 44.9 - 6.55 * std::log10 (m_BSAntennaHeight);
+  uint32_t n = distances.size ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double distance = distances[i];
+      double loss_in_db = fixed + (slope * std::log10 (distance * 1e-3)) + m_shadowing;
+      powerDbm[i] -= (distance <= m_minDistance) ? 0 : loss_in_db;
+    }
+  return true;
+}
+
 int64_t
 Cost231PropagationLossModel::DoAssignStreams (int64_t stream)
 {
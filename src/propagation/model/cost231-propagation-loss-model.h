@@ -140,6 +140,10 @@ private:
 
   virtual double DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoCalcRxPowerBatch (const Vector &a,
+                                   const std::vector<Vector> &b,
+                                   const std::vector<double> &distances,
+                                   std::vector<double> &powerDbm) const;
   double m_BSAntennaHeight; //!< BS Antenna Height [m]
   double m_SSAntennaHeight; //!< SS Antenna Height [m]
   double m_lambda; //!< The wavelength
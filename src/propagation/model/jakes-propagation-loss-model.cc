@@ -20,6 +20,7 @@
 
 #include "jakes-propagation-loss-model.h"
 #include "ns3/double.h"
+#include "ns3/uinteger.h"
 #include "ns3/log.h"
 
 namespace ns3
@@ -46,6 +47,19 @@ JakesPropagationLossModel::GetTypeId ()
   static TypeId tid = TypeId ("ns3::JakesPropagationLossModel")
     .SetParent<PropagationLossModel> ()
     .AddConstructor<JakesPropagationLossModel> ()
+    .AddAttribute ("CacheSize",
+                   "The maximum number of paths whose fading process is kept: "
+                   "the least recently used path is dropped when the limit is reached. "
+                   "0 means no limit.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&JakesPropagationLossModel::SetCacheSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("CacheInvalidationDistance",
+                   "The distance (m) either endpoint of a path may move before the fading "
+                   "process of the path is drawn again. 0 means never.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&JakesPropagationLossModel::SetCacheInvalidationDistance),
+                   MakeDoubleChecker<double> (0))
   ;
   return tid;
 }
@@ -71,6 +85,18 @@ JakesPropagationLossModel::GetUniformRandomVariable () const
   return m_uniformVariable;
 }
 
+void
+JakesPropagationLossModel::SetCacheSize (uint32_t size)
+{
+  m_propagationCache.SetMaxSize (size);
+}
+
+void
+JakesPropagationLossModel::SetCacheInvalidationDistance (double distance)
+{
+  m_propagationCache.SetInvalidationDistance (distance);
+}
+
 int64_t
 JakesPropagationLossModel::DoAssignStreams (int64_t stream)
 {
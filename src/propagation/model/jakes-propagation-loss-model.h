@@ -71,6 +71,16 @@ private:
    */
   Ptr<UniformRandomVariable> GetUniformRandomVariable () const;
 
+  /**
+   * \param size the maximum number of paths held by the cache, 0 for no limit
+   */
+  void SetCacheSize (uint32_t size);
+  /**
+   * \param distance the distance (m) an endpoint may move before the
+   *        fading process of its paths is drawn again, 0 to never do it
+   */
+  void SetCacheInvalidationDistance (double distance);
+
   Ptr<UniformRandomVariable> m_uniformVariable; //!< random stream
   mutable PropagationCache<JakesProcess> m_propagationCache; //!< Propagation cache
 };
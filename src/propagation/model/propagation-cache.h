@@ -21,7 +21,9 @@
 #define PROPAGATION_CACHE_H_
 
 #include "ns3/mobility-model.h"
-#include <map>
+#include "ns3/sgi-hashmap.h"
+#include <algorithm>
+#include <list>
 
 namespace ns3
 {
@@ -30,12 +32,23 @@ namespace ns3
  * \brief Constructs a cache of objects, where each object is responsible for a single propagation path loss calculations.
  * Propagation path a-->b and b-->a is the same thing. Propagation path is identified by
  * a couple of MobilityModels and a spectrum model UID
+ *
+ * The paths are stored in a hash table. The memory used by the cache
+ * can be bounded with SetMaxSize, in which case the least recently used
+ * path is evicted when a new one is added to a full cache. The data of
+ * a path can also be invalidated once either of its endpoints has moved
+ * by more than the distance set with SetInvalidationDistance since the
+ * data was added: GetPathData then returns 0 as if the path had never
+ * been added, so that the caller computes new data for it.
  */
 template<class T>
 class PropagationCache
 {
 public:
-  PropagationCache () {};
+  PropagationCache ()
+    : m_maxSize (0),
+      m_invalidationDistance (0)
+  {};
   ~PropagationCache () {};
 
   /**
@@ -53,7 +66,15 @@ public:
       {
         return 0;
       }
-    return it->second;
+    if (m_invalidationDistance > 0 && HasMoved (it->first, it->second))
+      {
+        m_lru.erase (it->second.m_lruPosition);
+        m_pathCache.erase (it);
+        return 0;
+      }
+    // move the path to the head of the LRU list
+    m_lru.splice (m_lru.begin (), m_lru, it->second.m_lruPosition);
+    return it->second.m_data;
   };
 
   /**
@@ -67,7 +88,60 @@ public:
   {
     PropagationPathIdentifier key = PropagationPathIdentifier (a, b, modelUid);
     NS_ASSERT (m_pathCache.find (key) == m_pathCache.end ());
-    m_pathCache.insert (std::make_pair (key, data)); 
+    if (m_maxSize > 0 && m_pathCache.size () >= m_maxSize)
+      {
+        // evict the least recently used path
+        m_pathCache.erase (m_lru.back ());
+        m_lru.pop_back ();
+      }
+    m_lru.push_front (key);
+    PathData pathData;
+    pathData.m_data = data;
+    pathData.m_lruPosition = m_lru.begin ();
+    pathData.m_firstPosition = key.m_first->GetPosition ();
+    pathData.m_secondPosition = key.m_second->GetPosition ();
+    m_pathCache.insert (std::make_pair (key, pathData));
+  };
+
+  /**
+   * Set the maximum number of paths held by the cache.
+   * \param maxSize the maximum number of paths, or 0 for no limit
+   */
+  void SetMaxSize (uint32_t maxSize)
+  {
+    m_maxSize = maxSize;
+    while (m_maxSize > 0 && m_pathCache.size () > m_maxSize)
+      {
+        m_pathCache.erase (m_lru.back ());
+        m_lru.pop_back ();
+      }
+  };
+
+  /**
+   * Set the distance an endpoint of a path may move before the data of
+   * the path is invalidated.
+   * \param distance the distance (m), or 0 to never invalidate the paths
+   */
+  void SetInvalidationDistance (double distance)
+  {
+    m_invalidationDistance = distance;
+  };
+
+  /**
+   * \return the number of paths in the cache
+   */
+  uint32_t GetSize (void) const
+  {
+    return m_pathCache.size ();
+  };
+
+  /**
+   * Remove all the paths from the cache.
+   */
+  void Clear (void)
+  {
+    m_pathCache.clear ();
+    m_lru.clear ();
   };
 private:
   /// Each path is identified by
@@ -75,39 +149,72 @@ private:
   {
     /**
      * Constructor
+     * Links are supposed to be symmetrical: the mobility models are
+     * stored in a canonical order so that a-->b and b-->a are the same key.
      * @param a 1st node mobility model
      * @param b 2nd node mobility model
      * @param modelUid model UID
      */
     PropagationPathIdentifier (Ptr<const MobilityModel> a, Ptr<const MobilityModel> b, uint32_t modelUid) :
-      m_srcMobility (a), m_dstMobility (b), m_spectrumModelUid (modelUid)
+      m_first (std::min (a, b)), m_second (std::max (a, b)), m_spectrumModelUid (modelUid)
     {};
-    Ptr<const MobilityModel> m_srcMobility; //!< 1st node mobility model
-    Ptr<const MobilityModel> m_dstMobility; //!< 2nd node mobility model
+    Ptr<const MobilityModel> m_first; //!< the node mobility model with the lowest address
+    Ptr<const MobilityModel> m_second; //!< the node mobility model with the highest address
     uint32_t m_spectrumModelUid; //!< model UID
-    bool operator < (const PropagationPathIdentifier & other) const
+    bool operator == (const PropagationPathIdentifier & other) const
+    {
+      return m_spectrumModelUid == other.m_spectrumModelUid
+             && m_first == other.m_first
+             && m_second == other.m_second;
+    }
+  };
+
+  /// Hash function of the path identifiers
+  struct PropagationPathIdentifierHash
+  {
+    /**
+     * \param key the path identifier
+     * \return the hash of the path identifier
+     */
+    size_t operator () (const PropagationPathIdentifier & key) const
     {
-      if (m_spectrumModelUid != other.m_spectrumModelUid)
-        {
-          return m_spectrumModelUid < other.m_spectrumModelUid;
-        }
-      /// Links are supposed to be symmetrical!
-      if (std::min (m_dstMobility, m_srcMobility) != std::min (other.m_dstMobility, other.m_srcMobility))
-        {
-          return std::min (m_dstMobility, m_srcMobility) < std::min (other.m_dstMobility, other.m_srcMobility);
-        }
-      if (std::max (m_dstMobility, m_srcMobility) != std::max (other.m_dstMobility, other.m_srcMobility))
-        {
-          return std::max (m_dstMobility, m_srcMobility) < std::max (other.m_dstMobility, other.m_srcMobility);
-        }
-      return false;
+      size_t h = reinterpret_cast<size_t> (PeekPointer (key.m_first));
+      h = h * 31 + reinterpret_cast<size_t> (PeekPointer (key.m_second));
+      h = h * 31 + key.m_spectrumModelUid;
+      return h ^ (h >> 16);
     }
   };
 
-  /// Typedef: PropagationPathIdentifier, Ptr<T>
-  typedef std::map<PropagationPathIdentifier, Ptr<T> > PathCache;
+  /// Typedef: list of paths, most recently used first
+  typedef std::list<PropagationPathIdentifier> LruList;
+
+  /// The data stored for each path
+  struct PathData
+  {
+    Ptr<T> m_data; //!< the data of the path
+    typename LruList::iterator m_lruPosition; //!< position of the path in the LRU list
+    Vector m_firstPosition; //!< position of the 1st endpoint when the data was added
+    Vector m_secondPosition; //!< position of the 2nd endpoint when the data was added
+  };
+
+  /**
+   * \param key the path identifier
+   * \param pathData the data of the path
+   * \return true if either endpoint moved by more than the invalidation distance
+   */
+  bool HasMoved (const PropagationPathIdentifier & key, const PathData & pathData) const
+  {
+    return CalculateDistance (key.m_first->GetPosition (), pathData.m_firstPosition) > m_invalidationDistance
+           || CalculateDistance (key.m_second->GetPosition (), pathData.m_secondPosition) > m_invalidationDistance;
+  };
+
+  /// Typedef: PropagationPathIdentifier, PathData
+  typedef sgi::hash_map<PropagationPathIdentifier, PathData, PropagationPathIdentifierHash> PathCache;
 private:
   PathCache m_pathCache; //!< Path cache
+  LruList m_lru; //!< paths, most recently used first
+  uint32_t m_maxSize; //!< maximum number of paths, 0 for no limit
+  double m_invalidationDistance; //!< distance (m) beyond which an endpoint move invalidates its paths
 };
 } // namespace ns3
 
@@ -29,6 +29,8 @@
 #include "ns3/string.h"
 #include "ns3/pointer.h"
 #include <cmath>
+#include <limits>
+#include <algorithm>
 
 namespace ns3 {
 
@@ -81,6 +83,47 @@ PropagationLossModel::CalcRxPower (double txPowerDbm,
   return self;
 }
 
+void
+PropagationLossModel::CalcRxPowerBatch (double txPowerDbm,
+                                        Ptr<MobilityModel> a,
+                                        const std::vector<Ptr<MobilityModel> > &b,
+                                        std::vector<double> &rxPowerDbm) const
+{
+  uint32_t n = b.size ();
+  rxPowerDbm.assign (n, txPowerDbm);
+  if (n == 0)
+    {
+      return;
+    }
+  Vector position = a->GetPosition ();
+  m_batchPositions.resize (n);
+  m_batchDistances.resize (n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      m_batchPositions[i] = b[i]->GetPosition ();
+      m_batchDistances[i] = CalculateDistance (position, m_batchPositions[i]);
+    }
+
+  // Apply the models of the chain one after the other to all the
+  // destinations as long as they support it. Once a model does not,
+  // the rest of the chain is evaluated destination by destination so
+  // that random models draw their values in the same order as with
+  // CalcRxPower.
+  const PropagationLossModel *model = this;
+  while (model != 0
+         && model->DoCalcRxPowerBatch (position, m_batchPositions, m_batchDistances, rxPowerDbm))
+    {
+      model = PeekPointer (model->m_next);
+    }
+  if (model != 0)
+    {
+      for (uint32_t i = 0; i < n; i++)
+        {
+          rxPowerDbm[i] = model->CalcRxPower (rxPowerDbm[i], a, b[i]);
+        }
+    }
+}
+
 int64_t
 PropagationLossModel::AssignStreams (int64_t stream)
 {
@@ -93,6 +136,38 @@ PropagationLossModel::AssignStreams (int64_t stream)
   return (currentStream - stream);
 }
 
+double
+PropagationLossModel::GetMaxRange (double txPowerDbm, double rxThresholdDbm) const
+{
+  double range = DoGetMaxRange (txPowerDbm, rxThresholdDbm);
+  if (m_next != 0)
+    {
+      double nextRange = m_next->GetMaxRange (txPowerDbm, rxThresholdDbm);
+      if (range == std::numeric_limits<double>::infinity ()
+          || nextRange == std::numeric_limits<double>::infinity ())
+        {
+          return std::numeric_limits<double>::infinity ();
+        }
+      range = std::min (range, nextRange);
+    }
+  return range;
+}
+
+double
+PropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxThresholdDbm) const
+{
+  return std::numeric_limits<double>::infinity ();
+}
+
+bool
+PropagationLossModel::DoCalcRxPowerBatch (const Vector &a,
+                                          const std::vector<Vector> &b,
+                                          const std::vector<double> &distances,
+                                          std::vector<double> &powerDbm) const
+{
+  return false;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (RandomPropagationLossModel);
@@ -274,6 +349,43 @@ FriisPropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+FriisPropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxThresholdDbm) const
+{
+  if (m_minLoss < 0 || m_systemLoss < 1)
+    {
+      // the model may yield a gain
+      return std::numeric_limits<double>::infinity ();
+    }
+  double minLossDb = txPowerDbm - rxThresholdDbm;
+  if (m_minLoss >= minLossDb)
+    {
+      return 0;
+    }
+  // invert lossDb = 20 log10 (4 * pi * d * sqrt (L) / lambda)
+  return m_lambda / (4 * M_PI * std::sqrt (m_systemLoss)) * std::pow (10.0, minLossDb / 20);
+}
+
+bool
+FriisPropagationLossModel::DoCalcRxPowerBatch (const Vector &a,
+                                               const std::vector<Vector> &b,
+                                               const std::vector<double> &distances,
+                                               std::vector<double> &powerDbm) const
+{
+  // Same formula as DoCalcRxPower, written as a branch-free loop over
+  // contiguous arrays so that the compiler can vectorize it.
+  double numerator = m_lambda * m_lambda;
+  uint32_t n = distances.size ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double distance = distances[i];
+      double denominator = 16 * M_PI * M_PI * distance * distance * m_systemLoss;
+      double lossDb = -10 * std::log10 (numerator / denominator);
+      powerDbm[i] -= (distance <= 0) ? m_minLoss : std::max (lossDb, m_minLoss);
+    }
+  return true;
+}
+
 // ------------------------------------------------------------------------- //
 // -- Two-Ray Ground Model ported from NS-2 -- tomhewer@mac.com -- Nov09 //
 
@@ -447,6 +559,54 @@ TwoRayGroundPropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+TwoRayGroundPropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxThresholdDbm) const
+{
+  if (m_systemLoss < 1)
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  double minLossDb = txPowerDbm - rxThresholdDbm;
+  if (minLossDb < 0)
+    {
+      return 0;
+    }
+  // Beyond the crossover distance the two-ray loss is larger than the
+  // Friis loss, so the Friis range bounds both regions whatever the
+  // antenna heights.
+  double friisRange = m_lambda / (4 * M_PI * std::sqrt (m_systemLoss)) * std::pow (10.0, minLossDb / 20);
+  return std::max (m_minDistance, friisRange);
+}
+
+bool
+TwoRayGroundPropagationLossModel::DoCalcRxPowerBatch (const Vector &a,
+                                                      const std::vector<Vector> &b,
+                                                      const std::vector<double> &distances,
+                                                      std::vector<double> &powerDbm) const
+{
+  // Same formulas as DoCalcRxPower: both the Friis and the two-ray
+  // gains are computed for every destination and the right one is
+  // selected, which keeps the loop free of branches.
+  double numerator = m_lambda * m_lambda;
+  double txAntHeight = a.z + m_heightAboveZ;
+  uint32_t n = distances.size ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double distance = distances[i];
+      double rxAntHeight = b[i].z + m_heightAboveZ;
+      double dCross = (4 * M_PI * txAntHeight * rxAntHeight) / m_lambda;
+      double tmp = M_PI * distance;
+      double pr = 10 * std::log10 (numerator / (16 * tmp * tmp * m_systemLoss));
+      tmp = txAntHeight * rxAntHeight;
+      double rayNumerator = tmp * tmp;
+      tmp = distance * distance;
+      double rayPr = 10 * std::log10 (rayNumerator / (tmp * tmp * m_systemLoss));
+      double gain = (distance <= dCross) ? pr : rayPr;
+      powerDbm[i] += (distance <= m_minDistance) ? 0 : gain;
+    }
+  return true;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (LogDistancePropagationLossModel);
@@ -535,6 +695,42 @@ LogDistancePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+LogDistancePropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxThresholdDbm) const
+{
+  if (m_referenceLoss < 0 || m_exponent <= 0)
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  double minLossDb = txPowerDbm - rxThresholdDbm;
+  if (minLossDb < 0)
+    {
+      return 0;
+    }
+  if (minLossDb <= m_referenceLoss)
+    {
+      return m_referenceDistance;
+    }
+  return m_referenceDistance * std::pow (10.0, (minLossDb - m_referenceLoss) / (10 * m_exponent));
+}
+
+bool
+LogDistancePropagationLossModel::DoCalcRxPowerBatch (const Vector &a,
+                                                     const std::vector<Vector> &b,
+                                                     const std::vector<double> &distances,
+                                                     std::vector<double> &powerDbm) const
+{
+  uint32_t n = distances.size ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double distance = distances[i];
+      double pathLossDb = 10 * m_exponent * std::log10 (distance / m_referenceDistance);
+      double rxc = -m_referenceLoss - pathLossDb;
+      powerDbm[i] += (distance <= m_referenceDistance) ? 0 : rxc;
+    }
+  return true;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (ThreeLogDistancePropagationLossModel);
@@ -636,6 +832,79 @@ ThreeLogDistancePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+ThreeLogDistancePropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxThresholdDbm) const
+{
+  if (m_referenceLoss < 0 || m_exponent0 < 0 || m_exponent1 < 0 || m_exponent2 <= 0)
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  double minLossDb = txPowerDbm - rxThresholdDbm;
+  if (minLossDb < 0)
+    {
+      return 0;
+    }
+  if (minLossDb < m_referenceLoss)
+    {
+      return m_distance0;
+    }
+  // path loss at the beginning of the middle and far fields
+  double loss1 = m_referenceLoss + 10 * m_exponent0 * std::log10 (m_distance1 / m_distance0);
+  double loss2 = loss1 + 10 * m_exponent1 * std::log10 (m_distance2 / m_distance1);
+  if (minLossDb < loss1)
+    {
+      return m_distance0 * std::pow (10.0, (minLossDb - m_referenceLoss) / (10 * m_exponent0));
+    }
+  if (minLossDb < loss2)
+    {
+      return m_distance1 * std::pow (10.0, (minLossDb - loss1) / (10 * m_exponent1));
+    }
+  return m_distance2 * std::pow (10.0, (minLossDb - loss2) / (10 * m_exponent2));
+}
+
+bool
+ThreeLogDistancePropagationLossModel::DoCalcRxPowerBatch (const Vector &a,
+                                                          const std::vector<Vector> &b,
+                                                          const std::vector<double> &distances,
+                                                          std::vector<double> &powerDbm) const
+{
+  // The loss at the start of each field only depends on the attributes:
+  // compute it once, then a single logarithm per destination is needed.
+  double loss1 = m_referenceLoss
+    + 10 * m_exponent0 * std::log10 (m_distance1 / m_distance0);
+  double loss2 = loss1
+    + 10 * m_exponent1 * std::log10 (m_distance2 / m_distance1);
+  uint32_t n = distances.size ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double distance = distances[i];
+      double base;
+      double exponent;
+      double reference;
+      if (distance < m_distance1)
+        {
+          base = m_referenceLoss;
+          exponent = m_exponent0;
+          reference = m_distance0;
+        }
+      else if (distance < m_distance2)
+        {
+          base = loss1;
+          exponent = m_exponent1;
+          reference = m_distance1;
+        }
+      else
+        {
+          base = loss2;
+          exponent = m_exponent2;
+          reference = m_distance2;
+        }
+      double pathLossDb = base + 10 * exponent * std::log10 (distance / reference);
+      powerDbm[i] -= (distance < m_distance0) ? 0 : pathLossDb;
+    }
+  return true;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (NakagamiPropagationLossModel);
@@ -920,6 +1189,20 @@ RangePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+RangePropagationLossModel::DoGetMaxRange (double txPowerDbm, double rxThresholdDbm) const
+{
+  if (rxThresholdDbm <= -1000)
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  if (txPowerDbm < rxThresholdDbm)
+    {
+      return 0;
+    }
+  return m_range;
+}
+
 // ------------------------------------------------------------------------- //
 
 } // namespace ns3
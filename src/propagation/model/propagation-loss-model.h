@@ -27,7 +27,9 @@
 
 #include "ns3/object.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/vector.h"
 #include <map>
+#include <vector>
 
 namespace ns3 {
 
@@ -93,6 +95,25 @@ public:
                       Ptr<MobilityModel> a,
                       Ptr<MobilityModel> b) const;
 
+  /**
+   * Returns the Rx Power at many destinations of the same transmission,
+   * taking into account all the PropagationLossModel(s) chained to the
+   * current one. The result is the same as calling CalcRxPower for each
+   * destination in turn, but the models whose loss only depends on the
+   * positions evaluate all the destinations in a single pass over
+   * contiguous arrays, and the positions are only fetched once.
+   *
+   * \param txPowerDbm current transmission power (in dBm)
+   * \param a the mobility model of the source
+   * \param b the mobility models of the destinations
+   * \param rxPowerDbm filled with the reception power (in dBm) at each
+   *        destination, in the order of b
+   */
+  void CalcRxPowerBatch (double txPowerDbm,
+                         Ptr<MobilityModel> a,
+                         const std::vector<Ptr<MobilityModel> > &b,
+                         std::vector<double> &rxPowerDbm) const;
+
   /**
    * If this loss model uses objects of type RandomVariableStream,
    * set the stream numbers to the integers starting with the offset
@@ -106,6 +127,24 @@ public:
    */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * Returns a distance beyond which the Rx power computed by this
+   * PropagationLossModel and all the ones chained to it is guaranteed
+   * to be lower than the given threshold. This allows channels to skip
+   * receivers which are too far away to ever detect a transmission.
+   *
+   * A chain can only be bounded if every model in it can: the range of
+   * the chain is then the shortest range of its models. Models which
+   * cannot provide such a bound (e.g., random or fading models, which
+   * may yield a gain) make the range of the whole chain infinite.
+   *
+   * \param txPowerDbm current transmission power (in dBm)
+   * \param rxThresholdDbm the Rx power (in dBm) under which a receiver
+   *        can ignore the signal
+   * \returns the range (m), or infinity if it cannot be bounded
+   */
+  double GetMaxRange (double txPowerDbm, double rxThresholdDbm) const;
+
 private:
   /**
    * \brief Copy constructor
@@ -140,7 +179,41 @@ private:
    */
   virtual int64_t DoAssignStreams (int64_t stream) = 0;
 
+  /**
+   * Returns a distance beyond which the Rx power computed by this
+   * particular PropagationLossModel is lower than the given threshold.
+   * Subclasses returning a finite range must never yield a gain, so
+   * that the range of a chain is the shortest range of its models.
+   * The default implementation cannot bound the range.
+   *
+   * \param txPowerDbm current transmission power (in dBm)
+   * \param rxThresholdDbm the Rx power threshold (in dBm)
+   * \returns the range (m), or infinity if it cannot be bounded
+   */
+  virtual double DoGetMaxRange (double txPowerDbm, double rxThresholdDbm) const;
+
+  /**
+   * Applies the loss of this particular PropagationLossModel to many
+   * destinations at once. Only the models whose loss is a deterministic
+   * function of the positions can implement it; the default
+   * implementation returns false, and CalcRxPowerBatch then evaluates
+   * this model and the ones chained to it for each destination in turn.
+   *
+   * \param a the position of the source
+   * \param b the positions of the destinations
+   * \param distances the distance between the source and each destination
+   * \param powerDbm the power (in dBm) of each destination, to which the
+   *        loss is applied in place
+   * \returns true if the loss was applied, false otherwise
+   */
+  virtual bool DoCalcRxPowerBatch (const Vector &a,
+                                   const std::vector<Vector> &b,
+                                   const std::vector<double> &distances,
+                                   std::vector<double> &powerDbm) const;
+
   Ptr<PropagationLossModel> m_next; //!< Next propagation loss model in the list
+  mutable std::vector<Vector> m_batchPositions; //!< scratch destination positions
+  mutable std::vector<double> m_batchDistances; //!< scratch destination distances
 };
 
 /**
@@ -322,6 +395,11 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRange (double txPowerDbm, double rxThresholdDbm) const;
+  virtual bool DoCalcRxPowerBatch (const Vector &a,
+                                   const std::vector<Vector> &b,
+                                   const std::vector<double> &distances,
+                                   std::vector<double> &powerDbm) const;
 
   /**
    * Transforms a Dbm value to Watt
@@ -442,6 +520,11 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRange (double txPowerDbm, double rxThresholdDbm) const;
+  virtual bool DoCalcRxPowerBatch (const Vector &a,
+                                   const std::vector<Vector> &b,
+                                   const std::vector<double> &distances,
+                                   std::vector<double> &powerDbm) const;
 
   /**
    * Transforms a Dbm value to Watt
@@ -530,6 +613,11 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRange (double txPowerDbm, double rxThresholdDbm) const;
+  virtual bool DoCalcRxPowerBatch (const Vector &a,
+                                   const std::vector<Vector> &b,
+                                   const std::vector<double> &distances,
+                                   std::vector<double> &powerDbm) const;
 
   /**
    *  Creates a default reference loss model
@@ -613,6 +701,11 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRange (double txPowerDbm, double rxThresholdDbm) const;
+  virtual bool DoCalcRxPowerBatch (const Vector &a,
+                                   const std::vector<Vector> &b,
+                                   const std::vector<double> &distances,
+                                   std::vector<double> &powerDbm) const;
 
   double m_distance0; //!< Beginning of the first (near) distance field
   double m_distance1; //!< Beginning of the second (middle) distance field.
@@ -845,6 +938,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetMaxRange (double txPowerDbm, double rxThresholdDbm) const;
 private:
   double m_range; //!< Maximum Transmission Range (meters)
 };
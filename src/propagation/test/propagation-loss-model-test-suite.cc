@@ -22,9 +22,14 @@
 #include "ns3/config.h"
 #include "ns3/double.h"
 #include "ns3/propagation-loss-model.h"
+#include "ns3/cost231-propagation-loss-model.h"
+#include "ns3/propagation-cache.h"
 #include "ns3/constant-position-mobility-model.h"
 #include "ns3/simulator.h"
 
+#include <limits>
+#include <vector>
+
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE ("PropagationLossModelsTest");
@@ -436,6 +441,213 @@ RangePropagationLossModelTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class MaxRangePropagationLossModelTestCase : public TestCase
+{
+public:
+  MaxRangePropagationLossModelTestCase ();
+  virtual ~MaxRangePropagationLossModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check that the rx power is above the threshold just inside the range
+   * returned by GetMaxRange, and below it just beyond that range.
+   */
+  void CheckMaxRange (Ptr<PropagationLossModel> lossModel, std::string name);
+};
+
+MaxRangePropagationLossModelTestCase::MaxRangePropagationLossModelTestCase ()
+  : TestCase ("Test PropagationLossModel::GetMaxRange")
+{
+}
+
+MaxRangePropagationLossModelTestCase::~MaxRangePropagationLossModelTestCase ()
+{
+}
+
+void
+MaxRangePropagationLossModelTestCase::CheckMaxRange (Ptr<PropagationLossModel> lossModel, std::string name)
+{
+  double txPowerDbm = 16.0206;
+  double thresholdDbm = -96.0;
+  double range = lossModel->GetMaxRange (txPowerDbm, thresholdDbm);
+  NS_TEST_ASSERT_MSG_GT (range, 1.0, name << ": unexpected range");
+  NS_TEST_ASSERT_MSG_LT (range, 1e6, name << ": unexpected range");
+
+  Ptr<MobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  a->SetPosition (Vector (0, 0, 1.5));
+  Ptr<MobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+  b->SetPosition (Vector (range * 1.001, 0, 1.5));
+  NS_TEST_EXPECT_MSG_LT (lossModel->CalcRxPower (txPowerDbm, a, b), thresholdDbm,
+                         name << ": receiver beyond the range is above the threshold");
+  if (dynamic_cast<TwoRayGroundPropagationLossModel *> (PeekPointer (lossModel)) == 0)
+    {
+      // the two-ray range is only an upper bound beyond the crossover distance
+      b->SetPosition (Vector (range * 0.999, 0, 1.5));
+      NS_TEST_EXPECT_MSG_GT (lossModel->CalcRxPower (txPowerDbm, a, b), thresholdDbm,
+                             name << ": receiver within the range is below the threshold");
+    }
+}
+
+void
+MaxRangePropagationLossModelTestCase::DoRun (void)
+{
+  CheckMaxRange (CreateObject<FriisPropagationLossModel> (), "Friis");
+  CheckMaxRange (CreateObject<TwoRayGroundPropagationLossModel> (), "TwoRayGround");
+  CheckMaxRange (CreateObject<LogDistancePropagationLossModel> (), "LogDistance");
+  CheckMaxRange (CreateObject<ThreeLogDistancePropagationLossModel> (), "ThreeLogDistance");
+
+  // a chain is bounded by its shortest model
+  Ptr<LogDistancePropagationLossModel> logDistance = CreateObject<LogDistancePropagationLossModel> ();
+  Ptr<FriisPropagationLossModel> friis = CreateObject<FriisPropagationLossModel> ();
+  logDistance->SetNext (friis);
+  NS_TEST_EXPECT_MSG_LT (logDistance->GetMaxRange (16.0206, -96.0),
+                         friis->GetMaxRange (16.0206, -96.0), "Unexpected chain range");
+
+  // a fading model in the chain cannot be bounded
+  friis->SetNext (CreateObject<NakagamiPropagationLossModel> ());
+  NS_TEST_EXPECT_MSG_EQ (logDistance->GetMaxRange (16.0206, -96.0),
+                         std::numeric_limits<double>::infinity (), "Chain with a fading model should not be bounded");
+  Simulator::Destroy ();
+}
+
+class BatchPropagationLossModelTestCase : public TestCase
+{
+public:
+  BatchPropagationLossModelTestCase ();
+  virtual ~BatchPropagationLossModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check that CalcRxPowerBatch yields the same powers as CalcRxPower
+   * for receivers spread over all the regions of the models.
+   */
+  void CheckBatch (Ptr<PropagationLossModel> batchModel, Ptr<PropagationLossModel> refModel, std::string name);
+};
+
+BatchPropagationLossModelTestCase::BatchPropagationLossModelTestCase ()
+  : TestCase ("Test PropagationLossModel::CalcRxPowerBatch")
+{
+}
+
+BatchPropagationLossModelTestCase::~BatchPropagationLossModelTestCase ()
+{
+}
+
+void
+BatchPropagationLossModelTestCase::CheckBatch (Ptr<PropagationLossModel> batchModel, Ptr<PropagationLossModel> refModel, std::string name)
+{
+  double txPowerDbm = 16.0206;
+  Ptr<MobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  a->SetPosition (Vector (0, 0, 1.5));
+  std::vector<Ptr<MobilityModel> > b;
+  // includes a receiver at the same position as the sender
+  for (double x = 0; x < 2000; x = x * 1.3 + 0.5)
+    {
+      Ptr<MobilityModel> m = CreateObject<ConstantPositionMobilityModel> ();
+      m->SetPosition (Vector (x, x / 2, 1 + x / 100));
+      b.push_back (m);
+    }
+  std::vector<double> rxPowerDbm;
+  batchModel->CalcRxPowerBatch (txPowerDbm, a, b, rxPowerDbm);
+  NS_TEST_ASSERT_MSG_EQ (rxPowerDbm.size (), b.size (), name << ": unexpected number of powers");
+  for (uint32_t i = 0; i < b.size (); i++)
+    {
+      double expectedDbm = refModel->CalcRxPower (txPowerDbm, a, b[i]);
+      NS_TEST_EXPECT_MSG_EQ_TOL (rxPowerDbm[i], expectedDbm, 1e-9,
+                                 name << ": batch power differs for receiver " << i);
+    }
+}
+
+void
+BatchPropagationLossModelTestCase::DoRun (void)
+{
+  CheckBatch (CreateObject<FriisPropagationLossModel> (), CreateObject<FriisPropagationLossModel> (), "Friis");
+  CheckBatch (CreateObject<TwoRayGroundPropagationLossModel> (), CreateObject<TwoRayGroundPropagationLossModel> (), "TwoRayGround");
+  CheckBatch (CreateObject<LogDistancePropagationLossModel> (), CreateObject<LogDistancePropagationLossModel> (), "LogDistance");
+  CheckBatch (CreateObject<ThreeLogDistancePropagationLossModel> (), CreateObject<ThreeLogDistancePropagationLossModel> (), "ThreeLogDistance");
+  CheckBatch (CreateObject<Cost231PropagationLossModel> (), CreateObject<Cost231PropagationLossModel> (), "Cost231");
+  // a model without batch support
+  Ptr<MatrixPropagationLossModel> matrix = CreateObject<MatrixPropagationLossModel> ();
+  matrix->SetDefaultLoss (10);
+  CheckBatch (matrix, matrix, "Matrix");
+
+  // a chain ending with a random model draws its values in the same order
+  Ptr<PropagationLossModel> chains[2];
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      chains[i] = CreateObject<LogDistancePropagationLossModel> ();
+      Ptr<PropagationLossModel> friis = CreateObject<FriisPropagationLossModel> ();
+      chains[i]->SetNext (friis);
+      friis->SetNext (CreateObject<NakagamiPropagationLossModel> ());
+      chains[i]->AssignStreams (1);
+    }
+  CheckBatch (chains[0], chains[1], "LogDistance+Friis+Nakagami");
+  Simulator::Destroy ();
+}
+
+class PropagationCacheTestCase : public TestCase
+{
+public:
+  PropagationCacheTestCase ();
+  virtual ~PropagationCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /// Data stored in the cache under test
+  class PathData : public SimpleRefCount<PathData>
+  {
+  };
+};
+
+PropagationCacheTestCase::PropagationCacheTestCase ()
+  : TestCase ("Test PropagationCache eviction and invalidation")
+{
+}
+
+PropagationCacheTestCase::~PropagationCacheTestCase ()
+{
+}
+
+void
+PropagationCacheTestCase::DoRun (void)
+{
+  Ptr<MobilityModel> m[4];
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      m[i] = CreateObject<ConstantPositionMobilityModel> ();
+      m[i]->SetPosition (Vector (100 * i, 0, 0));
+    }
+  Ptr<PathData> d01 = Create<PathData> ();
+  Ptr<PathData> d02 = Create<PathData> ();
+  Ptr<PathData> d03 = Create<PathData> ();
+
+  PropagationCache<PathData> cache;
+  cache.AddPathData (d01, m[0], m[1], 0);
+  NS_TEST_ASSERT_MSG_EQ (cache.GetPathData (m[1], m[0], 0), d01, "Paths should be symmetrical");
+  NS_TEST_ASSERT_MSG_EQ (cache.GetPathData (m[0], m[1], 1), 0, "Paths of another model uid should be distinct");
+
+  // the least recently used path is evicted
+  cache.SetMaxSize (2);
+  cache.AddPathData (d02, m[0], m[2], 0);
+  NS_TEST_ASSERT_MSG_EQ (cache.GetPathData (m[0], m[1], 0), d01, "Path 0-1 should be cached");
+  cache.AddPathData (d03, m[0], m[3], 0);
+  NS_TEST_ASSERT_MSG_EQ (cache.GetSize (), 2, "The cache should be bounded");
+  NS_TEST_ASSERT_MSG_EQ (cache.GetPathData (m[0], m[2], 0), 0, "Path 0-2 should have been evicted");
+  NS_TEST_ASSERT_MSG_EQ (cache.GetPathData (m[0], m[1], 0), d01, "Path 0-1 should be cached");
+  NS_TEST_ASSERT_MSG_EQ (cache.GetPathData (m[0], m[3], 0), d03, "Path 0-3 should be cached");
+
+  // a path is invalidated once an endpoint moved too far
+  cache.SetInvalidationDistance (10);
+  m[1]->SetPosition (Vector (105, 0, 0));
+  NS_TEST_ASSERT_MSG_EQ (cache.GetPathData (m[0], m[1], 0), d01, "Path 0-1 should still be valid");
+  m[1]->SetPosition (Vector (115, 0, 0));
+  NS_TEST_ASSERT_MSG_EQ (cache.GetPathData (m[0], m[1], 0), 0, "Path 0-1 should have been invalidated");
+  NS_TEST_ASSERT_MSG_EQ (cache.GetSize (), 1, "Invalidated path should be removed");
+  NS_TEST_ASSERT_MSG_EQ (cache.GetPathData (m[3], m[0], 0), d03, "Path 0-3 should still be valid");
+}
+
 class PropagationLossModelsTestSuite : public TestSuite
 {
 public:
@@ -450,6 +662,9 @@ PropagationLossModelsTestSuite::PropagationLossModelsTestSuite ()
   AddTestCase (new LogDistancePropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new MatrixPropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new RangePropagationLossModelTestCase, TestCase::QUICK);
+  AddTestCase (new MaxRangePropagationLossModelTestCase, TestCase::QUICK);
+  AddTestCase (new BatchPropagationLossModelTestCase, TestCase::QUICK);
+  AddTestCase (new PropagationCacheTestCase, TestCase::QUICK);
 }
 
 static PropagationLossModelsTestSuite propagationLossModelsTestSuite;
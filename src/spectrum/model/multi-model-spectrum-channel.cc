@@ -26,6 +26,7 @@
 #include <ns3/net-device.h>
 #include <ns3/node.h>
 #include <ns3/double.h>
+#include <ns3/boolean.h>
 #include <ns3/mobility-model.h>
 #include <ns3/spectrum-phy.h>
 #include <ns3/spectrum-converter.h>
@@ -34,7 +35,11 @@
 #include <ns3/propagation-delay-model.h>
 #include <ns3/antenna-model.h>
 #include <ns3/angles.h>
+#include <ns3/hash.h>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include <utility>
 #include "multi-model-spectrum-channel.h"
 
@@ -75,7 +80,26 @@ RxSpectrumModelInfo::RxSpectrumModelInfo (Ptr<const SpectrumModel> rxSpectrumMod
 }
 
 
+bool
+operator < (const ConvertedPsdKey &a, const ConvertedPsdKey &b)
+{
+  if (a.m_txSpectrumModelUid != b.m_txSpectrumModelUid)
+    {
+      return a.m_txSpectrumModelUid < b.m_txSpectrumModelUid;
+    }
+  if (a.m_rxSpectrumModelUid != b.m_rxSpectrumModelUid)
+    {
+      return a.m_rxSpectrumModelUid < b.m_rxSpectrumModelUid;
+    }
+  return a.m_hash < b.m_hash;
+}
+
+
 MultiModelSpectrumChannel::MultiModelSpectrumChannel ()
+  : m_convertedPsdHits (0),
+    m_convertedPsdMisses (0),
+    m_indexValid (false),
+    m_maxSpeed (0.0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -89,6 +113,11 @@ MultiModelSpectrumChannel::DoDispose ()
   m_spectrumPropagationLoss = 0;
   m_txSpectrumModelInfoMap.clear ();
   m_rxSpectrumModelInfoMap.clear ();
+  m_convertedPsdCache.clear ();
+  ClearIndex ();
+  m_candidates.clear ();
+  m_rxPhys.clear ();
+  m_rxMobilities.clear ();
   SpectrumChannel::DoDispose ();
 }
 
@@ -112,6 +141,28 @@ MultiModelSpectrumChannel::GetTypeId (void)
                    DoubleValue (1.0e9),
                    MakeDoubleAccessor (&MultiModelSpectrumChannel::m_maxLossDb),
                    MakeDoubleChecker<double> ())
+    .AddAttribute ("SpatialIndexing",
+                   "If true, the receivers are kept in a spatial index, and "
+                   "a transmission is only evaluated for the receivers located "
+                   "within the distance at which the PropagationLossModel "
+                   "reaches a loss of MaxLossDb plus MaxAntennaGainDb. "
+                   "The signals delivered are unchanged, but the PathLoss "
+                   "trace is not fired for the receivers which are culled.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MultiModelSpectrumChannel::m_spatialIndexing),
+                   MakeBooleanChecker ())
+    .AddAttribute ("SpatialCellSize",
+                   "The size (m) of the cells of the grid used when SpatialIndexing is true.",
+                   DoubleValue (500.0),
+                   MakeDoubleAccessor (&MultiModelSpectrumChannel::m_cellSize),
+                   MakeDoubleChecker<double> (1.0))
+    .AddAttribute ("MaxAntennaGainDb",
+                   "An upper bound of the sum of the tx and rx antenna gains (dB) "
+                   "of any pair of SpectrumPhy, used when SpatialIndexing is true "
+                   "to bound the range of the transmissions.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&MultiModelSpectrumChannel::m_maxAntennaGainDb),
+                   MakeDoubleChecker<double> ())
     .AddTraceSource ("PathLoss",
                      "This trace is fired whenever a new path loss value "
                      "is calculated. The first and second parameters "
@@ -144,6 +195,9 @@ MultiModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
 
   SpectrumModelUid_t rxSpectrumModelUid = rxSpectrumModel->GetUid ();
 
+  // the spatial index is rebuilt at the next transmission
+  m_indexValid = false;
+
   std::vector<Ptr<SpectrumPhy> >::const_iterator it;
 
   // remove a previous entry of this phy if it exists
@@ -244,6 +298,39 @@ MultiModelSpectrumChannel::FindAndEventuallyAddTxSpectrumModel (Ptr<const Spectr
 
     
 
+Ptr<SpectrumValue>
+MultiModelSpectrumChannel::GetConvertedPsd (Ptr<const SpectrumValue> txPsd,
+                                            SpectrumModelUid_t rxSpectrumModelUid,
+                                            const SpectrumConverter &converter)
+{
+  ConvertedPsdKey key;
+  key.m_txSpectrumModelUid = txPsd->GetSpectrumModelUid ();
+  key.m_rxSpectrumModelUid = rxSpectrumModelUid;
+  Values::const_iterator begin = txPsd->ConstValuesBegin ();
+  Values::const_iterator end = txPsd->ConstValuesEnd ();
+  key.m_hash = Hash32 (reinterpret_cast<const char *> (begin), (end - begin) * sizeof (double));
+  ConvertedPsdCache_t::iterator it = m_convertedPsdCache.find (key);
+  if (it != m_convertedPsdCache.end ()
+      && std::equal (begin, end, it->second.m_txPsdValues.ConstValuesBegin ()))
+    {
+      NS_LOG_LOGIC ("reusing converted PSD");
+      ++m_convertedPsdHits;
+      return it->second.m_convertedPsd;
+    }
+  ++m_convertedPsdMisses;
+  if (it == m_convertedPsdCache.end () && m_convertedPsdCache.size () >= 256)
+    {
+      // PSDs which change at every transmission (e.g., with a random
+      // power) would fill the cache, start over
+      NS_LOG_LOGIC ("flushing the converted PSD cache");
+      m_convertedPsdCache.clear ();
+    }
+  ConvertedPsdInfo &info = m_convertedPsdCache[key];
+  info.m_txPsdValues = *txPsd;
+  info.m_convertedPsd = converter.Convert (txPsd);
+  return info.m_convertedPsd;
+}
+
 void
 MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 {
@@ -265,6 +352,12 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
   NS_LOG_LOGIC ("converter map size: " << txInfoIteratorerator->second.m_spectrumConverterMap.size ());
   NS_LOG_LOGIC ("converter map first element: " << txInfoIteratorerator->second.m_spectrumConverterMap.begin ()->first);
 
+  bool culling = false;
+  if (m_spatialIndexing && txMobility && m_propagationLoss)
+    {
+      culling = FindCandidates (txMobility);
+    }
+
   for (RxSpectrumModelInfoMap_t::const_iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
        rxInfoIterator != m_rxSpectrumModelInfoMap.end ();
        ++rxInfoIterator)
@@ -272,6 +365,24 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
       SpectrumModelUid_t rxSpectrumModelUid = rxInfoIterator->second.m_rxSpectrumModel->GetUid ();
       NS_LOG_LOGIC (" rxSpectrumModelUids " << rxSpectrumModelUid);
 
+      m_rxPhys.clear ();
+      if (culling)
+        {
+          // deliver in the same order as without the spatial index
+          std::vector<Ptr<SpectrumPhy> > &candidates = m_candidates[rxSpectrumModelUid];
+          std::sort (candidates.begin (), candidates.end ());
+          m_rxPhys.swap (candidates);
+          NS_LOG_LOGIC (m_rxPhys.size () << " candidate receivers out of " << rxInfoIterator->second.m_rxPhySet.size ());
+          if (m_rxPhys.empty ())
+            {
+              continue;
+            }
+        }
+      else
+        {
+          m_rxPhys.assign (rxInfoIterator->second.m_rxPhySet.begin (), rxInfoIterator->second.m_rxPhySet.end ());
+        }
+
       Ptr <SpectrumValue> convertedTxPowerSpectrum;
       if (txSpectrumModelUid == rxSpectrumModelUid)
         {
@@ -283,12 +394,30 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
           NS_LOG_LOGIC (" converting txPowerSpectrum SpectrumModelUids" << txSpectrumModelUid << " --> " << rxSpectrumModelUid);
           SpectrumConverterMap_t::const_iterator rxConverterIterator = txInfoIteratorerator->second.m_spectrumConverterMap.find (rxSpectrumModelUid);
           NS_ASSERT (rxConverterIterator != txInfoIteratorerator->second.m_spectrumConverterMap.end ());
-          convertedTxPowerSpectrum = rxConverterIterator->second.Convert (txParams->psd);
+          convertedTxPowerSpectrum = GetConvertedPsd (txParams->psd, rxSpectrumModelUid, rxConverterIterator->second);
         }
 
 
-      for (std::set<Ptr<SpectrumPhy> >::const_iterator rxPhyIterator = rxInfoIterator->second.m_rxPhySet.begin ();
-           rxPhyIterator != rxInfoIterator->second.m_rxPhySet.end ();
+      // compute the propagation gain of all the receivers in one pass
+      m_rxMobilities.clear ();
+      if (txMobility && m_propagationLoss)
+        {
+          for (std::vector<Ptr<SpectrumPhy> >::const_iterator rxPhyIterator = m_rxPhys.begin ();
+               rxPhyIterator != m_rxPhys.end ();
+               ++rxPhyIterator)
+            {
+              Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
+              if ((*rxPhyIterator) != txParams->txPhy && receiverMobility)
+                {
+                  m_rxMobilities.push_back (receiverMobility);
+                }
+            }
+          m_propagationLoss->CalcRxPowerBatch (0, txMobility, m_rxMobilities, m_propagationGainsDb);
+        }
+      uint32_t gainIndex = 0;
+
+      for (std::vector<Ptr<SpectrumPhy> >::const_iterator rxPhyIterator = m_rxPhys.begin ();
+           rxPhyIterator != m_rxPhys.end ();
            ++rxPhyIterator)
         {
           NS_ASSERT_MSG ((*rxPhyIterator)->GetRxSpectrumModel ()->GetUid () == rxSpectrumModelUid,
@@ -323,7 +452,8 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
                     }
                   if (m_propagationLoss)
                     {
-                      double propagationGainDb = m_propagationLoss->CalcRxPower (0, txMobility, receiverMobility);
+                      NS_ASSERT (m_rxMobilities[gainIndex] == receiverMobility);
+                      double propagationGainDb = m_propagationGainsDb[gainIndex++];
                       NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
                       pathLossDb -= propagationGainDb;
                     }                    
@@ -377,6 +507,195 @@ MultiModelSpectrumChannel::StartRx (Ptr<SpectrumSignalParameters> params, Ptr<Sp
 }
 
 
+bool
+MultiModelSpectrumChannel::FindCandidates (Ptr<MobilityModel> txMobility)
+{
+  NS_LOG_FUNCTION (this << txMobility);
+  // beyond this distance, the loss is bigger than m_maxLossDb whatever
+  // the antenna gains
+  double range = m_propagationLoss->GetMaxRange (0, -(m_maxLossDb + m_maxAntennaGainDb));
+  if (!(range < std::numeric_limits<double>::infinity ()))
+    {
+      NS_LOG_LOGIC ("unbounded range, no culling");
+      return false;
+    }
+  if (!m_indexValid)
+    {
+      BuildIndex ();
+    }
+  // A receiver may have moved by up to m_maxSpeed * (now - m_lastRebuild)
+  // since it was stored in its cell: rebuild the index before that drift
+  // grows larger than a cell.
+  double drift = m_maxSpeed * (Simulator::Now () - m_lastRebuild).GetSeconds ();
+  if (drift > m_cellSize / 2)
+    {
+      RebuildIndex ();
+      drift = 0;
+    }
+  double radius = range + drift;
+  NS_LOG_LOGIC ("range=" << range << "m, drift=" << drift << "m");
+
+  for (std::map<SpectrumModelUid_t, std::vector<Ptr<SpectrumPhy> > >::iterator it = m_candidates.begin ();
+       it != m_candidates.end ();
+       ++it)
+    {
+      it->second.clear ();
+    }
+  for (std::vector<IndexedPhy>::const_iterator it = m_unplacedPhys.begin (); it != m_unplacedPhys.end (); ++it)
+    {
+      m_candidates[it->rxModelUid].push_back (it->phy);
+    }
+
+  Vector position = txMobility->GetPosition ();
+  double minX = std::floor ((position.x - radius) / m_cellSize);
+  double maxX = std::floor ((position.x + radius) / m_cellSize);
+  double minY = std::floor ((position.y - radius) / m_cellSize);
+  double maxY = std::floor ((position.y + radius) / m_cellSize);
+  if ((maxX - minX + 1) * (maxY - minY + 1) > m_grid.size ())
+    {
+      // the disc covers more cells than there are occupied ones
+      for (Grid::const_iterator it = m_grid.begin (); it != m_grid.end (); ++it)
+        {
+          if (it->first.first >= minX && it->first.first <= maxX
+              && it->first.second >= minY && it->first.second <= maxY)
+            {
+              for (std::vector<uint32_t>::const_iterator i = it->second.begin (); i != it->second.end (); ++i)
+                {
+                  m_candidates[m_indexedPhys[*i].rxModelUid].push_back (m_indexedPhys[*i].phy);
+                }
+            }
+        }
+    }
+  else
+    {
+      for (int32_t x = static_cast<int32_t> (minX); x <= static_cast<int32_t> (maxX); x++)
+        {
+          for (int32_t y = static_cast<int32_t> (minY); y <= static_cast<int32_t> (maxY); y++)
+            {
+              Grid::const_iterator it = m_grid.find (Cell (x, y));
+              if (it != m_grid.end ())
+                {
+                  for (std::vector<uint32_t>::const_iterator i = it->second.begin (); i != it->second.end (); ++i)
+                    {
+                      m_candidates[m_indexedPhys[*i].rxModelUid].push_back (m_indexedPhys[*i].phy);
+                    }
+                }
+            }
+        }
+    }
+  return true;
+}
+
+void
+MultiModelSpectrumChannel::BuildIndex (void)
+{
+  NS_LOG_FUNCTION (this);
+  ClearIndex ();
+  for (RxSpectrumModelInfoMap_t::const_iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
+       rxInfoIterator != m_rxSpectrumModelInfoMap.end ();
+       ++rxInfoIterator)
+    {
+      for (std::set<Ptr<SpectrumPhy> >::const_iterator phyIt = rxInfoIterator->second.m_rxPhySet.begin ();
+           phyIt != rxInfoIterator->second.m_rxPhySet.end ();
+           ++phyIt)
+        {
+          IndexedPhy entry;
+          entry.phy = *phyIt;
+          entry.rxModelUid = rxInfoIterator->first;
+          entry.mobility = (*phyIt)->GetMobility ();
+          entry.cell = Cell (std::numeric_limits<int32_t>::max (), std::numeric_limits<int32_t>::max ());
+          if (entry.mobility == 0)
+            {
+              m_unplacedPhys.push_back (entry);
+              continue;
+            }
+          std::vector<uint32_t> &phys = m_mobilityPhys[PeekPointer (entry.mobility)];
+          if (phys.empty ())
+            {
+              entry.mobility->TraceConnectWithoutContext ("CourseChange",
+                                                          MakeCallback (&MultiModelSpectrumChannel::CourseChanged, this));
+            }
+          phys.push_back (m_indexedPhys.size ());
+          m_indexedPhys.push_back (entry);
+        }
+    }
+  RebuildIndex ();
+  m_indexValid = true;
+}
+
+void
+MultiModelSpectrumChannel::ClearIndex (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (MobilityPhys::const_iterator it = m_mobilityPhys.begin (); it != m_mobilityPhys.end (); ++it)
+    {
+      Ptr<MobilityModel> mobility = m_indexedPhys[it->second.front ()].mobility;
+      mobility->TraceDisconnectWithoutContext ("CourseChange",
+                                               MakeCallback (&MultiModelSpectrumChannel::CourseChanged, this));
+    }
+  m_mobilityPhys.clear ();
+  m_indexedPhys.clear ();
+  m_unplacedPhys.clear ();
+  m_grid.clear ();
+  m_indexValid = false;
+}
+
+void
+MultiModelSpectrumChannel::RebuildIndex (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_maxSpeed = 0;
+  for (uint32_t i = 0; i < m_indexedPhys.size (); i++)
+    {
+      UpdateCell (i);
+      Vector velocity = m_indexedPhys[i].mobility->GetVelocity ();
+      m_maxSpeed = std::max (m_maxSpeed, CalculateDistance (velocity, Vector (0, 0, 0)));
+    }
+  m_lastRebuild = Simulator::Now ();
+}
+
+void
+MultiModelSpectrumChannel::UpdateCell (uint32_t i)
+{
+  IndexedPhy &entry = m_indexedPhys[i];
+  Vector position = entry.mobility->GetPosition ();
+  Cell cell (static_cast<int32_t> (std::floor (position.x / m_cellSize)),
+             static_cast<int32_t> (std::floor (position.y / m_cellSize)));
+  if (cell == entry.cell)
+    {
+      return;
+    }
+  Grid::iterator old = m_grid.find (entry.cell);
+  if (old != m_grid.end ())
+    {
+      std::vector<uint32_t> &phys = old->second;
+      phys.erase (std::find (phys.begin (), phys.end (), i));
+      if (phys.empty ())
+        {
+          m_grid.erase (old);
+        }
+    }
+  m_grid[cell].push_back (i);
+  entry.cell = cell;
+}
+
+void
+MultiModelSpectrumChannel::CourseChanged (Ptr<const MobilityModel> mobility)
+{
+  MobilityPhys::const_iterator phys = m_mobilityPhys.find (PeekPointer (mobility));
+  if (phys == m_mobilityPhys.end ())
+    {
+      return;
+    }
+  for (std::vector<uint32_t>::const_iterator i = phys->second.begin (); i != phys->second.end (); ++i)
+    {
+      UpdateCell (*i);
+    }
+  Vector velocity = mobility->GetVelocity ();
+  m_maxSpeed = std::max (m_maxSpeed, CalculateDistance (velocity, Vector (0, 0, 0)));
+}
+
+
 
 uint32_t
 MultiModelSpectrumChannel::GetNDevices (void) const
@@ -448,5 +767,17 @@ MultiModelSpectrumChannel::GetSpectrumPropagationLossModel (void)
   return m_spectrumPropagationLoss;
 }
 
+uint64_t
+MultiModelSpectrumChannel::GetConvertedPsdCacheHits (void) const
+{
+  return m_convertedPsdHits;
+}
+
+uint64_t
+MultiModelSpectrumChannel::GetConvertedPsdCacheMisses (void) const
+{
+  return m_convertedPsdMisses;
+}
+
 
 } // namespace ns3
@@ -27,8 +27,11 @@
 #include <ns3/spectrum-channel.h>
 #include <ns3/spectrum-propagation-loss-model.h>
 #include <ns3/propagation-delay-model.h>
+#include <ns3/vector.h>
+#include <ns3/nstime.h>
 #include <map>
 #include <set>
+#include <vector>
 
 namespace ns3 {
 
@@ -68,6 +71,40 @@ public:
 typedef std::map<SpectrumModelUid_t, RxSpectrumModelInfo> RxSpectrumModelInfoMap_t;
 
 
+/**
+ * \ingroup spectrum
+ *
+ * The key of a tx PSD converted to an rx SpectrumModel: the uids of
+ * the tx and rx SpectrumModel, and a hash of the tx values.
+ */
+struct ConvertedPsdKey
+{
+  SpectrumModelUid_t m_txSpectrumModelUid; ///< the uid of the tx SpectrumModel
+  SpectrumModelUid_t m_rxSpectrumModelUid; ///< the uid of the rx SpectrumModel
+  uint32_t m_hash;                         ///< the hash of the tx values
+};
+
+bool operator < (const ConvertedPsdKey &a, const ConvertedPsdKey &b);
+
+/**
+ * \ingroup spectrum
+ *
+ * A tx PSD converted to an rx SpectrumModel. Devices transmit the same
+ * few PSDs over and over, although some of them (e.g., the LTE PHYs)
+ * build a new SpectrumValue for each transmission, so the result of
+ * the conversion is kept and reused for any tx PSD with the same
+ * SpectrumModel and the same values.
+ */
+class ConvertedPsdInfo
+{
+public:
+  SpectrumValue m_txPsdValues;       ///< the values of the tx PSD which was converted
+  Ptr<SpectrumValue> m_convertedPsd; ///< the tx PSD converted to the rx SpectrumModel
+};
+
+typedef std::map<ConvertedPsdKey, ConvertedPsdInfo> ConvertedPsdCache_t;
+
+
 
 
 /**
@@ -82,6 +119,21 @@ typedef std::map<SpectrumModelUid_t, RxSpectrumModelInfo> RxSpectrumModelInfoMap
  * for this to work is that, after the SpectrumPhy switched its
  * SpectrumModel,  MultiModelSpectrumChannel::AddRx () is
  * called again passing the pointer to that SpectrumPhy.
+ *
+ * By default, every transmission is evaluated for every receiving
+ * SpectrumPhy, and MaxLossDb only discards a receiver once its loss has
+ * been computed. When the SpatialIndexing attribute is set, the channel
+ * keeps the receiving SpectrumPhy instances in a grid of
+ * SpatialCellSize cells, updated when their mobility model reports a
+ * course change, and only evaluates those located within the distance
+ * beyond which the PropagationLossModel returns a loss bigger than
+ * MaxLossDb plus MaxAntennaGainDb (see PropagationLossModel::GetMaxRange).
+ * The receivers which are delivered a signal are the same as without
+ * the index, but the PathLoss trace is not fired for the receivers
+ * which are culled. If the loss model does not bound its range (e.g.,
+ * because it includes fading) all the receivers are evaluated. Between
+ * two course changes, the mobility models are assumed to move at
+ * constant velocity.
  */
 class MultiModelSpectrumChannel : public SpectrumChannel
 {
@@ -105,6 +157,18 @@ public:
 
   virtual Ptr<SpectrumPropagationLossModel> GetSpectrumPropagationLossModel (void);
 
+  /**
+   * \return the number of conversions of a tx PSD to an rx SpectrumModel
+   * which were found in the cache of converted PSDs
+   */
+  uint64_t GetConvertedPsdCacheHits (void) const;
+
+  /**
+   * \return the number of conversions of a tx PSD to an rx SpectrumModel
+   * which were actually computed
+   */
+  uint64_t GetConvertedPsdCacheMisses (void) const;
+
 
 protected:
   void DoDispose ();
@@ -124,6 +188,21 @@ private:
    */
   TxSpectrumModelInfoMap_t::const_iterator FindAndEventuallyAddTxSpectrumModel (Ptr<const SpectrumModel> txSpectrumModel);
 
+  /**
+   * Convert a tx PSD to an rx SpectrumModel, reusing the result of a
+   * previous conversion of a PSD with the same SpectrumModel and the
+   * same values.
+   *
+   * @param txPsd the tx PSD
+   * @param rxSpectrumModelUid the uid of the rx SpectrumModel
+   * @param converter the converter from the tx to the rx SpectrumModel
+   *
+   * @return the converted PSD, which must not be modified
+   */
+  Ptr<SpectrumValue> GetConvertedPsd (Ptr<const SpectrumValue> txPsd,
+                                      SpectrumModelUid_t rxSpectrumModelUid,
+                                      const SpectrumConverter &converter);
+
   /**
    * used internally to reschedule transmission after the propagation delay
    *
@@ -132,6 +211,76 @@ private:
    */
   virtual void StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
 
+  /**
+   * Fill m_candidates with the receivers which may be within MaxLossDb
+   * of the given transmitter, bucketed by rx SpectrumModel uid.
+   *
+   * @param txMobility the mobility model of the transmitter
+   *
+   * @return false if the range of the propagation loss model is not
+   * bounded, in which case all the receivers must be evaluated
+   */
+  bool FindCandidates (Ptr<MobilityModel> txMobility);
+
+  /**
+   * Insert all the receivers in the spatial index and connect to the
+   * course change trace of their mobility model.
+   */
+  void BuildIndex (void);
+
+  /**
+   * Empty the spatial index and disconnect from the course change traces.
+   */
+  void ClearIndex (void);
+
+  /**
+   * Move all the indexed receivers to the cell of their current
+   * position, and refresh their maximum speed.
+   */
+  void RebuildIndex (void);
+
+  /**
+   * Move the given indexed receiver to the cell of its current position.
+   *
+   * @param i the index of the receiver in m_indexedPhys
+   */
+  void UpdateCell (uint32_t i);
+
+  /**
+   * Callback invoked when the mobility model of an indexed receiver
+   * changes course.
+   *
+   * @param mobility the mobility model
+   */
+  void CourseChanged (Ptr<const MobilityModel> mobility);
+
+  /**
+   * A cell of the spatial index.
+   */
+  typedef std::pair<int32_t, int32_t> Cell;
+
+  /**
+   * The spatial index: the indices in m_indexedPhys of the receivers
+   * located in each cell.
+   */
+  typedef std::map<Cell, std::vector<uint32_t> > Grid;
+
+  /**
+   * An entry of the spatial index.
+   */
+  struct IndexedPhy
+  {
+    Ptr<SpectrumPhy> phy;             //!< the receiver
+    SpectrumModelUid_t rxModelUid;    //!< the uid of its rx SpectrumModel
+    Ptr<MobilityModel> mobility;      //!< its mobility model
+    Cell cell;                        //!< the cell in which it is stored
+  };
+
+  /**
+   * The indexed receivers sharing a given mobility model.
+   */
+  typedef std::map<const MobilityModel *, std::vector<uint32_t> > MobilityPhys;
+
 
 
   /**
@@ -174,6 +323,27 @@ private:
   double m_maxLossDb;
 
   TracedCallback<Ptr<SpectrumPhy>, Ptr<SpectrumPhy>, double > m_pathLossTrace;
+
+  ConvertedPsdCache_t m_convertedPsdCache; //!< converted tx PSDs, by tx values and rx SpectrumModel uid
+  uint64_t m_convertedPsdHits;             //!< number of converted PSDs found in m_convertedPsdCache
+  uint64_t m_convertedPsdMisses;           //!< number of converted PSDs computed
+
+  std::vector<Ptr<SpectrumPhy> > m_rxPhys;         //!< scratch receivers of a transmission
+  std::vector<Ptr<MobilityModel> > m_rxMobilities; //!< scratch mobility models of the receivers of a transmission
+  std::vector<double> m_propagationGainsDb;        //!< scratch propagation gains (dB) of the receivers
+
+  bool m_spatialIndexing;    //!< whether the receivers are culled with the spatial index
+  double m_cellSize;         //!< size (m) of the cells of the spatial index
+  double m_maxAntennaGainDb; //!< upper bound of the sum of the tx and rx antenna gains (dB)
+  bool m_indexValid;         //!< false when the receivers changed since the index was built
+  std::vector<IndexedPhy> m_indexedPhys;  //!< receivers with a mobility model
+  std::vector<IndexedPhy> m_unplacedPhys; //!< receivers without a mobility model, never culled
+  Grid m_grid;                            //!< spatial index
+  MobilityPhys m_mobilityPhys;            //!< indexed receivers per mobility model
+  double m_maxSpeed;                      //!< max speed (m/s) of the receivers since m_lastRebuild
+  Time m_lastRebuild;                     //!< last time all the receivers were re-inserted
+  std::map<SpectrumModelUid_t, std::vector<Ptr<SpectrumPhy> > > m_candidates; //!< scratch candidate receivers per rx SpectrumModel uid
+
 };
 
 
@@ -39,23 +39,26 @@ SpectrumConverter::SpectrumConverter (Ptr<const SpectrumModel> fromSpectrumModel
   m_fromSpectrumModel = fromSpectrumModel;
   m_toSpectrumModel = toSpectrumModel;
 
+  m_rowStart.push_back (0);
   for (Bands::const_iterator toit = toSpectrumModel->Begin (); toit != toSpectrumModel->End (); ++toit)
     {
-      std::vector<double> coeffs;
-
-      for (Bands::const_iterator fromit = fromSpectrumModel->Begin (); fromit != fromSpectrumModel->End (); ++fromit)
+      uint32_t column = 0;
+      for (Bands::const_iterator fromit = fromSpectrumModel->Begin (); fromit != fromSpectrumModel->End (); ++fromit, ++column)
         {
           double c = GetCoefficient (*fromit, *toit);
           NS_LOG_LOGIC ("(" << fromit->fl << ","  << fromit->fh << ")"
                             << " --> " <<
                         "(" << toit->fl << "," << toit->fh << ")"
                             << " = " << c);
-          coeffs.push_back (c);
+          if (c != 0)
+            {
+              m_columns.push_back (column);
+              m_coefficients.push_back (c);
+            }
         }
-
-      m_conversionMatrix.push_back (coeffs);
+      m_rowStart.push_back (m_coefficients.size ());
     }
-
+  NS_LOG_LOGIC ("non-zero coefficients: " << m_coefficients.size ());
 }
 
 
@@ -74,30 +77,25 @@ Ptr<SpectrumValue>
 SpectrumConverter::Convert (Ptr<const SpectrumValue> fvvf) const
 {
   NS_ASSERT ( *(fvvf->GetSpectrumModel ()) == *m_fromSpectrumModel);
+  NS_ASSERT (!m_rowStart.empty ());
 
   Ptr<SpectrumValue> tvvf = Create<SpectrumValue> (m_toSpectrumModel);
 
   Values::iterator tvit = tvvf->ValuesBegin ();
+  Values::const_iterator fvit = fvvf->ConstValuesBegin ();
+  const uint32_t *columns = m_columns.empty () ? 0 : &m_columns[0];
+  const double *coefficients = m_coefficients.empty () ? 0 : &m_coefficients[0];
+  uint32_t rows = m_rowStart.size () - 1;
+  NS_ASSERT (rows == (uint32_t)(tvvf->ValuesEnd () - tvit));
 
-
-  for (std::vector<std::vector<double> >::const_iterator toit = m_conversionMatrix.begin ();
-       toit != m_conversionMatrix.end ();
-       ++toit)
+  for (uint32_t row = 0; row < rows; ++row)
     {
-      NS_ASSERT (tvit != tvvf->ValuesEnd ());
-      Values::const_iterator fvit = fvvf->ConstValuesBegin ();
-
       double sum = 0;
-      for (std::vector<double>::const_iterator fromit = toit->begin ();
-           fromit != toit->end ();
-           ++fromit)
+      for (uint32_t k = m_rowStart[row]; k < m_rowStart[row + 1]; ++k)
         {
-          NS_ASSERT (fvit != fvvf->ConstValuesEnd ());
-          sum += (*fvit) * (*fromit);
-          ++fvit;
+          sum += fvit[columns[k]] * coefficients[k];
         }
-      *tvit = sum;
-      ++tvit;
+      tvit[row] = sum;
     }
 
   return tvvf;
@@ -78,7 +78,17 @@ private:
    */
   double GetCoefficient (const BandInfo& from, const BandInfo& to) const;
 
-  std::vector<std::vector<double> > m_conversionMatrix; // /< matrix of conversion coefficients
+  /*
+   * The conversion matrix is banded, since each band only overlaps a
+   * few bands of the other SpectrumModel: only its non-zero
+   * coefficients are stored, row by row (compressed sparse row format).
+   * The coefficients of row i, i.e., of the i-th band of the "to"
+   * SpectrumModel, are m_coefficients[m_rowStart[i] ... m_rowStart[i+1]-1]
+   * and apply to the "from" bands m_columns[m_rowStart[i] ... m_rowStart[i+1]-1].
+   */
+  std::vector<uint32_t> m_rowStart;     // /< index of the first coefficient of each row, plus the total count
+  std::vector<uint32_t> m_columns;      // /< "from" band index of each non-zero coefficient
+  std::vector<double> m_coefficients;   // /< non-zero conversion coefficients
   Ptr<const SpectrumModel> m_fromSpectrumModel;  // /<  the SpectrumModel this SpectrumConverter instance can convert from
   Ptr<const SpectrumModel> m_toSpectrumModel;    // /<  the SpectrumModel this SpectrumConverter instance can convert to
 
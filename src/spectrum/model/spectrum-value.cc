@@ -22,11 +22,67 @@
 #include <ns3/spectrum-value.h>
 #include <ns3/math.h>
 #include <ns3/log.h>
+#include <algorithm>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("SpectrumValue");
 
+Values::Values ()
+  : m_data (m_inline),
+    m_size (0)
+{
+}
+
+Values::Values (size_t n)
+  : m_data (m_inline),
+    m_size (0)
+{
+  Allocate (n);
+  std::fill (begin (), end (), 0.0);
+}
+
+Values::Values (const Values &o)
+  : m_data (m_inline),
+    m_size (0)
+{
+  Allocate (o.m_size);
+  std::copy (o.begin (), o.end (), begin ());
+}
+
+Values::~Values ()
+{
+  if (m_data != m_inline)
+    {
+      delete [] m_data;
+    }
+}
+
+Values &
+Values::operator= (const Values &o)
+{
+  if (this != &o)
+    {
+      Allocate (o.m_size);
+      std::copy (o.begin (), o.end (), begin ());
+    }
+  return *this;
+}
+
+void
+Values::Allocate (size_t n)
+{
+  if (n != m_size && (n > INLINE_SIZE || m_data != m_inline))
+    {
+      if (m_data != m_inline)
+        {
+          delete [] m_data;
+        }
+      m_data = (n > INLINE_SIZE) ? new double[n] : m_inline;
+    }
+  m_size = n;
+}
+
 SpectrumValue::SpectrumValue ()
 {
 }
@@ -41,13 +97,15 @@ SpectrumValue::SpectrumValue (Ptr<const SpectrumModel> sof)
 double&
 SpectrumValue:: operator[] (size_t index)
 {
-  return m_values.at (index);
+  NS_ASSERT (index < m_values.size ());
+  return m_values[index];
 }
 
 const double&
 SpectrumValue:: operator[] (size_t index) const
 {
-  return m_values.at (index);
+  NS_ASSERT (index < m_values.size ());
+  return m_values[index];
 }
 
 
@@ -247,12 +305,12 @@ SpectrumValue::ShiftLeft (int n)
   int i = 0;
   while (i < (int) m_values.size () - n)
     {
-      m_values.at (i) = m_values.at (i + n);
+      m_values[i] = m_values[i + n];
       i++;
     }
   while (i < (int)m_values.size ())
     {
-      m_values.at (i) = 0;
+      m_values[i] = 0;
       i++;
     }
 }
@@ -264,12 +322,12 @@ SpectrumValue::ShiftRight (int n)
   int i = m_values.size () - 1;
   while (i - n >= 0)
     {
-      m_values.at (i) = m_values.at (i - n);
+      m_values[i] = m_values[i - n];
       i = i - 1;
     }
   while (i >= 0)
     {
-      m_values.at (i) = 0;
+      m_values[i] = 0;
       --i;
     }
 }
@@ -344,6 +402,72 @@ SpectrumValue::Log ()
     }
 }
 
+void
+SpectrumValue::SetInterference (const SpectrumValue& total, const SpectrumValue& signal, const SpectrumValue& noise)
+{
+  NS_ASSERT (m_spectrumModel == total.m_spectrumModel);
+  NS_ASSERT (m_spectrumModel == signal.m_spectrumModel);
+  NS_ASSERT (m_spectrumModel == noise.m_spectrumModel);
+  double *res = m_values.begin ();
+  const double *t = total.m_values.begin ();
+  const double *s = signal.m_values.begin ();
+  const double *n = noise.m_values.begin ();
+  size_t size = m_values.size ();
+  for (size_t i = 0; i < size; ++i)
+    {
+      res[i] = (t[i] - s[i]) + n[i];
+    }
+}
+
+void
+SpectrumValue::SetRatio (const SpectrumValue& lhs, const SpectrumValue& rhs)
+{
+  NS_ASSERT (m_spectrumModel == lhs.m_spectrumModel);
+  NS_ASSERT (m_spectrumModel == rhs.m_spectrumModel);
+  double *res = m_values.begin ();
+  const double *l = lhs.m_values.begin ();
+  const double *r = rhs.m_values.begin ();
+  size_t size = m_values.size ();
+  for (size_t i = 0; i < size; ++i)
+    {
+      res[i] = l[i] / r[i];
+    }
+}
+
+void
+SpectrumValue::SetSinr (const SpectrumValue& total, const SpectrumValue& signal, const SpectrumValue& noise, SpectrumValue& interference)
+{
+  NS_ASSERT (m_spectrumModel == total.m_spectrumModel);
+  NS_ASSERT (m_spectrumModel == signal.m_spectrumModel);
+  NS_ASSERT (m_spectrumModel == noise.m_spectrumModel);
+  NS_ASSERT (m_spectrumModel == interference.m_spectrumModel);
+  NS_ASSERT (&interference != this);
+  double *res = m_values.begin ();
+  double *in = interference.m_values.begin ();
+  const double *t = total.m_values.begin ();
+  const double *s = signal.m_values.begin ();
+  const double *n = noise.m_values.begin ();
+  size_t size = m_values.size ();
+  for (size_t i = 0; i < size; ++i)
+    {
+      in[i] = (t[i] - s[i]) + n[i];
+      res[i] = s[i] / in[i];
+    }
+}
+
+void
+SpectrumValue::AddScaled (const SpectrumValue& x, double s)
+{
+  NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  double *res = m_values.begin ();
+  const double *v = x.m_values.begin ();
+  size_t size = m_values.size ();
+  for (size_t i = 0; i < size; ++i)
+    {
+      res[i] += v[i] * s;
+    }
+}
+
 double
 Norm (const SpectrumValue& x)
 {
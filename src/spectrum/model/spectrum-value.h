@@ -30,7 +30,107 @@
 namespace ns3 {
 
 
-typedef std::vector<double> Values;
+/**
+ * \ingroup spectrum
+ *
+ * \brief Storage of the values of a SpectrumValue
+ *
+ * A minimal vector of doubles which keeps up to INLINE_SIZE values
+ * inside the object itself, and only allocates memory on the heap for
+ * larger sizes. This covers the LTE bandwidths (6 to 100 RBs), so that
+ * the SpectrumValue temporaries used by the interference and SINR
+ * computations do not allocate any memory.
+ */
+class Values
+{
+public:
+  typedef double *iterator; //!< iterator over the values
+  typedef const double *const_iterator; //!< const iterator over the values
+
+  Values ();
+  /**
+   * \param n the number of values, all set to zero
+   */
+  explicit Values (size_t n);
+  /**
+   * \param o the values to copy
+   */
+  Values (const Values &o);
+  ~Values ();
+  /**
+   * \param o the values to copy
+   * \return a reference to *this
+   */
+  Values & operator= (const Values &o);
+
+  /**
+   * \return the number of values
+   */
+  size_t size (void) const
+  {
+    return m_size;
+  }
+  /**
+   * \return an iterator pointing to the first value
+   */
+  iterator begin (void)
+  {
+    return m_data;
+  }
+  /**
+   * \return an iterator pointing past the last value
+   */
+  iterator end (void)
+  {
+    return m_data + m_size;
+  }
+  /**
+   * \return a const iterator pointing to the first value
+   */
+  const_iterator begin (void) const
+  {
+    return m_data;
+  }
+  /**
+   * \return a const iterator pointing past the last value
+   */
+  const_iterator end (void) const
+  {
+    return m_data + m_size;
+  }
+  /**
+   * \param index the index of the value
+   * \return a reference to the value
+   */
+  double & operator[] (size_t index)
+  {
+    return m_data[index];
+  }
+  /**
+   * \param index the index of the value
+   * \return a const reference to the value
+   */
+  const double & operator[] (size_t index) const
+  {
+    return m_data[index];
+  }
+
+private:
+  /**
+   * Point m_data to a buffer large enough for n values.
+   * \param n the number of values
+   */
+  void Allocate (size_t n);
+
+  /// the number of values stored inside the object
+  enum
+  {
+    INLINE_SIZE = 100
+  };
+  double *m_data; //!< the values, either m_inline or a heap buffer
+  size_t m_size; //!< the number of values
+  double m_inline[INLINE_SIZE]; //!< inline storage for small sizes
+};
 
 /**
  * \ingroup spectrum
@@ -510,6 +610,51 @@ public:
    */
   typedef void (* TracedCallback)(const Ptr<const SpectrumValue> value);
 
+  /**
+   * Set *this to total - signal + noise, component by component, in a
+   * single pass and without creating any temporary SpectrumValue. This
+   * is the interference seen by a signal. All the operands and *this
+   * must use the same SpectrumModel.
+   *
+   * @param total the sum of all the signals
+   * @param signal the signal of interest
+   * @param noise the noise
+   */
+  void SetInterference (const SpectrumValue& total, const SpectrumValue& signal, const SpectrumValue& noise);
+
+  /**
+   * Set *this to lhs / rhs, component by component, without creating
+   * any temporary SpectrumValue. All the operands and *this must use the
+   * same SpectrumModel.
+   *
+   * @param lhs the dividend
+   * @param rhs the divisor
+   */
+  void SetRatio (const SpectrumValue& lhs, const SpectrumValue& rhs);
+
+  /**
+   * Set interference to total - signal + noise and *this to signal /
+   * interference, component by component, in a single pass and without
+   * creating any temporary SpectrumValue. This gives the same values as
+   * SetInterference followed by SetRatio. All the operands and *this
+   * must use the same SpectrumModel, and interference must not be *this.
+   *
+   * @param total the sum of all the signals
+   * @param signal the signal of interest
+   * @param noise the noise
+   * @param interference set to the interference seen by signal
+   */
+  void SetSinr (const SpectrumValue& total, const SpectrumValue& signal, const SpectrumValue& noise, SpectrumValue& interference);
+
+  /**
+   * Add x * s to *this, component by component, without creating any
+   * temporary SpectrumValue. x and *this must use the same SpectrumModel.
+   *
+   * @param x the values to add
+   * @param s the scaling factor of x
+   */
+  void AddScaled (const SpectrumValue& x, double s);
+
 
 private:
   void Add (const SpectrumValue& x);
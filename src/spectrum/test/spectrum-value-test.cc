@@ -242,6 +242,42 @@ SpectrumValueTestSuite::SpectrumValueTestSuite ()
   AddTestCase (new SpectrumValueTestCase (tv1rs3, v1rs3, "tv1rs3 = v1 >> 3"), TestCase::QUICK);
 
 
+  SpectrumValue tv11 (f), tv12 (f);
+  tv11.SetInterference (v1, v2, v3);
+  tv12.SetRatio (v1, v2);
+  AddTestCase (new SpectrumValueTestCase (tv11, v1 - v2 + v3, "tv11.SetInterference (v1, v2, v3)"), TestCase::QUICK);
+  AddTestCase (new SpectrumValueTestCase (tv12, v6, "tv12.SetRatio (v1, v2)"), TestCase::QUICK);
+
+  SpectrumValue tv13 (f), tv14 (f), tv15 (f);
+  tv13.SetSinr (v1, v2, v3, tv14);
+  tv15 = v3;
+  tv15.AddScaled (v1, 2.5);
+  AddTestCase (new SpectrumValueTestCase (tv13, v2 / (v1 - v2 + v3), "tv13.SetSinr (v1, v2, v3, tv14)"), TestCase::QUICK);
+  AddTestCase (new SpectrumValueTestCase (tv14, v1 - v2 + v3, "tv14 (interference of SetSinr)"), TestCase::QUICK);
+  AddTestCase (new SpectrumValueTestCase (tv15, v3 + v1 * 2.5, "tv15.AddScaled (v1, 2.5)"), TestCase::QUICK);
+
+
+  // values too many to be stored inline
+  std::vector<double> largeFreqs;
+  for (int i = 1; i <= 200; i++)
+    {
+      largeFreqs.push_back (i);
+    }
+  Ptr<SpectrumModel> largeModel = Create<SpectrumModel> (largeFreqs);
+  SpectrumValue large (largeModel);
+  for (int i = 0; i < 200; i++)
+    {
+      large[i] = i * doubleValue;
+    }
+  SpectrumValue tlarge = large;
+  AddTestCase (new SpectrumValueTestCase (tlarge, large, "tlarge = large"), TestCase::QUICK);
+  SpectrumValue tsmall = large;
+  tsmall = v1;
+  AddTestCase (new SpectrumValueTestCase (tsmall, v1, "tsmall = large; tsmall = v1"), TestCase::QUICK);
+  tsmall = large;
+  AddTestCase (new SpectrumValueTestCase (tsmall, large, "tsmall = v1; tsmall = large"), TestCase::QUICK);
+
+
 }
 
 
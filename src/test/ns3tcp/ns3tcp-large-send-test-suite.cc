@@ -0,0 +1,500 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <set>
+#include <sstream>
+#include <vector>
+
+#include "ns3/log.h"
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/ppp-header.h"
+#include "ns3/csma-helper.h"
+#include "ns3/csma-net-device.h"
+#include "ns3/ethernet-header.h"
+#include "ns3/ethernet-trailer.h"
+#include "ns3/llc-snap-header.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-interface-container.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/segmentation-offload.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("Ns3TcpLargeSendTest");
+
+// ===========================================================================
+// Tests of the large sends of TCP split into segments by the NetDevices
+// ===========================================================================
+//
+
+/// The links on which the large sends are tested
+enum Ns3TcpLargeSendLink
+{
+  POINT_TO_POINT, //!< a PointToPointNetDevice
+  CSMA_DIX,       //!< a CsmaNetDevice encapsulating the frames as DIX
+  CSMA_LLC        //!< a CsmaNetDevice encapsulating the frames as LLC/SNAP
+};
+
+/**
+ * Strip a frame sent on a link down to its IPv4 datagram.
+ *
+ * \param link the link
+ * \param frame the frame, copied
+ * \param llcSize set to the size of the LLC/SNAP header of the frame, if any
+ * \return the IPv4 datagram, or 0 if the frame carries another protocol
+ */
+static Ptr<Packet>
+Ns3TcpLargeSendDatagram (Ns3TcpLargeSendLink link, Ptr<const Packet> frame, uint32_t &llcSize)
+{
+  Ptr<Packet> p = frame->Copy ();
+  llcSize = 0;
+  uint16_t protocol = 0;
+  if (link == POINT_TO_POINT)
+    {
+      PppHeader ppp;
+      p->RemoveHeader (ppp);
+      protocol = Ipv4L3Protocol::PROT_NUMBER; // no ARP on a point-to-point link
+    }
+  else
+    {
+      EthernetTrailer trailer;
+      p->RemoveTrailer (trailer);
+      EthernetHeader header (false);
+      p->RemoveHeader (header);
+      protocol = header.GetLengthType ();
+      if (link == CSMA_LLC)
+        {
+          LlcSnapHeader llc;
+          p->RemoveHeader (llc);
+          llcSize = llc.GetSerializedSize ();
+          protocol = llc.GetType ();
+        }
+    }
+  if (protocol != Ipv4L3Protocol::PROT_NUMBER)
+    {
+      return 0;
+    }
+  return p;
+}
+
+/**
+ * A bulk transfer of a TCP socket handing down large sends to a
+ * PointToPointNetDevice or a CsmaNetDevice, which splits them.
+ *
+ * Every frame sent must fit within the MTU of the device, without a
+ * LargeSendTag, and the IPv4 datagrams of the sender must carry
+ * consecutive identifications, as if the socket had sent its segments
+ * one by one. The receiver must get the data unchanged.
+ */
+class Ns3TcpLargeSendTestCase : public TestCase
+{
+public:
+  /**
+   * \param link the link
+   * \param segmentSize the segment size of the sender
+   */
+  Ns3TcpLargeSendTestCase (Ns3TcpLargeSendLink link, uint32_t segmentSize);
+  virtual ~Ns3TcpLargeSendTestCase () {}
+
+private:
+  static std::string BuildNameString (Ns3TcpLargeSendLink link, uint32_t segmentSize);
+  virtual void DoRun (void);
+
+  /**
+   * Record a packet handed down to the device of the sender.
+   * \param p the packet
+   */
+  void MacTx (Ptr<const Packet> p);
+  /**
+   * Record a packet dropped by the device of the sender.
+   * \param p the packet
+   */
+  void MacTxDrop (Ptr<const Packet> p);
+  /**
+   * Check a frame sent by the device of the sender.
+   * \param p the frame
+   */
+  void PhyTxBegin (Ptr<const Packet> p);
+  /**
+   * Set the receive callback of the accepted socket.
+   * \param socket the accepted socket
+   * \param from the address of the peer
+   */
+  void Accept (Ptr<Socket> socket, const Address &from);
+  /**
+   * Read the data received.
+   * \param socket the receiving socket
+   */
+  void Receive (Ptr<Socket> socket);
+
+  Ns3TcpLargeSendLink m_link;
+  uint32_t m_segmentSize;
+  uint32_t m_size;                         //!< the number of bytes to send
+  uint16_t m_mtu;                          //!< the MTU of the devices
+  Ipv4Address m_source;                    //!< the address of the sender
+  uint32_t m_largeSends;                   //!< the large sends handed down to the device
+  uint32_t m_drops;                        //!< the packets dropped by the device
+  uint32_t m_largestFrame;                 //!< the largest IPv4 datagram sent, with its LLC/SNAP header
+  uint32_t m_taggedFrames;                 //!< the frames sent with a LargeSendTag
+  std::vector<uint16_t> m_identifications; //!< the identifications of the datagrams sent
+  std::vector<uint8_t> m_received;         //!< the data received
+};
+
+std::string
+Ns3TcpLargeSendTestCase::BuildNameString (Ns3TcpLargeSendLink link, uint32_t segmentSize)
+{
+  std::ostringstream oss;
+  oss << "Large sends split by a ";
+  switch (link)
+    {
+    case POINT_TO_POINT:
+      oss << "PointToPointNetDevice";
+      break;
+    case CSMA_DIX:
+      oss << "CsmaNetDevice (DIX)";
+      break;
+    case CSMA_LLC:
+      oss << "CsmaNetDevice (LLC)";
+      break;
+    }
+  oss << " into segments of " << segmentSize << " bytes";
+  return oss.str ();
+}
+
+Ns3TcpLargeSendTestCase::Ns3TcpLargeSendTestCase (Ns3TcpLargeSendLink link, uint32_t segmentSize)
+  : TestCase (BuildNameString (link, segmentSize)),
+    m_link (link),
+    m_segmentSize (segmentSize),
+    m_size (200000),
+    m_mtu (1500),
+    m_largeSends (0),
+    m_drops (0),
+    m_largestFrame (0),
+    m_taggedFrames (0)
+{
+}
+
+void
+Ns3TcpLargeSendTestCase::MacTx (Ptr<const Packet> p)
+{
+  LargeSendTag largeSend;
+  if (p->PeekPacketTag (largeSend))
+    {
+      m_largeSends++;
+    }
+}
+
+void
+Ns3TcpLargeSendTestCase::MacTxDrop (Ptr<const Packet> p)
+{
+  m_drops++;
+}
+
+void
+Ns3TcpLargeSendTestCase::PhyTxBegin (Ptr<const Packet> p)
+{
+  LargeSendTag largeSend;
+  if (p->PeekPacketTag (largeSend))
+    {
+      m_taggedFrames++;
+    }
+  uint32_t llcSize;
+  Ptr<Packet> datagram = Ns3TcpLargeSendDatagram (m_link, p, llcSize);
+  if (datagram == 0)
+    {
+      return;
+    }
+  Ipv4Header ipHeader;
+  datagram->PeekHeader (ipHeader);
+  m_largestFrame = std::max (m_largestFrame, ipHeader.GetSerializedSize () + ipHeader.GetPayloadSize () + llcSize);
+  if (ipHeader.GetSource () == m_source)
+    {
+      m_identifications.push_back (ipHeader.GetIdentification ());
+    }
+}
+
+void
+Ns3TcpLargeSendTestCase::Accept (Ptr<Socket> socket, const Address &from)
+{
+  socket->SetRecvCallback (MakeCallback (&Ns3TcpLargeSendTestCase::Receive, this));
+}
+
+void
+Ns3TcpLargeSendTestCase::Receive (Ptr<Socket> socket)
+{
+  Ptr<Packet> p;
+  while ((p = socket->Recv ()))
+    {
+      std::size_t offset = m_received.size ();
+      m_received.resize (offset + p->GetSize ());
+      p->CopyData (&m_received[offset], p->GetSize ());
+    }
+}
+
+void
+Ns3TcpLargeSendTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  NetDeviceContainer devices;
+  if (m_link == POINT_TO_POINT)
+    {
+      PointToPointHelper pointToPoint;
+      pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+      pointToPoint.SetDeviceAttribute ("Mtu", UintegerValue (m_mtu));
+      pointToPoint.SetChannelAttribute ("Delay", StringValue ("5ms"));
+      devices = pointToPoint.Install (nodes);
+    }
+  else
+    {
+      CsmaHelper csma;
+      csma.SetChannelAttribute ("DataRate", StringValue ("10Mbps"));
+      csma.SetChannelAttribute ("Delay", StringValue ("5ms"));
+      csma.SetDeviceAttribute ("Mtu", UintegerValue (m_mtu));
+      csma.SetDeviceAttribute ("EncapsulationMode", StringValue (m_link == CSMA_LLC ? "Llc" : "Dix"));
+      devices = csma.Install (nodes);
+    }
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+  m_source = interfaces.GetAddress (0);
+
+  devices.Get (0)->TraceConnectWithoutContext ("MacTx", MakeCallback (&Ns3TcpLargeSendTestCase::MacTx, this));
+  devices.Get (0)->TraceConnectWithoutContext ("MacTxDrop", MakeCallback (&Ns3TcpLargeSendTestCase::MacTxDrop, this));
+  devices.Get (0)->TraceConnectWithoutContext ("PhyTxBegin", MakeCallback (&Ns3TcpLargeSendTestCase::PhyTxBegin, this));
+
+  Ptr<Socket> server = nodes.Get (1)->GetObject<TcpSocketFactory> ()->CreateSocket ();
+  server->SetAttribute ("RcvBufSize", UintegerValue (m_size));
+  server->Bind (InetSocketAddress (Ipv4Address::GetAny (), 50000));
+  server->Listen ();
+  server->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                             MakeCallback (&Ns3TcpLargeSendTestCase::Accept, this));
+
+  Ptr<Socket> source = nodes.Get (0)->GetObject<TcpSocketFactory> ()->CreateSocket ();
+  source->SetAttribute ("LargeSend", UintegerValue (16000));
+  source->SetAttribute ("SegmentSize", UintegerValue (m_segmentSize));
+  source->SetAttribute ("Timestamp", BooleanValue (false));
+  source->SetAttribute ("SndBufSize", UintegerValue (m_size));
+  source->Bind ();
+  source->Connect (InetSocketAddress (interfaces.GetAddress (1), 50000));
+  std::vector<uint8_t> data (m_size);
+  for (uint32_t i = 0; i < m_size; i++)
+    {
+      data[i] = i % 251;
+    }
+  NS_TEST_ASSERT_MSG_EQ (source->Send (Create<Packet> (&data[0], m_size)), static_cast<int> (m_size), "data not queued");
+
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_GT (m_largeSends, 0, "no large send handed down to the device");
+  NS_TEST_EXPECT_MSG_EQ (m_drops, 0, "large send dropped by the device");
+  NS_TEST_EXPECT_MSG_EQ (m_taggedFrames, 0, "frame sent with a LargeSendTag");
+  // IPv4 header of 20 bytes and TCP header of 20 bytes
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (m_largestFrame, m_mtu, "frame larger than the MTU");
+  NS_TEST_EXPECT_MSG_EQ (m_largestFrame, m_segmentSize + 40 + (m_link == CSMA_LLC ? 8 : 0), "largest datagram not a whole segment");
+
+  NS_TEST_ASSERT_MSG_GT (m_identifications.size (), m_size / m_segmentSize, "too few datagrams sent");
+  std::set<uint16_t> unique (m_identifications.begin (), m_identifications.end ());
+  NS_TEST_EXPECT_MSG_EQ (unique.size (), m_identifications.size (), "identification used twice");
+  for (uint32_t i = 1; i < m_identifications.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_identifications[i], static_cast<uint16_t> (m_identifications[i - 1] + 1),
+                             "identification of datagram " << i << " not following the previous one");
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (m_received.size (), m_size, "data lost");
+  NS_TEST_EXPECT_MSG_EQ ((m_received == data), true, "data corrupted");
+
+  Simulator::Destroy ();
+}
+
+
+/**
+ * A large send which cannot be split into segments: a datagram of another
+ * protocol than TCP carrying a LargeSendTag.
+ *
+ * Handed down to the PointToPointNetDevice, it is dropped with the
+ * MacTxDrop trace, as it would go out above the MTU. Sent through the
+ * IPv4 stack, it loses its tag and is fragmented as any other datagram.
+ */
+class Ns3TcpLargeSendUnsplittableTestCase : public TestCase
+{
+public:
+  Ns3TcpLargeSendUnsplittableTestCase ();
+  virtual ~Ns3TcpLargeSendUnsplittableTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Record a packet dropped by the device of the sender.
+   * \param p the packet
+   */
+  void MacTxDrop (Ptr<const Packet> p);
+  /**
+   * Record a frame sent by the device of the sender.
+   * \param p the frame
+   */
+  void PhyTxBegin (Ptr<const Packet> p);
+  /**
+   * Record a datagram delivered to the receiver.
+   * \param header the IPv4 header
+   * \param p the payload
+   * \param interface the interface
+   */
+  void LocalDeliver (const Ipv4Header &header, Ptr<const Packet> p, uint32_t interface);
+
+  uint32_t m_drops;                  //!< the packets dropped by the device
+  std::vector<Ipv4Header> m_frames;  //!< the IPv4 headers of the frames sent
+  uint32_t m_largestFrame;           //!< the largest frame sent, without its PPP header
+  uint32_t m_taggedFrames;           //!< the frames sent with a LargeSendTag
+  std::vector<uint32_t> m_delivered; //!< the sizes of the datagrams delivered
+};
+
+Ns3TcpLargeSendUnsplittableTestCase::Ns3TcpLargeSendUnsplittableTestCase ()
+  : TestCase ("Large send which cannot be split into segments"),
+    m_drops (0),
+    m_largestFrame (0),
+    m_taggedFrames (0)
+{
+}
+
+void
+Ns3TcpLargeSendUnsplittableTestCase::MacTxDrop (Ptr<const Packet> p)
+{
+  m_drops++;
+}
+
+void
+Ns3TcpLargeSendUnsplittableTestCase::PhyTxBegin (Ptr<const Packet> p)
+{
+  LargeSendTag largeSend;
+  if (p->PeekPacketTag (largeSend))
+    {
+      m_taggedFrames++;
+    }
+  uint32_t llcSize;
+  Ptr<Packet> datagram = Ns3TcpLargeSendDatagram (POINT_TO_POINT, p, llcSize);
+  m_largestFrame = std::max (m_largestFrame, datagram->GetSize ());
+  Ipv4Header ipHeader;
+  datagram->PeekHeader (ipHeader);
+  m_frames.push_back (ipHeader);
+}
+
+void
+Ns3TcpLargeSendUnsplittableTestCase::LocalDeliver (const Ipv4Header &header, Ptr<const Packet> p, uint32_t interface)
+{
+  m_delivered.push_back (p->GetSize ());
+}
+
+void
+Ns3TcpLargeSendUnsplittableTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  PointToPointHelper pointToPoint;
+  pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  pointToPoint.SetChannelAttribute ("Delay", StringValue ("5ms"));
+  NetDeviceContainer devices = pointToPoint.Install (nodes);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  devices.Get (0)->TraceConnectWithoutContext ("MacTxDrop", MakeCallback (&Ns3TcpLargeSendUnsplittableTestCase::MacTxDrop, this));
+  devices.Get (0)->TraceConnectWithoutContext ("PhyTxBegin", MakeCallback (&Ns3TcpLargeSendUnsplittableTestCase::PhyTxBegin, this));
+  nodes.Get (1)->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext ("LocalDeliver", MakeCallback (&Ns3TcpLargeSendUnsplittableTestCase::LocalDeliver, this));
+
+  uint16_t mtu = devices.Get (0)->GetMtu ();
+  uint32_t size = 3 * mtu;
+  LargeSendTag largeSend;
+  largeSend.SetSegmentSize (1000);
+
+  // Handed down to the device: dropped
+  Ptr<Packet> packet = Create<Packet> (size);
+  Ipv4Header ipHeader;
+  ipHeader.SetSource (interfaces.GetAddress (0));
+  ipHeader.SetDestination (interfaces.GetAddress (1));
+  ipHeader.SetProtocol (17);
+  ipHeader.SetPayloadSize (size);
+  packet->AddHeader (ipHeader);
+  packet->AddPacketTag (largeSend);
+  NS_TEST_EXPECT_MSG_EQ (devices.Get (0)->Send (packet, devices.Get (1)->GetAddress (), Ipv4L3Protocol::PROT_NUMBER),
+                         false, "large send which cannot be split accepted by the device");
+  NS_TEST_ASSERT_MSG_EQ (m_drops, 1, "large send which cannot be split not dropped by the device");
+  NS_TEST_ASSERT_MSG_EQ (m_frames.size (), 0, "large send which cannot be split sent by the device");
+
+  // Sent through IPv4: fragmented
+  packet = Create<Packet> (size);
+  packet->AddPacketTag (largeSend);
+  nodes.Get (0)->GetObject<Ipv4L3Protocol> ()->Send (packet, interfaces.GetAddress (0), interfaces.GetAddress (1), 17, 0);
+
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_drops, 1, "fragments dropped by the device");
+  NS_TEST_EXPECT_MSG_EQ (m_taggedFrames, 0, "fragment sent with a LargeSendTag");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (m_largestFrame, mtu, "fragment larger than the MTU");
+  uint32_t fragmentSize = (mtu - 20) & ~uint32_t (0x7);
+  NS_TEST_ASSERT_MSG_EQ (m_frames.size (), (size + fragmentSize - 1) / fragmentSize, "wrong number of fragments");
+  for (uint32_t i = 0; i < m_frames.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_frames[i].GetIdentification (), m_frames[0].GetIdentification (),
+                             "fragment " << i << " of another datagram");
+      NS_TEST_EXPECT_MSG_EQ (m_frames[i].IsLastFragment (), (i + 1 == m_frames.size ()), "wrong last fragment");
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_delivered.size (), 1, "datagram not reassembled");
+  NS_TEST_EXPECT_MSG_EQ (m_delivered[0], size, "datagram reassembled with the wrong size");
+
+  Simulator::Destroy ();
+}
+
+
+class Ns3TcpLargeSendTestSuite : public TestSuite
+{
+public:
+  Ns3TcpLargeSendTestSuite ();
+};
+
+Ns3TcpLargeSendTestSuite::Ns3TcpLargeSendTestSuite ()
+  : TestSuite ("ns3-tcp-large-send", SYSTEM)
+{
+  // Datagrams of a whole MTU; with LLC/SNAP, the datagrams must leave
+  // room for its 8 bytes, as for any datagram sent by a CsmaNetDevice
+  AddTestCase (new Ns3TcpLargeSendTestCase (POINT_TO_POINT, 1460), TestCase::QUICK);
+  AddTestCase (new Ns3TcpLargeSendTestCase (CSMA_DIX, 1460), TestCase::QUICK);
+  AddTestCase (new Ns3TcpLargeSendTestCase (CSMA_LLC, 1452), TestCase::QUICK);
+  // Segments smaller than the MTU
+  AddTestCase (new Ns3TcpLargeSendTestCase (CSMA_LLC, 1000), TestCase::QUICK);
+  AddTestCase (new Ns3TcpLargeSendUnsplittableTestCase, TestCase::QUICK);
+}
+
+static Ns3TcpLargeSendTestSuite ns3TcpLargeSendTestSuite;
@@ -91,38 +91,13 @@ InterferenceHelper::Event::GetTxVector (void) const
 }
 
 
-/****************************************************************
- *       Class which records SNIR change events for a
- *       short period of time.
- ****************************************************************/
-
-InterferenceHelper::NiChange::NiChange (Time time, double delta)
-  : m_time (time),
-    m_delta (delta)
-{
-}
-Time
-InterferenceHelper::NiChange::GetTime (void) const
-{
-  return m_time;
-}
-double
-InterferenceHelper::NiChange::GetDelta (void) const
-{
-  return m_delta;
-}
-bool
-InterferenceHelper::NiChange::operator < (const InterferenceHelper::NiChange& o) const
-{
-  return (m_time < o.m_time);
-}
-
 /****************************************************************
  *       The actual InterferenceHelper
  ****************************************************************/
 
 InterferenceHelper::InterferenceHelper ()
   : m_errorRateModel (0),
+    m_niStart (0),
     m_firstPower (0.0),
     m_rxing (false)
 {
@@ -182,10 +157,10 @@ InterferenceHelper::GetEnergyDuration (double energyW)
   double noiseInterferenceW = 0.0;
   Time end = now;
   noiseInterferenceW = m_firstPower;
-  for (NiChanges::const_iterator i = m_niChanges.begin (); i != m_niChanges.end (); i++)
+  for (uint32_t i = m_niStart; i < m_niTimes.size (); i++)
     {
-      noiseInterferenceW += i->GetDelta ();
-      end = i->GetTime ();
+      noiseInterferenceW += m_niDeltas[i];
+      end = TimeStep (m_niTimes[i]);
       if (end < now)
         {
           continue;
@@ -204,52 +179,83 @@ InterferenceHelper::AppendEvent (Ptr<InterferenceHelper::Event> event)
   Time now = Simulator::Now ();
   if (!m_rxing)
     {
-      NiChanges::iterator nowIterator = GetPosition (now);
-      for (NiChanges::iterator i = m_niChanges.begin (); i != nowIterator; i++)
+      uint32_t nowPosition = GetPosition (now);
+      for (uint32_t i = m_niStart; i < nowPosition; i++)
+        {
+          m_firstPower += m_niDeltas[i];
+        }
+      m_niStart = nowPosition;
+      // All the remaining changes are later than now, so the start of
+      // the new event goes at the head. Reuse the slot of the last
+      // expired change when there is one rather than shifting the arrays.
+      if (m_niStart > 0)
+        {
+          m_niStart--;
+          m_niTimes[m_niStart] = event->GetStartTime ().GetTimeStep ();
+          m_niDeltas[m_niStart] = event->GetRxPowerW ();
+        }
+      else
         {
-          m_firstPower += i->GetDelta ();
+          m_niTimes.insert (m_niTimes.begin (), event->GetStartTime ().GetTimeStep ());
+          m_niDeltas.insert (m_niDeltas.begin (), event->GetRxPowerW ());
         }
-      m_niChanges.erase (m_niChanges.begin (), nowIterator);
-      m_niChanges.insert (m_niChanges.begin (), NiChange (event->GetStartTime (), event->GetRxPowerW ()));
+      CompactNiChanges ();
     }
   else
     {
-      AddNiChangeEvent (NiChange (event->GetStartTime (), event->GetRxPowerW ()));
+      AddNiChangeEvent (event->GetStartTime (), event->GetRxPowerW ());
     }
-  AddNiChangeEvent (NiChange (event->GetEndTime (), -event->GetRxPowerW ()));
+  AddNiChangeEvent (event->GetEndTime (), -event->GetRxPowerW ());
 
 }
 
 
 double
-InterferenceHelper::CalculateSnr (double signal, double noiseInterference, WifiMode mode) const
+InterferenceHelper::CalculateNoiseFloor (WifiMode mode) const
 {
   // thermal noise at 290K in J/s = W
   static const double BOLTZMANN = 1.3803e-23;
   // Nt is the power of thermal noise in W
   double Nt = BOLTZMANN * 290.0 * mode.GetBandwidth ();
   // receiver noise Floor (W) which accounts for thermal noise and non-idealities of the receiver
-  double noiseFloor = m_noiseFigure * Nt;
+  return m_noiseFigure * Nt;
+}
+
+double
+InterferenceHelper::CalculateSnr (double signal, double noiseInterference, WifiMode mode) const
+{
+  double noiseFloor = CalculateNoiseFloor (mode);
   double noise = noiseFloor + noiseInterference;
   double snr = signal / noise;
   return snr;
 }
 
 double
-InterferenceHelper::CalculateNoiseInterferenceW (Ptr<InterferenceHelper::Event> event, NiChanges *ni) const
+InterferenceHelper::CalculateNoiseInterferenceW (Ptr<InterferenceHelper::Event> event) const
 {
   double noiseInterference = m_firstPower;
   NS_ASSERT (m_rxing);
-  for (NiChanges::const_iterator i = m_niChanges.begin () + 1; i != m_niChanges.end (); i++)
+  int64_t endTime = event->GetEndTime ().GetTimeStep ();
+  double endDelta = -event->GetRxPowerW ();
+  // The first live change is the start of the event being received:
+  // find the end of the event among the following changes.
+  uint32_t end = m_niStart + 1;
+  while (end < m_niTimes.size ()
+         && !(m_niTimes[end] == endTime && m_niDeltas[end] == endDelta))
     {
-      if ((event->GetEndTime () == i->GetTime ()) && event->GetRxPowerW () == -i->GetDelta ())
-        {
-          break;
-        }
-      ni->push_back (*i);
+      end++;
+    }
+  uint32_t nChunks = end - m_niStart;
+  m_chunkTimes.resize (nChunks + 1);
+  m_chunkPowers.resize (nChunks);
+  m_chunkTimes[0] = event->GetStartTime ().GetTimeStep ();
+  m_chunkPowers[0] = noiseInterference;
+  for (uint32_t i = 1; i < nChunks; i++)
+    {
+      m_chunkTimes[i] = m_niTimes[m_niStart + i];
+      m_chunkPowers[i] = m_chunkPowers[i - 1] + m_niDeltas[m_niStart + i];
     }
-  ni->insert (ni->begin (), NiChange (event->GetStartTime (), noiseInterference));
-  ni->push_back (NiChange (event->GetEndTime (), 0));
+  m_chunkTimes[nChunks] = endTime;
   return noiseInterference;
 }
 
@@ -267,11 +273,11 @@ InterferenceHelper::CalculateChunkSuccessRate (double snir, Time duration, WifiM
 }
 
 double
-InterferenceHelper::CalculatePer (Ptr<const InterferenceHelper::Event> event, NiChanges *ni) const
+InterferenceHelper::CalculatePer (Ptr<const InterferenceHelper::Event> event) const
 {
   double psr = 1.0; /* Packet Success Rate */
-  NiChanges::iterator j = ni->begin ();
-  Time previous = (*j).GetTime ();
+  uint32_t nChunks = m_chunkPowers.size ();
+  Time previous = TimeStep (m_chunkTimes[0]);
   WifiMode payloadMode = event->GetPayloadMode ();
   WifiPreamble preamble = event->GetPreambleType ();
  WifiMode MfHeaderMode ;
@@ -281,23 +287,29 @@ InterferenceHelper::CalculatePer (Ptr<const InterferenceHelper::Event> event, Ni
 
    }
   WifiMode headerMode = WifiPhy::GetPlcpHeaderMode (payloadMode, preamble);
-  Time plcpHeaderStart = (*j).GetTime () + WifiPhy::GetPlcpPreambleDuration (payloadMode, preamble); //packet start time+ preamble
+  Time plcpHeaderStart = previous + WifiPhy::GetPlcpPreambleDuration (payloadMode, preamble); //packet start time+ preamble
   Time plcpHsigHeaderStart = plcpHeaderStart + WifiPhy::GetPlcpHeaderDuration (payloadMode, preamble);//packet start time+ preamble+L SIG
   Time plcpHtTrainingSymbolsStart = plcpHsigHeaderStart + WifiPhy::GetPlcpHtSigHeaderDuration (payloadMode, preamble);//packet start time+ preamble+L SIG+HT SIG
   Time plcpPayloadStart =plcpHtTrainingSymbolsStart + WifiPhy::GetPlcpHtTrainingSymbolDuration (preamble,event->GetTxVector()); //packet start time+ preamble+L SIG+HT SIG+Training
-  double noiseInterferenceW = (*j).GetDelta ();
   double powerW = event->GetRxPowerW ();
-    j++;
-  while (ni->end () != j)
+  // Most chunks lie in the payload: compute their SNR in one pass over
+  // the contiguous chunk powers.
+  double payloadNoiseFloor = CalculateNoiseFloor (payloadMode);
+  m_chunkSnrs.resize (nChunks);
+  for (uint32_t k = 0; k < nChunks; k++)
     {
-      Time current = (*j).GetTime ();
+      m_chunkSnrs[k] = powerW / (payloadNoiseFloor + m_chunkPowers[k]);
+    }
+  for (uint32_t k = 0; k < nChunks; k++)
+    {
+      Time current = TimeStep (m_chunkTimes[k + 1]);
+      double noiseInterferenceW = m_chunkPowers[k];
+      double payloadSnr = m_chunkSnrs[k];
       NS_ASSERT (current >= previous);
       //Case 1: Both prev and curr point to the payload
       if (previous >= plcpPayloadStart)
         {
-          psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
-                                                          noiseInterferenceW,
-                                                          payloadMode),
+          psr *= CalculateChunkSuccessRate (payloadSnr,
                                             current - previous,
                                             payloadMode);
         }
@@ -308,9 +320,7 @@ InterferenceHelper::CalculatePer (Ptr<const InterferenceHelper::Event> event, Ni
           if (current >= plcpPayloadStart)
             { 
                //Case 2ai and 2aii: All formats
-               psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
-                                                              noiseInterferenceW,
-                                                              payloadMode),
+               psr *= CalculateChunkSuccessRate (payloadSnr,
                                                 current - plcpPayloadStart,
                                                 payloadMode);
                 
@@ -322,9 +332,7 @@ InterferenceHelper::CalculatePer (Ptr<const InterferenceHelper::Event> event, Ni
           //Case 3a: cuurent after payload start
           if (current >=plcpPayloadStart)
              {
-                   psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
-                                                              noiseInterferenceW,
-                                                              payloadMode),
+                   psr *= CalculateChunkSuccessRate (payloadSnr,
                                                 current - plcpPayloadStart,
                                                 payloadMode);
                  
@@ -361,9 +369,7 @@ InterferenceHelper::CalculatePer (Ptr<const InterferenceHelper::Event> event, Ni
           //Case 4a: current after payload start  
           if (current >=plcpPayloadStart)
              {
-                   psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
-                                                              noiseInterferenceW,
-                                                              payloadMode),
+                   psr *= CalculateChunkSuccessRate (payloadSnr,
                                                       current - plcpPayloadStart,
                                                       payloadMode);
                     //Case 4ai: Non HT format (No HT-SIG or Training Symbols)
@@ -446,9 +452,7 @@ InterferenceHelper::CalculatePer (Ptr<const InterferenceHelper::Event> event, Ni
           if (current >= plcpPayloadStart)
             {
               //for all
-              psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
-                                                              noiseInterferenceW,
-                                                              payloadMode),
+              psr *= CalculateChunkSuccessRate (payloadSnr,
                                                 current - plcpPayloadStart,
                                                 payloadMode); 
              
@@ -528,9 +532,7 @@ InterferenceHelper::CalculatePer (Ptr<const InterferenceHelper::Event> event, Ni
             }
         }
 
-      noiseInterferenceW += (*j).GetDelta ();
-      previous = (*j).GetTime ();
-      j++;
+      previous = current;
     }
 
   double per = 1 - psr;
@@ -541,8 +543,7 @@ InterferenceHelper::CalculatePer (Ptr<const InterferenceHelper::Event> event, Ni
 struct InterferenceHelper::SnrPer
 InterferenceHelper::CalculateSnrPer (Ptr<InterferenceHelper::Event> event)
 {
-  NiChanges ni;
-  double noiseInterferenceW = CalculateNoiseInterferenceW (event, &ni);
+  double noiseInterferenceW = CalculateNoiseInterferenceW (event);
   double snr = CalculateSnr (event->GetRxPowerW (),
                              noiseInterferenceW,
                              event->GetPayloadMode ());
@@ -550,7 +551,7 @@ InterferenceHelper::CalculateSnrPer (Ptr<InterferenceHelper::Event> event)
   /* calculate the SNIR at the start of the packet and accumulate
    * all SNIR changes in the snir vector.
    */
-  double per = CalculatePer (event, &ni);
+  double per = CalculatePer (event);
 
   struct SnrPer snrPer;
   snrPer.snr = snr;
@@ -561,20 +562,41 @@ InterferenceHelper::CalculateSnrPer (Ptr<InterferenceHelper::Event> event)
 void
 InterferenceHelper::EraseEvents (void)
 {
-  m_niChanges.clear ();
+  m_niTimes.clear ();
+  m_niDeltas.clear ();
+  m_niStart = 0;
   m_rxing = false;
   m_firstPower = 0.0;
 }
-InterferenceHelper::NiChanges::iterator
-InterferenceHelper::GetPosition (Time moment)
+uint32_t
+InterferenceHelper::GetPosition (Time moment) const
 {
-  return std::upper_bound (m_niChanges.begin (), m_niChanges.end (), NiChange (moment, 0));
-
+  return std::upper_bound (m_niTimes.begin () + m_niStart, m_niTimes.end (), moment.GetTimeStep ())
+         - m_niTimes.begin ();
+}
+void
+InterferenceHelper::AddNiChangeEvent (Time time, double delta)
+{
+  uint32_t position = GetPosition (time);
+  if (position == m_niTimes.size ())
+    {
+      m_niTimes.push_back (time.GetTimeStep ());
+      m_niDeltas.push_back (delta);
+      return;
+    }
+  m_niTimes.insert (m_niTimes.begin () + position, time.GetTimeStep ());
+  m_niDeltas.insert (m_niDeltas.begin () + position, delta);
 }
 void
-InterferenceHelper::AddNiChangeEvent (NiChange change)
+InterferenceHelper::CompactNiChanges (void)
 {
-  m_niChanges.insert (GetPosition (change.GetTime ()), change);
+  if (m_niStart == 0 || 2 * m_niStart < m_niTimes.size ())
+    {
+      return;
+    }
+  m_niTimes.erase (m_niTimes.begin (), m_niTimes.begin () + m_niStart);
+  m_niDeltas.erase (m_niDeltas.begin (), m_niDeltas.begin () + m_niStart);
+  m_niStart = 0;
 }
 void
 InterferenceHelper::NotifyRxStart ()
@@ -203,45 +203,18 @@ private:
   void EraseEvents (void);
 private:
   /**
-   * Noise and Interference (thus Ni) event.
+   * The noise and interference (thus Ni) changes are stored as a
+   * structure of arrays: one array holds the time (in time steps) of
+   * each change and a parallel array holds the power change (W) at
+   * that time. Both arrays are kept sorted by time so that the
+   * accumulation loops run over contiguous memory and can be
+   * vectorized by the compiler.
    */
-  class NiChange
-  {
-public:
-    /**
-     * Create a NiChange at the given time and the amount of NI change.
-     *
-     * \param time time of the event
-     * \param delta the power
-     */
-    NiChange (Time time, double delta);
-    /**
-     * Return the event time.
-     *
-     * \return the event time.
-     */
-    Time GetTime (void) const;
-    /**
-     * Return the power
-     *
-     * \return the power
-     */
-    double GetDelta (void) const;
-    /**
-     * Compare the event time of two NiChange objects (a < o).
-     *
-     * \param o
-     * \return true if a < o.time, false otherwise
-     */
-    bool operator < (const NiChange& o) const;
-private:
-    Time m_time;
-    double m_delta;
-  };
+  typedef std::vector<int64_t> NiTimes;
   /**
-   * typedef for a vector of NiChanges
+   * typedef for an array of powers (W)
    */
-  typedef std::vector <NiChange> NiChanges;
+  typedef std::vector<double> NiPowers;
   /**
    * typedef for a list of Events
    */
@@ -256,13 +229,16 @@ private:
    */
   void AppendEvent (Ptr<Event> event);
   /**
-   * Calculate noise and interference power in W.
+   * Calculate noise and interference power in W at the start of the
+   * given event, and fill m_chunkTimes and m_chunkPowers with the
+   * piecewise-constant noise and interference seen by the event:
+   * chunk i spans [m_chunkTimes[i], m_chunkTimes[i+1]) with a
+   * noise and interference power of m_chunkPowers[i].
    *
    * \param event
-   * \param ni
    * \return noise and interference power
    */
-  double CalculateNoiseInterferenceW (Ptr<Event> event, NiChanges *ni) const;
+  double CalculateNoiseInterferenceW (Ptr<Event> event) const;
   /**
    * Calculate SNR (linear ratio) from the given signal power and noise+interference power.
    * (Mode is not currently used)
@@ -273,6 +249,13 @@ private:
    * \return SNR in liear ratio
    */
   double CalculateSnr (double signal, double noiseInterference, WifiMode mode) const;
+  /**
+   * Calculate the receiver noise floor (W) for the given Wi-Fi mode.
+   *
+   * \param mode
+   * \return the noise floor (W)
+   */
+  double CalculateNoiseFloor (WifiMode mode) const;
   /**
    * Calculate the success rate of the chunk given the SINR, duration, and Wi-Fi mode.
    * The duration and mode are used to calculate how many bits are present in the chunk.
@@ -284,29 +267,51 @@ private:
    */
   double CalculateChunkSuccessRate (double snir, Time duration, WifiMode mode) const;
   /**
-   * Calculate the error rate of the given packet. The packet can be divided into
+   * Calculate the error rate of the given packet from the chunks computed
+   * by CalculateNoiseInterferenceW. The packet can be divided into
    * multiple chunks (e.g. due to interference from other transmissions).
    *
    * \param event
-   * \param ni
    * \return the error rate of the packet
    */
-  double CalculatePer (Ptr<const Event> event, NiChanges *ni) const;
+  double CalculatePer (Ptr<const Event> event) const;
 
   double m_noiseFigure; /**< noise figure (linear) */
   Ptr<ErrorRateModel> m_errorRateModel;
   /// Experimental: needed for energy duration calculation
-  NiChanges m_niChanges;
+  NiTimes m_niTimes;   //!< time (in time steps) of each Ni change
+  NiPowers m_niDeltas; //!< power change (W) of each Ni change
+  /**
+   * Index of the first Ni change still relevant. The changes before it
+   * have already been folded into m_firstPower and are only physically
+   * removed from the arrays once they make up half of them, so that
+   * the cost of the removal is amortized over many events.
+   */
+  uint32_t m_niStart;
   double m_firstPower;
   bool m_rxing;
-  /// Returns an iterator to the first nichange, which is later than moment
-  NiChanges::iterator GetPosition (Time moment);
+  mutable NiTimes m_chunkTimes;   //!< scratch chunk boundaries, reused across receptions
+  mutable NiPowers m_chunkPowers; //!< scratch chunk noise and interference powers (W)
+  mutable NiPowers m_chunkSnrs;   //!< scratch chunk payload SNRs
+  /**
+   * Returns the index of the first Ni change which is later than moment.
+   *
+   * \param moment
+   * \return the index of the first Ni change later than moment
+   */
+  uint32_t GetPosition (Time moment) const;
   /**
-   * Add NiChange to the list at the appropriate position.
+   * Add an Ni change to the arrays at the appropriate position.
    *
-   * \param change
+   * \param time time of the change
+   * \param delta the power change (W)
+   */
+  void AddNiChangeEvent (Time time, double delta);
+  /**
+   * Physically remove the Ni changes located before m_niStart if they
+   * make up at least half of the arrays.
    */
-  void AddNiChangeEvent (NiChange change);
+  void CompactNiChanges (void);
 };
 
 } // namespace ns3
@@ -24,11 +24,16 @@
 #include "ns3/node.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
 #include "ns3/object-factory.h"
 #include "yans-wifi-channel.h"
 #include "yans-wifi-phy.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/propagation-delay-model.h"
+#include <algorithm>
+#include <limits>
+#include <cmath>
 
 namespace ns3 {
 
@@ -36,6 +41,43 @@ NS_LOG_COMPONENT_DEFINE ("YansWifiChannel");
 
 NS_OBJECT_ENSURE_REGISTERED (YansWifiChannel);
 
+YansWifiChannel::TxParamsFreeList YansWifiChannel::m_txParamsFreeList;
+bool YansWifiChannel::m_txParamsRecycling = true;
+
+YansWifiChannel::TxParamsFreeList::~TxParamsFreeList ()
+{
+  for (iterator i = begin (); i != end (); i++)
+    {
+      delete *i;
+    }
+  YansWifiChannel::m_txParamsRecycling = false;
+}
+
+void
+YansWifiChannel::TxParamsRecycler::Delete (TxParams *params)
+{
+  if (!m_txParamsRecycling || m_txParamsFreeList.size () > 1000)
+    {
+      delete params;
+      return;
+    }
+  params->packet = 0;
+  m_txParamsFreeList.push_back (params);
+}
+
+Ptr<YansWifiChannel::TxParams>
+YansWifiChannel::CreateTxParams (void)
+{
+  if (m_txParamsFreeList.empty ())
+    {
+      return Create<TxParams> ();
+    }
+  TxParams *params = m_txParamsFreeList.back ();
+  m_txParamsFreeList.pop_back ();
+  // the recycled instance is not referenced anymore: take a reference
+  return Ptr<TxParams> (params);
+}
+
 TypeId
 YansWifiChannel::GetTypeId (void)
 {
@@ -50,11 +92,30 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("SpatialIndexing",
+                   "If true, only deliver packets to the PHYs which are close enough to detect them, "
+                   "using a grid of the PHY positions.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansWifiChannel::m_spatialIndexing),
+                   MakeBooleanChecker ())
+    .AddAttribute ("SpatialCellSize",
+                   "The size (m) of the cells of the grid used when SpatialIndexing is true.",
+                   DoubleValue (500.0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_cellSize),
+                   MakeDoubleChecker<double> (1.0))
+    .AddAttribute ("MaxRange",
+                   "The distance (m) beyond which PHYs are ignored when SpatialIndexing is true. "
+                   "If zero, it is derived from the propagation loss model and the tx power.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_maxRange),
+                   MakeDoubleChecker<double> (0.0))
   ;
   return tid;
 }
 
 YansWifiChannel::YansWifiChannel ()
+  : m_maxSpeed (0.0),
+    m_minRxThresholdDbm (0.0)
 {
 }
 YansWifiChannel::~YansWifiChannel ()
@@ -63,6 +124,28 @@ YansWifiChannel::~YansWifiChannel ()
   m_phyList.clear ();
 }
 
+void
+YansWifiChannel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  // the course change callbacks were connected from a const method
+  const YansWifiChannel *self = this;
+  for (std::vector<IndexedPhy>::iterator i = m_indexedPhys.begin (); i != m_indexedPhys.end (); ++i)
+    {
+      MobilityPhys::iterator j = m_mobilityPhys.find (PeekPointer (i->mobility));
+      if (j != m_mobilityPhys.end ())
+        {
+          i->mobility->TraceDisconnectWithoutContext ("CourseChange",
+                                                      MakeCallback (&YansWifiChannel::CourseChanged, self));
+          m_mobilityPhys.erase (j);
+        }
+    }
+  m_indexedPhys.clear ();
+  m_grid.clear ();
+  m_candidates.clear ();
+  WifiChannel::DoDispose ();
+}
+
 void
 YansWifiChannel::SetPropagationLossModel (Ptr<PropagationLossModel> loss)
 {
@@ -80,6 +163,19 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
 {
   Ptr<MobilityModel> senderMobility = sender->GetMobility ()->GetObject<MobilityModel> ();
   NS_ASSERT (senderMobility != 0);
+  Ptr<TxParams> params = CreateTxParams ();
+  params->packet = packet;
+  params->txVector = txVector;
+  params->preamble = preamble;
+  params->packetType = packetType;
+  params->duration = duration;
+  if (m_spatialIndexing)
+    {
+      SendIndexed (sender, senderMobility, txPowerDbm, params);
+      return;
+    }
+  m_rxPhys.clear ();
+  m_rxMobilities.clear ();
   uint32_t j = 0;
   for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++, j++)
     {
@@ -90,42 +186,222 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
             {
               continue;
             }
+          m_rxPhys.push_back (j);
+          m_rxMobilities.push_back ((*i)->GetMobility ()->GetObject<MobilityModel> ());
+        }
+    }
+  m_loss->CalcRxPowerBatch (txPowerDbm, senderMobility, m_rxMobilities, m_rxPowersDbm);
+  for (uint32_t k = 0; k < m_rxPhys.size (); k++)
+    {
+      Ptr<MobilityModel> receiverMobility = m_rxMobilities[k];
+      Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
+      NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << m_rxPowersDbm[k] << "dbm, " <<
+                    "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
+      ScheduleReceive (m_rxPhys[k], m_rxPowersDbm[k], delay, params);
+    }
+}
 
-          Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
-          Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
-          double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
-          NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
-                        "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
-          Ptr<Packet> copy = packet->Copy ();
-          Ptr<Object> dstNetDevice = m_phyList[j]->GetDevice ();
-          uint32_t dstNode;
-          if (dstNetDevice == 0)
-            {
-              dstNode = 0xffffffff;
-            }
-          else
-            {
-              dstNode = dstNetDevice->GetObject<NetDevice> ()->GetNode ()->GetId ();
-            }
+void
+YansWifiChannel::SendIndexed (Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility,
+                              double txPowerDbm, Ptr<TxParams> params) const
+{
+  if (m_indexedPhys.size () != m_phyList.size ())
+    {
+      IndexNewPhys ();
+    }
+  // A PHY may have moved by up to m_maxSpeed * (now - m_lastRebuild) since
+  // it was stored in its cell: rebuild the index before that drift grows
+  // larger than a cell.
+  double drift = m_maxSpeed * (Simulator::Now () - m_lastRebuild).GetSeconds ();
+  if (drift > m_cellSize / 2)
+    {
+      RebuildIndex ();
+      drift = 0;
+    }
+  double range = m_maxRange;
+  if (range == 0)
+    {
+      range = m_loss->GetMaxRange (txPowerDbm, m_minRxThresholdDbm);
+    }
+  NS_LOG_DEBUG ("indexed send: txPower=" << txPowerDbm << "dbm, range=" << range << "m, drift=" << drift << "m");
+  FindCandidates (senderMobility->GetPosition (), range + drift);
 
-          double *atts = new double[3];
-          *atts = rxPowerDbm;
-          *(atts+1)= packetType;
-          *(atts+2)= duration.GetNanoSeconds();
+  m_rxPhys.clear ();
+  m_rxMobilities.clear ();
+  for (std::vector<uint32_t>::const_iterator i = m_candidates.begin (); i != m_candidates.end (); i++)
+    {
+      Ptr<YansWifiPhy> phy = m_phyList[*i];
+      if (phy == sender || phy->GetChannelNumber () != sender->GetChannelNumber ())
+        {
+          continue;
+        }
+      m_rxPhys.push_back (*i);
+      m_rxMobilities.push_back (m_indexedPhys[*i].mobility);
+    }
+  m_loss->CalcRxPowerBatch (txPowerDbm, senderMobility, m_rxMobilities, m_rxPowersDbm);
+  for (uint32_t k = 0; k < m_rxPhys.size (); k++)
+    {
+      double rxPowerDbm = m_rxPowersDbm[k];
+      if (rxPowerDbm < GetRxThresholdDbm (m_phyList[m_rxPhys[k]]))
+        {
+          NS_LOG_DEBUG ("drop reception below the thresholds of phy " << m_rxPhys[k] << ": rxPower=" << rxPowerDbm << "dbm");
+          continue;
+        }
+      Ptr<MobilityModel> receiverMobility = m_rxMobilities[k];
+      Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
+      NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
+                    "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
+      ScheduleReceive (m_rxPhys[k], rxPowerDbm, delay, params);
+    }
+}
 
-          Simulator::ScheduleWithContext (dstNode,
-                                          delay, &YansWifiChannel::Receive, this,
-                                          j, copy, atts, txVector, preamble);
+void
+YansWifiChannel::ScheduleReceive (uint32_t i, double rxPowerDbm, Time delay, Ptr<TxParams> params) const
+{
+  Ptr<Object> dstNetDevice = m_phyList[i]->GetDevice ();
+  uint32_t dstNode;
+  if (dstNetDevice == 0)
+    {
+      dstNode = 0xffffffff;
+    }
+  else
+    {
+      dstNode = dstNetDevice->GetObject<NetDevice> ()->GetNode ()->GetId ();
+    }
+
+  Simulator::ScheduleWithContext (dstNode,
+                                  delay, &YansWifiChannel::Receive, this,
+                                  i, rxPowerDbm, params);
+}
+
+void
+YansWifiChannel::Receive (uint32_t i, double rxPowerDbm, Ptr<TxParams> params) const
+{
+  m_phyList[i]->StartReceivePacket (params->packet->Copy (), rxPowerDbm, params->txVector,
+                                    params->preamble, params->packetType, params->duration);
+}
+
+double
+YansWifiChannel::GetRxThresholdDbm (Ptr<YansWifiPhy> phy)
+{
+  return std::min (phy->GetEdThreshold (), phy->GetCcaMode1Threshold ()) - phy->GetRxGain ();
+}
+
+void
+YansWifiChannel::IndexNewPhys (void) const
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = m_indexedPhys.size (); i < m_phyList.size (); i++)
+    {
+      IndexedPhy entry;
+      entry.mobility = m_phyList[i]->GetMobility ()->GetObject<MobilityModel> ();
+      NS_ASSERT_MSG (entry.mobility != 0, "PHY " << i << " has no mobility model");
+      entry.cell = Cell (std::numeric_limits<int32_t>::max (), std::numeric_limits<int32_t>::max ());
+      m_indexedPhys.push_back (entry);
+      std::vector<uint32_t> &phys = m_mobilityPhys[PeekPointer (entry.mobility)];
+      if (phys.empty ())
+        {
+          entry.mobility->TraceConnectWithoutContext ("CourseChange",
+                                                      MakeCallback (&YansWifiChannel::CourseChanged, this));
+        }
+      phys.push_back (i);
+    }
+  RebuildIndex ();
+}
+
+void
+YansWifiChannel::UpdateCell (uint32_t i) const
+{
+  IndexedPhy &entry = m_indexedPhys[i];
+  Vector position = entry.mobility->GetPosition ();
+  Cell cell (static_cast<int32_t> (std::floor (position.x / m_cellSize)),
+             static_cast<int32_t> (std::floor (position.y / m_cellSize)));
+  if (cell == entry.cell)
+    {
+      return;
+    }
+  Grid::iterator old = m_grid.find (entry.cell);
+  if (old != m_grid.end ())
+    {
+      std::vector<uint32_t> &phys = old->second;
+      phys.erase (std::find (phys.begin (), phys.end (), i));
+      if (phys.empty ())
+        {
+          m_grid.erase (old);
         }
     }
+  m_grid[cell].push_back (i);
+  entry.cell = cell;
+}
+
+void
+YansWifiChannel::RebuildIndex (void) const
+{
+  NS_LOG_FUNCTION (this);
+  m_maxSpeed = 0;
+  m_minRxThresholdDbm = std::numeric_limits<double>::infinity ();
+  for (uint32_t i = 0; i < m_indexedPhys.size (); i++)
+    {
+      UpdateCell (i);
+      Vector velocity = m_indexedPhys[i].mobility->GetVelocity ();
+      m_maxSpeed = std::max (m_maxSpeed, CalculateDistance (velocity, Vector (0, 0, 0)));
+      m_minRxThresholdDbm = std::min (m_minRxThresholdDbm, GetRxThresholdDbm (m_phyList[i]));
+    }
+  m_lastRebuild = Simulator::Now ();
 }
 
 void
-YansWifiChannel::Receive (uint32_t i, Ptr<Packet> packet, double *atts,
-                          WifiTxVector txVector, WifiPreamble preamble) const
+YansWifiChannel::CourseChanged (Ptr<const MobilityModel> mobility) const
 {
-  m_phyList[i]->StartReceivePacket (packet, *atts, txVector, preamble,*(atts+1), NanoSeconds(*(atts+2)));
-  delete[] atts;
+  MobilityPhys::const_iterator phys = m_mobilityPhys.find (PeekPointer (mobility));
+  if (phys == m_mobilityPhys.end ())
+    {
+      return;
+    }
+  for (std::vector<uint32_t>::const_iterator i = phys->second.begin (); i != phys->second.end (); i++)
+    {
+      UpdateCell (*i);
+    }
+  Vector velocity = mobility->GetVelocity ();
+  m_maxSpeed = std::max (m_maxSpeed, CalculateDistance (velocity, Vector (0, 0, 0)));
+}
+
+void
+YansWifiChannel::FindCandidates (Vector position, double radius) const
+{
+  m_candidates.clear ();
+  double minX = std::floor ((position.x - radius) / m_cellSize);
+  double maxX = std::floor ((position.x + radius) / m_cellSize);
+  double minY = std::floor ((position.y - radius) / m_cellSize);
+  double maxY = std::floor ((position.y + radius) / m_cellSize);
+  if ((maxX - minX + 1) * (maxY - minY + 1) > m_grid.size ())
+    {
+      // the disc covers more cells than there are occupied ones
+      for (Grid::const_iterator i = m_grid.begin (); i != m_grid.end (); i++)
+        {
+          if (i->first.first >= minX && i->first.first <= maxX
+              && i->first.second >= minY && i->first.second <= maxY)
+            {
+              m_candidates.insert (m_candidates.end (), i->second.begin (), i->second.end ());
+            }
+        }
+    }
+  else
+    {
+      for (int32_t x = static_cast<int32_t> (minX); x <= static_cast<int32_t> (maxX); x++)
+        {
+          for (int32_t y = static_cast<int32_t> (minY); y <= static_cast<int32_t> (maxY); y++)
+            {
+              Grid::const_iterator i = m_grid.find (Cell (x, y));
+              if (i != m_grid.end ())
+                {
+                  m_candidates.insert (m_candidates.end (), i->second.begin (), i->second.end ());
+                }
+            }
+        }
+    }
+  // deliver in the same order as the brute-force loop
+  std::sort (m_candidates.begin (), m_candidates.end ());
 }
 
 uint32_t
@@ -21,17 +21,21 @@
 #define YANS_WIFI_CHANNEL_H
 
 #include <vector>
+#include <map>
 #include <stdint.h>
 #include "ns3/packet.h"
+#include "ns3/simple-ref-count.h"
 #include "wifi-channel.h"
 #include "wifi-mode.h"
 #include "wifi-preamble.h"
 #include "wifi-tx-vector.h"
 #include "ns3/nstime.h"
+#include "ns3/vector.h"
 
 namespace ns3 {
 
 class NetDevice;
+class MobilityModel;
 class PropagationLossModel;
 class PropagationDelayModel;
 class YansWifiPhy;
@@ -47,6 +51,19 @@ class YansWifiPhy;
  * class and contains a ns3::PropagationLossModel and a ns3::PropagationDelayModel.
  * By default, no propagation models are set so, it is the caller's responsability
  * to set them before using the channel.
+ *
+ * By default, every transmission is delivered to every PHY operating on the
+ * same channel number, whatever its distance from the sender. When the
+ * SpatialIndexing attribute is set, the channel instead keeps the PHYs in a
+ * grid of SpatialCellSize cells, updated when their mobility model reports
+ * a course change, and only considers the PHYs located within the range
+ * returned by PropagationLossModel::GetMaxRange (or MaxRange if set) for
+ * the lowest energy detection/CCA threshold of the PHYs. Receptions whose
+ * power is below both the energy detection and CCA mode 1 thresholds of
+ * their receiver are then dropped by the channel instead of being
+ * scheduled, so that weak signals no longer contribute to the interference
+ * seen by the receivers. Between two course changes, the mobility models
+ * are assumed to move at constant velocity.
  */
 class YansWifiChannel : public WifiChannel
 {
@@ -103,6 +120,9 @@ public:
   */
   int64_t AssignStreams (int64_t stream);
 
+protected:
+  virtual void DoDispose (void);
+
 private:
   //YansWifiChannel& operator = (const YansWifiChannel &);
   //YansWifiChannel (const YansWifiChannel &);
@@ -111,24 +131,152 @@ private:
    * A vector of pointers to YansWifiPhy.
    */
   typedef std::vector<Ptr<YansWifiPhy> > PhyList;
+  class TxParams;
+  /**
+   * Recycles the TxParams which are not referenced anymore.
+   */
+  struct TxParamsRecycler
+  {
+    /**
+     * \param params the TxParams to recycle
+     */
+    static void Delete (TxParams *params);
+  };
+  /**
+   * The parameters of a transmission which are common to all its
+   * receptions. A single instance is shared by all the receptions of a
+   * frame so that only the rx power is stored per receiver, and the
+   * instances are recycled once all the receptions are done.
+   */
+  class TxParams : public SimpleRefCount<TxParams, empty, TxParamsRecycler>
+  {
+public:
+    Ptr<const Packet> packet; //!< the packet being sent
+    WifiTxVector txVector;    //!< the TXVECTOR of the packet
+    WifiPreamble preamble;    //!< the type of preamble being used to send the packet
+    uint8_t packetType;       //!< the type of packet, used for A-MPDU
+    Time duration;            //!< the transmission duration of the packet
+  };
+  /**
+   * Holds the recycled TxParams until they are reused.
+   */
+  class TxParamsFreeList : public std::vector<TxParams *>
+  {
+public:
+    ~TxParamsFreeList ();
+  };
+  /**
+   * \return a TxParams, reused from the free list when possible
+   */
+  static Ptr<TxParams> CreateTxParams (void);
+
   /**
    * This method is scheduled by Send for each associated YansWifiPhy.
    * The method then calls the corresponding YansWifiPhy that the first
    * bit of the packet has arrived.
    *
    * \param i index of the corresponding YansWifiPhy in the PHY list
-   * \param packet the packet being sent
-   * \param atts a vector containing the received power in dBm and the packet type
-   * \param txVector the TXVECTOR of the packet
-   * \param preamble the type of preamble being used to send the packet
+   * \param rxPowerDbm the received power (dBm)
+   * \param params the parameters of the transmission
+   */
+  void Receive (uint32_t i, double rxPowerDbm, Ptr<TxParams> params) const;
+  /**
+   * Schedule the reception of a transmission by the given YansWifiPhy.
+   *
+   * \param i index of the corresponding YansWifiPhy in the PHY list
+   * \param rxPowerDbm the received power (dBm)
+   * \param delay the propagation delay
+   * \param params the parameters of the transmission
+   */
+  void ScheduleReceive (uint32_t i, double rxPowerDbm, Time delay, Ptr<TxParams> params) const;
+  /**
+   * Send the packet only to the PHYs of the spatial index which may
+   * detect it.
+   *
+   * \param sender the device from which the packet is originating
+   * \param senderMobility the mobility model of the sender
+   * \param txPowerDbm the tx power associated to the packet
+   * \param params the parameters of the transmission
    */
-  void Receive (uint32_t i, Ptr<Packet> packet, double *atts,
-                WifiTxVector txVector, WifiPreamble preamble) const;
+  void SendIndexed (Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility,
+                    double txPowerDbm, Ptr<TxParams> params) const;
+  /**
+   * Insert in the spatial index the PHYs added since the last call.
+   */
+  void IndexNewPhys (void) const;
+  /**
+   * Move the given PHY to the cell of its current position.
+   *
+   * \param i index of the corresponding YansWifiPhy in the PHY list
+   */
+  void UpdateCell (uint32_t i) const;
+  /**
+   * Move all the PHYs to the cell of their current position, and
+   * refresh the maximum speed and the lowest rx threshold of the PHYs.
+   */
+  void RebuildIndex (void) const;
+  /**
+   * Callback invoked when the mobility model of an indexed PHY changes course.
+   *
+   * \param mobility the mobility model
+   */
+  void CourseChanged (Ptr<const MobilityModel> mobility) const;
+  /**
+   * Fill m_candidates with the sorted indices of the PHYs which may be
+   * located within the given radius of the given position.
+   *
+   * \param position the center of the search disc
+   * \param radius the radius (m) of the search disc
+   */
+  void FindCandidates (Vector position, double radius) const;
+  /**
+   * \param phy the PHY
+   * \return the rx power (dBm, before rx gain) below which the PHY
+   *         ignores a signal.
+   */
+  static double GetRxThresholdDbm (Ptr<YansWifiPhy> phy);
 
+  /**
+   * A cell of the spatial index.
+   */
+  typedef std::pair<int32_t, int32_t> Cell;
+  /**
+   * The spatial index: the indices of the PHYs located in each cell.
+   */
+  typedef std::map<Cell, std::vector<uint32_t> > Grid;
+  /**
+   * An entry of the spatial index.
+   */
+  struct IndexedPhy
+  {
+    Ptr<MobilityModel> mobility; //!< mobility model of the PHY
+    Cell cell;                   //!< cell in which the PHY is stored
+  };
+  /**
+   * The PHYs sharing a given mobility model.
+   */
+  typedef std::map<const MobilityModel *, std::vector<uint32_t> > MobilityPhys;
 
   PhyList m_phyList; //!< List of YansWifiPhys connected to this YansWifiChannel
   Ptr<PropagationLossModel> m_loss; //!< Propagation loss model
   Ptr<PropagationDelayModel> m_delay; //!< Propagation delay model
+
+  bool m_spatialIndexing; //!< whether the spatial index is used
+  double m_cellSize;      //!< size (m) of the cells of the spatial index
+  double m_maxRange;      //!< user-provided max range (m), zero to derive it from m_loss
+  mutable std::vector<IndexedPhy> m_indexedPhys; //!< spatial index entries, parallel to m_phyList
+  mutable Grid m_grid;                   //!< spatial index
+  mutable MobilityPhys m_mobilityPhys;   //!< indexed PHYs per mobility model
+  mutable double m_maxSpeed;             //!< max speed (m/s) of the PHYs since m_lastRebuild
+  mutable Time m_lastRebuild;            //!< last time all the PHYs were re-inserted
+  mutable double m_minRxThresholdDbm;    //!< lowest rx threshold of the PHYs
+  mutable std::vector<uint32_t> m_candidates; //!< scratch list of candidate receivers
+  mutable std::vector<uint32_t> m_rxPhys;                   //!< scratch indices of the receivers of a transmission
+  mutable std::vector<Ptr<MobilityModel> > m_rxMobilities;  //!< scratch mobility models of the receivers
+  mutable std::vector<double> m_rxPowersDbm;                //!< scratch rx powers (dBm) of the receivers
+
+  static TxParamsFreeList m_txParamsFreeList; //!< recycled TxParams
+  static bool m_txParamsRecycling;            //!< false once the free list is destroyed
 };
 
 } // namespace ns3
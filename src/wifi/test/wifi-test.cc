@@ -29,7 +29,9 @@
 #include "ns3/propagation-loss-model.h"
 #include "ns3/error-rate-model.h"
 #include "ns3/yans-error-rate-model.h"
+#include "ns3/interference-helper.h"
 #include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
 #include "ns3/node.h"
 #include "ns3/simulator.h"
 #include "ns3/test.h"
@@ -41,6 +43,9 @@
 #include "ns3/edca-txop-n.h"
 #include "ns3/config.h"
 #include "ns3/boolean.h"
+#include "ns3/double.h"
+#include <sstream>
+#include <cstdlib>
 
 using namespace ns3;
 
@@ -322,6 +327,263 @@ InterferenceHelperSequenceTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+//-----------------------------------------------------------------------------
+/**
+ * Make sure that the noise and interference changes which expire and
+ * are compacted away by a long-running InterferenceHelper do not alter
+ * the energy duration and the SNR/PER seen by a later reception: an
+ * "aged" helper which has seen many past events must report exactly
+ * what a "fresh" helper which only sees the final events reports.
+ */
+class InterferenceHelperCompactionTest : public TestCase
+{
+public:
+  InterferenceHelperCompactionTest ();
+
+  virtual void DoRun (void);
+private:
+  void AddPastEvent (void);
+  void StartRx (void);
+  void AddInterferer (void);
+  void CheckEnergyDuration (void);
+  void EndRx (void);
+
+  InterferenceHelper m_aged;
+  InterferenceHelper m_fresh;
+  Ptr<InterferenceHelper::Event> m_agedEvent;
+  Ptr<InterferenceHelper::Event> m_freshEvent;
+  WifiMode m_mode;
+  WifiTxVector m_txVector;
+};
+
+InterferenceHelperCompactionTest::InterferenceHelperCompactionTest ()
+  : TestCase ("InterferenceHelperCompaction")
+{
+}
+
+void
+InterferenceHelperCompactionTest::AddPastEvent (void)
+{
+  m_aged.Add (1000, m_mode, WIFI_PREAMBLE_LONG, MicroSeconds (100), 1e-10, m_txVector);
+}
+
+void
+InterferenceHelperCompactionTest::StartRx (void)
+{
+  m_agedEvent = m_aged.Add (1000, m_mode, WIFI_PREAMBLE_LONG, MicroSeconds (2000), 1e-9, m_txVector);
+  m_freshEvent = m_fresh.Add (1000, m_mode, WIFI_PREAMBLE_LONG, MicroSeconds (2000), 1e-9, m_txVector);
+  m_aged.NotifyRxStart ();
+  m_fresh.NotifyRxStart ();
+}
+
+void
+InterferenceHelperCompactionTest::AddInterferer (void)
+{
+  m_aged.Add (1000, m_mode, WIFI_PREAMBLE_LONG, MicroSeconds (500), 5e-10, m_txVector);
+  m_fresh.Add (1000, m_mode, WIFI_PREAMBLE_LONG, MicroSeconds (500), 5e-10, m_txVector);
+}
+
+void
+InterferenceHelperCompactionTest::CheckEnergyDuration (void)
+{
+  NS_TEST_EXPECT_MSG_EQ (m_aged.GetEnergyDuration (1e-11), m_fresh.GetEnergyDuration (1e-11),
+                         "Compacted helper reports a different energy duration");
+  NS_TEST_EXPECT_MSG_EQ (m_aged.GetEnergyDuration (1e-11), MicroSeconds (1900),
+                         "Unexpected energy duration");
+}
+
+void
+InterferenceHelperCompactionTest::EndRx (void)
+{
+  struct InterferenceHelper::SnrPer aged = m_aged.CalculateSnrPer (m_agedEvent);
+  struct InterferenceHelper::SnrPer fresh = m_fresh.CalculateSnrPer (m_freshEvent);
+  NS_TEST_EXPECT_MSG_EQ (aged.snr, fresh.snr, "Compacted helper reports a different SNR");
+  NS_TEST_EXPECT_MSG_EQ (aged.per, fresh.per, "Compacted helper reports a different PER");
+  NS_TEST_EXPECT_MSG_GT (aged.per, 0.0, "The interferer should corrupt part of the payload");
+  m_aged.NotifyRxEnd ();
+  m_fresh.NotifyRxEnd ();
+}
+
+void
+InterferenceHelperCompactionTest::DoRun (void)
+{
+  m_mode = WifiPhy::GetOfdmRate6Mbps ();
+  m_txVector.SetMode (m_mode);
+  m_aged.SetNoiseFigure (5.01187);
+  m_aged.SetErrorRateModel (CreateObject<YansErrorRateModel> ());
+  m_fresh.SetNoiseFigure (5.01187);
+  m_fresh.SetErrorRateModel (CreateObject<YansErrorRateModel> ());
+
+  const uint32_t nPastEvents = 1000;
+  for (uint32_t i = 0; i < nPastEvents; i++)
+    {
+      Simulator::Schedule (MicroSeconds (200 * i),
+                           &InterferenceHelperCompactionTest::AddPastEvent, this);
+    }
+  Time start = MicroSeconds (200 * nPastEvents);
+  Simulator::Schedule (start, &InterferenceHelperCompactionTest::StartRx, this);
+  Simulator::Schedule (start + MicroSeconds (100), &InterferenceHelperCompactionTest::CheckEnergyDuration, this);
+  Simulator::Schedule (start + MicroSeconds (1000), &InterferenceHelperCompactionTest::AddInterferer, this);
+  Simulator::Schedule (start + MicroSeconds (2000), &InterferenceHelperCompactionTest::EndRx, this);
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_agedEvent = 0;
+  m_freshEvent = 0;
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Make sure that a YansWifiChannel using its spatial index delivers the
+ * same receptions as the brute-force channel. Two clusters of stations
+ * 1 km apart broadcast periodically while one station travels from the
+ * first cluster to the second one at constant velocity (so the index has
+ * to account for its drift) and another one changes course halfway (so
+ * the index has to follow its course change).
+ */
+class YansWifiChannelSpatialIndexTest : public TestCase
+{
+public:
+  YansWifiChannelSpatialIndexTest ();
+
+  virtual void DoRun (void);
+private:
+  /**
+   * Run the scenario and record the receptions of each station.
+   *
+   * \param spatialIndexing whether the channel uses its spatial index
+   */
+  void RunScenario (bool spatialIndexing);
+  Ptr<Node> CreateOne (Ptr<MobilityModel> mobility, Ptr<YansWifiChannel> channel);
+  void SendOnePacket (Ptr<WifiNetDevice> dev);
+  void PhyRxEnd (std::string context, Ptr<const Packet> packet);
+
+  ObjectFactory m_manager;
+  ObjectFactory m_mac;
+  std::vector<uint32_t> m_rxEnd;
+  std::vector<Time> m_lastRx;
+};
+
+YansWifiChannelSpatialIndexTest::YansWifiChannelSpatialIndexTest ()
+  : TestCase ("YansWifiChannelSpatialIndex")
+{
+}
+
+void
+YansWifiChannelSpatialIndexTest::SendOnePacket (Ptr<WifiNetDevice> dev)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  dev->Send (p, dev->GetBroadcast (), 1);
+}
+
+void
+YansWifiChannelSpatialIndexTest::PhyRxEnd (std::string context, Ptr<const Packet> packet)
+{
+  uint32_t i = std::atoi (context.c_str ());
+  m_rxEnd[i]++;
+  m_lastRx[i] = Simulator::Now ();
+}
+
+Ptr<Node>
+YansWifiChannelSpatialIndexTest::CreateOne (Ptr<MobilityModel> mobility, Ptr<YansWifiChannel> channel)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<WifiNetDevice> dev = CreateObject<WifiNetDevice> ();
+
+  Ptr<WifiMac> mac = m_mac.Create<WifiMac> ();
+  mac->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  Ptr<ErrorRateModel> error = CreateObject<YansErrorRateModel> ();
+  phy->SetErrorRateModel (error);
+  phy->SetChannel (channel);
+  phy->SetDevice (dev);
+  phy->SetMobility (node);
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  Ptr<WifiRemoteStationManager> manager = m_manager.Create<WifiRemoteStationManager> ();
+
+  node->AggregateObject (mobility);
+  mac->SetAddress (Mac48Address::Allocate ());
+  dev->SetMac (mac);
+  dev->SetPhy (phy);
+  dev->SetRemoteStationManager (manager);
+  node->AddDevice (dev);
+
+  std::ostringstream oss;
+  oss << m_rxEnd.size ();
+  phy->TraceConnect ("PhyRxEnd", oss.str (), MakeCallback (&YansWifiChannelSpatialIndexTest::PhyRxEnd, this));
+  m_rxEnd.push_back (0);
+  m_lastRx.push_back (Seconds (0));
+  return node;
+}
+
+void
+YansWifiChannelSpatialIndexTest::RunScenario (bool spatialIndexing)
+{
+  m_rxEnd.clear ();
+  m_lastRx.clear ();
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  channel->SetPropagationLossModel (CreateObject<LogDistancePropagationLossModel> ());
+  channel->SetAttribute ("SpatialIndexing", BooleanValue (spatialIndexing));
+  channel->SetAttribute ("SpatialCellSize", DoubleValue (100.0));
+
+  std::vector<Ptr<Node> > nodes;
+  double xs[] = { 0.0, 10.0, 1000.0, 1010.0 };
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+      mobility->SetPosition (Vector (xs[i], 0.0, 0.0));
+      nodes.push_back (CreateOne (mobility, channel));
+    }
+  // travels from the first cluster to the second one
+  Ptr<ConstantVelocityMobilityModel> traveller = CreateObject<ConstantVelocityMobilityModel> ();
+  traveller->SetPosition (Vector (0.0, 5.0, 0.0));
+  traveller->SetVelocity (Vector (100.0, 0.0, 0.0));
+  nodes.push_back (CreateOne (traveller, channel));
+  // travels toward the second cluster, then turns back halfway
+  Ptr<ConstantVelocityMobilityModel> turner = CreateObject<ConstantVelocityMobilityModel> ();
+  turner->SetPosition (Vector (0.0, -5.0, 0.0));
+  turner->SetVelocity (Vector (100.0, 0.0, 0.0));
+  nodes.push_back (CreateOne (turner, channel));
+  Simulator::Schedule (Seconds (5.0), &ConstantVelocityMobilityModel::SetVelocity, turner,
+                       Vector (-100.0, 0.0, 0.0));
+
+  for (uint32_t i = 0; i < nodes.size (); i++)
+    {
+      Ptr<WifiNetDevice> dev = DynamicCast<WifiNetDevice> (nodes[i]->GetDevice (0));
+      for (Time t = MilliSeconds (10 * i); t < Seconds (10.0); t += MilliSeconds (100))
+        {
+          Simulator::Schedule (t, &YansWifiChannelSpatialIndexTest::SendOnePacket, this, dev);
+        }
+    }
+
+  Simulator::Stop (Seconds (11.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+YansWifiChannelSpatialIndexTest::DoRun (void)
+{
+  m_mac.SetTypeId ("ns3::AdhocWifiMac");
+  m_manager.SetTypeId ("ns3::ConstantRateWifiManager");
+
+  RunScenario (false);
+  std::vector<uint32_t> bruteForceRxEnd = m_rxEnd;
+  std::vector<Time> bruteForceLastRx = m_lastRx;
+  RunScenario (true);
+
+  NS_TEST_ASSERT_MSG_EQ (m_rxEnd.size (), bruteForceRxEnd.size (), "Different number of stations");
+  for (uint32_t i = 0; i < m_rxEnd.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_GT (m_rxEnd[i], 0, "Station " << i << " received nothing");
+      NS_TEST_EXPECT_MSG_EQ (m_rxEnd[i], bruteForceRxEnd[i],
+                             "Station " << i << " received a different number of packets");
+      NS_TEST_EXPECT_MSG_EQ (m_lastRx[i], bruteForceLastRx[i],
+                             "Station " << i << " received its last packet at a different time");
+    }
+}
+
 //-----------------------------------------------------------------------------
 /**
  * Make sure that when multiple broadcast packets are queued on the same
@@ -489,6 +751,8 @@ WifiTestSuite::WifiTestSuite ()
   AddTestCase (new WifiTest, TestCase::QUICK);
   AddTestCase (new QosUtilsIsOldPacketTest, TestCase::QUICK);
   AddTestCase (new InterferenceHelperSequenceTest, TestCase::QUICK); // Bug 991
+  AddTestCase (new InterferenceHelperCompactionTest, TestCase::QUICK);
+  AddTestCase (new YansWifiChannelSpatialIndexTest, TestCase::QUICK);
   AddTestCase (new Bug555TestCase, TestCase::QUICK); // Bug 555
 }
 